@@ -56,3 +56,6 @@ SET_PROPERTY(CACHE QT_VERSION PROPERTY STRINGS 5 6)
 
 # Translations
 OPTION(ENABLE_NLS "Enable NLS using Qt's built-in localization system." ON)
+
+# Unit tests.
+OPTION(BUILD_TESTING "Build unit tests." OFF)
@@ -13,10 +13,12 @@
 
 // C includes (C++ namespace)
 #include <cassert>
+#include <cstddef>
 #include <cstdio>
 #include <cstring>
 
 // C++ includes
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -307,6 +309,290 @@ uint32_t PokemonXD(const uint8_t *buf, uint32_t siz, uint32_t crc_addr, uint32_t
 	return chk_actual;
 }
 
+/** Incremental calculation **/
+
+/**
+ * Can a checksum algorithm be calculated incrementally?
+ *
+ * Incremental calculation is used if the checksummed data
+ * isn't contiguous in memory, e.g. when a file is being
+ * reassembled from memory card blocks.
+ *
+ * @param algorithm Checksum algorithm
+ * @return True if IncInit(), IncUpdate(), and IncFinal() can be used.
+ */
+bool IsIncremental(ChkAlgorithm algorithm)
+{
+	switch (algorithm) {
+		case ChkAlgorithm::CRC16:
+		case ChkAlgorithm::AddInvDual16:
+		case ChkAlgorithm::AddBytes32:
+		case ChkAlgorithm::SonicChaoGarden:
+		case ChkAlgorithm::DreamcastVMU:
+			return true;
+
+		default:
+			// NOTE: Pokémon XD has to decrypt the entire
+			// checksummed area before calculating the checksum.
+			break;
+	}
+	return false;
+}
+
+/**
+ * Initialize an incremental checksum.
+ * @param checksumDef Checksum definition
+ * @return Initial state
+ */
+uint32_t IncInit(const ChecksumDef &checksumDef)
+{
+	switch (checksumDef.algorithm) {
+		case ChkAlgorithm::CRC16:
+			return 0xFFFF;
+		case ChkAlgorithm::SonicChaoGarden:
+			return 0x6368616F;
+		default:
+			break;
+	}
+	return 0;
+}
+
+/**
+ * Update an incremental checksum.
+ *
+ * Data outside of the checksummed area is ignored.
+ * The checksummed area must be processed in order.
+ *
+ * @param checksumDef Checksum definition
+ * @param state Current state
+ * @param buf Data buffer
+ * @param offset Offset of the data buffer within the file
+ * @param siz Length of data buffer
+ * @return New state
+ */
+uint32_t IncUpdate(const ChecksumDef &checksumDef, uint32_t state,
+		   const uint8_t *buf, uint32_t offset, uint32_t siz)
+{
+	// Clip the data to the checksummed area.
+	uint64_t end = (uint64_t)checksumDef.start + checksumDef.length;
+	if (checksumDef.algorithm == ChkAlgorithm::AddInvDual16) {
+		// Only complete words are added.
+		end = (uint64_t)checksumDef.start + (checksumDef.length & ~1U);
+	}
+	end = std::min(end, (uint64_t)offset + siz);
+	uint32_t pos = std::max(offset, checksumDef.start);
+	if (pos >= end) {
+		// Nothing to do here.
+		return state;
+	}
+
+	buf += (pos - offset);
+	switch (checksumDef.algorithm) {
+		default:
+			assert(!"Algorithm can't be calculated incrementally.");
+			break;
+
+		case ChkAlgorithm::CRC16: {
+			const uint16_t poly = (checksumDef.param != 0
+				? (uint16_t)(checksumDef.param & 0xFFFF)
+				: CRC16_POLY_CCITT);
+			uint16_t crc = (uint16_t)state;
+			for (; pos < end; pos++, buf++) {
+				crc ^= *buf;
+				for (int i = 8; i > 0; i--) {
+					if (crc & 1)
+						crc = ((crc >> 1) ^ poly);
+					else
+						crc >>= 1;
+				}
+			}
+			state = crc;
+			break;
+		}
+
+		case ChkAlgorithm::AddInvDual16: {
+			// Words are aligned to the start of the checksummed area.
+			// NOTE: Integer overflow is expected here.
+			const bool evenIsHigh = (checksumDef.endian != ChkEndian::Little);
+			uint16_t chk1 = (uint16_t)state;
+			for (; pos < end; pos++, buf++) {
+				const bool even = !((pos - checksumDef.start) & 1);
+				chk1 += (even == evenIsHigh ? (*buf << 8) : *buf);
+			}
+			state = chk1;
+			break;
+		}
+
+		case ChkAlgorithm::AddBytes32:
+			for (; pos < end; pos++, buf++) {
+				state += *buf;
+			}
+			break;
+
+		case ChkAlgorithm::SonicChaoGarden: {
+			// The checksum bytes and random_3 must be 0.
+			const uint32_t chk_addr = checksumDef.address;
+			for (; pos < end; pos++, buf++) {
+				uint8_t chr = *buf;
+				if (pos >= chk_addr && pos < chk_addr + sizeof(ChaoGardenChecksumData)) {
+					switch (pos - chk_addr) {
+						case offsetof(ChaoGardenChecksumData, checksum_0):
+						case offsetof(ChaoGardenChecksumData, checksum_1):
+						case offsetof(ChaoGardenChecksumData, checksum_2):
+						case offsetof(ChaoGardenChecksumData, checksum_3):
+						case offsetof(ChaoGardenChecksumData, random_3):
+							chr = 0;
+							break;
+						default:
+							break;
+					}
+				}
+				state = SonicChaoGarden_CRC32_Table[chr ^ (state & 0xFF)] ^ (state >> 8);
+			}
+			break;
+		}
+
+		case ChkAlgorithm::DreamcastVMU: {
+			// See Exec() for the default CRC address.
+			const uint32_t crc_addr = (checksumDef.param != 0 ? checksumDef.param : 0x46);
+			unsigned int n = state;
+			for (; pos < end; pos++, buf++) {
+				const uint32_t i = pos - checksumDef.start;
+				uint8_t chr = *buf;
+				if (i == crc_addr || i == (crc_addr + 1)) {
+					// CRC address. Pretend it's 0.
+					chr = 0;
+				}
+
+				n ^= (chr << 8);
+				for (int c = 0; c < 8; c++) {
+					if (n & 0x8000)
+						n = (n << 1) ^ 4129;
+					else
+						n = (n << 1);
+				}
+			}
+			state = (n & 0xFFFF);
+			break;
+		}
+	}
+
+	return state;
+}
+
+/**
+ * Finalize an incremental checksum.
+ * @param checksumDef Checksum definition
+ * @param state Current state
+ * @return Checksum, as returned by Exec()
+ */
+uint32_t IncFinal(const ChecksumDef &checksumDef, uint32_t state)
+{
+	switch (checksumDef.algorithm) {
+		default:
+			break;
+
+		case ChkAlgorithm::CRC16:
+			return (uint16_t)~state;
+
+		case ChkAlgorithm::AddInvDual16: {
+			// See AddInvDual16() for an explanation.
+			const uint16_t chk1 = (uint16_t)state;
+			uint16_t chk2 = (uint16_t)(-(int)(checksumDef.length / 2));
+			chk2 -= chk1;
+			return (((chk1 == 0xFFFF ? 0 : chk1) << 16) |
+				 (chk2 == 0xFFFF ? 0 : chk2));
+		}
+
+		case ChkAlgorithm::SonicChaoGarden:
+			return (0x686F6765 ^ state);
+	}
+
+	// AddBytes32 and DreamcastVMU use the state as-is.
+	return state;
+}
+
+/**
+ * Get the size of a checksum field.
+ * @param algorithm Checksum algorithm
+ * @return Size of the checksum field, in bytes.
+ */
+uint32_t FieldSize(ChkAlgorithm algorithm)
+{
+	switch (algorithm) {
+		case ChkAlgorithm::CRC16:
+		case ChkAlgorithm::DreamcastVMU:
+			return 2;
+		case ChkAlgorithm::SonicChaoGarden:
+			return (uint32_t)sizeof(ChaoGardenChecksumData);
+		default:
+			break;
+	}
+	return 4;
+}
+
+/**
+ * Get the expected checksum from a checksum field.
+ * NOTE: Not valid for ChkAlgorithm::PokemonXD.
+ * @param checksumDef Checksum definition
+ * @param field Checksum field (FieldSize() bytes)
+ * @return Expected checksum
+ */
+uint32_t Expected(const ChecksumDef &checksumDef, const uint8_t *field)
+{
+	// NOTE: Assuming big-endian for all values.
+	const bool isLE = (checksumDef.endian == ChkEndian::Little);
+	switch (checksumDef.algorithm) {
+		default:
+			// Unsupported algorithm.
+			break;
+
+		case ChkAlgorithm::CRC16:
+		case ChkAlgorithm::DreamcastVMU:
+			if (!isLE) {
+				// Big-endian
+				return (field[0] << 8) | field[1];
+			} else {
+				// Little-endian
+				return (field[1] << 8) | field[0];
+			}
+
+		case ChkAlgorithm::CRC32:
+		case ChkAlgorithm::AddInvDual16:
+		case ChkAlgorithm::AddBytes32:
+			if (!isLE) {
+				// Big-endian
+				return ((uint32_t)field[0] << 24) | (field[1] << 16) |
+				       (field[2] << 8) | field[3];
+			} else {
+				// Little-endian
+				return ((uint32_t)field[3] << 24) | (field[2] << 16) |
+				       (field[1] << 8) | field[0];
+			}
+
+		case ChkAlgorithm::SonicChaoGarden: {
+			const ChaoGardenChecksumData *const chaoChk =
+				reinterpret_cast<const ChaoGardenChecksumData*>(field);
+			if (!isLE) {
+				// Big-endian
+				return ((uint32_t)chaoChk->checksum_3 << 24) |
+				       (chaoChk->checksum_2 << 16) |
+				       (chaoChk->checksum_1 << 8) |
+				       (chaoChk->checksum_0);
+			} else {
+				// Little-endian
+				// TODO: Is this correct?
+				return ((uint32_t)chaoChk->checksum_0 << 24) |
+				       (chaoChk->checksum_1 << 16) |
+				       (chaoChk->checksum_2 << 8) |
+				       (chaoChk->checksum_3);
+			}
+		}
+	}
+
+	return 0;
+}
+
 /** General functions **/
 
 /**
@@ -361,6 +647,109 @@ uint32_t Exec(ChkAlgorithm algorithm, const void *buf, uint32_t siz, ChkEndian e
 	return 0;
 }
 
+/**
+ * Calculate a checksum for file data.
+ * This gets both the expected checksum (stored in the file)
+ * and the actual checksum.
+ *
+ * NOTE: Some algorithms temporarily modify the file data
+ * while calculating the checksum. The data is restored
+ * before this function returns.
+ *
+ * @param checksumDef	[in] Checksum definition
+ * @param data		[in] File data
+ * @param size		[in] Size of the file data
+ * @param pValue	[out] Checksum value
+ * @return True on success; false if the definition is invalid or out of range.
+ */
+bool Calculate(const ChecksumDef &checksumDef, uint8_t *data, uint32_t size, ChecksumValue *pValue)
+{
+	if (checksumDef.algorithm == ChkAlgorithm::None ||
+	    checksumDef.algorithm >= ChkAlgorithm::Max ||
+	    checksumDef.length == 0)
+	{
+		// No algorithm or invalid algorithm set,
+		// or the checksum data has no length.
+		return false;
+	}
+
+	// Make sure the checksum definition is in range.
+	if (size < checksumDef.address ||
+	    size < checksumDef.start + checksumDef.length)
+	{
+		// File is too small...
+		// TODO: Also check the size of the checksum itself.
+		return false;
+	}
+
+	// Get the expected checksum.
+	uint32_t expected = 0;
+	ChaoGardenChecksumData chaoChk_orig;
+
+	// Use Exec() for most algorithms.
+	// Some unusual ones need to be run manually.
+	bool useExec = true;
+
+	const char *const start = (reinterpret_cast<const char*>(data) + checksumDef.start);
+	uint32_t actual = 0;
+
+	switch (checksumDef.algorithm) {
+		default:
+		case ChkAlgorithm::None:
+			// Unsupported algorithm.
+			expected = 0;
+			break;
+
+		case ChkAlgorithm::CRC16:
+		case ChkAlgorithm::CRC32:
+		case ChkAlgorithm::AddInvDual16:
+		case ChkAlgorithm::AddBytes32:
+		case ChkAlgorithm::DreamcastVMU:
+			expected = Expected(checksumDef, &data[checksumDef.address]);
+			break;
+
+		case ChkAlgorithm::SonicChaoGarden: {
+			memcpy(&chaoChk_orig, &data[checksumDef.address], sizeof(chaoChk_orig));
+			expected = Expected(checksumDef, &data[checksumDef.address]);
+
+			// Temporary working copy.
+			ChaoGardenChecksumData chaoChk = chaoChk_orig;
+
+			// Clear some fields that must be 0 when calculating the checksum.
+			chaoChk.checksum_3 = 0;
+			chaoChk.checksum_2 = 0;
+			chaoChk.checksum_1 = 0;
+			chaoChk.checksum_0 = 0;
+			chaoChk.random_3 = 0;
+			memcpy(&data[checksumDef.address], &chaoChk, sizeof(chaoChk));
+			break;
+		}
+
+		case ChkAlgorithm::PokemonXD:
+			// Pokémon XD has a more complicated checksum.
+			useExec = false;
+			actual = PokemonXD(reinterpret_cast<const uint8_t*>(start),
+				checksumDef.length, checksumDef.address, &expected);
+			break;
+	}
+
+	if (useExec) {
+		// Use Exec().
+		actual = Exec(checksumDef.algorithm,
+			start, checksumDef.length, checksumDef.endian, checksumDef.param);
+	}
+
+	if (checksumDef.algorithm == ChkAlgorithm::SonicChaoGarden) {
+		// Restore the Chao Garden checksum data.
+		memcpy(&data[checksumDef.address], &chaoChk_orig, sizeof(chaoChk_orig));
+	}
+
+	// Save the checksums.
+	pValue->expected = expected;
+	pValue->actual = actual;
+	return true;
+}
+
 /**
  * Get a ChkAlgorithm from a checksum algorithm name.
  * @param algorithm Checksum algorithm name
@@ -178,6 +178,67 @@ uint16_t DreamcastVMU(const uint8_t *buf, uint32_t siz, uint32_t crc_addr = -1);
  */
 uint32_t PokemonXD(const uint8_t *buf, uint32_t siz, uint32_t crc_addr, uint32_t *pChkExpect);
 
+/** Incremental calculation **/
+
+/**
+ * Can a checksum algorithm be calculated incrementally?
+ *
+ * Incremental calculation is used if the checksummed data
+ * isn't contiguous in memory, e.g. when a file is being
+ * reassembled from memory card blocks.
+ *
+ * @param algorithm Checksum algorithm
+ * @return True if IncInit(), IncUpdate(), and IncFinal() can be used.
+ */
+bool IsIncremental(ChkAlgorithm algorithm);
+
+/**
+ * Initialize an incremental checksum.
+ * @param checksumDef Checksum definition
+ * @return Initial state
+ */
+uint32_t IncInit(const ChecksumDef &checksumDef);
+
+/**
+ * Update an incremental checksum.
+ *
+ * Data outside of the checksummed area is ignored.
+ * The checksummed area must be processed in order.
+ *
+ * @param checksumDef Checksum definition
+ * @param state Current state
+ * @param buf Data buffer
+ * @param offset Offset of the data buffer within the file
+ * @param siz Length of data buffer
+ * @return New state
+ */
+uint32_t IncUpdate(const ChecksumDef &checksumDef, uint32_t state,
+		   const uint8_t *buf, uint32_t offset, uint32_t siz);
+
+/**
+ * Finalize an incremental checksum.
+ * @param checksumDef Checksum definition
+ * @param state Current state
+ * @return Checksum, as returned by Exec()
+ */
+uint32_t IncFinal(const ChecksumDef &checksumDef, uint32_t state);
+
+/**
+ * Get the size of a checksum field.
+ * @param algorithm Checksum algorithm
+ * @return Size of the checksum field, in bytes.
+ */
+uint32_t FieldSize(ChkAlgorithm algorithm);
+
+/**
+ * Get the expected checksum from a checksum field.
+ * NOTE: Not valid for ChkAlgorithm::PokemonXD.
+ * @param checksumDef Checksum definition
+ * @param field Checksum field (FieldSize() bytes)
+ * @return Expected checksum
+ */
+uint32_t Expected(const ChecksumDef &checksumDef, const uint8_t *field);
+
 /** General functions. **/
 
 /**
@@ -191,6 +252,23 @@ uint32_t PokemonXD(const uint8_t *buf, uint32_t siz, uint32_t crc_addr, uint32_t
  */
 uint32_t Exec(ChkAlgorithm algorithm, const void *buf, uint32_t siz, ChkEndian endian, uint32_t param = 0);
 
+/**
+ * Calculate a checksum for file data.
+ * This gets both the expected checksum (stored in the file)
+ * and the actual checksum.
+ *
+ * NOTE: Some algorithms temporarily modify the file data
+ * while calculating the checksum. The data is restored
+ * before this function returns.
+ *
+ * @param checksumDef	[in] Checksum definition
+ * @param data		[in] File data
+ * @param size		[in] Size of the file data
+ * @param pValue	[out] Checksum value
+ * @return True on success; false if the definition is invalid or out of range.
+ */
+bool Calculate(const ChecksumDef &checksumDef, uint8_t *data, uint32_t size, ChecksumValue *pValue);
+
 /**
  * Get a ChkAlgorithm from a checksum algorithm name.
  * @param algorithm Checksum algorithm name
@@ -0,0 +1,149 @@
+/***************************************************************************
+ * GameCube Tools Library: Unit tests.                                     *
+ * ChecksumTest.cpp: Incremental checksum tests.                           *
+ *                                                                         *
+ * Copyright (c) 2013-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "Checksum.hpp"
+using namespace Checksum;
+
+// C includes (C++ namespace)
+#include <cstring>
+
+// C++ includes
+#include <vector>
+using std::vector;
+
+// Qt includes
+#include <QtCore/QObject>
+#include <QtTest/QtTest>
+
+Q_DECLARE_METATYPE(Checksum::ChkAlgorithm)
+
+class ChecksumTest : public QObject
+{
+	Q_OBJECT
+
+	private:
+		/**
+		 * Pseudo-random number generator.
+		 * The sequence must be the same on all platforms,
+		 * so qrand() and rand() aren't used.
+		 * @return Pseudo-random number (15 bits)
+		 */
+		uint32_t nextRandom(void)
+		{
+			seed = (seed * 1103515245U) + 12345U;
+			return (seed >> 16) & 0x7FFF;
+		}
+
+		uint32_t seed;
+
+	private slots:
+		void init(void);
+
+		void incremental_data(void);
+		void incremental(void);
+
+		void notIncremental_data(void);
+		void notIncremental(void);
+};
+
+void ChecksumTest::init(void)
+{
+	seed = 1;
+}
+
+void ChecksumTest::incremental_data(void)
+{
+	QTest::addColumn<ChkAlgorithm>("algorithm");
+
+	QTest::newRow("CRC16") << ChkAlgorithm::CRC16;
+	QTest::newRow("AddInvDual16") << ChkAlgorithm::AddInvDual16;
+	QTest::newRow("AddBytes32") << ChkAlgorithm::AddBytes32;
+	QTest::newRow("SonicChaoGarden") << ChkAlgorithm::SonicChaoGarden;
+	QTest::newRow("DreamcastVMU") << ChkAlgorithm::DreamcastVMU;
+}
+
+/**
+ * The incremental functions must return the same checksums as
+ * Calculate(), regardless of how the data is split up.
+ */
+void ChecksumTest::incremental(void)
+{
+	QFETCH(ChkAlgorithm, algorithm);
+	QVERIFY(IsIncremental(algorithm));
+
+	int tested = 0;
+	for (int i = 0; i < 2000; i++) {
+		const uint32_t size = 8 + (nextRandom() % 300);
+		vector<uint8_t> data(size);
+		for (uint8_t &chr : data) {
+			chr = (uint8_t)nextRandom();
+		}
+
+		ChecksumDef def;
+		def.algorithm = algorithm;
+		def.start = nextRandom() % size;
+		def.length = 1 + (nextRandom() % (size - def.start));
+		if (algorithm == ChkAlgorithm::AddInvDual16) {
+			// AddInvDual16 works with 16-bit words.
+			def.start &= ~1U;
+		}
+		def.address = nextRandom() % (size - 7);
+		def.param = ((nextRandom() & 1) ? 0 : (nextRandom() % 0x60));
+		def.endian = ((nextRandom() & 1) ? ChkEndian::Little : ChkEndian::Big);
+
+		ChecksumValue value;
+		if (!Calculate(def, data.data(), size, &value)) {
+			// Definition isn't valid for this buffer.
+			continue;
+		}
+
+		// Process the data in randomly-sized pieces.
+		// Pieces may be partially outside of the checksummed area.
+		uint32_t state = IncInit(def);
+		uint32_t offset = 0;
+		while (offset < size) {
+			uint32_t len = 1 + (nextRandom() % 17);
+			if (offset + len > size) {
+				len = size - offset;
+			}
+			state = IncUpdate(def, state, &data[offset], offset, len);
+			offset += len;
+		}
+
+		QCOMPARE(IncFinal(def, state), value.actual);
+		QVERIFY(def.address + FieldSize(algorithm) <= size);
+		QCOMPARE(Expected(def, &data[def.address]), value.expected);
+		tested++;
+	}
+
+	// Make sure most of the definitions were actually tested.
+	QVERIFY(tested >= 1000);
+}
+
+void ChecksumTest::notIncremental_data(void)
+{
+	QTest::addColumn<ChkAlgorithm>("algorithm");
+
+	QTest::newRow("None") << ChkAlgorithm::None;
+	QTest::newRow("CRC32") << ChkAlgorithm::CRC32;
+	QTest::newRow("PokemonXD") << ChkAlgorithm::PokemonXD;
+}
+
+/**
+ * Algorithms that can't be calculated incrementally
+ * must not be reported as incremental.
+ */
+void ChecksumTest::notIncremental(void)
+{
+	QFETCH(ChkAlgorithm, algorithm);
+	QVERIFY(!IsIncremental(algorithm));
+}
+
+QTEST_APPLESS_MAIN(ChecksumTest)
+
+#include "ChecksumTest.moc"
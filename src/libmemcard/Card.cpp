@@ -16,10 +16,12 @@
 #include <cassert>
 
 // C++ includes.
+#include <algorithm>
 #include <limits>
 
 // Qt includes.
 #include <QtCore/QFile>
+#include <QtCore/QMutexLocker>
 #include <QtCore/QVector>
 
 #define NUM_ELEMENTS(x) ((int)(sizeof(x) / sizeof(x[0])))
@@ -73,7 +75,6 @@ CardPrivate::~CardPrivate()
 
 	if (file) {
 		file->close();
-		delete file;
 	}
 }
 
@@ -102,18 +103,16 @@ int CardPrivate::open(const QString &filename, QIODevice::OpenModeFlag openMode)
 	}
 
 	// Open the file.
-	Q_Q(Card);
-	QFile *tmp_file = new QFile(filename, q);
+	std::unique_ptr<QFile> tmp_file(new QFile(filename));
 	if (!tmp_file->open(openMode)) {
 		// Error opening the file.
 		// NOTE: Qt doesn't return the raw error number.
 		// QFile::error() has a useless generic error number.
 		// TODO: Translate the error message.
 		this->errorString = tmp_file->errorString();
-		delete tmp_file;
 		return -1;
 	}
-	this->file = tmp_file;
+	this->file = std::move(tmp_file);
 	this->filename = filename;
 
 	// Save the readOnly flag.
@@ -158,9 +157,14 @@ void CardPrivate::close(void)
 		return;
 	}
 
+	// Write any uncommitted blocks.
+	// NOTE: If this fails, the writes are lost.
+	flushDirtyBlocks();
+
 	file->close();
-	delete file;
-	file = nullptr;
+	file.reset();
+	dirtyBlocks.clear();
+	image.clear();
 
 	// Clear the cached values.
 	filename.clear();
@@ -170,6 +174,185 @@ void CardPrivate::close(void)
 	freeBlocks = 0;
 }
 
+/**
+ * Load the entire card image into memory.
+ * This should only be used for small cards.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CardPrivate::loadImage(void)
+{
+	if (!file)
+		return -EBADF;
+
+	if (!file->seek(0))
+		return -EIO;
+	image = file->read(this->filesize);
+	if (image.size() < (int)this->filesize) {
+		// Short read.
+		image.clear();
+		return -EIO;
+	}
+	return 0;
+}
+
+/**
+ * Read a block directly from the card image, bypassing the cache.
+ * Subclasses that don't map blocks 1:1 to a single file
+ * can override this.
+ * @param buf Buffer to read the block data into. (Must be >= blockSize.)
+ * @param blockIdx Block index.
+ * @return Bytes read on success; negative POSIX error code on error.
+ */
+int CardPrivate::readBlockDirect(void *buf, uint16_t blockIdx)
+{
+	const qint64 pos = ((qint64)blockIdx * blockSize) + headerSize;
+	if (!image.isEmpty()) {
+		// Card image is in memory.
+		if (pos >= image.size())
+			return 0;
+		const int len = (int)std::min((qint64)blockSize, image.size() - pos);
+		memcpy(buf, image.constData() + pos, len);
+		return len;
+	}
+
+	if (!file->seek(pos))
+		return -EIO;	// TODO: Proper error code?
+	int ret = (int)file->read((char*)buf, blockSize);
+	return (ret >= 0 ? ret : -EIO);
+}
+
+/**
+ * Read contiguous blocks directly from the card image, bypassing the cache.
+ * The default implementation reads all blocks at once.
+ * Subclasses that override readBlockDirect() must override this, too.
+ * @param buf Buffer to read the block data into. (Must be >= count*blockSize.)
+ * @param blockIdx First block index.
+ * @param count Number of blocks.
+ * @return Bytes read on success; negative POSIX error code on error.
+ */
+int CardPrivate::readBlocksDirect(void *buf, uint16_t blockIdx, int count)
+{
+	const qint64 pos = ((qint64)blockIdx * blockSize) + headerSize;
+	const qint64 size = ((qint64)count * blockSize);
+	if (!image.isEmpty()) {
+		// Card image is in memory.
+		if (pos >= image.size())
+			return 0;
+		const int len = (int)std::min(size, image.size() - pos);
+		memcpy(buf, image.constData() + pos, len);
+		return len;
+	}
+
+	if (!file->seek(pos))
+		return -EIO;	// TODO: Proper error code?
+	int ret = (int)file->read((char*)buf, size);
+	return (ret >= 0 ? ret : -EIO);
+}
+
+/**
+ * Write all cached block writes to the card image,
+ * then update the file system metadata.
+ * Blocks are written in sorted order, with contiguous
+ * blocks coalesced into a single write.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CardPrivate::flushDirtyBlocks(void)
+{
+	if (!file)
+		return -EBADF;
+	else if (dirtyBlocks.isEmpty())
+		return 0;
+	else if (readOnly)
+		return -EROFS;
+
+	// Coalesce runs of contiguous blocks.
+	// QMap is sorted by key, so the blocks are already in order.
+	QByteArray run;
+	uint16_t runStart = 0;
+	int runCount = 0;
+	int ret = 0;
+	for (auto iter = dirtyBlocks.constBegin();
+	     iter != dirtyBlocks.constEnd(); ++iter)
+	{
+		if (runCount > 0 && iter.key() == runStart + runCount) {
+			// Contiguous with the current run.
+			run += iter.value();
+			runCount++;
+			continue;
+		}
+
+		// Flush the current run.
+		if (runCount > 0) {
+			ret = writeBlocksDirect(run.constData(), runStart, runCount);
+			if (ret != 0)
+				return ret;
+		}
+
+		// Start a new run.
+		run = iter.value();
+		runStart = iter.key();
+		runCount = 1;
+	}
+	if (runCount > 0) {
+		ret = writeBlocksDirect(run.constData(), runStart, runCount);
+		if (ret != 0)
+			return ret;
+	}
+
+	// Make sure the file data is written before the metadata.
+	file->flush();
+	dirtyBlocks.clear();
+
+	// Update the file system metadata.
+	ret = commitMetadata();
+	file->flush();
+	return ret;
+}
+
+/**
+ * Write blocks directly to the card image, bypassing the cache.
+ * @param buf Block data. (Must be count*blockSize bytes.)
+ * @param blockIdx First block index.
+ * @param count Number of blocks.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CardPrivate::writeBlocksDirect(const void *buf, uint16_t blockIdx, int count)
+{
+	if (!file)
+		return -EBADF;
+	else if (readOnly)
+		return -EROFS;
+	else if (count <= 0)
+		return 0;
+
+	const qint64 pos = ((qint64)blockIdx * blockSize) + headerSize;
+	const qint64 len = (qint64)count * blockSize;
+	if (!file->seek(pos))
+		return -EIO;	// TODO: Proper error code?
+	const qint64 ret = file->write(static_cast<const char*>(buf), len);
+	if (ret != len)
+		return -EIO;
+
+	if (pos + len <= image.size()) {
+		// Keep the in-memory image in sync.
+		memcpy(image.data() + pos, buf, len);
+	}
+	return 0;
+}
+
+/**
+ * Update the file system metadata after the dirty blocks
+ * have been flushed by Card::commit().
+ * Subclasses should override this to rewrite their
+ * directory and block tables. (checksums, update counters)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CardPrivate::commitMetadata(void)
+{
+	// Default implementation has no metadata to update.
+	return 0;
+}
+
 /**
  * Find the most common byte in a block of data.
  * This is useful for determining header garbage.
@@ -223,6 +406,11 @@ Card::Card(CardPrivate *d, QObject *parent)
 
 Card::~Card()
 {
+	// NOTE: Uncommitted blocks must be written by the subclass
+	// destructor, since commitMetadata() is virtual and the
+	// subclass has already been destroyed at this point.
+	// Anything left over is discarded.
+	d_ptr->dirtyBlocks.clear();
 	delete d_ptr;
 }
 
@@ -274,6 +462,9 @@ bool Card::isReadOnly(void) const
  * on the card, since writing to a card with errors can cause even
  * more problems.
  *
+ * When switching to read-only, uncommitted block writes
+ * are committed first. If that fails, the card stays writable.
+ *
  * @param readOnly New readOnly value.
  * @return 0 on success; negative POSIX error code on error.
  * (Check this->errorString for more information.)
@@ -281,6 +472,7 @@ bool Card::isReadOnly(void) const
 int Card::setReadOnly(bool readOnly)
 {
 	Q_D(Card);
+	QMutexLocker ioLocker(&d->ioMutex);
 	if (!isOpen())
 		return -EBADF;
 	if (d->readOnly == readOnly)
@@ -298,13 +490,21 @@ int Card::setReadOnly(bool readOnly)
 		return -EROFS;
 	}
 
+	if (readOnly) {
+		// Write any uncommitted blocks first.
+		// If this fails, the card stays writable.
+		int ret = d->flushDirtyBlocks();
+		if (ret != 0)
+			return ret;
+	}
+
 	// Open mode.
 	const QIODevice::OpenMode openMode = (readOnly ? QIODevice::ReadOnly : QIODevice::ReadWrite);
 
 	// Attempt to open the file using a new QFile.
 	// FIXME: Do we need to close the first QFile due to sharing?
 	// Open the file.
-	QFile *tmp_file = new QFile(d->filename, this);
+	std::unique_ptr<QFile> tmp_file(new QFile(d->filename));
 	if (!tmp_file->open(openMode)) {
 		// Error opening the file.
 		// NOTE: Qt doesn't return the raw error number.
@@ -312,7 +512,6 @@ int Card::setReadOnly(bool readOnly)
 		// TODO: Translate the error message.
 		// TODO: Convert into a POSIX error code?
 		d->errorString = tmp_file->errorString();
-		delete tmp_file;
 		return -EIO;
 	}
 
@@ -321,7 +520,6 @@ int Card::setReadOnly(bool readOnly)
 	std::swap(d->file, tmp_file);
 	d->readOnly = readOnly;
 	tmp_file->close();
-	delete tmp_file;
 	return 0;
 }
 
@@ -613,6 +811,7 @@ bool Card::isFreeBlockCountValid(int idx) const
 int Card::readBlock(void *buf, int siz, uint16_t blockIdx)
 {
 	Q_D(Card);
+	QMutexLocker ioLocker(&d->ioMutex);
 	if (!isOpen())
 		return EBADF;
 	else if (siz < (int)d->blockSize)
@@ -620,12 +819,15 @@ int Card::readBlock(void *buf, int siz, uint16_t blockIdx)
 	else if (siz == 0)
 		return 0;
 
+	// Check the write-back cache first.
+	auto iter = d->dirtyBlocks.constFind(blockIdx);
+	if (iter != d->dirtyBlocks.constEnd()) {
+		memcpy(buf, iter->constData(), d->blockSize);
+		return (int)d->blockSize;
+	}
+
 	// Read the specified block.
-	const qint64 pos = ((qint64)blockIdx * d->blockSize) + d->headerSize;
-	if (!d->file->seek(pos))
-		return -EIO;	// TODO: Proper error code?
-	int ret = (int)d->file->read((char*)buf, d->blockSize);
-	return (ret >= 0 ? ret : -EIO);
+	return d->readBlockDirect(buf, blockIdx);
 }
 
 /**
@@ -638,6 +840,7 @@ int Card::readBlock(void *buf, int siz, uint16_t blockIdx)
 int Card::writeBlock(const void *buf, int siz, uint16_t blockIdx)
 {
 	Q_D(Card);
+	QMutexLocker ioLocker(&d->ioMutex);
 	if (!isOpen())
 		return -EBADF;
 	else if (siz < (int)d->blockSize)
@@ -649,16 +852,98 @@ int Card::writeBlock(const void *buf, int siz, uint16_t blockIdx)
 	if (d->readOnly)
 		return -EROFS;
 
-	// Write the specified block.
-	const qint64 pos = ((qint64)blockIdx * d->blockSize) + d->headerSize;
-	if (!d->file->seek(pos))
-		return -EIO;    // TODO: Proper error code?
-	// TODO: Check for errors?
-	int ret = (int)d->file->write((char*)buf, d->blockSize);
-	return (ret >= 0 ? ret : -EIO);
+	// Don't allow writes past the end of the card.
+	if ((int)blockIdx >= d->totalPhysBlocks)
+		return -EINVAL;
+
+	// Store the block in the write-back cache.
+	// It will be written to the card image by commit().
+	d->dirtyBlocks.insert(blockIdx,
+		QByteArray(static_cast<const char*>(buf), (int)d->blockSize));
+	return (int)d->blockSize;
 }
 
-// TODO: Add readBlocks() and writeBlocks() functions?
+/**
+ * Read contiguous blocks.
+ * This is faster than calling readBlock() for each block,
+ * since the card image is read all at once.
+ * @param buf Buffer to read the block data into.
+ * @param siz Size of buffer. (Must be >= count*blockSize.)
+ * @param blockIdx First block index.
+ * @param count Number of blocks.
+ * @return Bytes read on success; negative POSIX error code on error.
+ */
+int Card::readBlocks(void *buf, int siz, uint16_t blockIdx, int count)
+{
+	Q_D(Card);
+	QMutexLocker ioLocker(&d->ioMutex);
+	if (!isOpen())
+		return -EBADF;
+	else if (count <= 0)
+		return 0;
+	else if (siz < (int)d->blockSize * count)
+		return -EINVAL;
+
+	int ret = d->readBlocksDirect(buf, blockIdx, count);
+	if (ret <= 0)
+		return ret;
+
+	// Apply blocks from the write-back cache.
+	const int blocksRead = (ret / (int)d->blockSize);
+	const uint32_t lastBlockIdx = (uint32_t)blockIdx + blocksRead;
+	for (auto iter = d->dirtyBlocks.lowerBound(blockIdx);
+	     iter != d->dirtyBlocks.end() && iter.key() < lastBlockIdx; ++iter)
+	{
+		memcpy(static_cast<uint8_t*>(buf) + ((iter.key() - blockIdx) * d->blockSize),
+			iter->constData(), d->blockSize);
+	}
+
+	return ret;
+}
+
+// TODO: Add a writeBlocks() function?
+
+/**
+ * Are there any uncommitted block writes?
+ * @return True if there are uncommitted writes; false if not.
+ */
+bool Card::isDirty(void) const
+{
+	Q_D(const Card);
+	QMutexLocker ioLocker(&d->ioMutex);
+	return !d->dirtyBlocks.isEmpty();
+}
+
+/**
+ * Commit all cached block writes to the card image.
+ * Blocks are written in sorted order, with contiguous
+ * blocks coalesced into a single write. The file system
+ * metadata is then updated once for the entire transaction.
+ *
+ * NOTE: Data blocks are overwritten in place. If the commit
+ * is interrupted, the directory and block tables are still
+ * consistent, but the file data may be partially written.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Card::commit(void)
+{
+	Q_D(Card);
+	QMutexLocker ioLocker(&d->ioMutex);
+	if (!isOpen())
+		return -EBADF;
+	return d->flushDirtyBlocks();
+}
+
+/**
+ * Discard all cached block writes.
+ */
+void Card::rollback(void)
+{
+	Q_D(Card);
+	QMutexLocker ioLocker(&d->ioMutex);
+	d->dirtyBlocks.clear();
+}
 
 /** File management **/
 
@@ -305,8 +305,22 @@ class Card : public QObject
 		 */
 		int readBlock(void *buf, int siz, uint16_t blockIdx);
 
+		/**
+		 * Read contiguous blocks.
+		 * This is faster than calling readBlock() for each block,
+		 * since the card image is read all at once.
+		 * @param buf Buffer to read the block data into.
+		 * @param siz Size of buffer. (Must be >= count*blockSize.)
+		 * @param blockIdx First block index.
+		 * @param count Number of blocks.
+		 * @return Bytes read on success; negative POSIX error code on error.
+		 */
+		int readBlocks(void *buf, int siz, uint16_t blockIdx, int count);
+
 		/**
 		 * Write a block.
+		 * NOTE: The block is held in the write-back cache
+		 * until commit() is called.
 		 * @param buf Buffer containing the data to write.
 		 * @param siz Size of buffer. (Must be equal to blockSize.)
 		 * @param blockIdx Block index.
@@ -314,6 +328,31 @@ class Card : public QObject
 		 */
 		int writeBlock(const void *buf, int siz, uint16_t blockIdx);
 
+		/**
+		 * Are there any uncommitted block writes?
+		 * @return True if there are uncommitted writes; false if not.
+		 */
+		bool isDirty(void) const;
+
+		/**
+		 * Commit all cached block writes to the card image.
+		 * Blocks are written in sorted order, with contiguous
+		 * blocks coalesced into a single write. The file system
+		 * metadata is then updated once for the entire transaction.
+		 *
+		 * NOTE: Data blocks are overwritten in place. If the commit
+		 * is interrupted, the directory and block tables are still
+		 * consistent, but the file data may be partially written.
+		 *
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int commit(void);
+
+		/**
+		 * Discard all cached block writes.
+		 */
+		void rollback(void);
+
 		/** File management **/
 	signals:
 		/**
@@ -458,6 +497,9 @@ class Card : public QObject
 		 * on the card, since writing to a card with errors can cause even
 		 * more problems.
 		 *
+		 * When switching to read-only, uncommitted block writes
+		 * are committed first. If that fails, the card stays writable.
+		 *
 		 * @param readOnly New readOnly value.
 		 * @return 0 on success; negative POSIX error code on error.
 		 * (Check this->errorString for more information.)
@@ -0,0 +1,367 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * CardDiff.cpp: Compare two Memory Card images.                           *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "CardDiff.hpp"
+#include "Card.hpp"
+#include "File.hpp"
+#include "GcnFile.hpp"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+// Qt includes.
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+
+/** CardDiffPrivate **/
+
+class CardDiffPrivate
+{
+	public:
+		CardDiffPrivate(CardDiff *q, Card *cardA, Card *cardB);
+
+	protected:
+		CardDiff *const q_ptr;
+		Q_DECLARE_PUBLIC(CardDiff)
+	private:
+		Q_DISABLE_COPY(CardDiffPrivate)
+
+	public:
+		Card *const cardA;
+		Card *const cardB;
+
+		/**
+		 * Get the identity key for a file.
+		 * GCN files are identified by gamecode, company, and filename.
+		 * @param file File
+		 * @return Identity key
+		 */
+		static inline QString fileKey(const File *file)
+		{
+			return file->gameID() + QChar(L'/') + file->filename();
+		}
+
+		/**
+		 * Append a byte range, merging it with the previous
+		 * range if the two are contiguous.
+		 * @param ranges Byte ranges
+		 * @param offset Offset
+		 * @param length Length
+		 */
+		static void appendRange(QVector<CardDiff::ByteRange> &ranges, uint32_t offset, uint32_t length);
+
+		/**
+		 * Compare two blocks and record the differing byte ranges.
+		 * @param ranges	[out] Byte ranges
+		 * @param base		[in] File offset of the blocks
+		 * @param bufA		[in] Block from card A
+		 * @param bufB		[in] Block from card B
+		 * @param siz		[in] Block size
+		 */
+		static void diffBlock(QVector<CardDiff::ByteRange> &ranges, uint32_t base,
+			const uint8_t *bufA, const uint8_t *bufB, uint32_t siz);
+
+		/**
+		 * Check if two files' directory entries differ.
+		 * The starting block is ignored; see DIFF_MOVED.
+		 * @param fileA File from card A
+		 * @param fileB File from card B
+		 * @return True if the directory entries differ.
+		 */
+		static bool metadataDiffers(const File *fileA, const File *fileB);
+
+		/**
+		 * Compare a file that's present on both cards.
+		 * @param diff	[in/out] File difference
+		 * @param bufA	[in] Block buffer for card A
+		 * @param bufB	[in] Block buffer for card B
+		 */
+		void diffFile(CardDiff::FileDiff &diff, uint8_t *bufA, uint8_t *bufB);
+};
+
+CardDiffPrivate::CardDiffPrivate(CardDiff *q, Card *cardA, Card *cardB)
+	: q_ptr(q)
+	, cardA(cardA)
+	, cardB(cardB)
+{ }
+
+/**
+ * Append a byte range, merging it with the previous
+ * range if the two are contiguous.
+ * @param ranges Byte ranges
+ * @param offset Offset
+ * @param length Length
+ */
+void CardDiffPrivate::appendRange(QVector<CardDiff::ByteRange> &ranges, uint32_t offset, uint32_t length)
+{
+	if (length == 0)
+		return;
+
+	if (!ranges.isEmpty()) {
+		CardDiff::ByteRange &last = ranges.last();
+		if (last.offset + last.length == offset) {
+			// Contiguous with the previous range.
+			last.length += length;
+			return;
+		}
+	}
+
+	CardDiff::ByteRange range;
+	range.offset = offset;
+	range.length = length;
+	ranges.append(range);
+}
+
+/**
+ * Compare two blocks and record the differing byte ranges.
+ * @param ranges	[out] Byte ranges
+ * @param base		[in] File offset of the blocks
+ * @param bufA		[in] Block from card A
+ * @param bufB		[in] Block from card B
+ * @param siz		[in] Block size
+ */
+void CardDiffPrivate::diffBlock(QVector<CardDiff::ByteRange> &ranges, uint32_t base,
+	const uint8_t *bufA, const uint8_t *bufB, uint32_t siz)
+{
+	if (!memcmp(bufA, bufB, siz)) {
+		// Blocks are identical.
+		return;
+	}
+
+	uint32_t i = 0;
+	while (i < siz) {
+		if (bufA[i] == bufB[i]) {
+			i++;
+			continue;
+		}
+
+		// Found a difference. Find the end of this run.
+		const uint32_t start = i;
+		while (i < siz && bufA[i] != bufB[i]) {
+			i++;
+		}
+		appendRange(ranges, base + start, i - start);
+	}
+}
+
+/**
+ * Check if two files' directory entries differ.
+ * The starting block is ignored; see DIFF_MOVED.
+ * @param fileA File from card A
+ * @param fileB File from card B
+ * @return True if the directory entries differ.
+ */
+bool CardDiffPrivate::metadataDiffers(const File *fileA, const File *fileB)
+{
+	const GcnFile *const gcnFileA = qobject_cast<const GcnFile*>(fileA);
+	const GcnFile *const gcnFileB = qobject_cast<const GcnFile*>(fileB);
+	if (gcnFileA && gcnFileB) {
+		// Compare the raw directory entries.
+		card_direntry dirEntryA = *gcnFileA->dirEntry();
+		card_direntry dirEntryB = *gcnFileB->dirEntry();
+		dirEntryA.block = 0;
+		dirEntryB.block = 0;
+		return (memcmp(&dirEntryA, &dirEntryB, sizeof(dirEntryA)) != 0);
+	}
+
+	// Other card types: Compare the common fields.
+	return (fileA->mtime() != fileB->mtime() ||
+		fileA->mode() != fileB->mode() ||
+		fileA->description() != fileB->description());
+}
+
+/**
+ * Compare a file that's present on both cards.
+ * @param diff	[in/out] File difference
+ * @param bufA	[in] Block buffer for card A
+ * @param bufB	[in] Block buffer for card B
+ */
+void CardDiffPrivate::diffFile(CardDiff::FileDiff &diff, uint8_t *bufA, uint8_t *bufB)
+{
+	const vector<uint16_t> fatA = diff.fileA->fatEntries();
+	const vector<uint16_t> fatB = diff.fileB->fatEntries();
+	if (fatA != fatB) {
+		diff.flags |= CardDiff::DIFF_MOVED;
+	}
+	if (metadataDiffers(diff.fileA, diff.fileB)) {
+		diff.flags |= CardDiff::DIFF_METADATA;
+	}
+
+	const uint32_t blockSize = (uint32_t)cardA->blockSize();
+	const size_t common = std::min(fatA.size(), fatB.size());
+	for (size_t i = 0; i < common; i++) {
+		const uint32_t base = (uint32_t)i * blockSize;
+		const int retA = cardA->readBlock(bufA, blockSize, fatA[i]);
+		const int retB = cardB->readBlock(bufB, blockSize, fatB[i]);
+		if (retA != (int)blockSize || retB != (int)blockSize) {
+			// Read error. Consider the entire block modified.
+			appendRange(diff.ranges, base, blockSize);
+			continue;
+		}
+
+		diffBlock(diff.ranges, base, bufA, bufB, blockSize);
+	}
+
+	if (fatA.size() != fatB.size()) {
+		// File size changed. The extra blocks are modified.
+		const size_t extra = std::max(fatA.size(), fatB.size()) - common;
+		appendRange(diff.ranges, (uint32_t)common * blockSize, (uint32_t)extra * blockSize);
+	}
+
+	if (!diff.ranges.isEmpty()) {
+		diff.flags |= CardDiff::DIFF_MODIFIED;
+	}
+}
+
+/** CardDiff **/
+
+/**
+ * Compare two Memory Card images.
+ * Both cards must have the same block size.
+ * @param cardA "Old" card
+ * @param cardB "New" card
+ */
+CardDiff::CardDiff(Card *cardA, Card *cardB)
+	: d_ptr(new CardDiffPrivate(this, cardA, cardB))
+{ }
+
+CardDiff::~CardDiff()
+{
+	Q_D(CardDiff);
+	delete d;
+}
+
+/**
+ * Compare the files on both cards.
+ * Only one block from each card is held in memory at a time.
+ * Unchanged files are not included in the result.
+ * @param diffs	[out] File differences
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CardDiff::compareFiles(QVector<FileDiff> &diffs)
+{
+	Q_D(CardDiff);
+	diffs.clear();
+	if (!d->cardA || !d->cardB)
+		return -EINVAL;
+	if (!d->cardA->isOpen() || !d->cardB->isOpen())
+		return -EBADF;
+	if (d->cardA->blockSize() != d->cardB->blockSize())
+		return -EINVAL;
+
+	// Index card B's files by identity.
+	// NOTE: Lost files are excluded, since their
+	// block assignments are only a guess.
+	const QVector<File*> filesA = d->cardA->getFiles(Card::FileTypes::Normal);
+	const QVector<File*> filesB = d->cardB->getFiles(Card::FileTypes::Normal);
+	QHash<QString, File*> mapB;
+	mapB.reserve(filesB.size());
+	foreach (File *file, filesB) {
+		const QString key = CardDiffPrivate::fileKey(file);
+		if (!mapB.contains(key)) {
+			mapB.insert(key, file);
+		}
+	}
+
+	const uint32_t blockSize = (uint32_t)d->cardA->blockSize();
+	unique_ptr<uint8_t[]> bufA(new uint8_t[blockSize]);
+	unique_ptr<uint8_t[]> bufB(new uint8_t[blockSize]);
+
+	QSet<File*> matchedB;
+	matchedB.reserve(filesB.size());
+	foreach (File *fileA, filesA) {
+		FileDiff diff;
+		diff.gameID = fileA->gameID();
+		diff.filename = fileA->filename();
+		diff.fileA = fileA;
+		diff.fileB = mapB.value(CardDiffPrivate::fileKey(fileA), nullptr);
+
+		if (!diff.fileB || matchedB.contains(diff.fileB)) {
+			// File was removed.
+			diff.fileB = nullptr;
+			diff.flags = DIFF_REMOVED;
+			CardDiffPrivate::appendRange(diff.ranges, 0, (uint32_t)fileA->size() * blockSize);
+			diffs.append(diff);
+			continue;
+		}
+
+		matchedB.insert(diff.fileB);
+		d->diffFile(diff, bufA.get(), bufB.get());
+		if (diff.flags != DIFF_NONE) {
+			diffs.append(diff);
+		}
+	}
+
+	// Any unmatched files on card B were added.
+	foreach (File *fileB, filesB) {
+		if (matchedB.contains(fileB))
+			continue;
+
+		FileDiff diff;
+		diff.flags = DIFF_ADDED;
+		diff.gameID = fileB->gameID();
+		diff.filename = fileB->filename();
+		diff.fileA = nullptr;
+		diff.fileB = fileB;
+		CardDiffPrivate::appendRange(diff.ranges, 0, (uint32_t)fileB->size() * blockSize);
+		diffs.append(diff);
+	}
+
+	return 0;
+}
+
+/**
+ * Compare the physical blocks on both cards.
+ * Blocks that exist on only one card are counted as different.
+ * @param blocks	[out] Physical block indexes that differ
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CardDiff::compareBlocks(QVector<uint16_t> &blocks)
+{
+	Q_D(CardDiff);
+	blocks.clear();
+	if (!d->cardA || !d->cardB)
+		return -EINVAL;
+	if (!d->cardA->isOpen() || !d->cardB->isOpen())
+		return -EBADF;
+	if (d->cardA->blockSize() != d->cardB->blockSize())
+		return -EINVAL;
+
+	const int blockSize = d->cardA->blockSize();
+	const int totalA = d->cardA->totalPhysBlocks();
+	const int totalB = d->cardB->totalPhysBlocks();
+	const int common = std::min(totalA, totalB);
+
+	unique_ptr<uint8_t[]> bufA(new uint8_t[blockSize]);
+	unique_ptr<uint8_t[]> bufB(new uint8_t[blockSize]);
+	for (int i = 0; i < common; i++) {
+		const int retA = d->cardA->readBlock(bufA.get(), blockSize, (uint16_t)i);
+		const int retB = d->cardB->readBlock(bufB.get(), blockSize, (uint16_t)i);
+		if (retA != blockSize || retB != blockSize ||
+		    memcmp(bufA.get(), bufB.get(), blockSize) != 0)
+		{
+			blocks.append((uint16_t)i);
+		}
+	}
+
+	// Blocks past the end of the smaller card.
+	const int total = std::max(totalA, totalB);
+	for (int i = common; i < total; i++) {
+		blocks.append((uint16_t)i);
+	}
+
+	return 0;
+}
@@ -0,0 +1,105 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * CardDiff.hpp: Compare two Memory Card images.                           *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+// C includes
+#include <stdint.h>
+
+// Qt includes
+#include <QtCore/QFlags>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+class Card;
+class File;
+
+class CardDiffPrivate;
+class CardDiff
+{
+	public:
+		/**
+		 * Compare two Memory Card images.
+		 * Both cards must have the same block size.
+		 * @param cardA "Old" card
+		 * @param cardB "New" card
+		 */
+		CardDiff(Card *cardA, Card *cardB);
+		~CardDiff();
+
+	protected:
+		CardDiffPrivate *const d_ptr;
+		Q_DECLARE_PRIVATE(CardDiff)
+	private:
+		Q_DISABLE_COPY(CardDiff)
+
+	public:
+		/**
+		 * File difference flags.
+		 */
+		enum DiffFlag {
+			DIFF_NONE	= 0,
+
+			// File is only present on card B.
+			DIFF_ADDED	= (1U << 0),
+			// File is only present on card A.
+			DIFF_REMOVED	= (1U << 1),
+			// File contents differ.
+			DIFF_MODIFIED	= (1U << 2),
+			// File is stored in different physical blocks.
+			DIFF_MOVED	= (1U << 3),
+			// Directory entry differs, e.g. timestamp,
+			// permissions, icon, or comment address.
+			DIFF_METADATA	= (1U << 4),
+		};
+		Q_DECLARE_FLAGS(DiffFlags, DiffFlag)
+
+		/**
+		 * Byte range within a file.
+		 */
+		struct ByteRange {
+			uint32_t offset;
+			uint32_t length;
+		};
+
+		/**
+		 * Differences for a single file.
+		 * Files are matched by game ID and filename,
+		 * not by their position on the card.
+		 */
+		struct FileDiff {
+			DiffFlags flags;
+			QString gameID;
+			QString filename;
+			File *fileA;	// nullptr if DIFF_ADDED
+			File *fileB;	// nullptr if DIFF_REMOVED
+
+			// Modified byte ranges, relative to the start of the file.
+			// For DIFF_ADDED and DIFF_REMOVED, this covers the entire file.
+			QVector<ByteRange> ranges;
+		};
+
+		/**
+		 * Compare the files on both cards.
+		 * Only one block from each card is held in memory at a time.
+		 * Unchanged files are not included in the result.
+		 * @param diffs	[out] File differences
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int compareFiles(QVector<FileDiff> &diffs);
+
+		/**
+		 * Compare the physical blocks on both cards.
+		 * Blocks that exist on only one card are counted as different.
+		 * @param blocks	[out] Physical block indexes that differ
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int compareBlocks(QVector<uint16_t> &blocks);
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(CardDiff::DiffFlags)
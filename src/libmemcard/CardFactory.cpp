@@ -0,0 +1,293 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * CardFactory.cpp: Card factory class.                                    *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "CardFactory.hpp"
+#include "util/byteswap.h"
+
+// Card classes
+#include "GcnCard.hpp"
+#include "GciCard.hpp"
+#include "GciDirectoryCard.hpp"
+#include "VmuCard.hpp"
+
+// Card definitions
+#include "card.h"
+#include "vmu.h"
+#include "Checksum.hpp"
+
+// C includes. (C++ namespace)
+#include <cctype>
+#include <cstring>
+
+// Qt includes.
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#define NUM_ELEMENTS(x) ((int)(sizeof(x) / sizeof(x[0])))
+
+/**
+ * Check if a number is a power of 2.
+ * @param n Number.
+ * @return True if this number is a power of 2.
+ */
+static inline bool isPow2(qint64 n)
+{
+	return !(n == 0) && !(n & (n - 1));
+}
+
+/**
+ * Check if a character is valid in a game ID.
+ * @param chr Character
+ * @return True if valid; false if not.
+ */
+static inline bool isGameIdChar(char chr)
+{
+	return (isupper((unsigned char)chr) || isdigit((unsigned char)chr));
+}
+
+/**
+ * Score a file as a GameCube memory card.
+ * @param file Opened file
+ * @param filesize File size
+ * @return Score (0 == not a GCN memory card)
+ */
+static int scoreGcn(QFile &file, qint64 filesize)
+{
+	if (filesize < 5*8192)
+		return 0;
+
+	int score = 0;
+	if (filesize >= 512*1024 && filesize <= 16*1024*1024 && isPow2(filesize)) {
+		// Valid GCN memory card size.
+		score++;
+	}
+
+	// Header checksum.
+	card_header header;
+	if (!file.seek(0) || file.read((char*)&header, sizeof(header)) != (qint64)sizeof(header))
+		return score;
+	const uint32_t chk = Checksum::AddInvDual16(
+		reinterpret_cast<const uint16_t*>(&header), 0x1FC, Checksum::ChkEndian::Big);
+	if ((chk >> 16) == be16_to_cpu(header.chksum1) &&
+	    (chk & 0xFFFF) == be16_to_cpu(header.chksum2))
+	{
+		// Header checksum is valid.
+		score += 4;
+	}
+
+	// Header size field is in Mbits. (1 Mbit == 128 KiB)
+	if ((qint64)be16_to_cpu(header.size) * 128*1024 == filesize) {
+		score++;
+	}
+
+	// Block table sanity checks.
+	// Only the control fields are read; not the entire table.
+	const int totalBlocks = (int)(filesize / 8192);
+	static const uint32_t batAddr[2] = {CARD_SYSBAT, CARD_SYSBAT_BACK};
+	for (int i = 0; i < NUM_ELEMENTS(batAddr); i++) {
+		uint16_t bat_hdr[5];
+		if (!file.seek(batAddr[i]) || file.read((char*)bat_hdr, sizeof(bat_hdr)) != (qint64)sizeof(bat_hdr))
+			break;
+		const int freeblocks = be16_to_cpu(bat_hdr[3]);
+		const int lastalloc = be16_to_cpu(bat_hdr[4]);
+		if (freeblocks <= (totalBlocks - CARD_SYSAREA) &&
+		    lastalloc >= (CARD_SYSAREA - 1) && lastalloc < totalBlocks)
+		{
+			// Block table looks valid.
+			score++;
+			break;
+		}
+	}
+
+	return score;
+}
+
+/**
+ * Score a file as a GameCube save file.
+ * @param file Opened file
+ * @param filesize File size
+ * @return Score (0 == not a GCI file)
+ */
+static int scoreGci(QFile &file, qint64 filesize)
+{
+	if (filesize < 8192+64)
+		return 0;
+
+	int score = 0;
+	if (((filesize - 64) % 8192) == 0) {
+		// Valid GCI file size.
+		score++;
+	}
+
+	card_direntry dirEntry;
+	if (!file.seek(0) || file.read((char*)&dirEntry, sizeof(dirEntry)) != (qint64)sizeof(dirEntry))
+		return score;
+
+	// Game ID should be uppercase alphanumeric.
+	bool idOk = true;
+	for (int i = 0; i < NUM_ELEMENTS(dirEntry.gamecode); i++) {
+		idOk &= isGameIdChar(dirEntry.gamecode[i]);
+	}
+	for (int i = 0; i < NUM_ELEMENTS(dirEntry.company); i++) {
+		idOk &= isGameIdChar(dirEntry.company[i]);
+	}
+	if (idOk) {
+		score += 2;
+	}
+
+	// Padding should be 0xFF.
+	if (dirEntry.pad_00 == 0xFF) {
+		score++;
+	}
+
+	// File length should match the data area.
+	if ((qint64)be16_to_cpu(dirEntry.length) * 8192 + 64 == filesize) {
+		score += 2;
+	}
+
+	return score;
+}
+
+/**
+ * Score a file as a Dreamcast VMU image.
+ * @param file Opened file
+ * @param filesize File size
+ * @return Score (0 == not a VMU image)
+ */
+static int scoreVmu(QFile &file, qint64 filesize)
+{
+	static const qint64 rootAddr = (qint64)VMU_ROOT_BLOCK_ADDRESS * VMU_BLOCK_SIZE;
+	if (filesize < rootAddr + VMU_BLOCK_SIZE)
+		return 0;
+
+	int score = 0;
+	if (filesize == 256 * VMU_BLOCK_SIZE) {
+		// Valid VMU size.
+		score++;
+	}
+
+	vmu_root_block root;
+	if (!file.seek(rootAddr) || file.read((char*)&root, sizeof(root)) != (qint64)sizeof(root))
+		return score;
+
+	// The first 16 bytes should be 0x55.
+	bool format55 = true;
+	for (int i = 0; i < NUM_ELEMENTS(root.format55); i++) {
+		format55 &= (root.format55[i] == 0x55);
+	}
+	if (format55) {
+		score += 4;
+	}
+
+	// FAT and directory locations.
+	if (le16_to_cpu(root.fat_size) == 1 &&
+	    le16_to_cpu(root.fat_addr) < VMU_ROOT_BLOCK_ADDRESS &&
+	    le16_to_cpu(root.dir_addr) < VMU_ROOT_BLOCK_ADDRESS)
+	{
+		score++;
+	}
+
+	return score;
+}
+
+/**
+ * Determine the type of a memory card image.
+ *
+ * Only the first few KiB of the file are read.
+ * Each format is scored by its content, e.g. the GCN
+ * header checksum, the VMU root block, or the GCI
+ * directory entry; the file size is only a tiebreaker.
+ *
+ * @param filename Memory card image filename
+ * @return Card type, or CardType::Unknown if no format matched.
+ */
+CardFactory::CardType CardFactory::probe(const QString &filename)
+{
+	QFileInfo fileInfo(filename);
+	if (fileInfo.isDir()) {
+		// Directory of GCI files.
+		return CardType::GCIDirectory;
+	}
+
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly))
+		return CardType::Unknown;
+	const qint64 filesize = file.size();
+
+	// Score each format.
+	// NOTE: Ties are resolved in the order listed here.
+	struct {
+		CardType type;
+		int score;
+	} scores[] = {
+		{CardType::GCN, scoreGcn(file, filesize)},
+		{CardType::VMU, scoreVmu(file, filesize)},
+		{CardType::GCI, scoreGci(file, filesize)},
+	};
+
+	CardType type = CardType::Unknown;
+	int bestScore = 0;
+	for (int i = 0; i < NUM_ELEMENTS(scores); i++) {
+		if (scores[i].score > bestScore) {
+			type = scores[i].type;
+			bestScore = scores[i].score;
+		}
+	}
+
+	return type;
+}
+
+/**
+ * Open a memory card image.
+ * @param filename Memory card image filename
+ * @param parent Parent object
+ * @param type Card type, or CardType::Unknown to probe the file.
+ * If the card type can't be determined, GCN is assumed.
+ * @return Card. (Always non-null; check isOpen() and errorString() on error.)
+ */
+Card *CardFactory::open(const QString &filename, QObject *parent, CardType type)
+{
+	if (type == CardType::Unknown) {
+		// Check what type of card this is.
+		type = probe(filename);
+	}
+
+	switch (type) {
+		default:
+		case CardType::Unknown:
+		case CardType::GCN:
+			return GcnCard::open(filename, parent);
+		case CardType::GCI:
+			return GciCard::open(filename, parent);
+		case CardType::VMU:
+			return VmuCard::open(filename, parent);
+		case CardType::GCIDirectory:
+			return GciDirectoryCard::open(filename, parent);
+	}
+}
+
+/**
+ * Get the class name for a card type.
+ * @param type Card type
+ * @return Class name, e.g. "GcnCard"
+ */
+const char *CardFactory::className(CardType type)
+{
+	switch (type) {
+		default:
+		case CardType::Unknown:
+		case CardType::GCN:
+			return "GcnCard";
+		case CardType::GCI:
+			return "GciCard";
+		case CardType::VMU:
+			return "VmuCard";
+		case CardType::GCIDirectory:
+			return "GciDirectoryCard";
+	}
+}
@@ -0,0 +1,68 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * CardFactory.hpp: Card factory class.                                    *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+// for Q_DISABLE_COPY()
+#include <QtCore/qglobal.h>
+#include <QtCore/QString>
+class QObject;
+
+class Card;
+class CardFactory
+{
+	private:
+		CardFactory();
+		~CardFactory();
+	private:
+		Q_DISABLE_COPY(CardFactory)
+
+	public:
+		/**
+		 * Card type.
+		 */
+		enum class CardType {
+			Unknown = -1,
+
+			GCN = 0,		// GameCube memory card
+			GCI = 1,		// GameCube save file
+			VMU = 2,		// Dreamcast memory card
+			GCIDirectory = 3,	// Directory of GameCube save files
+		};
+
+		/**
+		 * Determine the type of a memory card image.
+		 *
+		 * Only the first few KiB of the file are read.
+		 * Each format is scored by its content, e.g. the GCN
+		 * header checksum, the VMU root block, or the GCI
+		 * directory entry; the file size is only a tiebreaker.
+		 *
+		 * @param filename Memory card image filename
+		 * @return Card type, or CardType::Unknown if no format matched.
+		 */
+		static CardType probe(const QString &filename);
+
+		/**
+		 * Open a memory card image.
+		 * @param filename Memory card image filename
+		 * @param parent Parent object
+		 * @param type Card type, or CardType::Unknown to probe the file.
+		 * If the card type can't be determined, GCN is assumed.
+		 * @return Card. (Always non-null; check isOpen() and errorString() on error.)
+		 */
+		static Card *open(const QString &filename, QObject *parent,
+				  CardType type = CardType::Unknown);
+
+		/**
+		 * Get the class name for a card type.
+		 * @param type Card type
+		 * @return Class name, e.g. "GcnCard"
+		 */
+		static const char *className(CardType type);
+};
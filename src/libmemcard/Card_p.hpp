@@ -10,9 +10,15 @@
 
 #include "Card.hpp"
 
+// C++ includes.
+#include <memory>
+
 // Qt includes.
 #include <QtCore/QFile>
+#include <QtCore/QByteArray>
 #include <QtCore/QFlags>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
 #include <QtCore/QString>
 #include <QtCore/QVector>
 #include <QtGui/QPixmap>
@@ -54,7 +60,9 @@ class CardPrivate
 
 		// File information.
 		QString filename;
-		QFile *file;
+		// NOTE: Not parented to the Card, since the file
+		// may be replaced while reading from a worker thread.
+		std::unique_ptr<QFile> file;
 		quint64 filesize;
 		bool readOnly;
 		bool canMakeWritable;	// subclass should set this
@@ -105,6 +113,89 @@ class CardPrivate
 
 		// TODO: Move usedBlockMap here?
 
+		/**
+		 * In-memory copy of the card image.
+		 * If loaded, Card::readBlock() reads from here instead of
+		 * the file. Only used for small cards, e.g. VMU. (128 KB)
+		 */
+		QByteArray image;
+
+		/**
+		 * Load the entire card image into memory.
+		 * This should only be used for small cards.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadImage(void);
+
+		/**
+		 * Write-back block cache.
+		 * Blocks written using Card::writeBlock() are held here
+		 * until Card::commit() is called, or until the card is made
+		 * read-only or closed. QMap keeps the blocks
+		 * sorted by index, which allows coalesced writes.
+		 */
+		QMap<uint16_t, QByteArray> dirtyBlocks;
+
+		/**
+		 * Card I/O lock.
+		 * CardPrivate::file is shared by all readers, and a read is
+		 * a seek() followed by a read(), so Card::readBlock() et al.
+		 * hold this lock for the entire operation. This allows
+		 * GcnSearchWorker to scan the card while the GUI thread
+		 * loads file images or exports files.
+		 */
+		mutable QMutex ioMutex;
+
+		/**
+		 * Read a block directly from the card image, bypassing the cache.
+		 * Subclasses that don't map blocks 1:1 to a single file
+		 * can override this.
+		 * @param buf Buffer to read the block data into. (Must be >= blockSize.)
+		 * @param blockIdx Block index.
+		 * @return Bytes read on success; negative POSIX error code on error.
+		 */
+		virtual int readBlockDirect(void *buf, uint16_t blockIdx);
+
+		/**
+		 * Read contiguous blocks directly from the card image, bypassing the cache.
+		 * The default implementation reads all blocks at once.
+		 * Subclasses that override readBlockDirect() must override this, too.
+		 * @param buf Buffer to read the block data into. (Must be >= count*blockSize.)
+		 * @param blockIdx First block index.
+		 * @param count Number of blocks.
+		 * @return Bytes read on success; negative POSIX error code on error.
+		 */
+		virtual int readBlocksDirect(void *buf, uint16_t blockIdx, int count);
+
+		/**
+		 * Write blocks directly to the card image, bypassing the cache.
+		 * @param buf Block data. (Must be count*blockSize bytes.)
+		 * @param blockIdx First block index.
+		 * @param count Number of blocks.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int writeBlocksDirect(const void *buf, uint16_t blockIdx, int count);
+
+		/**
+		 * Write all cached block writes to the card image,
+		 * then update the file system metadata.
+		 * Blocks are written in sorted order, with contiguous
+		 * blocks coalesced into a single write.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int flushDirtyBlocks(void);
+
+		/**
+		 * Update the file system metadata after the dirty blocks
+		 * have been flushed by Card::commit().
+		 * Subclasses should override this to rewrite their
+		 * directory and block tables. (checksums, update counters)
+		 * NOTE: Called with ioMutex held. Slots connected to signals
+		 * emitted here must not read from the card.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		virtual int commitMetadata(void);
+
 		/**
 		 * Check if a number is a power of 2.
 		 * Reference: http://stackoverflow.com/questions/108318/whats-the-simplest-way-to-test-whether-a-number-is-a-power-of-2-in-c
@@ -14,6 +14,7 @@
 #include "GcImage.hpp"
 #include "GcToolsQt.hpp"
 #include "GcImageWriter.hpp"
+#include "FileImages.hpp"
 
 // C includes (C++ namespace)
 #include <cerrno>
@@ -29,6 +30,7 @@ using std::vector;
 #include <QtCore/QByteArray>
 #include <QtCore/QFile>
 #include <QtCore/QIODevice>
+#include <QtCore/QMutexLocker>
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 #  include <QtCore/QStringDecoder>
@@ -51,6 +53,8 @@ FilePrivate::FilePrivate(File *q, Card *card)
 	, mode(0)
 	, gcBanner(nullptr)
 	, iconAnimMode(0)
+	, gcImagesLoaded(false)
+	, imagesLoaded(false)
 	, lostFile(false)
 { }
 
@@ -289,8 +293,14 @@ QString FilePrivate::decodeText_SJISorCP1252(const char *str, int len)
  */
 void FilePrivate::loadImages(void)
 {
-	// Load the banner.
-	this->gcBanner = loadBannerImage();
+	// Delete the old images, if any.
+	unloadImages();
+	imagesLoaded = true;
+
+	// Load the GcImages.
+	ensureGcImagesLoaded();
+
+	// Convert the banner.
 	if (gcBanner) {
 		// Set the new banner image.
 		QImage qBanner = gcImageToQImage(gcBanner);
@@ -303,8 +313,7 @@ void FilePrivate::loadImages(void)
 		banner = QPixmap();
 	}
 
-	// Load the icons.
-	this->gcIcons = loadIconImages();
+	// Convert the icons.
 	icons.clear();
 	icons.reserve(gcIcons.size());
 	foreach (GcImage *gcIcon, gcIcons) {
@@ -321,6 +330,54 @@ void FilePrivate::loadImages(void)
 	}
 }
 
+/**
+ * Load the GcImages if they aren't loaded.
+ * This doesn't create any QPixmaps, so it can be called
+ * from any thread. Card reads are serialized by the card's
+ * I/O lock, so this is safe during a search.
+ *
+ * Once loaded, the GcImages aren't modified until
+ * unloadImages() is called on the GUI thread.
+ */
+void FilePrivate::ensureGcImagesLoaded(void) const
+{
+	QMutexLocker gcImageLocker(&gcImageMutex);
+	ensureGcImagesLoaded_int();
+}
+
+/**
+ * Load the GcImages if they aren't loaded. [INTERNAL FUNCTION]
+ * gcImageMutex must be locked by the caller.
+ */
+void FilePrivate::ensureGcImagesLoaded_int(void) const
+{
+	if (gcImagesLoaded)
+		return;
+
+	// NOTE: loadIconImages() also sets the icon animation information.
+	FilePrivate *const d = const_cast<FilePrivate*>(this);
+	d->gcBanner = d->loadBannerImage();
+	d->gcIcons = d->loadIconImages();
+	d->gcImagesLoaded = true;
+}
+
+/**
+ * Unload the banner and icon images.
+ */
+void FilePrivate::unloadImages(void)
+{
+	QMutexLocker gcImageLocker(&gcImageMutex);
+	delete gcBanner;
+	gcBanner = nullptr;
+	qDeleteAll(gcIcons);
+	gcIcons.clear();
+	gcImagesLoaded = false;
+
+	banner = QPixmap();
+	icons.clear();
+	imagesLoaded = false;
+}
+
 /** Checksums **/
 
 /**
@@ -349,127 +406,13 @@ void FilePrivate::calculateChecksum(void)
 	for (size_t i = 0; i < checksumDefs.size(); i++) {
 		const Checksum::ChecksumDef &checksumDef = checksumDefs[i];
 
-		if (checksumDef.algorithm == Checksum::ChkAlgorithm::None ||
-		    checksumDef.algorithm >= Checksum::ChkAlgorithm::Max ||
-		    checksumDef.length == 0)
-		{
-			// No algorithm or invalid algorithm set,
-			// or the checksum data has no length.
-			continue;
-		}
-
-		// Make sure the checksum definition is in range.
-		if (fileData.size() < (int)checksumDef.address ||
-		    fileData.size() < (int)(checksumDef.start + checksumDef.length))
-		{
-			// File is too small...
-			// TODO: Also check the size of the checksum itself.
+		Checksum::ChecksumValue checksumValue;
+		if (!Checksum::Calculate(checksumDef, data, (uint32_t)fileData.size(), &checksumValue)) {
+			// Invalid checksum definition.
 			continue;
 		}
 
-		// Get the expected checksum.
-		// NOTE: Assuming big-endian for all values.
-		uint32_t expected = 0;
-		Checksum::ChaoGardenChecksumData chaoChk_orig;
-
-		// Use Exec() for most algorithms.
-		// Some unusual ones need to be run manually.
-		bool useExec = true;
-
-		const char *const start = (fileData.constData() + checksumDef.start);
-		uint32_t actual = 0;
-
-		switch (checksumDef.algorithm) {
-			default:
-			case Checksum::ChkAlgorithm::None:
-				// Unsupported algorithm.
-				expected = 0;
-				break;
-
-			case Checksum::ChkAlgorithm::CRC16:
-			case Checksum::ChkAlgorithm::DreamcastVMU:
-				if (checksumDef.endian != Checksum::ChkEndian::Little) {
-					// Big-endian
-					expected = (data[checksumDef.address+0] << 8) |
-						   (data[checksumDef.address+1]);
-				} else {
-					// Little-endian
-					expected = (data[checksumDef.address+1] << 8) |
-						   (data[checksumDef.address+0]);
-				}
-				break;
-
-			case Checksum::ChkAlgorithm::CRC32:
-			case Checksum::ChkAlgorithm::AddInvDual16:
-			case Checksum::ChkAlgorithm::AddBytes32:
-				if (checksumDef.endian != Checksum::ChkEndian::Little) {
-					// Big-endian
-					expected = (data[checksumDef.address+0] << 24) |
-						   (data[checksumDef.address+1] << 16) |
-						   (data[checksumDef.address+2] << 8) |
-						   (data[checksumDef.address+3]);
-				} else {
-					// Little-endian
-					expected = (data[checksumDef.address+3] << 24) |
-						   (data[checksumDef.address+2] << 16) |
-						   (data[checksumDef.address+1] << 8) |
-						   (data[checksumDef.address+0]);
-				}
-				break;
-
-			case Checksum::ChkAlgorithm::SonicChaoGarden: {
-				memcpy(&chaoChk_orig, &data[checksumDef.address], sizeof(chaoChk_orig));
-
-				// Temporary working copy.
-				Checksum::ChaoGardenChecksumData chaoChk = chaoChk_orig;
-				if (checksumDef.endian != Checksum::ChkEndian::Little) {
-					// Big-endian
-					expected = (chaoChk.checksum_3 << 24) |
-						   (chaoChk.checksum_2 << 16) |
-						   (chaoChk.checksum_1 << 8) |
-						   (chaoChk.checksum_0);
-				} else {
-					// Little-endian
-					// TODO: Is this correct?
-					expected = (chaoChk.checksum_0 << 24) |
-						   (chaoChk.checksum_1 << 16) |
-						   (chaoChk.checksum_2 << 8) |
-						   (chaoChk.checksum_3);
-				}
-
-				// Clear some fields that must be 0 when calculating the checksum.
-				chaoChk.checksum_3 = 0;
-				chaoChk.checksum_2 = 0;
-				chaoChk.checksum_1 = 0;
-				chaoChk.checksum_0 = 0;
-				chaoChk.random_3 = 0;
-				memcpy(&data[checksumDef.address], &chaoChk, sizeof(chaoChk));
-				break;
-			}
-
-			case Checksum::ChkAlgorithm::PokemonXD:
-				// Pokémon XD has a more complicated checksum.
-				useExec = false;
-				actual = Checksum::PokemonXD(reinterpret_cast<const uint8_t*>(start),
-					checksumDef.length, checksumDef.address, &expected);
-				break;
-		}
-
-		if (useExec) {
-			// Use Checksum::Exec().
-			actual = Checksum::Exec(checksumDef.algorithm,
-				start, checksumDef.length, checksumDef.endian, checksumDef.param);
-		}
-
-		if (checksumDef.algorithm == Checksum::ChkAlgorithm::SonicChaoGarden) {
-			// Restore the Chao Garden checksum data.
-			memcpy(&data[checksumDef.address], &chaoChk_orig, sizeof(chaoChk_orig));
-		}
-
 		// Save the checksums.
-		Checksum::ChecksumValue checksumValue;
-		checksumValue.expected = expected;
-		checksumValue.actual = actual;
 		checksumValues.push_back(checksumValue);
 	}
 }
@@ -510,6 +453,16 @@ QString File::filename(void) const
 	return d->filename;
 }
 
+/**
+ * Get the Card this file belongs to.
+ * @return Card
+ */
+Card *File::card(void) const
+{
+	Q_D(const File);
+	return d->card;
+}
+
 /**
  * Get this file's FAT entries.
  * @return FAT entries
@@ -532,6 +485,8 @@ QByteArray File::loadFileData(void)
 
 /**
  * Write data to the file.
+ * NOTE: Data is held in the card's write-back cache
+ * until Card::commit() is called.
  * NOTE: This function cannot expand files at the moment.
  * Length+size must be <= total file size.
  * @param address Address to write to
@@ -571,7 +526,7 @@ int File::write(uint32_t address, const void *const data, uint32_t length)
 			// This is the only block being written.
 			memcpy(block.data() + blockStartOffset, data_u8, length);
 			d->card->writeBlock(block.data(), blockSize, physBlockStartIdx);
-			// FIXME: Trigger card metadata update.
+			// NOTE: Card metadata is updated by Card::commit().
 			return 0;
 		}
 
@@ -588,7 +543,7 @@ int File::write(uint32_t address, const void *const data, uint32_t length)
 	// Write entire blocks.
 	for (; length >= (uint32_t)blockSize; length -= blockSize, data_u8 += blockSize, address += blockSize) {
 		const uint16_t physBlockIdx = d->fileBlockAddrToPhysBlockAddr(address / blockSize);
-		d->card->writeBlock(data, blockSize, physBlockIdx);
+		d->card->writeBlock(data_u8, blockSize, physBlockIdx);
 	}
 
 	// Check if we still have data left (not a full block).
@@ -672,6 +627,7 @@ int File::size(void) const
 QPixmap File::banner(void) const
 {
 	Q_D(const File);
+	d->ensureImagesLoaded();
 	return d->banner;
 }
 
@@ -682,6 +638,7 @@ QPixmap File::banner(void) const
 int File::iconCount(void) const
 {
 	Q_D(const File);
+	d->ensureImagesLoaded();
 	return d->icons.size();
 }
 
@@ -693,6 +650,7 @@ int File::iconCount(void) const
 QPixmap File::icon(int idx) const
 {
 	Q_D(const File);
+	d->ensureImagesLoaded();
 	if (idx < 0 || idx >= d->icons.size())
 		return QPixmap();
 	return d->icons.at(idx);
@@ -707,6 +665,7 @@ QPixmap File::icon(int idx) const
 int File::iconDelay(int idx) const
 {
 	Q_D(const File);
+	d->ensureImagesLoaded();
 	if (idx < 0 || idx >= d->iconSpeed.size())
 		return 0x0;
 	return d->iconSpeed.at(idx);
@@ -721,9 +680,20 @@ int File::iconDelay(int idx) const
 int File::iconAnimMode(void) const
 {
 	Q_D(const File);
+	d->ensureImagesLoaded();
 	return (d->iconAnimMode & 0x4);
 }
 
+/**
+ * Unload the banner and icon images to save memory.
+ * They will be reloaded from the card on demand.
+ */
+void File::unloadImages(void)
+{
+	Q_D(File);
+	d->unloadImages();
+}
+
 /** Lost File information **/
 
 /**
@@ -775,6 +745,7 @@ int File::exportToFile(const QString &filename)
 int File::saveBanner(const QString &filenameNoExt) const
 {
 	Q_D(const File);
+	d->ensureImagesLoaded();
 	// TODO: Make GcImageWriter more generic and move the
 	// internal image data here.
 	if (d->banner.isNull())
@@ -814,6 +785,7 @@ int File::saveBanner(const QString &filenameNoExt) const
 int File::saveBanner(QIODevice *qioDevice) const
 {
 	Q_D(const File);
+	d->ensureImagesLoaded();
 	if (!d->gcBanner)
 		return -EINVAL;
 
@@ -842,59 +814,20 @@ int File::saveIcon(const QString &filenameNoExt,
 	GcImageWriter::AnimImageFormat animImgf) const
 {
 	Q_D(const File);
+	d->ensureImagesLoaded();
 	if (d->gcIcons.isEmpty())
 		return -EINVAL;
 
 	// Append the correct extension.
-	const char *ext;
-	if (d->gcIcons.size() > 1) {
-		// Animated icon.
-		ext = GcImageWriter::extForAnimImageFormat(animImgf);
-	} else {
-		// Static icon.
-		ext = GcImageWriter::extForImageFormat(GcImageWriter::ImageFormat::PNG);
-	}
+	const char *const ext = FileImages::iconExt(d->gcIcons.size(), animImgf);
 
 	// NOTE: Due to PNG_FPF saving multiple files, we can't simply
 	// call a version of saveIcon() that takes a QIODevice.
+	vector<const GcImage*> gcImages(d->gcIcons.constBegin(), d->gcIcons.constEnd());
+	vector<int> gcIconDelays(d->iconSpeed.constBegin(), d->iconSpeed.constEnd());
 	GcImageWriter gcImageWriter;
-	int ret;
-	if (d->gcIcons.size() > 1) {
-		// Animated icon.
-		vector<const GcImage*> gcImages;
-		const int maxIcons = (d->gcIcons.size() * 2 - 2);
-		gcImages.reserve(maxIcons);
-		gcImages.resize(d->gcIcons.size());
-		for (int i = 0; i < d->gcIcons.size(); i++) {
-			gcImages[i] = d->gcIcons[i];
-		}
-
-		// Icon speed.
-		vector<int> gcIconDelays;
-		gcIconDelays.reserve(maxIcons);
-		gcIconDelays.resize(d->gcIcons.size());
-		for (int i = 0; i < d->gcIcons.size(); i++) {
-			gcIconDelays[i] = iconDelay(i);
-		}
-
-		if (gcImages.size() > 1 && iconAnimMode() == CARD_ANIM_BOUNCE) {
-			// BOUNCE animation.
-			int src = (gcImages.size() - 2);
-			int dest = gcImages.size();
-			gcImages.resize(maxIcons);
-			gcIconDelays.resize(maxIcons);
-			for (; src >= 1; src--, dest++) {
-				gcImages[dest] = gcImages[src];
-				gcIconDelays[dest] = gcIconDelays[src];
-			}
-		}
-
-		ret = gcImageWriter.write(&gcImages, &gcIconDelays, animImgf);
-	} else {
-		// Static icon.
-		ret = gcImageWriter.write(d->gcIcons.at(0), GcImageWriter::ImageFormat::PNG);
-	}
-
+	int ret = FileImages::encodeIcon(&gcImageWriter, gcImages, gcIconDelays,
+		(d->iconAnimMode & CARD_ANIM_BOUNCE), animImgf);
 	if (ret != 0) {
 		// Error writing the icon.
 		return ret;
@@ -940,6 +873,25 @@ int File::saveIcon(const QString &filenameNoExt,
 	return ret;
 }
 
+/**
+ * Copy the banner and icon images.
+ * The copies can be encoded on another thread.
+ * This can be called from any thread, since it
+ * doesn't use the cached QPixmaps.
+ * @param images FileImages to copy the images to
+ */
+void File::copyImages(FileImages *images) const
+{
+	Q_D(const File);
+	QMutexLocker gcImageLocker(&d->gcImageMutex);
+	d->ensureGcImagesLoaded_int();
+	images->setBanner(d->gcBanner);
+
+	vector<const GcImage*> gcIcons(d->gcIcons.constBegin(), d->gcIcons.constEnd());
+	vector<int> iconDelays(d->iconSpeed.constBegin(), d->iconSpeed.constEnd());
+	images->setIcons(gcIcons, iconDelays, (d->iconAnimMode & CARD_ANIM_BOUNCE));
+}
+
 /** Checksum **/
 
 /**
@@ -24,6 +24,8 @@
 #include <QtCore/QIODevice>
 #include <QtGui/QPixmap>
 
+class FileImages;
+
 class FilePrivate;
 class File : public QObject
 {
@@ -97,6 +99,12 @@ public:
 	 */
 	QString filename(void) const;
 
+	/**
+	 * Get the Card this file belongs to.
+	 * @return Card
+	 */
+	Card *card(void) const;
+
 	/**
 	 * Get this file's FAT entries.
 	 * @return FAT entries
@@ -111,6 +119,8 @@ public:
 
 	/**
 	 * Write data to the file.
+	 * NOTE: Data is held in the card's write-back cache
+	 * until Card::commit() is called.
 	 * NOTE: This function cannot expand files at the moment.
 	 * Length+size must be <= total file size.
 	 * @param address Address to write to
@@ -213,6 +223,12 @@ public:
 	 */
 	int iconAnimMode(void) const;
 
+	/**
+	 * Unload the banner and icon images to save memory.
+	 * They will be reloaded from the card on demand.
+	 */
+	void unloadImages(void);
+
 public:
 	/** Lost File information **/
 
@@ -276,6 +292,15 @@ public:
 	int saveIcon(const QString &filenameNoExt,
 		     GcImageWriter::AnimImageFormat animImgf) const;
 
+	/**
+	 * Copy the banner and icon images.
+	 * The copies can be encoded on another thread.
+	 * This can be called from any thread, since it
+	 * doesn't use the cached QPixmaps.
+	 * @param images FileImages to copy the images to
+	 */
+	void copyImages(FileImages *images) const;
+
 public:
 	/** Checksums **/
 
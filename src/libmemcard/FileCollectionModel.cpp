@@ -0,0 +1,969 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * FileCollectionModel.cpp: QAbstractListModel for large file collections. *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "FileCollectionModel.hpp"
+#include "MemCardModel.hpp"
+
+// Card classes.
+#include "Card.hpp"
+#include "File.hpp"
+
+// TODO: Get correct icon size from the Card object.
+#include "card.h"
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <climits>
+
+// C++ includes.
+#include <algorithm>
+#include <list>
+
+// Qt includes.
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+#include <QApplication>
+#include <QtGui/QBrush>
+#include <QtGui/QColor>
+#include <QtGui/QFont>
+#include <QtGui/QPalette>
+
+/** FileCollectionModelPrivate **/
+
+class FileCollectionModelPrivate
+{
+	public:
+		explicit FileCollectionModelPrivate(FileCollectionModel *q);
+
+	protected:
+		FileCollectionModel *const q_ptr;
+		Q_DECLARE_PUBLIC(FileCollectionModel)
+	private:
+		Q_DISABLE_COPY(FileCollectionModelPrivate)
+
+	public:
+		/**
+		 * Card in the collection.
+		 */
+		struct CardEntry {
+			Card *card;
+			int firstRow;	// First row in the model.
+			int fileCount;	// Number of files.
+		};
+		QVector<CardEntry> cards;
+
+		/**
+		 * Find the Card entry that contains a row.
+		 * @param row Row
+		 * @return Index in cards[], or -1 if not found.
+		 */
+		int cardIndexForRow(int row) const;
+
+		/**
+		 * Find the Card entry for a Card.
+		 * @param card Card
+		 * @return Index in cards[], or -1 if not found.
+		 */
+		int cardIndex(const Card *card) const;
+
+		/**
+		 * Get the File for a row.
+		 * @param row Row
+		 * @return File, or nullptr on error.
+		 */
+		File *fileForRow(int row) const;
+
+		/**
+		 * Update firstRow for all cards starting at the specified index.
+		 * @param idx First index in cards[]
+		 */
+		void updateFirstRows(int idx);
+
+		// Pending insert/remove operation.
+		// Set by filesAboutTo*(); applied by files*().
+		int pendingCardIdx;
+		int pendingStart;	// Model row
+		int pendingCount;
+
+		/** Columnar metadata store **/
+
+		// Rows are paged in from the Cards this many at a time.
+		static const int PAGE_SIZE = 256;
+
+		// Row flags.
+		enum RowFlags : uint8_t {
+			RF_LOADED	= (1U << 0),	// Metadata has been loaded.
+			RF_LOST		= (1U << 1),	// "Lost" file.
+
+			// Checksum::ChkStatus
+			RF_CHK_SHIFT	= 2,
+			RF_CHK_MASK	= (3U << RF_CHK_SHIFT),
+		};
+
+		// mtime value for invalid timestamps.
+		static const qint64 MTIME_INVALID = LLONG_MIN;
+
+		// Metadata, indexed by row.
+		struct Columns {
+			QVector<uint8_t> flags;
+			QVector<quint16> size;
+			QVector<qint64> mtime;	// msecs since Epoch (UTC)
+			QVector<QString> description;
+			QVector<QString> mode;
+			QVector<QString> gameID;
+			QVector<QString> filename;
+
+			/**
+			 * Insert unloaded rows.
+			 * @param row First row
+			 * @param count Number of rows
+			 */
+			void insert(int row, int count);
+
+			/**
+			 * Remove rows.
+			 * @param row First row
+			 * @param count Number of rows
+			 */
+			void remove(int row, int count);
+
+			/**
+			 * Remove all rows.
+			 */
+			void clear(void);
+		};
+		mutable Columns columns;
+
+		/**
+		 * Get the number of rows.
+		 * @return Number of rows
+		 */
+		inline int rowCount(void) const
+		{
+			return (int)columns.flags.size();
+		}
+
+		/**
+		 * Make sure the metadata for a row is loaded.
+		 * If it isn't, the row's page is loaded.
+		 * @param row Row
+		 */
+		inline void ensureRowLoaded(int row) const
+		{
+			if (!(columns.flags.at(row) & RF_LOADED)) {
+				loadPage(row / PAGE_SIZE);
+			}
+		}
+
+		/**
+		 * Load the metadata for a page of rows.
+		 * @param page Page number
+		 */
+		void loadPage(int page) const;
+
+		/** Resident images **/
+
+		// Default maximum number of files with resident images.
+		// A GCN file has up to 8 icons plus a banner, so this
+		// is roughly 10 MB of pixmaps.
+		static const int DEFAULT_MAX_RESIDENT = 512;
+		int maxResident;
+
+		/**
+		 * Files with resident images, most recently used first.
+		 * The Card is stored so entries can be purged after
+		 * the Card (and its Files) has been deleted.
+		 */
+		struct LruEntry {
+			File *file;
+			const Card *card;
+		};
+		typedef std::list<LruEntry> LruList;
+		mutable LruList lru;
+		mutable QHash<const File*, LruList::iterator> lruHash;
+
+		/**
+		 * Mark a File's images as recently used.
+		 * If too many files have resident images, the
+		 * least recently used images are unloaded.
+		 * @param file File
+		 */
+		void touchImages(File *file) const;
+
+		/**
+		 * Unload images until the LRU list is within the limit.
+		 */
+		void trimImages(void) const;
+
+		/**
+		 * Stop tracking a File's images.
+		 * The images are *not* unloaded.
+		 * @param file File
+		 */
+		void forgetImages(const File *file);
+
+		/**
+		 * Stop tracking images for all Files on a Card.
+		 * The images are *not* unloaded.
+		 * @param card Card
+		 */
+		void forgetImages(const Card *card);
+
+		/** Style **/
+
+		// Background colors for "lost" files.
+		QBrush brush_lostFile;
+		QBrush brush_lostFile_alt;
+
+		/**
+		 * Initialize the background colors for "lost" files.
+		 */
+		void initBrushes(void);
+};
+
+FileCollectionModelPrivate::FileCollectionModelPrivate(FileCollectionModel *q)
+	: q_ptr(q)
+	, pendingCardIdx(-1)
+	, pendingStart(-1)
+	, pendingCount(0)
+	, maxResident(DEFAULT_MAX_RESIDENT)
+{
+	initBrushes();
+}
+
+/**
+ * Find the Card entry that contains a row.
+ * @param row Row
+ * @return Index in cards[], or -1 if not found.
+ */
+int FileCollectionModelPrivate::cardIndexForRow(int row) const
+{
+	if (row < 0 || row >= rowCount())
+		return -1;
+
+	// Find the last card whose first row is <= row.
+	// Empty cards share firstRow with the next card,
+	// so upper_bound() skips them.
+	auto iter = std::upper_bound(cards.cbegin(), cards.cend(), row,
+		[](int row, const CardEntry &entry) { return row < entry.firstRow; });
+	if (iter == cards.cbegin())
+		return -1;
+	return (int)(iter - cards.cbegin()) - 1;
+}
+
+/**
+ * Find the Card entry for a Card.
+ * @param card Card
+ * @return Index in cards[], or -1 if not found.
+ */
+int FileCollectionModelPrivate::cardIndex(const Card *card) const
+{
+	for (int i = 0; i < cards.size(); i++) {
+		if (cards.at(i).card == card)
+			return i;
+	}
+	return -1;
+}
+
+/**
+ * Get the File for a row.
+ * @param row Row
+ * @return File, or nullptr on error.
+ */
+File *FileCollectionModelPrivate::fileForRow(int row) const
+{
+	const int idx = cardIndexForRow(row);
+	if (idx < 0)
+		return nullptr;
+	const CardEntry &entry = cards.at(idx);
+	return entry.card->getFile(row - entry.firstRow);
+}
+
+/**
+ * Update firstRow for all cards starting at the specified index.
+ * @param idx First index in cards[]
+ */
+void FileCollectionModelPrivate::updateFirstRows(int idx)
+{
+	int row = (idx > 0 ? cards.at(idx - 1).firstRow + cards.at(idx - 1).fileCount : 0);
+	for (; idx < cards.size(); idx++) {
+		cards[idx].firstRow = row;
+		row += cards.at(idx).fileCount;
+	}
+}
+
+/**
+ * Insert unloaded rows.
+ * @param row First row
+ * @param count Number of rows
+ */
+void FileCollectionModelPrivate::Columns::insert(int row, int count)
+{
+	flags.insert(row, count, 0);
+	size.insert(row, count, 0);
+	mtime.insert(row, count, qint64(MTIME_INVALID));
+	description.insert(row, count, QString());
+	mode.insert(row, count, QString());
+	gameID.insert(row, count, QString());
+	filename.insert(row, count, QString());
+}
+
+/**
+ * Remove rows.
+ * @param row First row
+ * @param count Number of rows
+ */
+void FileCollectionModelPrivate::Columns::remove(int row, int count)
+{
+	flags.remove(row, count);
+	size.remove(row, count);
+	mtime.remove(row, count);
+	description.remove(row, count);
+	mode.remove(row, count);
+	gameID.remove(row, count);
+	filename.remove(row, count);
+}
+
+/**
+ * Remove all rows.
+ */
+void FileCollectionModelPrivate::Columns::clear(void)
+{
+	flags.clear();
+	size.clear();
+	mtime.clear();
+	description.clear();
+	mode.clear();
+	gameID.clear();
+	filename.clear();
+}
+
+/**
+ * Load the metadata for a page of rows.
+ * @param page Page number
+ */
+void FileCollectionModelPrivate::loadPage(int page) const
+{
+	const int start = page * PAGE_SIZE;
+	const int end = std::min(start + PAGE_SIZE, rowCount());
+
+	int idx = cardIndexForRow(start);
+	for (int row = start; row < end && idx >= 0 && idx < cards.size(); idx++) {
+		const CardEntry &entry = cards.at(idx);
+		const int cardEnd = std::min(entry.firstRow + entry.fileCount, end);
+		for (; row < cardEnd; row++) {
+			if (columns.flags.at(row) & RF_LOADED)
+				continue;
+
+			const File *file = entry.card->getFile(row - entry.firstRow);
+			if (!file) {
+				// No file. Mark the row as loaded anyway
+				// so we don't keep trying to load it.
+				columns.flags[row] = RF_LOADED;
+				continue;
+			}
+
+			uint8_t flags = RF_LOADED;
+			if (file->isLostFile())
+				flags |= RF_LOST;
+			flags |= ((uint8_t)file->checksumStatus() << RF_CHK_SHIFT) & RF_CHK_MASK;
+			columns.flags[row] = flags;
+
+			columns.size[row] = (quint16)file->size();
+			const QDateTime mtime = file->mtime();
+			columns.mtime[row] = (mtime.isValid() ? mtime.toMSecsSinceEpoch() : MTIME_INVALID);
+			columns.description[row] = file->description();
+			columns.mode[row] = file->modeAsString();
+			columns.gameID[row] = file->gameID();
+			columns.filename[row] = file->filename();
+		}
+	}
+}
+
+/**
+ * Mark a File's images as recently used.
+ * If too many files have resident images, the
+ * least recently used images are unloaded.
+ * @param file File
+ */
+void FileCollectionModelPrivate::touchImages(File *file) const
+{
+	auto iter = lruHash.find(file);
+	if (iter != lruHash.end()) {
+		// Move the file to the front of the list.
+		lru.splice(lru.begin(), lru, iter.value());
+		return;
+	}
+
+	LruEntry entry;
+	entry.file = file;
+	entry.card = file->card();
+	lru.push_front(entry);
+	lruHash.insert(file, lru.begin());
+	trimImages();
+}
+
+/**
+ * Unload images until the LRU list is within the limit.
+ */
+void FileCollectionModelPrivate::trimImages(void) const
+{
+	while (lruHash.size() > maxResident) {
+		File *const file = lru.back().file;
+		lruHash.remove(file);
+		lru.pop_back();
+		file->unloadImages();
+	}
+}
+
+/**
+ * Stop tracking a File's images.
+ * The images are *not* unloaded.
+ * @param file File
+ */
+void FileCollectionModelPrivate::forgetImages(const File *file)
+{
+	auto iter = lruHash.find(file);
+	if (iter != lruHash.end()) {
+		lru.erase(iter.value());
+		lruHash.erase(iter);
+	}
+}
+
+/**
+ * Stop tracking images for all Files on a Card.
+ * The images are *not* unloaded.
+ * @param card Card
+ */
+void FileCollectionModelPrivate::forgetImages(const Card *card)
+{
+	// NOTE: The Card may have been deleted already,
+	// so the Files must not be dereferenced here.
+	for (auto iter = lru.begin(); iter != lru.end(); ) {
+		if (iter->card == card) {
+			lruHash.remove(iter->file);
+			iter = lru.erase(iter);
+		} else {
+			++iter;
+		}
+	}
+}
+
+/**
+ * Initialize the background colors for "lost" files.
+ * (Same colors as MemCardModel.)
+ */
+void FileCollectionModelPrivate::initBrushes(void)
+{
+	QPalette pal = QApplication::palette("QTreeView");
+	QColor bgColor_lostFile = pal.base().color();
+	QColor bgColor_lostFile_alt = pal.alternateBase().color();
+
+	// Adjust the colors to have a yellow hue.
+	int h, s, v;
+	bgColor_lostFile.getHsv(&h, &s, &v, nullptr);
+	bgColor_lostFile.setHsv(60, (255 - s), v);
+	bgColor_lostFile_alt.getHsv(&h, &s, &v, nullptr);
+	bgColor_lostFile_alt.setHsv(60, (255 - s), v);
+
+	brush_lostFile = QBrush(bgColor_lostFile);
+	brush_lostFile_alt = QBrush(bgColor_lostFile_alt);
+}
+
+/** FileCollectionModel **/
+
+FileCollectionModel::FileCollectionModel(QObject *parent)
+	: super(parent)
+	, d_ptr(new FileCollectionModelPrivate(this))
+{
+	// Connect the "themeChanged" signal.
+	connect(qApp, SIGNAL(themeChanged()),
+		this, SLOT(themeChanged_slot()));
+}
+
+FileCollectionModel::~FileCollectionModel()
+{
+	Q_D(FileCollectionModel);
+	delete d;
+}
+
+int FileCollectionModel::rowCount(const QModelIndex& parent) const
+{
+	Q_UNUSED(parent);
+	Q_D(const FileCollectionModel);
+	return d->rowCount();
+}
+
+int FileCollectionModel::columnCount(const QModelIndex& parent) const
+{
+	Q_UNUSED(parent);
+	return MemCardModel::COL_MAX;
+}
+
+QVariant FileCollectionModel::data(const QModelIndex& index, int role) const
+{
+	Q_D(const FileCollectionModel);
+	if (!index.isValid())
+		return QVariant();
+	const int row = index.row();
+	if (row >= d->rowCount())
+		return QVariant();
+
+	typedef FileCollectionModelPrivate FCMP;
+	switch (role) {
+		case Qt::DisplayRole:
+			d->ensureRowLoaded(row);
+			switch (index.column()) {
+				case MemCardModel::COL_DESCRIPTION:
+					return d->columns.description.at(row);
+				case MemCardModel::COL_SIZE:
+					return (int)d->columns.size.at(row);
+				case MemCardModel::COL_MTIME: {
+					const qint64 mtime = d->columns.mtime.at(row);
+					if (mtime == FCMP::MTIME_INVALID)
+						return QDateTime();
+					return QDateTime::fromMSecsSinceEpoch(mtime, Qt::UTC);
+				}
+				case MemCardModel::COL_MODE:
+					return d->columns.mode.at(row);
+				case MemCardModel::COL_GAMEID:
+					return d->columns.gameID.at(row);
+				case MemCardModel::COL_FILENAME:
+					return d->columns.filename.at(row);
+				default:
+					break;
+			}
+			break;
+
+		case Qt::DecorationRole:
+			// Images must use Qt::DecorationRole.
+			switch (index.column()) {
+				case MemCardModel::COL_ICON:
+				case MemCardModel::COL_BANNER: {
+					// NOTE: Images are loaded from the Card here.
+					// Metadata-only queries don't touch them.
+					File *const file = d->fileForRow(row);
+					if (!file)
+						break;
+					d->touchImages(file);
+					// TODO: Animated icons?
+					return (index.column() == MemCardModel::COL_ICON
+						? file->icon(0)
+						: file->banner());
+				}
+
+				case MemCardModel::COL_ISVALID: {
+					d->ensureRowLoaded(row);
+					const uint8_t flags = d->columns.flags.at(row);
+					return MemCardModel::checksumStatusIcon(static_cast<Checksum::ChkStatus>(
+						(flags & FCMP::RF_CHK_MASK) >> FCMP::RF_CHK_SHIFT));
+				}
+
+				default:
+					break;
+			}
+			break;
+
+		case Qt::TextAlignmentRole:
+			switch (index.column()) {
+				case MemCardModel::COL_SIZE:
+				case MemCardModel::COL_MODE:
+				case MemCardModel::COL_GAMEID:
+				case MemCardModel::COL_ISVALID:
+					// These columns should be center-aligned horizontally.
+					return (int)(Qt::AlignHCenter | Qt::AlignVCenter);
+
+				default:
+					// Everything should be center-aligned vertically.
+					return Qt::AlignVCenter;
+			}
+			break;
+
+		case Qt::FontRole:
+			switch (index.column()) {
+				case MemCardModel::COL_SIZE:
+				case MemCardModel::COL_MODE:
+				case MemCardModel::COL_GAMEID: {
+					// These columns should be monospaced.
+					QFont fntMonospace(QLatin1String("Monospace"));
+					fntMonospace.setStyleHint(QFont::TypeWriter);
+					return fntMonospace;
+				}
+
+				default:
+					break;
+			}
+			break;
+
+		case Qt::BackgroundRole:
+			// "Lost" files should be displayed using a different color.
+			d->ensureRowLoaded(row);
+			if (d->columns.flags.at(row) & FCMP::RF_LOST) {
+				if (row & 1)
+					return d->brush_lostFile_alt;
+				else
+					return d->brush_lostFile;
+			}
+			break;
+
+		case MemCardModel::ChecksumStatusRole:
+			d->ensureRowLoaded(row);
+			return (d->columns.flags.at(row) & FCMP::RF_CHK_MASK) >> FCMP::RF_CHK_SHIFT;
+
+		case MemCardModel::LostFileRole:
+			d->ensureRowLoaded(row);
+			return !!(d->columns.flags.at(row) & FCMP::RF_LOST);
+
+		case Qt::SizeHintRole: {
+			// Same sizes as MemCardModel.
+		#ifdef Q_OS_WIN
+			static const int iconWadj = 8;
+			static const int bannerWadj = 8;
+		#else
+			static const int iconWadj = 0;
+			static const int bannerWadj = 8;
+		#endif
+			switch (index.column()) {
+				case MemCardModel::COL_ICON:
+					return QSize(CARD_ICON_W + iconWadj, (CARD_ICON_H + 4));
+				case MemCardModel::COL_BANNER:
+					return QSize(CARD_BANNER_W + bannerWadj, (CARD_BANNER_H + 4));
+				case MemCardModel::COL_ISVALID:
+					return QSize(32, 32+4);
+				default:
+					break;
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	// Default value.
+	return QVariant();
+}
+
+QVariant FileCollectionModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	Q_UNUSED(orientation);
+
+	// NOTE: Using MemCardModel's translations.
+	switch (role) {
+		case Qt::DisplayRole:
+			switch (section) {
+				case MemCardModel::COL_ICON:
+					return QCoreApplication::translate("MemCardModel", "Icon");
+				case MemCardModel::COL_BANNER:
+					return QCoreApplication::translate("MemCardModel", "Banner");
+				case MemCardModel::COL_DESCRIPTION:
+					return QCoreApplication::translate("MemCardModel", "Description");
+				case MemCardModel::COL_SIZE:
+					return QCoreApplication::translate("MemCardModel", "Size");
+				case MemCardModel::COL_MTIME:
+					return QCoreApplication::translate("MemCardModel", "Last Modified");
+				case MemCardModel::COL_MODE:
+					return QCoreApplication::translate("MemCardModel", "Mode");
+				case MemCardModel::COL_GAMEID:
+					return QCoreApplication::translate("MemCardModel", "Game ID");
+				case MemCardModel::COL_FILENAME:
+					return QCoreApplication::translate("MemCardModel", "Filename");
+				default:
+					break;
+			}
+			break;
+
+		case Qt::TextAlignmentRole:
+			switch (section) {
+				case MemCardModel::COL_ICON:
+				case MemCardModel::COL_SIZE:
+				case MemCardModel::COL_MODE:
+				case MemCardModel::COL_GAMEID:
+				case MemCardModel::COL_ISVALID:
+					// Center-align the text.
+					return Qt::AlignHCenter;
+
+				default:
+					break;
+			}
+			break;
+	}
+
+	// Default value.
+	return QVariant();
+}
+
+/**
+ * Add a Card to the collection.
+ * Its files are appended to the end of the list.
+ * @param card Card
+ */
+void FileCollectionModel::addCard(Card *card)
+{
+	Q_D(FileCollectionModel);
+	if (!card || d->cardIndex(card) >= 0)
+		return;
+
+	const int firstRow = d->rowCount();
+	const int fileCount = std::max(card->fileCount(), 0);
+	if (fileCount > 0)
+		beginInsertRows(QModelIndex(), firstRow, firstRow + fileCount - 1);
+
+	FileCollectionModelPrivate::CardEntry entry;
+	entry.card = card;
+	entry.firstRow = firstRow;
+	entry.fileCount = fileCount;
+	d->cards.append(entry);
+	d->columns.insert(firstRow, fileCount);
+
+	// Connect the Card's signals.
+	connect(card, &QObject::destroyed,
+		this, &FileCollectionModel::card_destroyed_slot);
+	connect(card, &Card::filesAboutToBeInserted,
+		this, &FileCollectionModel::card_filesAboutToBeInserted_slot);
+	connect(card, &Card::filesInserted,
+		this, &FileCollectionModel::card_filesInserted_slot);
+	connect(card, &Card::filesAboutToBeRemoved,
+		this, &FileCollectionModel::card_filesAboutToBeRemoved_slot);
+	connect(card, &Card::filesRemoved,
+		this, &FileCollectionModel::card_filesRemoved_slot);
+
+	if (fileCount > 0)
+		endInsertRows();
+}
+
+/**
+ * Remove a Card from the collection.
+ * @param card Card
+ */
+void FileCollectionModel::removeCard(Card *card)
+{
+	Q_D(FileCollectionModel);
+	const int idx = d->cardIndex(card);
+	if (idx < 0)
+		return;
+
+	disconnect(card, nullptr, this, nullptr);
+
+	const FileCollectionModelPrivate::CardEntry entry = d->cards.at(idx);
+	if (entry.fileCount > 0)
+		beginRemoveRows(QModelIndex(), entry.firstRow, entry.firstRow + entry.fileCount - 1);
+
+	d->forgetImages(card);
+	d->columns.remove(entry.firstRow, entry.fileCount);
+	d->cards.remove(idx);
+	d->updateFirstRows(idx);
+
+	if (entry.fileCount > 0)
+		endRemoveRows();
+}
+
+/**
+ * Remove all Cards from the collection.
+ */
+void FileCollectionModel::clear(void)
+{
+	Q_D(FileCollectionModel);
+	if (d->cards.isEmpty())
+		return;
+
+	const int rowCount = d->rowCount();
+	if (rowCount > 0)
+		beginRemoveRows(QModelIndex(), 0, rowCount - 1);
+
+	foreach (const FileCollectionModelPrivate::CardEntry &entry, d->cards) {
+		disconnect(entry.card, nullptr, this, nullptr);
+	}
+	d->cards.clear();
+	d->columns.clear();
+	d->lru.clear();
+	d->lruHash.clear();
+
+	if (rowCount > 0)
+		endRemoveRows();
+}
+
+/**
+ * Get the number of Cards in the collection.
+ * @return Number of Cards
+ */
+int FileCollectionModel::cardCount(void) const
+{
+	Q_D(const FileCollectionModel);
+	return d->cards.size();
+}
+
+/**
+ * Get the File for a row.
+ * @param row Row
+ * @return File, or nullptr on error.
+ */
+File *FileCollectionModel::file(int row) const
+{
+	Q_D(const FileCollectionModel);
+	return d->fileForRow(row);
+}
+
+/**
+ * Get the maximum number of files with resident images.
+ * @return Maximum number of files with resident images
+ */
+int FileCollectionModel::maxResidentImages(void) const
+{
+	Q_D(const FileCollectionModel);
+	return d->maxResident;
+}
+
+/**
+ * Set the maximum number of files with resident images.
+ * Images for the least recently displayed files are unloaded.
+ * @param maxResidentImages Maximum number of files with resident images
+ */
+void FileCollectionModel::setMaxResidentImages(int maxResidentImages)
+{
+	Q_D(FileCollectionModel);
+	assert(maxResidentImages > 0);
+	if (maxResidentImages <= 0)
+		maxResidentImages = 1;
+	d->maxResident = maxResidentImages;
+	d->trimImages();
+}
+
+/** Private slots. **/
+
+/**
+ * A Card object was destroyed.
+ * @param obj QObject that was destroyed
+ */
+void FileCollectionModel::card_destroyed_slot(QObject *obj)
+{
+	// NOTE: The Card is no longer valid, so don't use qobject_cast<>.
+	Q_D(FileCollectionModel);
+	int idx = -1;
+	for (int i = 0; i < d->cards.size(); i++) {
+		if (d->cards.at(i).card == obj) {
+			idx = i;
+			break;
+		}
+	}
+	if (idx < 0)
+		return;
+
+	const FileCollectionModelPrivate::CardEntry entry = d->cards.at(idx);
+	if (entry.fileCount > 0)
+		beginRemoveRows(QModelIndex(), entry.firstRow, entry.firstRow + entry.fileCount - 1);
+
+	d->forgetImages(entry.card);
+	d->columns.remove(entry.firstRow, entry.fileCount);
+	d->cards.remove(idx);
+	d->updateFirstRows(idx);
+
+	if (entry.fileCount > 0)
+		endRemoveRows();
+}
+
+/**
+ * Files are about to be added to a Card.
+ * @param start First file index
+ * @param end Last file index
+ */
+void FileCollectionModel::card_filesAboutToBeInserted_slot(int start, int end)
+{
+	Q_D(FileCollectionModel);
+	const int idx = d->cardIndex(qobject_cast<Card*>(sender()));
+	assert(idx >= 0);
+	if (idx < 0)
+		return;
+
+	const int firstRow = d->cards.at(idx).firstRow;
+	beginInsertRows(QModelIndex(), firstRow + start, firstRow + end);
+
+	// Save the start/end indexes.
+	d->pendingCardIdx = idx;
+	d->pendingStart = firstRow + start;
+	d->pendingCount = end - start + 1;
+}
+
+/**
+ * Files have been added to a Card.
+ */
+void FileCollectionModel::card_filesInserted_slot(void)
+{
+	Q_D(FileCollectionModel);
+	if (d->pendingCardIdx < 0)
+		return;
+
+	// Add unloaded rows for the new files.
+	d->columns.insert(d->pendingStart, d->pendingCount);
+	d->cards[d->pendingCardIdx].fileCount += d->pendingCount;
+	d->updateFirstRows(d->pendingCardIdx + 1);
+	d->pendingCardIdx = -1;
+
+	// Done adding rows.
+	endInsertRows();
+}
+
+/**
+ * Files are about to be removed from a Card.
+ * @param start First file index
+ * @param end Last file index
+ */
+void FileCollectionModel::card_filesAboutToBeRemoved_slot(int start, int end)
+{
+	Q_D(FileCollectionModel);
+	Card *const card = qobject_cast<Card*>(sender());
+	const int idx = d->cardIndex(card);
+	assert(idx >= 0);
+	if (idx < 0)
+		return;
+
+	const int firstRow = d->cards.at(idx).firstRow;
+	beginRemoveRows(QModelIndex(), firstRow + start, firstRow + end);
+
+	// The Files are about to be deleted.
+	for (int i = start; i <= end; i++) {
+		d->forgetImages(card->getFile(i));
+	}
+
+	// Save the start/end indexes.
+	d->pendingCardIdx = idx;
+	d->pendingStart = firstRow + start;
+	d->pendingCount = end - start + 1;
+}
+
+/**
+ * Files have been removed from a Card.
+ */
+void FileCollectionModel::card_filesRemoved_slot(void)
+{
+	Q_D(FileCollectionModel);
+	if (d->pendingCardIdx < 0)
+		return;
+
+	d->columns.remove(d->pendingStart, d->pendingCount);
+	d->cards[d->pendingCardIdx].fileCount -= d->pendingCount;
+	d->updateFirstRows(d->pendingCardIdx + 1);
+	d->pendingCardIdx = -1;
+
+	// Done removing rows.
+	endRemoveRows();
+}
+
+/** Slots. **/
+
+/**
+ * The system theme has changed.
+ */
+void FileCollectionModel::themeChanged_slot(void)
+{
+	// Reinitialize the background colors.
+	Q_D(FileCollectionModel);
+	d->initBrushes();
+}
@@ -0,0 +1,136 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * FileCollectionModel.hpp: QAbstractListModel for large file collections. *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+class Card;
+class File;
+
+// Qt includes.
+#include <QtCore/QAbstractListModel>
+
+class FileCollectionModelPrivate;
+
+/**
+ * QAbstractListModel for large file collections.
+ *
+ * Files from one or more Cards are shown as a single list,
+ * using the same columns as MemCardModel.
+ *
+ * File metadata is paged in from the Cards on demand and kept
+ * in a compact columnar store, so rowCount() and the sort and
+ * filter roles don't need to touch the File objects.
+ *
+ * Banners and icons are only kept resident for the most recently
+ * displayed files; older images are unloaded from their Files.
+ * Icons are not animated.
+ */
+class FileCollectionModel : public QAbstractListModel
+{
+	Q_OBJECT
+	typedef QAbstractListModel super;
+
+	public:
+		explicit FileCollectionModel(QObject *parent = 0);
+		virtual ~FileCollectionModel();
+
+	protected:
+		FileCollectionModelPrivate *const d_ptr;
+		Q_DECLARE_PRIVATE(FileCollectionModel)
+	private:
+		Q_DISABLE_COPY(FileCollectionModel)
+
+	public:
+		// Qt Model/View interface.
+		int rowCount(const QModelIndex& parent = QModelIndex()) const final;
+		int columnCount(const QModelIndex& parent = QModelIndex()) const final;
+
+		QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const final;
+		QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const final;
+
+	public:
+		/**
+		 * Add a Card to the collection.
+		 * Its files are appended to the end of the list.
+		 * @param card Card
+		 */
+		void addCard(Card *card);
+
+		/**
+		 * Remove a Card from the collection.
+		 * @param card Card
+		 */
+		void removeCard(Card *card);
+
+		/**
+		 * Remove all Cards from the collection.
+		 */
+		void clear(void);
+
+		/**
+		 * Get the number of Cards in the collection.
+		 * @return Number of Cards
+		 */
+		int cardCount(void) const;
+
+		/**
+		 * Get the File for a row.
+		 * @param row Row
+		 * @return File, or nullptr on error.
+		 */
+		File *file(int row) const;
+
+		/**
+		 * Get the maximum number of files with resident images.
+		 * @return Maximum number of files with resident images
+		 */
+		int maxResidentImages(void) const;
+
+		/**
+		 * Set the maximum number of files with resident images.
+		 * Images for the least recently displayed files are unloaded.
+		 * @param maxResidentImages Maximum number of files with resident images
+		 */
+		void setMaxResidentImages(int maxResidentImages);
+
+	private slots:
+		/**
+		 * A Card object was destroyed.
+		 * @param obj QObject that was destroyed
+		 */
+		void card_destroyed_slot(QObject *obj);
+
+		/**
+		 * Files are about to be added to a Card.
+		 * @param start First file index
+		 * @param end Last file index
+		 */
+		void card_filesAboutToBeInserted_slot(int start, int end);
+
+		/**
+		 * Files have been added to a Card.
+		 */
+		void card_filesInserted_slot(void);
+
+		/**
+		 * Files are about to be removed from a Card.
+		 * @param start First file index
+		 * @param end Last file index
+		 */
+		void card_filesAboutToBeRemoved_slot(int start, int end);
+
+		/**
+		 * Files have been removed from a Card.
+		 */
+		void card_filesRemoved_slot(void);
+
+		/**
+		 * The system theme has changed.
+		 */
+		void themeChanged_slot(void);
+};
@@ -0,0 +1,484 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * FileFilterIndex.cpp: Indexed file list filter.                          *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "FileFilterIndex.hpp"
+
+// C includes. (C++ namespace)
+#include <cassert>
+
+// C++ includes.
+#include <algorithm>
+
+FileFilterIndex::FileFilterIndex()
+	: m_resultValid(false)
+{ }
+
+/**
+ * Split a string into case-folded words.
+ * @param str String
+ * @return Words
+ */
+QStringList FileFilterIndex::tokenize(const QString &str)
+{
+	// NOTE: Text without spaces, e.g. Japanese descriptions,
+	// is indexed as a single word.
+	QStringList words;
+	const QString folded = str.toCaseFolded();
+	int start = -1;
+	for (int i = 0; i <= folded.size(); i++) {
+		if (i < folded.size() && folded.at(i).isLetterOrNumber()) {
+			if (start < 0)
+				start = i;
+		} else if (start >= 0) {
+			words.append(folded.mid(start, i - start));
+			start = -1;
+		}
+	}
+	return words;
+}
+
+/** Index **/
+
+/**
+ * Resize all bitsets.
+ * @param size New size
+ */
+void FileFilterIndex::resizeBitsets(int size)
+{
+	m_used.resize(size);
+	for (QBitArray &bits : m_status) {
+		bits.resize(size);
+	}
+	m_lost.resize(size);
+	for (auto iter = m_region.begin(); iter != m_region.end(); ++iter) {
+		iter.value().resize(size);
+	}
+}
+
+/**
+ * Allocate an ID.
+ * @return ID
+ */
+quint32 FileFilterIndex::allocId(void)
+{
+	if (!m_freeIds.isEmpty()) {
+		const quint32 id = m_freeIds.last();
+		m_freeIds.removeLast();
+		return id;
+	}
+
+	const quint32 id = (quint32)m_regionOf.size();
+	for (QVector<QStringList> &words : m_words) {
+		words.append(QStringList());
+	}
+	m_regionOf.append(0);
+	if ((int)id >= m_used.size()) {
+		resizeBitsets(std::max(64, m_used.size() * 2));
+	}
+	return id;
+}
+
+/**
+ * Add an entry to the index.
+ * @param id ID
+ * @param entry Entry
+ */
+void FileFilterIndex::addToIndex(quint32 id, const Entry &entry)
+{
+	m_used.setBit(id);
+
+	// Text fields.
+	m_words[FIELD_GAMEDESC][id] = tokenize(entry.gameDesc);
+	m_words[FIELD_FILEDESC][id] = tokenize(entry.fileDesc);
+	m_words[FIELD_FILENAME][id] = tokenize(entry.filename);
+	m_words[FIELD_GAMEID][id] = tokenize(entry.gameID);
+	for (int f = 0; f < FIELD_TEXT_MAX; f++) {
+		foreach (const QString &word, m_words[f].at(id)) {
+			m_index[f][word].insert(id);
+		}
+	}
+
+	// Checksum status.
+	const int status = static_cast<int>(entry.status);
+	assert(status >= 0 && status < 3);
+	if (status >= 0 && status < 3) {
+		m_status[status].setBit(id);
+	}
+
+	// "Lost" file.
+	m_lost.setBit(id, entry.lost);
+
+	// Region. (4th character of the game ID)
+	if (entry.gameID.size() >= 4) {
+		const ushort region = entry.gameID.at(3).toUpper().unicode();
+		auto iter = m_region.find(region);
+		if (iter == m_region.end()) {
+			iter = m_region.insert(region, QBitArray(m_used.size()));
+		}
+		iter.value().setBit(id);
+		m_regionOf[id] = region;
+	}
+}
+
+/**
+ * Remove an ID from the index.
+ * @param id ID
+ */
+void FileFilterIndex::removeFromIndex(quint32 id)
+{
+	for (int f = 0; f < FIELD_TEXT_MAX; f++) {
+		foreach (const QString &word, m_words[f].at(id)) {
+			auto iter = m_index[f].find(word);
+			if (iter != m_index[f].end()) {
+				iter.value().remove(id);
+				if (iter.value().isEmpty()) {
+					m_index[f].erase(iter);
+				}
+			}
+		}
+		m_words[f][id].clear();
+	}
+
+	m_used.clearBit(id);
+	for (QBitArray &bits : m_status) {
+		bits.clearBit(id);
+	}
+	m_lost.clearBit(id);
+	if (m_regionOf.at(id) != 0) {
+		m_region[m_regionOf.at(id)].clearBit(id);
+		m_regionOf[id] = 0;
+	}
+}
+
+/**
+ * Insert rows.
+ * @param row First row
+ * @param entries Entries for the new rows
+ */
+void FileFilterIndex::insertRows(int row, const QVector<Entry> &entries)
+{
+	assert(row >= 0 && row <= m_rowIds.size());
+	if (row < 0 || row > m_rowIds.size() || entries.isEmpty())
+		return;
+
+	m_rowIds.insert(row, entries.size(), 0);
+	for (int i = 0; i < entries.size(); i++) {
+		const quint32 id = allocId();
+		addToIndex(id, entries.at(i));
+		m_rowIds[row + i] = id;
+	}
+
+	// The new rows haven't been checked against the query.
+	m_resultValid = false;
+}
+
+/**
+ * Remove rows.
+ * @param row First row
+ * @param count Number of rows
+ */
+void FileFilterIndex::removeRows(int row, int count)
+{
+	assert(row >= 0 && count >= 0 && row + count <= m_rowIds.size());
+	if (row < 0 || count <= 0 || row + count > m_rowIds.size())
+		return;
+
+	// NOTE: The cached result is still valid for the remaining rows.
+	for (int i = row; i < row + count; i++) {
+		const quint32 id = m_rowIds.at(i);
+		removeFromIndex(id);
+		m_freeIds.append(id);
+	}
+	m_rowIds.remove(row, count);
+}
+
+/**
+ * Update a row.
+ * @param row Row
+ * @param entry New entry
+ */
+void FileFilterIndex::updateRow(int row, const Entry &entry)
+{
+	assert(row >= 0 && row < m_rowIds.size());
+	if (row < 0 || row >= m_rowIds.size())
+		return;
+
+	const quint32 id = m_rowIds.at(row);
+	removeFromIndex(id);
+	addToIndex(id, entry);
+	m_resultValid = false;
+}
+
+/**
+ * Remove all rows.
+ */
+void FileFilterIndex::clear(void)
+{
+	m_rowIds.clear();
+	m_freeIds.clear();
+	for (int f = 0; f < FIELD_TEXT_MAX; f++) {
+		m_words[f].clear();
+		m_index[f].clear();
+	}
+	m_used.clear();
+	for (QBitArray &bits : m_status) {
+		bits.clear();
+	}
+	m_lost.clear();
+	m_region.clear();
+	m_regionOf.clear();
+
+	m_result.clear();
+	m_resultValid = false;
+}
+
+/** Query **/
+
+/**
+ * Set the query.
+ * @param query Query
+ */
+void FileFilterIndex::setQuery(const QString &query)
+{
+	if (m_query == query)
+		return;
+
+	m_query = query;
+	m_terms = parseQuery(query);
+	m_resultValid = false;
+}
+
+/**
+ * Parse a query.
+ * @param query Query
+ * @return Terms
+ */
+QVector<FileFilterIndex::Term> FileFilterIndex::parseQuery(const QString &query)
+{
+	QVector<Term> terms;
+
+	const int len = query.size();
+	int i = 0;
+	while (i < len) {
+		// Skip whitespace.
+		if (query.at(i).isSpace()) {
+			i++;
+			continue;
+		}
+
+		// Read the next term.
+		Term term;
+		term.type = TermType::Text;
+		term.negate = false;
+		term.prefix = false;
+		term.fieldMask = 0;
+		term.value = 0;
+		if (query.at(i) == QLatin1Char('-')) {
+			term.negate = true;
+			i++;
+		}
+
+		QString str;
+		int colonPos = -1;
+		bool inQuotes = false;
+		for (; i < len; i++) {
+			const QChar chr = query.at(i);
+			if (chr == QLatin1Char('"')) {
+				inQuotes = !inQuotes;
+			} else if (!inQuotes && chr.isSpace()) {
+				break;
+			} else {
+				if (!inQuotes && colonPos < 0 && chr == QLatin1Char(':')) {
+					colonPos = str.size();
+				}
+				str += chr;
+			}
+		}
+
+		// Check for a field name.
+		QString key, value = str;
+		if (colonPos > 0) {
+			key = str.left(colonPos).toLower();
+			value = str.mid(colonPos + 1);
+		}
+		const QString lcValue = value.trimmed().toLower();
+
+		if (key == QLatin1String("id")) {
+			term.fieldMask = (1U << FIELD_GAMEID);
+		} else if (key == QLatin1String("game")) {
+			term.fieldMask = (1U << FIELD_GAMEDESC);
+		} else if (key == QLatin1String("file")) {
+			term.fieldMask = (1U << FIELD_FILEDESC);
+		} else if (key == QLatin1String("desc")) {
+			term.fieldMask = (1U << FIELD_GAMEDESC) | (1U << FIELD_FILEDESC);
+		} else if (key == QLatin1String("name") || key == QLatin1String("filename")) {
+			term.fieldMask = (1U << FIELD_FILENAME);
+		} else if (key == QLatin1String("status")) {
+			term.type = TermType::Status;
+			if (lcValue == QLatin1String("good") || lcValue == QLatin1String("valid")) {
+				term.value = static_cast<int>(Checksum::ChkStatus::Good);
+			} else if (lcValue == QLatin1String("invalid") || lcValue == QLatin1String("bad")) {
+				term.value = static_cast<int>(Checksum::ChkStatus::Invalid);
+			} else if (lcValue == QLatin1String("unknown")) {
+				term.value = static_cast<int>(Checksum::ChkStatus::Unknown);
+			} else {
+				term.type = TermType::Nothing;
+			}
+		} else if (key == QLatin1String("lost")) {
+			term.type = TermType::Lost;
+			if (lcValue == QLatin1String("yes") || lcValue == QLatin1String("true") || lcValue == QLatin1String("1")) {
+				term.value = 1;
+			} else if (lcValue == QLatin1String("no") || lcValue == QLatin1String("false") || lcValue == QLatin1String("0")) {
+				term.value = 0;
+			} else {
+				term.type = TermType::Nothing;
+			}
+		} else if (key == QLatin1String("region")) {
+			term.type = TermType::Region;
+			if (lcValue == QLatin1String("jpn") || lcValue == QLatin1String("japan")) {
+				term.value = 'J';
+			} else if (lcValue == QLatin1String("usa") || lcValue == QLatin1String("us") || lcValue == QLatin1String("ntsc-u")) {
+				term.value = 'E';
+			} else if (lcValue == QLatin1String("eur") || lcValue == QLatin1String("europe") || lcValue == QLatin1String("pal")) {
+				term.value = 'P';
+			} else if (lcValue.size() == 1) {
+				term.value = lcValue.at(0).toUpper().unicode();
+			} else {
+				term.type = TermType::Nothing;
+			}
+		} else {
+			// No field name, or unknown field name.
+			// Search all text fields for words starting with the value.
+			value = str;
+			term.fieldMask = (1U << FIELD_TEXT_MAX) - 1;
+			term.prefix = true;
+		}
+
+		if (term.type == TermType::Text) {
+			// Field values only match whole words unless they end with '*'.
+			while (value.endsWith(QLatin1Char('*'))) {
+				term.prefix = true;
+				value.chop(1);
+			}
+			term.words = tokenize(value);
+			if (term.words.isEmpty()) {
+				// No words. This term matches everything.
+				continue;
+			}
+		}
+
+		terms.append(term);
+	}
+
+	return terms;
+}
+
+/**
+ * Get the IDs that have a word in the specified fields.
+ * @param word Word
+ * @param prefix If true, match words starting with this word.
+ * @param fieldMask Fields to check (1 << Field)
+ * @return Bitset of matching IDs
+ */
+QBitArray FileFilterIndex::wordMatches(const QString &word, bool prefix, uint8_t fieldMask) const
+{
+	QBitArray bits(m_used.size());
+	for (int f = 0; f < FIELD_TEXT_MAX; f++) {
+		if (!(fieldMask & (1U << f)))
+			continue;
+
+		const QMap<QString, QSet<quint32> > &index = m_index[f];
+		if (prefix) {
+			// All words starting with this word are sorted
+			// immediately after it.
+			for (auto iter = index.lowerBound(word);
+			     iter != index.end() && iter.key().startsWith(word); ++iter)
+			{
+				foreach (quint32 id, iter.value()) {
+					bits.setBit(id);
+				}
+			}
+		} else {
+			auto iter = index.find(word);
+			if (iter != index.end()) {
+				foreach (quint32 id, iter.value()) {
+					bits.setBit(id);
+				}
+			}
+		}
+	}
+	return bits;
+}
+
+/**
+ * Get the IDs that match a term.
+ * @param term Term
+ * @return Bitset of matching IDs
+ */
+QBitArray FileFilterIndex::termMatches(const Term &term) const
+{
+	switch (term.type) {
+		case TermType::Text: {
+			// All words must match.
+			QBitArray bits = m_used;
+			foreach (const QString &word, term.words) {
+				bits &= wordMatches(word, term.prefix, term.fieldMask);
+			}
+			return bits;
+		}
+
+		case TermType::Status:
+			return m_status[term.value];
+
+		case TermType::Lost:
+			return (term.value ? m_lost : (m_used & ~m_lost));
+
+		case TermType::Region:
+			return m_region.value((ushort)term.value, QBitArray(m_used.size()));
+
+		case TermType::Nothing:
+		default:
+			break;
+	}
+
+	return QBitArray(m_used.size());
+}
+
+/**
+ * Evaluate the query.
+ */
+void FileFilterIndex::evaluate(void) const
+{
+	m_result = m_used;
+	foreach (const Term &term, m_terms) {
+		if (term.negate) {
+			m_result &= ~termMatches(term);
+		} else {
+			m_result &= termMatches(term);
+		}
+	}
+	m_resultValid = true;
+}
+
+/**
+ * Does a row match the query?
+ * @param row Row
+ * @return True if the row matches; false if not.
+ */
+bool FileFilterIndex::acceptsRow(int row) const
+{
+	if (m_terms.isEmpty())
+		return true;
+	if (row < 0 || row >= m_rowIds.size())
+		return true;
+
+	if (!m_resultValid) {
+		evaluate();
+	}
+	return m_result.testBit(m_rowIds.at(row));
+}
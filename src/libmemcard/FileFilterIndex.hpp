@@ -0,0 +1,254 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * FileFilterIndex.hpp: Indexed file list filter.                          *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "Checksum.hpp"
+
+// C includes.
+#include <stdint.h>
+
+// Qt includes.
+#include <QtCore/QBitArray>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+/**
+ * Indexed file list filter.
+ *
+ * Words from the game description, file description, filename,
+ * and game ID are kept in an inverted index, and the checksum
+ * status, "lost" flag, and region are kept in bitsets. Queries
+ * are answered by intersecting sets, and the result is cached,
+ * so acceptsRow() is a single bit lookup.
+ *
+ * Query syntax: Terms are separated by spaces, and all terms
+ * must match. Prefix a term with '-' to exclude matching files.
+ * - word: Any text field has a word starting with "word".
+ * - id:GALE01, id:GAL*: Game ID.
+ * - game:word, file:word, desc:word: Game/file/either description.
+ * - name:word: Filename.
+ * - status:good, status:invalid, status:unknown: Checksum status.
+ * - lost:yes, lost:no: "Lost" files.
+ * - region:J, region:usa, region:pal: Region. (4th character of the game ID)
+ * Field values only match whole words unless they end with '*'.
+ * Double quotes can be used to include spaces in a value.
+ */
+class FileFilterIndex
+{
+	public:
+		FileFilterIndex();
+
+	private:
+		Q_DISABLE_COPY(FileFilterIndex)
+
+	public:
+		/**
+		 * Indexed fields for a single file.
+		 */
+		struct Entry {
+			Entry() : status(Checksum::ChkStatus::Unknown), lost(false) { }
+
+			QString gameDesc;
+			QString fileDesc;
+			QString filename;
+			QString gameID;
+			Checksum::ChkStatus status;
+			bool lost;
+		};
+
+		/**
+		 * Insert rows.
+		 * @param row First row
+		 * @param entries Entries for the new rows
+		 */
+		void insertRows(int row, const QVector<Entry> &entries);
+
+		/**
+		 * Remove rows.
+		 * @param row First row
+		 * @param count Number of rows
+		 */
+		void removeRows(int row, int count);
+
+		/**
+		 * Update a row.
+		 * @param row Row
+		 * @param entry New entry
+		 */
+		void updateRow(int row, const Entry &entry);
+
+		/**
+		 * Remove all rows.
+		 */
+		void clear(void);
+
+		/**
+		 * Get the number of rows.
+		 * @return Number of rows
+		 */
+		inline int rowCount(void) const
+		{
+			return m_rowIds.size();
+		}
+
+		/**
+		 * Get the current query.
+		 * @return Query
+		 */
+		inline QString query(void) const
+		{
+			return m_query;
+		}
+
+		/**
+		 * Set the query.
+		 * @param query Query
+		 */
+		void setQuery(const QString &query);
+
+		/**
+		 * Is the query empty?
+		 * @return True if the query is empty (all rows are accepted).
+		 */
+		inline bool isQueryEmpty(void) const
+		{
+			return m_terms.isEmpty();
+		}
+
+		/**
+		 * Does a row match the query?
+		 * @param row Row
+		 * @return True if the row matches; false if not.
+		 */
+		bool acceptsRow(int row) const;
+
+	private:
+		// Indexed text fields.
+		enum Field : uint8_t {
+			FIELD_GAMEDESC,
+			FIELD_FILEDESC,
+			FIELD_FILENAME,
+			FIELD_GAMEID,
+
+			FIELD_TEXT_MAX
+		};
+
+		/**
+		 * Split a string into case-folded words.
+		 * @param str String
+		 * @return Words
+		 */
+		static QStringList tokenize(const QString &str);
+
+		/** Index **/
+
+		// Row to ID mapping.
+		// IDs are stable when rows are inserted or removed.
+		QVector<quint32> m_rowIds;
+		// Unused IDs.
+		QVector<quint32> m_freeIds;
+
+		// Words for each ID, per field.
+		// Needed to remove an ID from the inverted index.
+		QVector<QStringList> m_words[FIELD_TEXT_MAX];
+
+		// Inverted index: Word -> IDs, per field.
+		// QMap is used for prefix lookups.
+		QMap<QString, QSet<quint32> > m_index[FIELD_TEXT_MAX];
+
+		// Bitsets, indexed by ID.
+		QBitArray m_used;	// ID is in use.
+		QBitArray m_status[3];	// Checksum::ChkStatus
+		QBitArray m_lost;	// "Lost" file.
+		QHash<ushort, QBitArray> m_region;	// Region code (uppercase)
+		QVector<ushort> m_regionOf;	// Region code for each ID.
+
+		/**
+		 * Resize all bitsets.
+		 * @param size New size
+		 */
+		void resizeBitsets(int size);
+
+		/**
+		 * Allocate an ID.
+		 * @return ID
+		 */
+		quint32 allocId(void);
+
+		/**
+		 * Add an entry to the index.
+		 * @param id ID
+		 * @param entry Entry
+		 */
+		void addToIndex(quint32 id, const Entry &entry);
+
+		/**
+		 * Remove an ID from the index.
+		 * @param id ID
+		 */
+		void removeFromIndex(quint32 id);
+
+		/** Query **/
+
+		enum class TermType : uint8_t {
+			Text,		// Text fields (see fieldMask)
+			Status,		// Checksum status
+			Lost,		// "Lost" file
+			Region,		// Region
+			Nothing,	// Invalid value; matches nothing.
+		};
+
+		struct Term {
+			TermType type;
+			bool negate;
+			bool prefix;		// Words are prefixes.
+			uint8_t fieldMask;	// (1 << Field)
+			QStringList words;	// Text
+			int value;		// Status, Lost, Region
+		};
+
+		QString m_query;
+		QVector<Term> m_terms;
+
+		// Cached query result, indexed by ID.
+		mutable QBitArray m_result;
+		mutable bool m_resultValid;
+
+		/**
+		 * Parse a query.
+		 * @param query Query
+		 * @return Terms
+		 */
+		static QVector<Term> parseQuery(const QString &query);
+
+		/**
+		 * Get the IDs that match a term.
+		 * @param term Term
+		 * @return Bitset of matching IDs
+		 */
+		QBitArray termMatches(const Term &term) const;
+
+		/**
+		 * Get the IDs that have a word in the specified fields.
+		 * @param word Word
+		 * @param prefix If true, match words starting with this word.
+		 * @param fieldMask Fields to check (1 << Field)
+		 * @return Bitset of matching IDs
+		 */
+		QBitArray wordMatches(const QString &word, bool prefix, uint8_t fieldMask) const;
+
+		/**
+		 * Evaluate the query.
+		 */
+		void evaluate(void) const;
+};
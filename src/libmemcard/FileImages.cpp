@@ -0,0 +1,171 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * FileImages.cpp: Copy of a file's banner and icon images.                *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "FileImages.hpp"
+
+#include "card.h"
+#include "GcImage.hpp"
+
+// C includes (C++ namespace)
+#include <cerrno>
+
+// C++ includes
+#include <vector>
+using std::vector;
+
+FileImages::FileImages()
+	: m_banner(nullptr)
+	, m_iconAnimMode(0)
+{ }
+
+FileImages::~FileImages()
+{
+	delete m_banner;
+	clearIcons();
+}
+
+/**
+ * Delete the icon images.
+ */
+void FileImages::clearIcons(void)
+{
+	for (const GcImage *gcImage : m_icons) {
+		delete gcImage;
+	}
+	m_icons.clear();
+	m_iconDelays.clear();
+}
+
+/**
+ * Set the banner image.
+ * @param gcBanner Banner image (copied) (may be nullptr)
+ */
+void FileImages::setBanner(const GcImage *gcBanner)
+{
+	delete m_banner;
+	m_banner = (gcBanner ? new GcImage(*gcBanner) : nullptr);
+}
+
+/**
+ * Set the icon images.
+ * @param gcIcons Icon images (copied) (may contain nullptr)
+ * @param iconDelays Icon delays
+ * @param iconAnimMode Icon animation mode
+ */
+void FileImages::setIcons(const vector<const GcImage*> &gcIcons,
+			  const vector<int> &iconDelays, int iconAnimMode)
+{
+	clearIcons();
+	m_icons.reserve(gcIcons.size());
+	for (const GcImage *gcImage : gcIcons) {
+		m_icons.push_back(gcImage ? new GcImage(*gcImage) : nullptr);
+	}
+	m_iconDelays = iconDelays;
+	m_iconAnimMode = iconAnimMode;
+}
+
+/**
+ * Encode the banner image.
+ * @param gcImageWriter GcImageWriter
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FileImages::encodeBanner(GcImageWriter *gcImageWriter) const
+{
+	if (!m_banner)
+		return -EINVAL;
+	return gcImageWriter->write(m_banner, GcImageWriter::ImageFormat::PNG);
+}
+
+/**
+ * Encode the icon.
+ * @param gcImageWriter GcImageWriter
+ * @param animImgf Animated image format for animated icons
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FileImages::encodeIcon(GcImageWriter *gcImageWriter,
+	GcImageWriter::AnimImageFormat animImgf) const
+{
+	return encodeIcon(gcImageWriter, m_icons, m_iconDelays, m_iconAnimMode, animImgf);
+}
+
+/**
+ * Get the file extension for the icon.
+ * @param animImgf Animated image format for animated icons
+ * @return File extension, without the leading dot. (May be nullptr.)
+ */
+const char *FileImages::iconExt(GcImageWriter::AnimImageFormat animImgf) const
+{
+	return iconExt((int)m_icons.size(), animImgf);
+}
+
+/**
+ * Encode an icon.
+ * This handles bounce animations.
+ * @param gcImageWriter GcImageWriter
+ * @param gcIcons Icon images
+ * @param iconDelays Icon delays
+ * @param iconAnimMode Icon animation mode (GCN value)
+ * @param animImgf Animated image format for animated icons
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FileImages::encodeIcon(GcImageWriter *gcImageWriter,
+	const vector<const GcImage*> &gcIcons,
+	const vector<int> &iconDelays, int iconAnimMode,
+	GcImageWriter::AnimImageFormat animImgf)
+{
+	if (gcIcons.empty())
+		return -EINVAL;
+
+	if (gcIcons.size() == 1) {
+		// Static icon.
+		return gcImageWriter->write(gcIcons.at(0), GcImageWriter::ImageFormat::PNG);
+	}
+
+	// Animated icon.
+	vector<const GcImage*> gcImages;
+	const int maxIcons = ((int)gcIcons.size() * 2 - 2);
+	gcImages.reserve(maxIcons);
+	gcImages = gcIcons;
+
+	// Icon speed.
+	vector<int> gcIconDelays;
+	gcIconDelays.reserve(maxIcons);
+	gcIconDelays = iconDelays;
+	gcIconDelays.resize(gcIcons.size());
+
+	if (iconAnimMode == CARD_ANIM_BOUNCE) {
+		// BOUNCE animation.
+		int src = ((int)gcImages.size() - 2);
+		int dest = (int)gcImages.size();
+		gcImages.resize(maxIcons);
+		gcIconDelays.resize(maxIcons);
+		for (; src >= 1; src--, dest++) {
+			gcImages[dest] = gcImages[src];
+			gcIconDelays[dest] = gcIconDelays[src];
+		}
+	}
+
+	return gcImageWriter->write(&gcImages, &gcIconDelays, animImgf);
+}
+
+/**
+ * Get the file extension for an icon.
+ * @param iconCount Number of icon images
+ * @param animImgf Animated image format for animated icons
+ * @return File extension, without the leading dot. (May be nullptr.)
+ */
+const char *FileImages::iconExt(int iconCount, GcImageWriter::AnimImageFormat animImgf)
+{
+	if (iconCount > 1) {
+		// Animated icon.
+		return GcImageWriter::extForAnimImageFormat(animImgf);
+	}
+
+	// Static icon.
+	return GcImageWriter::extForImageFormat(GcImageWriter::ImageFormat::PNG);
+}
@@ -0,0 +1,128 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * FileImages.hpp: Copy of a file's banner and icon images.                *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "GcImageWriter.hpp"
+
+// C++ includes
+#include <vector>
+
+// for Q_DISABLE_COPY()
+#include <QtCore/qglobal.h>
+
+class GcImage;
+
+/**
+ * Copy of a file's banner and icon images.
+ *
+ * This is used to encode a file's images on a worker thread.
+ * File loads its images from the Card, which is not thread-safe,
+ * so the images are copied on the Card's thread first.
+ */
+class FileImages
+{
+	public:
+		FileImages();
+		~FileImages();
+
+	private:
+		Q_DISABLE_COPY(FileImages)
+
+	public:
+		/**
+		 * Set the banner image.
+		 * @param gcBanner Banner image (copied) (may be nullptr)
+		 */
+		void setBanner(const GcImage *gcBanner);
+
+		/**
+		 * Set the icon images.
+		 * @param gcIcons Icon images (copied) (may contain nullptr)
+		 * @param iconDelays Icon delays
+		 * @param iconAnimMode Icon animation mode
+		 */
+		void setIcons(const std::vector<const GcImage*> &gcIcons,
+			      const std::vector<int> &iconDelays, int iconAnimMode);
+
+		/**
+		 * Does this object have a banner image?
+		 * @return True if it does; false if not.
+		 */
+		inline bool hasBanner(void) const
+		{
+			return (m_banner != nullptr);
+		}
+
+		/**
+		 * Get the number of icon images.
+		 * @return Number of icon images
+		 */
+		inline int iconCount(void) const
+		{
+			return (int)m_icons.size();
+		}
+
+		/**
+		 * Encode the banner image.
+		 * @param gcImageWriter GcImageWriter
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int encodeBanner(GcImageWriter *gcImageWriter) const;
+
+		/**
+		 * Encode the icon.
+		 * @param gcImageWriter GcImageWriter
+		 * @param animImgf Animated image format for animated icons
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int encodeIcon(GcImageWriter *gcImageWriter,
+			       GcImageWriter::AnimImageFormat animImgf) const;
+
+		/**
+		 * Get the file extension for the icon.
+		 * @param animImgf Animated image format for animated icons
+		 * @return File extension, without the leading dot. (May be nullptr.)
+		 */
+		const char *iconExt(GcImageWriter::AnimImageFormat animImgf) const;
+
+	public:
+		/**
+		 * Encode an icon.
+		 * This handles bounce animations.
+		 * @param gcImageWriter GcImageWriter
+		 * @param gcIcons Icon images
+		 * @param iconDelays Icon delays
+		 * @param iconAnimMode Icon animation mode (GCN value)
+		 * @param animImgf Animated image format for animated icons
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int encodeIcon(GcImageWriter *gcImageWriter,
+				      const std::vector<const GcImage*> &gcIcons,
+				      const std::vector<int> &iconDelays, int iconAnimMode,
+				      GcImageWriter::AnimImageFormat animImgf);
+
+		/**
+		 * Get the file extension for an icon.
+		 * @param iconCount Number of icon images
+		 * @param animImgf Animated image format for animated icons
+		 * @return File extension, without the leading dot. (May be nullptr.)
+		 */
+		static const char *iconExt(int iconCount, GcImageWriter::AnimImageFormat animImgf);
+
+	private:
+		GcImage *m_banner;
+		std::vector<const GcImage*> m_icons;	// Owned
+		std::vector<int> m_iconDelays;
+		int m_iconAnimMode;
+
+		/**
+		 * Delete the icon images.
+		 */
+		void clearIcons(void);
+};
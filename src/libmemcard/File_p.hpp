@@ -20,6 +20,9 @@ class GcImage;
 // C++ includes
 #include <vector>
 
+// Qt includes
+#include <QtCore/QMutex>
+
 class FilePrivate
 {
 public:
@@ -54,16 +57,27 @@ public:
 	// Size is calculated using fatEntries.size().
 
 	// GcImages. (internal use only)
+	// NOTE: Loaded on demand by ensureGcImagesLoaded(),
+	// which may be called from any thread.
 	GcImage *gcBanner;
 	QVector<GcImage*> gcIcons;
 	// FIXME: Use system-independent values.
 	// Currently uses GCN values.
 	QVector<uint8_t> iconSpeed;
 	uint8_t iconAnimMode;
+	bool gcImagesLoaded;
+
+	// Protects the GcImages and icon animation
+	// information while they're being loaded.
+	mutable QMutex gcImageMutex;
 
 	// QPixmap images
+	// NOTE: Images are loaded on demand, and may be
+	// unloaded later by File::unloadImages().
+	// QPixmaps can only be used on the GUI thread.
 	QPixmap banner;
 	QVector<QPixmap> icons;
+	bool imagesLoaded;
 
 	// Lost File information
 	bool lostFile;
@@ -116,9 +130,45 @@ public:
 
 	/**
 	 * Load the banner and icon images.
+	 * Any previously-loaded images are replaced.
+	 * NOTE: GUI thread only.
 	 */
 	void loadImages(void);
 
+	/**
+	 * Load the banner and icon images if they aren't loaded.
+	 * NOTE: Called by const accessors, so the images are mutable.
+	 * NOTE: GUI thread only.
+	 */
+	inline void ensureImagesLoaded(void) const
+	{
+		if (!imagesLoaded) {
+			const_cast<FilePrivate*>(this)->loadImages();
+		}
+	}
+
+	/**
+	 * Load the GcImages if they aren't loaded.
+	 * This doesn't create any QPixmaps, so it can be called
+	 * from any thread. Card reads are serialized by the card's
+	 * I/O lock, so this is safe during a search.
+	 *
+	 * Once loaded, the GcImages aren't modified until
+	 * unloadImages() is called on the GUI thread.
+	 */
+	void ensureGcImagesLoaded(void) const;
+
+	/**
+	 * Load the GcImages if they aren't loaded. [INTERNAL FUNCTION]
+	 * gcImageMutex must be locked by the caller.
+	 */
+	void ensureGcImagesLoaded_int(void) const;
+
+	/**
+	 * Unload the banner and icon images.
+	 */
+	void unloadImages(void);
+
 	/**
 	 * Load the banner image.
 	 * @return GcImage containing the banner image, or nullptr on error.
@@ -0,0 +1,403 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * GciDirectoryCard.cpp: GameCube GCI directory class.                     *
+ *                                                                         *
+ * This is a wrapper class that maps a directory of .gci files into a      *
+ * single read-only virtual card. Scanning for lost files is not           *
+ * supported.                                                              *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "GciDirectoryCard.hpp"
+#include "util/byteswap.h"
+#include "card.h"
+
+// GcnFile
+#include "GcnFile.hpp"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <limits>
+#include <vector>
+using std::vector;
+
+// Qt includes.
+#include <QtCore/QDir>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+/** GciDirectoryCardPrivate **/
+
+#include "Card_p.hpp"
+class GciDirectoryCardPrivate : public CardPrivate
+{
+	typedef CardPrivate super;
+
+public:
+	explicit GciDirectoryCardPrivate(GciDirectoryCard *q);
+
+protected:
+	Q_DECLARE_PUBLIC(GciDirectoryCard)
+private:
+	Q_DISABLE_COPY(GciDirectoryCardPrivate)
+
+public:
+	// GCI block size and header size.
+	static const uint32_t GCI_BLOCK_SIZE = 8192;
+	static const uint32_t GCI_HEADER_SIZE = 64;
+
+	// GCI file entry.
+	struct GciEntry {
+		QString filename;
+		card_direntry dirEntry;	// host-endian
+		quint64 filesize;
+		uint16_t firstBlock;	// first virtual block
+		uint16_t blockCount;
+		bool valid;
+	};
+
+	/**
+	 * GCI file entries, sorted by virtual block.
+	 * NOTE: GcnFile keeps a pointer to each dirEntry,
+	 * so this must not be resized after the files are created.
+	 */
+	vector<GciEntry> entries;
+
+	// Index of the GCI file currently opened in CardPrivate::file.
+	int curEntry;
+
+	/**
+	 * Worker for reading GCI headers in parallel.
+	 */
+	class HeaderReader : public QRunnable
+	{
+		public:
+			HeaderReader(GciEntry *entries, int count)
+				: entries(entries)
+				, count(count) { }
+
+			void run(void) final;
+
+		private:
+			GciEntry *const entries;
+			const int count;
+	};
+
+public:
+	/**
+	 * Open a directory of GCI files.
+	 * @param dirname Directory name
+	 * @return 0 on success; non-zero on error. (also check errorString)
+	 */
+	int open(const QString &dirname);
+
+	/**
+	 * Read a block directly from the card image, bypassing the cache.
+	 * Virtual blocks are mapped to the GCI file that contains them.
+	 * @param buf Buffer to read the block data into. (Must be >= blockSize.)
+	 * @param blockIdx Block index.
+	 * @return Bytes read on success; negative POSIX error code on error.
+	 */
+	int readBlockDirect(void *buf, uint16_t blockIdx) final;
+
+	/**
+	 * Read contiguous blocks directly from the card image, bypassing the cache.
+	 * Blocks may be in different GCI files, so they're read one at a time.
+	 * @param buf Buffer to read the block data into. (Must be >= count*blockSize.)
+	 * @param blockIdx First block index.
+	 * @param count Number of blocks.
+	 * @return Bytes read on success; negative POSIX error code on error.
+	 */
+	int readBlocksDirect(void *buf, uint16_t blockIdx, int count) final;
+};
+
+GciDirectoryCardPrivate::GciDirectoryCardPrivate(GciDirectoryCard *q)
+	: super(q,
+		GCI_BLOCK_SIZE,	// 8 KB blocks.
+		1,	// Minimum card size, in blocks.
+		std::numeric_limits<uint16_t>::max(),	// Maximum card size, in blocks.
+		1,	// Number of directory tables.
+		1,	// Number of block tables.
+		GCI_HEADER_SIZE)	// Header size. (offset to actual data area)
+	, curEntry(-1)
+{
+	// GCI files are *not* writable.
+	canMakeWritable = false;
+}
+
+/**
+ * Read the GCI headers.
+ * Each worker handles its own range of entries,
+ * so no locking is needed.
+ */
+void GciDirectoryCardPrivate::HeaderReader::run(void)
+{
+	for (int i = 0; i < count; i++) {
+		GciEntry *const entry = &entries[i];
+		entry->valid = false;
+
+		QFile gciFile(entry->filename);
+		if (!gciFile.open(QIODevice::ReadOnly))
+			continue;
+
+		entry->filesize = gciFile.size();
+		if (entry->filesize < GCI_HEADER_SIZE + GCI_BLOCK_SIZE) {
+			// Too small to be a GCI file.
+			continue;
+		}
+
+		qint64 sz = gciFile.read((char*)&entry->dirEntry, sizeof(entry->dirEntry));
+		if (sz != (qint64)sizeof(entry->dirEntry))
+			continue;
+
+#if SYS_BYTEORDER != SYS_BIG_ENDIAN
+		// Byteswap the directory entry.
+		card_direntry *const dirEntry = &entry->dirEntry;
+		dirEntry->lastmodified	= be32_to_cpu(dirEntry->lastmodified);
+		dirEntry->iconaddr	= be32_to_cpu(dirEntry->iconaddr);
+		dirEntry->iconfmt	= be16_to_cpu(dirEntry->iconfmt);
+		dirEntry->iconspeed	= be16_to_cpu(dirEntry->iconspeed);
+		dirEntry->block		= be16_to_cpu(dirEntry->block);
+		dirEntry->length	= be16_to_cpu(dirEntry->length);
+		dirEntry->commentaddr	= be32_to_cpu(dirEntry->commentaddr);
+#endif /* SYS_BYTEORDER != SYS_BIG_ENDIAN */
+
+		// Don't trust the length field past the end of the file.
+		const quint64 blocks = (entry->filesize - GCI_HEADER_SIZE) / GCI_BLOCK_SIZE;
+		if (entry->dirEntry.length == 0 || entry->dirEntry.length > blocks)
+			continue;
+
+		entry->blockCount = entry->dirEntry.length;
+		entry->valid = true;
+	}
+}
+
+/**
+ * Open a directory of GCI files.
+ * @param dirname Directory name
+ * @return 0 on success; non-zero on error. (also check errorString)
+ */
+int GciDirectoryCardPrivate::open(const QString &dirname)
+{
+	QDir dir(dirname);
+	if (!dir.exists()) {
+		// TODO: Translate the error message.
+		this->errorString = QLatin1String("Directory does not exist");
+		return -ENOENT;
+	}
+
+	// Find all GCI files.
+	// NOTE: Name filters are case-insensitive by default.
+	const QStringList gciFilenames = dir.entryList(
+		QStringList(QLatin1String("*.gci")),
+		QDir::Files | QDir::Readable, QDir::Name);
+
+	// Read the headers in parallel.
+	// NOTE: Using a local thread pool so we don't wait on
+	// other tasks that might be using the global instance.
+	entries.resize(gciFilenames.size());
+	for (int i = 0; i < gciFilenames.size(); i++) {
+		entries[i].filename = dir.filePath(gciFilenames.at(i));
+		entries[i].valid = false;
+	}
+	if (!entries.empty()) {
+		QThreadPool pool;
+		const int threads = std::max(1, QThread::idealThreadCount());
+		const int perThread = ((int)entries.size() + threads - 1) / threads;
+		for (int i = 0; i < (int)entries.size(); i += perThread) {
+			const int count = std::min(perThread, (int)entries.size() - i);
+			pool.start(new HeaderReader(&entries[i], count));
+		}
+		pool.waitForDone();
+	}
+
+	// Remove invalid entries and assign virtual blocks.
+	entries.erase(std::remove_if(entries.begin(), entries.end(),
+		[](const GciEntry &entry) { return !entry.valid; }), entries.end());
+	uint32_t nextBlock = 0;
+	for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
+		if (nextBlock + iter->blockCount > std::numeric_limits<uint16_t>::max()) {
+			// Out of virtual blocks.
+			this->errors |= Card::MCE_SZ_TOO_BIG;
+			entries.erase(iter, entries.end());
+			break;
+		}
+		iter->firstBlock = (uint16_t)nextBlock;
+		iter->dirEntry.block = (uint16_t)nextBlock;
+		nextBlock += iter->blockCount;
+	}
+
+	if (entries.empty()) {
+		// TODO: Translate the error message.
+		this->errorString = QLatin1String("No GCI files were found");
+		return -ENOENT;
+	}
+
+	// Open the first GCI file.
+	// CardPrivate::file always refers to the most recently read GCI file.
+	Q_Q(GciDirectoryCard);
+	std::unique_ptr<QFile> tmp_file(new QFile(entries[0].filename));
+	if (!tmp_file->open(QIODevice::ReadOnly)) {
+		// TODO: Translate the error message.
+		this->errorString = tmp_file->errorString();
+		entries.clear();
+		return -EIO;
+	}
+	this->file = std::move(tmp_file);
+	this->curEntry = 0;
+	this->filename = dirname;
+	this->readOnly = true;
+
+	// Fake block count.
+	this->filesize = 0;
+	for (const GciEntry &entry : entries) {
+		this->filesize += entry.filesize;
+	}
+	totalPhysBlocks = (int)nextBlock;
+	totalUserBlocks = totalPhysBlocks;
+	freeBlocks = 0;
+
+	// Block and directory tables are "valid".
+	bat_info.active = 0;
+	dat_info.active = 0;
+	bat_info.valid = 1;
+	dat_info.valid = 1;
+	bat_info.valid_freeblocks = 1;
+	dat_info.valid_freeblocks = 1;
+
+	// GcnFile determines the encoding from each file's region byte.
+	this->encoding = Card::Encoding::CP1252;
+
+	// Add the directory entries to the file list.
+	// NOTE: Only the comment block is read here. The banner
+	// and icons are loaded on first use, and everything else
+	// is read on demand.
+	QVector<File*> lstFiles_new;
+	lstFiles_new.reserve((int)entries.size());
+	for (const GciEntry &entry : entries) {
+		lstFiles_new.append(new GcnFile(q, &entry.dirEntry, std::vector<uint16_t>()));
+	}
+
+	emit q->filesAboutToBeInserted(0, (lstFiles_new.size() - 1));
+	lstFiles = lstFiles_new;
+	emit q->filesInserted();
+
+	// Block count has changed.
+	emit q->blockCountChanged(totalPhysBlocks, totalUserBlocks, freeBlocks);
+	return 0;
+}
+
+/**
+ * Read a block directly from the card image, bypassing the cache.
+ * Virtual blocks are mapped to the GCI file that contains them.
+ * @param buf Buffer to read the block data into. (Must be >= blockSize.)
+ * @param blockIdx Block index.
+ * @return Bytes read on success; negative POSIX error code on error.
+ */
+int GciDirectoryCardPrivate::readBlockDirect(void *buf, uint16_t blockIdx)
+{
+	// Find the GCI file containing this block.
+	auto iter = std::upper_bound(entries.cbegin(), entries.cend(), blockIdx,
+		[](uint16_t block, const GciEntry &entry) { return block < entry.firstBlock; });
+	if (iter == entries.cbegin())
+		return -EINVAL;
+	--iter;
+	if (blockIdx >= iter->firstBlock + iter->blockCount)
+		return -EINVAL;
+
+	const int idx = (int)(iter - entries.cbegin());
+	if (idx != curEntry) {
+		// Switch to the other GCI file.
+		// NOTE: This may be called from a worker thread,
+		// so the QFile must not be parented to the card.
+		std::unique_ptr<QFile> tmp_file(new QFile(iter->filename));
+		if (!tmp_file->open(QIODevice::ReadOnly)) {
+			return -EIO;
+		}
+		file->close();
+		file = std::move(tmp_file);
+		curEntry = idx;
+	}
+
+	const qint64 pos = ((qint64)(blockIdx - iter->firstBlock) * blockSize) + headerSize;
+	if (!file->seek(pos))
+		return -EIO;	// TODO: Proper error code?
+	int ret = (int)file->read((char*)buf, blockSize);
+	return (ret >= 0 ? ret : -EIO);
+}
+
+/**
+ * Read contiguous blocks directly from the card image, bypassing the cache.
+ * Blocks may be in different GCI files, so they're read one at a time.
+ * @param buf Buffer to read the block data into. (Must be >= count*blockSize.)
+ * @param blockIdx First block index.
+ * @param count Number of blocks.
+ * @return Bytes read on success; negative POSIX error code on error.
+ */
+int GciDirectoryCardPrivate::readBlocksDirect(void *buf, uint16_t blockIdx, int count)
+{
+	uint8_t *p = static_cast<uint8_t*>(buf);
+	int total = 0;
+	for (int i = 0; i < count; i++, p += blockSize) {
+		int ret = readBlockDirect(p, (uint16_t)(blockIdx + i));
+		if (ret < 0) {
+			// Error reading the block.
+			// Return what we have so far, if anything.
+			return (total > 0 ? total : ret);
+		}
+		total += ret;
+		if (ret != (int)blockSize)
+			break;
+	}
+	return total;
+}
+
+/** GciDirectoryCard **/
+
+GciDirectoryCard::GciDirectoryCard(QObject *parent)
+	: super(new GciDirectoryCardPrivate(this), parent)
+{}
+
+/**
+ * Open a directory of GCI files.
+ *
+ * Each GCI file is mapped to a contiguous range of
+ * virtual blocks. Since block indexes are 16-bit,
+ * GCI files past the 65,535th block are skipped,
+ * and MCE_SZ_TOO_BIG is set.
+ *
+ * All GCI headers are read when the directory is opened,
+ * since the virtual block layout and the file list depend
+ * on them. Save data is only read on demand.
+ *
+ * @param dirname Directory name
+ * @param parent Parent object
+ * @return GciDirectoryCard object. (Always non-null; check isOpen() and errorString() on error.)
+ */
+GciDirectoryCard *GciDirectoryCard::open(const QString& dirname, QObject *parent)
+{
+	GciDirectoryCard *const gciDir = new GciDirectoryCard(parent);
+	GciDirectoryCardPrivate *const d = gciDir->d_func();
+	d->open(dirname);
+	return gciDir;
+}
+
+/** Card information **/
+
+/**
+ * Get the product name of this memory card.
+ * This refers to the class in general,
+ * and does not change based on size.
+ * @return Product name
+ */
+QString GciDirectoryCard::productName(void) const
+{
+	return tr("GameCube save file directory");
+}
@@ -0,0 +1,85 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * GciDirectoryCard.hpp: GameCube GCI directory class.                     *
+ *                                                                         *
+ * This is a wrapper class that maps a directory of .gci files into a      *
+ * single read-only virtual card. Scanning for lost files is not           *
+ * supported.                                                              *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "Card.hpp"
+
+class GciDirectoryCardPrivate;
+class GciDirectoryCard : public Card
+{
+	Q_OBJECT
+	typedef Card super;
+
+protected:
+	explicit GciDirectoryCard(QObject *parent = 0);
+
+protected:
+	Q_DECLARE_PRIVATE(GciDirectoryCard)
+private:
+	Q_DISABLE_COPY(GciDirectoryCard)
+
+public:
+	/**
+	 * Open a directory of GCI files.
+	 *
+	 * Each GCI file is mapped to a contiguous range of
+	 * virtual blocks. Since block indexes are 16-bit,
+	 * GCI files past the 65,535th block are skipped,
+	 * and MCE_SZ_TOO_BIG is set.
+	 *
+	 * All GCI headers are read when the directory is opened,
+	 * since the virtual block layout and the file list depend
+	 * on them. Save data is only read on demand.
+	 *
+	 * @param dirname Directory name
+	 * @param parent Parent object
+	 * @return GciDirectoryCard object. (Always non-null; check isOpen() and errorString() on error.)
+	 */
+	static GciDirectoryCard *open(const QString& dirname, QObject *parent);
+
+public:
+	/** File system **/
+
+	/**
+	 * Set the active Directory Table index.
+	 * NOTE: This function reloads the file list, without lost files.
+	 * @param idx Active Directory Table index
+	 */
+	void setActiveDatIdx(int idx) final
+	{
+		// GCI doesn't have a directory table.
+		Q_UNUSED(idx)
+	}
+
+	/**
+	 * Set the active Block Table index.
+	 * NOTE: This function reloads the file list, without lost files.
+	 * @param idx Active Block Table index
+	 */
+	void setActiveBatIdx(int idx) final
+	{
+		// GCI doesn't have a block table.
+		Q_UNUSED(idx)
+	}
+
+public:
+	/** Card information **/
+
+	/**
+	 * Get the product name of this memory card.
+	 * This refers to the class in general,
+	 * and does not change based on size.
+	 * @return Product name
+	 */
+	QString productName(void) const final;
+};
@@ -117,6 +117,20 @@ class GcnCardPrivate : public CardPrivate
 		 */
 		int loadBlockTable(card_bat *bat, uint32_t address, uint32_t *checksum);
 
+		/**
+		 * Byteswap a directory table between big-endian and host-endian.
+		 * This is a no-op on big-endian systems.
+		 * @param dat card_dat to byteswap.
+		 */
+		static void byteswapDirTable(card_dat *dat);
+
+		/**
+		 * Byteswap a block allocation table between big-endian and host-endian.
+		 * This is a no-op on big-endian systems.
+		 * @param bat card_bat to byteswap.
+		 */
+		static void byteswapBlockTable(card_bat *bat);
+
 		/**
 		 * Determine which tables are active.
 		 * Sets mc_dat_hdr_idx and mc_bat_hdr_idx.
@@ -129,6 +143,22 @@ class GcnCardPrivate : public CardPrivate
 		 * Load the GcnFile list.
 		 */
 		void loadGcnFileList(void);
+
+	public:
+		/**
+		 * Update the file system metadata after the dirty blocks
+		 * have been flushed by Card::commit().
+		 *
+		 * The active directory and block tables are copied to the
+		 * inactive slots with an incremented update counter and new
+		 * checksums, then the new tables are made active. If the
+		 * commit is interrupted, the previous tables remain valid.
+		 * NOTE: This only protects the tables. The file data was
+		 * already written in place by Card::commit().
+		 *
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int commitMetadata(void) final;
 };
 
 GcnCardPrivate::GcnCardPrivate(GcnCard *q)
@@ -578,25 +608,8 @@ int GcnCardPrivate::loadDirTable(card_dat *dat, uint32_t address, uint32_t *chec
 			Checksum::ChkEndian::Big);
 	}
 
-#if SYS_BYTEORDER != SYS_BIG_ENDIAN
-	// Byteswap the directory table contents.
-	for (int i = 0; i < NUM_ELEMENTS(dat->entries); i++) {
-		card_direntry *dirEntry	= &dat->entries[i];
-		dirEntry->lastmodified	= be32_to_cpu(dirEntry->lastmodified);
-		dirEntry->iconaddr	= be32_to_cpu(dirEntry->iconaddr);
-		dirEntry->iconfmt	= be16_to_cpu(dirEntry->iconfmt);
-		dirEntry->iconspeed	= be16_to_cpu(dirEntry->iconspeed);
-		dirEntry->block		= be16_to_cpu(dirEntry->block);
-		dirEntry->length	= be16_to_cpu(dirEntry->length);
-		dirEntry->commentaddr	= be32_to_cpu(dirEntry->commentaddr);
-	}
-
-	// Byteswap the directory control block.
-	dat->dircntrl.updated = be16_to_cpu(dat->dircntrl.updated);
-	dat->dircntrl.chksum1 = be16_to_cpu(dat->dircntrl.chksum1);
-	dat->dircntrl.chksum2 = be16_to_cpu(dat->dircntrl.chksum2);
-#endif /* SYS_BYTEORDER != SYS_BIG_ENDIAN */
-
+	// Byteswap the directory table.
+	byteswapDirTable(dat);
 	return 0;
 }
 
@@ -625,6 +638,47 @@ int GcnCardPrivate::loadBlockTable(card_bat *bat, uint32_t address, uint32_t *ch
 			Checksum::ChkEndian::Big);
 	}
 
+	// Byteswap the block allocation table.
+	byteswapBlockTable(bat);
+	return 0;
+}
+
+/**
+ * Byteswap a directory table between big-endian and host-endian.
+ * This is a no-op on big-endian systems.
+ * @param dat card_dat to byteswap.
+ */
+void GcnCardPrivate::byteswapDirTable(card_dat *dat)
+{
+#if SYS_BYTEORDER != SYS_BIG_ENDIAN
+	// Byteswap the directory table contents.
+	for (int i = 0; i < NUM_ELEMENTS(dat->entries); i++) {
+		card_direntry *dirEntry	= &dat->entries[i];
+		dirEntry->lastmodified	= be32_to_cpu(dirEntry->lastmodified);
+		dirEntry->iconaddr	= be32_to_cpu(dirEntry->iconaddr);
+		dirEntry->iconfmt	= be16_to_cpu(dirEntry->iconfmt);
+		dirEntry->iconspeed	= be16_to_cpu(dirEntry->iconspeed);
+		dirEntry->block		= be16_to_cpu(dirEntry->block);
+		dirEntry->length	= be16_to_cpu(dirEntry->length);
+		dirEntry->commentaddr	= be32_to_cpu(dirEntry->commentaddr);
+	}
+
+	// Byteswap the directory control block.
+	dat->dircntrl.updated = be16_to_cpu(dat->dircntrl.updated);
+	dat->dircntrl.chksum1 = be16_to_cpu(dat->dircntrl.chksum1);
+	dat->dircntrl.chksum2 = be16_to_cpu(dat->dircntrl.chksum2);
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+	Q_UNUSED(dat)
+#endif /* SYS_BYTEORDER != SYS_BIG_ENDIAN */
+}
+
+/**
+ * Byteswap a block allocation table between big-endian and host-endian.
+ * This is a no-op on big-endian systems.
+ * @param bat card_bat to byteswap.
+ */
+void GcnCardPrivate::byteswapBlockTable(card_bat *bat)
+{
 #if SYS_BYTEORDER != SYS_BIG_ENDIAN
 	// Byteswap the block allocation table contents.
 	bat->chksum1	= be16_to_cpu(bat->chksum1);
@@ -636,9 +690,9 @@ int GcnCardPrivate::loadBlockTable(card_bat *bat, uint32_t address, uint32_t *ch
 	for (int i = 0; i < NUM_ELEMENTS(bat->fat); i++) {
 		bat->fat[i] = be16_to_cpu(bat->fat[i]);
 	}
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+	Q_UNUSED(bat)
 #endif /* SYS_BYTEORDER != SYS_BIG_ENDIAN */
-
-	return 0;
 }
 
 /**
@@ -804,6 +858,99 @@ void GcnCardPrivate::loadGcnFileList(void)
 	emit q->blockCountChanged(totalPhysBlocks, totalUserBlocks, freeBlocks);
 }
 
+/**
+ * Update the file system metadata after the dirty blocks
+ * have been flushed by Card::commit().
+ *
+ * The active directory and block tables are copied to the
+ * inactive slots with an incremented update counter and new
+ * checksums, then the new tables are made active. If the
+ * commit is interrupted, the previous tables remain valid.
+ * NOTE: This only protects the tables. The file data was
+ * already written in place by Card::commit().
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GcnCardPrivate::commitMetadata(void)
+{
+	if (dat_info.active < 0 || bat_info.active < 0) {
+		// The tables are damaged. Don't touch them.
+		return 0;
+	}
+
+	// NOTE: GcnFile objects point to directory entries in the
+	// current table. That table isn't modified here, and its
+	// contents are identical to the new table, so the pointers
+	// remain valid.
+	const int oldDatIdx = dat_info.active;
+	const int oldBatIdx = bat_info.active;
+	const int newDatIdx = !oldDatIdx;
+	const int newBatIdx = !oldBatIdx;
+
+	// Directory table.
+	card_dat *const dat = &mc_dat_int[newDatIdx];
+	memcpy(dat, &mc_dat_int[oldDatIdx], sizeof(*dat));
+	dat->dircntrl.updated = mc_dat_int[oldDatIdx].dircntrl.updated + 1;
+
+	card_dat dat_be;
+	memcpy(&dat_be, dat, sizeof(dat_be));
+	byteswapDirTable(&dat_be);
+	const uint32_t dat_chk = Checksum::AddInvDual16(
+		reinterpret_cast<const uint16_t*>(&dat_be),
+		(uint32_t)(sizeof(dat_be) - 4),
+		Checksum::ChkEndian::Big);
+	dat->dircntrl.chksum1 = (dat_chk >> 16);
+	dat->dircntrl.chksum2 = (dat_chk & 0xFFFF);
+	dat_be.dircntrl.chksum1 = cpu_to_be16(dat->dircntrl.chksum1);
+	dat_be.dircntrl.chksum2 = cpu_to_be16(dat->dircntrl.chksum2);
+	mc_dat_chk_actual[newDatIdx] = dat_chk;
+	mc_dat_chk_expected[newDatIdx] = dat_chk;
+
+	// Block allocation table.
+	card_bat *const bat = &mc_bat_int[newBatIdx];
+	memcpy(bat, &mc_bat_int[oldBatIdx], sizeof(*bat));
+	bat->updated = mc_bat_int[oldBatIdx].updated + 1;
+
+	card_bat bat_be;
+	memcpy(&bat_be, bat, sizeof(bat_be));
+	byteswapBlockTable(&bat_be);
+	const uint32_t bat_chk = Checksum::AddInvDual16(
+		(reinterpret_cast<const uint16_t*>(&bat_be) + 2),
+		(uint32_t)(sizeof(bat_be) - 4),
+		Checksum::ChkEndian::Big);
+	bat->chksum1 = (bat_chk >> 16);
+	bat->chksum2 = (bat_chk & 0xFFFF);
+	bat_be.chksum1 = cpu_to_be16(bat->chksum1);
+	bat_be.chksum2 = cpu_to_be16(bat->chksum2);
+	mc_bat_chk_actual[newBatIdx] = bat_chk;
+	mc_bat_chk_expected[newBatIdx] = bat_chk;
+
+	// Write the new tables.
+	static const uint32_t datAddr[2] = {CARD_SYSDIR, CARD_SYSDIR_BACK};
+	static const uint32_t batAddr[2] = {CARD_SYSBAT, CARD_SYSBAT_BACK};
+	int ret = writeBlocksDirect(&dat_be, (uint16_t)(datAddr[newDatIdx] / blockSize), 1);
+	if (ret != 0)
+		return ret;
+	ret = writeBlocksDirect(&bat_be, (uint16_t)(batAddr[newBatIdx] / blockSize), 1);
+	if (ret != 0)
+		return ret;
+
+	// Switch to the new tables.
+	dat_info.valid |= (1 << newDatIdx);
+	bat_info.valid |= (1 << newBatIdx);
+	dat_info.active = newDatIdx;
+	dat_info.active_hdr = newDatIdx;
+	bat_info.active = newBatIdx;
+	bat_info.active_hdr = newBatIdx;
+	mc_dat = dat;
+	mc_bat = bat;
+
+	Q_Q(GcnCard);
+	emit q->activeDatIdxChanged(newDatIdx);
+	emit q->activeBatIdxChanged(newBatIdx);
+	return 0;
+}
+
 /** GcnCard **/
 
 GcnCard::GcnCard(QObject *parent)
@@ -812,7 +959,10 @@ GcnCard::GcnCard(QObject *parent)
 
 GcnCard::~GcnCard()
 {
-	// TODO: Is this needed anymore?
+	// Write any uncommitted blocks.
+	// This can't be done by ~Card(), since the metadata
+	// is updated by GcnCardPrivate::commitMetadata().
+	commit();
 }
 
 /**
@@ -970,6 +1120,28 @@ GcnFile *GcnCard::addLostFile(const card_direntry *dirEntry, const std::vector<u
 	return file;
 }
 
+/**
+ * Add a "lost" file.
+ * @param searchData Search data
+ * @return GcnFile added to the GcnCard, or nullptr on error.
+ */
+GcnFile *GcnCard::addLostFile(const GcnSearchData &searchData)
+{
+	if (!isOpen())
+		return nullptr;
+
+	// NOTE: The checksum definitions must be set before the
+	// file is added, since models may cache the checksum status.
+	Q_D(GcnCard);
+	GcnFile *file = new GcnFile(this, &searchData.dirEntry, searchData.fatEntries);
+	file->setChecksumDefs(searchData.checksumDefs);
+	int idx = d->lstFiles.size();
+	emit filesAboutToBeInserted(idx, idx);
+	d->lstFiles.append(file);
+	emit filesInserted();
+	return file;
+}
+
 /**
  * Add "lost" files.
  * @param filesFoundList List of GcnSearchData
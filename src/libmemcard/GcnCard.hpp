@@ -107,6 +107,13 @@ public:
 	 */
 	GcnFile *addLostFile(const card_direntry *dirEntry, const std::vector<uint16_t> &fatEntries);
 
+	/**
+	 * Add a "lost" file.
+	 * @param searchData Search data
+	 * @return GcnFile added to the GcnCard, or nullptr on error.
+	 */
+	GcnFile *addLostFile(const GcnSearchData &searchData);
+
 	/**
 	 * Add "lost" files.
 	 * @param filesFoundList List of SearchData
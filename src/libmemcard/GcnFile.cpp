@@ -464,8 +464,9 @@ void GcnFilePrivate::loadFileInfo(void)
 	// pointing to description.
 	description = gameDesc + QChar(L'\0') + fileDesc;
 
-	// Load the banner and icon images.
-	loadImages();
+	// NOTE: The banner and icon images are loaded on demand.
+	// Large collections (e.g. GCI directories) would otherwise
+	// decode every image up front.
 }
 
 /**
@@ -13,7 +13,14 @@
 
 struct GcnSearchData
 {
+	GcnSearchData() : specificity(0) { }
+
 	card_direntry dirEntry;
 	std::vector<uint16_t> fatEntries;
 	std::vector<Checksum::ChecksumDef> checksumDefs;
+
+	// Number of literal characters in the file definition's
+	// search patterns. Used to rank multiple matches for
+	// the same block; more specific definitions rank higher.
+	int specificity;
 };
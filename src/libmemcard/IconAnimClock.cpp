@@ -0,0 +1,179 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * IconAnimClock.cpp: Shared icon animation clock.                         *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "IconAnimClock.hpp"
+
+// Qt includes.
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
+
+/** IconAnimClockPrivate **/
+
+class IconAnimClockPrivate
+{
+	public:
+		explicit IconAnimClockPrivate(IconAnimClock *q);
+
+	protected:
+		IconAnimClock *const q_ptr;
+		Q_DECLARE_PUBLIC(IconAnimClock)
+	private:
+		Q_DISABLE_COPY(IconAnimClockPrivate)
+
+	public:
+		static IconAnimClock *instance;
+
+		// Tick length, in milliseconds.
+		// FIXME: Support PAL; handle extra beginning frame and reduced ending frame.
+		// FIXME: Dreamcast animation timing?
+		static const int TICK_MS = 67;	/*4*1000/60*/
+
+		// Animation timer
+		QTimer *animTimer;
+		// Time since the clock was created.
+		QElapsedTimer elapsed;
+		// Last tick that was emitted.
+		quint32 lastTick;
+
+		// Registered clients.
+		QSet<const QObject*> clients;
+
+		/**
+		 * Update the animation timer state.
+		 * Starts the timer if clients are registered; stops the timer if not.
+		 */
+		void updateAnimTimerState(void);
+};
+
+// Singleton instance.
+IconAnimClock *IconAnimClockPrivate::instance = nullptr;
+
+IconAnimClockPrivate::IconAnimClockPrivate(IconAnimClock *q)
+	: q_ptr(q)
+	, animTimer(new QTimer(q))
+	, lastTick(0)
+{
+	animTimer->setTimerType(Qt::PreciseTimer);
+	animTimer->setInterval(TICK_MS);
+	QObject::connect(animTimer, &QTimer::timeout,
+			 q, &IconAnimClock::animTimer_slot);
+	elapsed.start();
+}
+
+/**
+ * Update the animation timer state.
+ * Starts the timer if clients are registered; stops the timer if not.
+ */
+void IconAnimClockPrivate::updateAnimTimerState(void)
+{
+	if (!clients.isEmpty()) {
+		if (!animTimer->isActive()) {
+			animTimer->start();
+		}
+	} else {
+		animTimer->stop();
+	}
+}
+
+/** IconAnimClock **/
+
+IconAnimClock::IconAnimClock()
+	: d_ptr(new IconAnimClockPrivate(this))
+{ }
+
+IconAnimClock::~IconAnimClock()
+{
+	Q_D(IconAnimClock);
+	delete d;
+}
+
+/**
+ * Get the IconAnimClock instance.
+ * NOTE: Must be called from the GUI thread.
+ * @return IconAnimClock instance
+ */
+IconAnimClock *IconAnimClock::instance(void)
+{
+	if (!IconAnimClockPrivate::instance)
+		IconAnimClockPrivate::instance = new IconAnimClock();
+	return IconAnimClockPrivate::instance;
+}
+
+/**
+ * Get the current animation tick.
+ * One tick is 4 frames at 60 Hz.
+ * @return Current animation tick
+ */
+quint32 IconAnimClock::tick(void) const
+{
+	Q_D(const IconAnimClock);
+	return (quint32)(d->elapsed.elapsed() / IconAnimClockPrivate::TICK_MS);
+}
+
+/**
+ * Register a client.
+ * The timer is started if it isn't running already.
+ * @param client Client object
+ */
+void IconAnimClock::addClient(const QObject *client)
+{
+	Q_D(IconAnimClock);
+	if (!client || d->clients.contains(client))
+		return;
+
+	d->clients.insert(client);
+	connect(client, &QObject::destroyed,
+		this, &IconAnimClock::client_destroyed_slot);
+	d->updateAnimTimerState();
+}
+
+/**
+ * Unregister a client.
+ * The timer is stopped if no clients are left.
+ * @param client Client object
+ */
+void IconAnimClock::removeClient(const QObject *client)
+{
+	Q_D(IconAnimClock);
+	if (!d->clients.remove(client))
+		return;
+
+	disconnect(client, &QObject::destroyed,
+		   this, &IconAnimClock::client_destroyed_slot);
+	d->updateAnimTimerState();
+}
+
+/** Private slots **/
+
+/**
+ * Animation timer slot.
+ */
+void IconAnimClock::animTimer_slot(void)
+{
+	Q_D(IconAnimClock);
+	const quint32 curTick = tick();
+	if (curTick == d->lastTick) {
+		// Timer fired early. Nothing has changed.
+		return;
+	}
+
+	d->lastTick = curTick;
+	emit ticked(curTick);
+}
+
+/**
+ * A client object was destroyed.
+ * @param obj QObject that was destroyed
+ */
+void IconAnimClock::client_destroyed_slot(QObject *obj)
+{
+	Q_D(IconAnimClock);
+	d->clients.remove(obj);
+	d->updateAnimTimerState();
+}
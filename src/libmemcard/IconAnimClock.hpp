@@ -0,0 +1,87 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * IconAnimClock.hpp: Shared icon animation clock.                         *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+// Qt includes.
+#include <QtCore/QObject>
+
+class IconAnimClockPrivate;
+
+/**
+ * Shared icon animation clock.
+ *
+ * All icon animations are driven by a single timer.
+ * The current tick is derived from the elapsed time,
+ * so animations stay in sync even if ticks are missed.
+ *
+ * The timer only runs while at least one client is registered.
+ */
+class IconAnimClock : public QObject
+{
+	Q_OBJECT
+	typedef QObject super;
+
+	private:
+		IconAnimClock();
+		virtual ~IconAnimClock();
+
+	protected:
+		IconAnimClockPrivate *const d_ptr;
+		Q_DECLARE_PRIVATE(IconAnimClock)
+	private:
+		Q_DISABLE_COPY(IconAnimClock)
+
+	public:
+		/**
+		 * Get the IconAnimClock instance.
+		 * NOTE: Must be called from the GUI thread.
+		 * @return IconAnimClock instance
+		 */
+		static IconAnimClock *instance(void);
+
+		/**
+		 * Get the current animation tick.
+		 * One tick is 4 frames at 60 Hz.
+		 * @return Current animation tick
+		 */
+		quint32 tick(void) const;
+
+		/**
+		 * Register a client.
+		 * The timer is started if it isn't running already.
+		 * @param client Client object
+		 */
+		void addClient(const QObject *client);
+
+		/**
+		 * Unregister a client.
+		 * The timer is stopped if no clients are left.
+		 * @param client Client object
+		 */
+		void removeClient(const QObject *client);
+
+	signals:
+		/**
+		 * The animation tick has changed.
+		 * @param tick New animation tick
+		 */
+		void ticked(quint32 tick);
+
+	private slots:
+		/**
+		 * Animation timer slot.
+		 */
+		void animTimer_slot(void);
+
+		/**
+		 * A client object was destroyed.
+		 * @param obj QObject that was destroyed
+		 */
+		void client_destroyed_slot(QObject *obj);
+};
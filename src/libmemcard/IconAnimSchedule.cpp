@@ -0,0 +1,134 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * IconAnimSchedule.cpp: Precomputed icon animation schedule.              *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "IconAnimSchedule.hpp"
+
+// TODO: Eliminate card.h and use system-independent values.
+#include "card.h"
+#include "File.hpp"
+
+IconAnimSchedule::IconAnimSchedule()
+	: m_count(0)
+{ }
+
+IconAnimSchedule::IconAnimSchedule(const File *file)
+	: m_count(0)
+{
+	setFile(file);
+}
+
+/**
+ * Compute the animation schedule for a file.
+ * @param file File, or nullptr to clear the schedule.
+ */
+void IconAnimSchedule::setFile(const File *file)
+{
+	clear();
+	if (!file || file->iconCount() <= 1) {
+		// No file specified, or icon is not animated.
+		return;
+	}
+
+	// Find the last frame.
+	// The animation ends at CARD_SPEED_END or CARD_MAXICONS.
+	int last = 0;
+	while (last < (CARD_MAXICONS - 1) &&
+	       file->iconDelay(last + 1) != CARD_SPEED_END)
+	{
+		last++;
+	}
+
+	// Unroll the frame sequence.
+	// Loop: 0, 1, ..., last
+	// Bounce: 0, 1, ..., last, last-1, ..., 1
+	static_assert((CARD_MAXICONS * 2) - 2 <= MAX_STEPS, "MAX_STEPS is too small!");
+	uint8_t frames[MAX_STEPS];
+	int steps = 0;
+	for (int i = 0; i <= last; i++) {
+		frames[steps++] = (uint8_t)i;
+	}
+	if (file->iconAnimMode() == CARD_ANIM_BOUNCE) {
+		for (int i = last - 1; i > 0; i--) {
+			frames[steps++] = (uint8_t)i;
+		}
+	}
+
+	// Frames without an icon continue showing the previous icon.
+	// For the first frames, that's the last valid icon in the loop.
+	bool hasIcon[CARD_MAXICONS];
+	for (int i = 0; i <= last; i++) {
+		hasIcon[i] = !file->icon(i).isNull();
+	}
+	uint8_t curIcon = 0;
+	for (int i = steps - 1; i >= 0; i--) {
+		if (hasIcon[frames[i]]) {
+			curIcon = frames[i];
+			break;
+		}
+	}
+
+	// Build the schedule, merging steps that show the same icon.
+	unsigned int end = 0;
+	for (int i = 0; i < steps; i++) {
+		if (hasIcon[frames[i]]) {
+			curIcon = frames[i];
+		}
+
+		// NOTE: A delay of 0 still lasts for one tick.
+		int delay = file->iconDelay(frames[i]);
+		if (delay <= 0)
+			delay = 1;
+		end += delay;
+
+		if (m_count > 0 && m_icon[m_count - 1] == curIcon) {
+			// Same icon as the previous step.
+			m_end[m_count - 1] = (uint16_t)end;
+		} else {
+			m_icon[m_count] = curIcon;
+			m_end[m_count] = (uint16_t)end;
+			m_count++;
+		}
+	}
+}
+
+/**
+ * Clear the animation schedule.
+ */
+void IconAnimSchedule::clear(void)
+{
+	m_count = 0;
+}
+
+/**
+ * Get the icon index to display at a given tick.
+ * @param tick		[in] Animation tick (from IconAnimClock)
+ * @param pNextTick	[out,opt] First tick at which the icon may change
+ * @return Icon index for File::icon().
+ */
+int IconAnimSchedule::iconAt(quint32 tick, quint32 *pNextTick) const
+{
+	if (m_count <= 1) {
+		// Not animated.
+		if (pNextTick) {
+			*pNextTick = ~0U;
+		}
+		return (m_count == 1 ? m_icon[0] : 0);
+	}
+
+	// Position within the loop.
+	const quint32 pos = tick % m_end[m_count - 1];
+	int i = 0;
+	while (pos >= m_end[i]) {
+		i++;
+	}
+
+	if (pNextTick) {
+		*pNextTick = tick - pos + m_end[i];
+	}
+	return m_icon[i];
+}
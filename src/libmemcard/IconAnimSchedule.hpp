@@ -0,0 +1,74 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]                      *
+ * IconAnimSchedule.hpp: Precomputed icon animation schedule.              *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+// C includes.
+#include <stdint.h>
+
+// Qt includes.
+#include <QtCore/qglobal.h>
+
+class File;
+
+/**
+ * Precomputed icon animation schedule.
+ *
+ * The frame sequence (including "bounce" animations) is unrolled
+ * into a single loop when the file is set, and consecutive steps
+ * that show the same icon are merged. The icon for any tick of
+ * IconAnimClock can then be determined without querying the File.
+ */
+class IconAnimSchedule
+{
+	public:
+		IconAnimSchedule();
+		explicit IconAnimSchedule(const File *file);
+
+	public:
+		/**
+		 * Compute the animation schedule for a file.
+		 * @param file File, or nullptr to clear the schedule.
+		 */
+		void setFile(const File *file);
+
+		/**
+		 * Clear the animation schedule.
+		 */
+		void clear(void);
+
+		/**
+		 * Does this schedule have more than one icon?
+		 * @return True if the icon is animated; false if not.
+		 */
+		inline bool isAnimated(void) const
+		{
+			return (m_count > 1);
+		}
+
+		/**
+		 * Get the icon index to display at a given tick.
+		 * @param tick		[in] Animation tick (from IconAnimClock)
+		 * @param pNextTick	[out,opt] First tick at which the icon may change
+		 * @return Icon index for File::icon().
+		 */
+		int iconAt(quint32 tick, quint32 *pNextTick = nullptr) const;
+
+	private:
+		// Maximum number of steps.
+		// A "bounce" animation with 8 icons has 14 steps.
+		static const int MAX_STEPS = 16;
+
+		// Number of steps.
+		uint8_t m_count;
+		// Icon index for each step.
+		uint8_t m_icon[MAX_STEPS];
+		// Tick (relative to the start of the loop) at which each step ends.
+		// The last entry is the loop length.
+		uint16_t m_end[MAX_STEPS];
+};
@@ -12,6 +12,8 @@
 #include "card.h"
 
 // Qt includes.
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
 #include <QtGui/QPainter>
 #include <QApplication>
 #include <QtGui/QFont>
@@ -38,6 +40,82 @@ class MemCardItemDelegatePrivate
 		QFont fontGameDesc(const QWidget *widget = 0) const;
 		QFont fontFileDesc(const QWidget *widget = 0) const;
 
+		// Cached fonts.
+		// NOTE: Updated by updateFonts().
+		mutable QFont m_fontBase;
+		mutable QFont m_fontGameDesc;
+		mutable QFont m_fontFileDesc;
+		// Font generation. Incremented when the fonts change.
+		mutable unsigned int m_fontGen;
+		// If false, the fonts must be reloaded.
+		mutable bool m_fontsValid;
+
+		/**
+		 * Update the cached fonts if the widget's font has changed.
+		 * If the fonts have changed, the text layout cache is cleared.
+		 * @param widget Relevant widget. (If nullptr, use QApplication.)
+		 */
+		void updateFonts(const QWidget *widget) const;
+
+		/**
+		 * Text layout for a "GameDesc\0FileDesc" item.
+		 */
+		struct TextLayout {
+			TextLayout() : fontGen(0), alignment(0) { }
+
+			QString text;		// Original text
+			unsigned int fontGen;	// Font generation
+			QString lines[2];	// Game description, file description
+
+			// Unelided size. (Invalid if not calculated yet.)
+			QSize sizeHint;
+
+			// Elided text for paint().
+			// Rects are relative to the item's top-left corner.
+			QSize rectSize;		// Item size (invalid if not calculated yet)
+			int alignment;		// Text alignment
+			QString elided[2];
+			QRect rects[2];
+		};
+
+		/**
+		 * Text layout cache.
+		 * Key: (row << 32) | column
+		 * NOTE: Entries are validated against the item text,
+		 * so a stale entry is recalculated, not reused.
+		 */
+		mutable QHash<quint64, TextLayout> layoutCache;
+
+		// Maximum number of cached layouts.
+		static const int LAYOUT_CACHE_MAX = 4096;
+
+		// Model whose layouts are cached.
+		mutable QPointer<QAbstractItemModel> model;
+
+		/**
+		 * Get the text layout for an item.
+		 * The text is only split; it is not measured.
+		 * @param option Style option
+		 * @param index Model index
+		 * @return Text layout, or nullptr if this isn't a "GameDesc\0FileDesc" item.
+		 */
+		TextLayout *getLayout(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+
+		/**
+		 * Calculate the unelided size of a text layout.
+		 * @param layout Text layout
+		 */
+		void calcSizeHint(TextLayout *layout) const;
+
+		/**
+		 * Calculate the elided text and line rects of a text layout.
+		 * Nothing is done if the item size and alignment haven't changed.
+		 * @param layout Text layout
+		 * @param size Item size
+		 * @param alignment Text alignment
+		 */
+		void calcElided(TextLayout *layout, const QSize &size, int alignment) const;
+
 #ifdef Q_OS_WIN
 		// Win32: Theming functions.
 	private:
@@ -54,6 +132,8 @@ class MemCardItemDelegatePrivate
 
 MemCardItemDelegatePrivate::MemCardItemDelegatePrivate(MemCardItemDelegate *q)
 	: q_ptr(q)
+	, m_fontGen(0)
+	, m_fontsValid(false)
 #ifdef Q_OS_WIN
 	, m_isXPTheme(false)
 #endif /* Q_OS_WIN */
@@ -71,9 +151,7 @@ MemCardItemDelegatePrivate::MemCardItemDelegatePrivate(MemCardItemDelegate *q)
  */
 QFont MemCardItemDelegatePrivate::fontGameDesc(const QWidget *widget) const
 {
-	// TODO: This should be cached, but we don't have a
-	// reasonable way to update it if the system font
-	// is changed...
+	// NOTE: Cached in m_fontGameDesc by updateFonts().
 	return (widget != nullptr
 		? widget->font()
 		: QApplication::font());
@@ -86,9 +164,7 @@ QFont MemCardItemDelegatePrivate::fontGameDesc(const QWidget *widget) const
  */
 QFont MemCardItemDelegatePrivate::fontFileDesc(const QWidget *widget) const
 {
-	// TODO: This should be cached, but we don't have a
-	// reasonable way to update it if the system font
-	// is changed...
+	// NOTE: Cached in m_fontFileDesc by updateFonts().
 	QFont fontFileDesc = fontGameDesc(widget);
 	int pointSize = fontFileDesc.pointSize();
 	if (pointSize >= 10)
@@ -99,6 +175,193 @@ QFont MemCardItemDelegatePrivate::fontFileDesc(const QWidget *widget) const
 	return fontFileDesc;
 }
 
+/**
+ * Update the cached fonts if the widget's font has changed.
+ * If the fonts have changed, the text layout cache is cleared.
+ * @param widget Relevant widget. (If nullptr, use QApplication.)
+ */
+void MemCardItemDelegatePrivate::updateFonts(const QWidget *widget) const
+{
+	const QFont fontBase = fontGameDesc(widget);
+	if (m_fontsValid && fontBase == m_fontBase) {
+		// Fonts haven't changed.
+		return;
+	}
+
+	m_fontBase = fontBase;
+	m_fontGameDesc = fontBase;
+	m_fontFileDesc = fontFileDesc(widget);
+	m_fontsValid = true;
+	m_fontGen++;
+	layoutCache.clear();
+}
+
+/**
+ * Get the text layout for an item.
+ * The text is only split; it is not measured.
+ * @param option Style option
+ * @param index Model index
+ * @return Text layout, or nullptr if this isn't a "GameDesc\0FileDesc" item.
+ */
+MemCardItemDelegatePrivate::TextLayout *MemCardItemDelegatePrivate::getLayout(
+	const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+	// GCN file comments: "GameDesc\0FileDesc"
+	// If there isn't exactly one '\0', this is regular text.
+	const QString text = index.data().toString();
+	const int nulPos = text.indexOf(QChar(L'\0'));
+	if (nulPos < 0 || text.indexOf(QChar(L'\0'), nulPos + 1) >= 0)
+		return nullptr;
+
+	updateFonts(option.widget);
+	if (index.model() != model.data()) {
+		// Different model. Cached rows don't apply.
+		MemCardItemDelegate *const q = q_ptr;
+		if (model) {
+			QObject::disconnect(model.data(), nullptr, q, nullptr);
+		}
+		model = const_cast<QAbstractItemModel*>(index.model());
+		layoutCache.clear();
+
+		// Clear the cache if rows are moved, added, or removed.
+		// NOTE: Not using dataChanged(), since icon animations
+		// would clear the cache on every tick. Changed text is
+		// detected when the layout is retrieved.
+		QObject::connect(model, &QAbstractItemModel::modelReset,
+			q, &MemCardItemDelegate::clearLayoutCache);
+		QObject::connect(model, &QAbstractItemModel::layoutChanged,
+			q, &MemCardItemDelegate::clearLayoutCache);
+		QObject::connect(model, &QAbstractItemModel::rowsInserted,
+			q, &MemCardItemDelegate::clearLayoutCache);
+		QObject::connect(model, &QAbstractItemModel::rowsRemoved,
+			q, &MemCardItemDelegate::clearLayoutCache);
+	}
+
+	const quint64 key = ((quint64)(unsigned int)index.row() << 32) | (unsigned int)index.column();
+	auto iter = layoutCache.find(key);
+	if (iter == layoutCache.end()) {
+		if (layoutCache.size() >= LAYOUT_CACHE_MAX) {
+			// Too many cached layouts.
+			layoutCache.clear();
+		}
+		iter = layoutCache.insert(key, TextLayout());
+	}
+
+	TextLayout *const layout = &(*iter);
+	if (layout->fontGen != m_fontGen || layout->text != text) {
+		// New entry, or the text has changed.
+		layout->text = text;
+		layout->fontGen = m_fontGen;
+		layout->lines[0] = text.left(nulPos);
+		layout->lines[1] = text.mid(nulPos + 1);
+		layout->sizeHint = QSize();
+		layout->rectSize = QSize();
+	}
+	return layout;
+}
+
+/**
+ * Calculate the unelided size of a text layout.
+ * @param layout Text layout
+ */
+void MemCardItemDelegatePrivate::calcSizeHint(TextLayout *layout) const
+{
+	if (layout->sizeHint.isValid()) {
+		// Already calculated.
+		return;
+	}
+
+	QSize sz(0, 0);
+	for (int i = 0; i < 2; i++) {
+		// Game description uses the normal font.
+		// File description lines use a slightly smaller font.
+		const QFontMetrics fm(i == 0 ? m_fontGameDesc : m_fontFileDesc);
+		QSize szLine = fm.size(0, layout->lines[i]);
+		sz.setHeight(sz.height() + szLine.height());
+
+		if (szLine.width() > sz.width()) {
+			sz.setWidth(szLine.width());
+		}
+	}
+
+	// Increase width by 1 to prevent accidental eliding.
+	// NOTE: We can't just remove the "-1" from calcElided(),
+	// because that still causes weird wordwrapping.
+	if (sz.width() > 0)
+		sz.setWidth(sz.width() + 1);
+
+	layout->sizeHint = sz;
+}
+
+/**
+ * Calculate the elided text and line rects of a text layout.
+ * Nothing is done if the item size and alignment haven't changed.
+ * @param layout Text layout
+ * @param size Item size
+ * @param alignment Text alignment
+ */
+void MemCardItemDelegatePrivate::calcElided(TextLayout *layout, const QSize &size, int alignment) const
+{
+	if (layout->rectSize == size && layout->alignment == alignment) {
+		// Already calculated.
+		return;
+	}
+
+	// Alignment flags.
+	static const int HALIGN_FLAGS =
+			Qt::AlignLeft |
+			Qt::AlignRight |
+			Qt::AlignHCenter |
+			Qt::AlignJustify;
+	static const int VALIGN_FLAGS =
+			Qt::AlignTop |
+			Qt::AlignBottom |
+			Qt::AlignVCenter;
+
+	// Total text height.
+	int textHeight = 0;
+
+	const QRect textRect(QPoint(0, 0), size);
+	for (int i = 0; i < 2; i++) {
+		// Name uses the normal font.
+		// Description lines use a slightly smaller font.
+		const QFontMetrics fm(i == 0 ? m_fontGameDesc : m_fontFileDesc);
+		layout->elided[i] = fm.elidedText(layout->lines[i], Qt::ElideRight, textRect.width()-1);
+		QRect tmpRect(textRect.x(), textRect.y() + textHeight, textRect.width(), fm.height());
+		textHeight += fm.height();
+		layout->rects[i] = fm.boundingRect(tmpRect, (alignment & HALIGN_FLAGS), layout->elided[i]);
+	}
+
+	// Adjust for vertical alignment.
+	int diff = 0;
+	switch (alignment & VALIGN_FLAGS) {
+		default:
+		case Qt::AlignTop:
+			// No adjustment is necessary.
+			break;
+
+		case Qt::AlignBottom:
+			// Bottom alignment.
+			diff = (textRect.height() - textHeight);
+			break;
+
+		case Qt::AlignVCenter:
+			// Center alignment.
+			diff = (textRect.height() - textHeight);
+			diff /= 2;
+			break;
+	}
+
+	if (diff != 0) {
+		for (QRect &rect : layout->rects) {
+			rect.translate(0, diff);
+		}
+	}
+
+	layout->rectSize = size;
+	layout->alignment = alignment;
+}
+
 #ifdef Q_OS_WIN
 typedef bool (WINAPI *PtrIsAppThemed)(void);
 typedef bool (WINAPI *PtrIsThemeActive)(void);
@@ -164,11 +427,9 @@ MemCardItemDelegate::MemCardItemDelegate(QObject *parent)
 	: super(parent)
 	, d_ptr(new MemCardItemDelegatePrivate(this))
 {
-#ifdef Q_OS_WIN
 	// Connect the "themeChanged" signal.
 	connect(qApp, SIGNAL(themeChanged()),
 		this, SLOT(themeChanged_slot()));
-#endif /* Q_OS_WIN */
 }
 
 MemCardItemDelegate::~MemCardItemDelegate()
@@ -188,31 +449,18 @@ void MemCardItemDelegate::paint(QPainter *painter,
 		return;
 	}
 
-	// TODO: Combine code with sizeHint().
-
 	// GCN file comments: "GameDesc\0FileDesc"
 	// If no '\0' is present, assume this is regular text
 	// and use the default paint().
-	QString s_fileComments = index.data().toString();
-	QStringList sl = s_fileComments.split(QChar(L'\0'));
-	if (sl.size() != 2) {
+	Q_D(const MemCardItemDelegate);
+	MemCardItemDelegatePrivate::TextLayout *const layout = d->getLayout(option, index);
+	if (!layout) {
 		// No '\0' is present.
 		// Use the default paint().
 		super::paint(painter, option, index);
 		return;
 	}
 
-	// Alignment flags.
-	static const int HALIGN_FLAGS =
-			Qt::AlignLeft |
-			Qt::AlignRight |
-			Qt::AlignHCenter |
-			Qt::AlignJustify;
-	static const int VALIGN_FLAGS =
-			Qt::AlignTop |
-			Qt::AlignBottom |
-			Qt::AlignVCenter;
-
 	// Get the text alignment.
 	int textAlignment = 0;
 	QVariant varAlignment = index.data(Qt::TextAlignmentRole);
@@ -223,7 +471,6 @@ void MemCardItemDelegate::paint(QPainter *painter,
 		textAlignment = option.displayAlignment;
 	}
 
-	QRect textRect = option.rect;
 	QStyleOptionViewItem bgOption = option;
 
 	// Horizontal margins.
@@ -238,58 +485,9 @@ void MemCardItemDelegate::paint(QPainter *painter,
 	// an icon in the same column as the text?)
 	//textRect.adjust(hmargin, 0, -hmargin, 0);
 
-	// Get the fonts.
-	Q_D(const MemCardItemDelegate);
-	QFont fontGameDesc = d->fontGameDesc(bgOption.widget);
-	QFont fontFileDesc = d->fontFileDesc(bgOption.widget);
-
-	// Total text height.
-	int textHeight = 0;
-
-	// Text boundaries.
-	QVector<QRect> v_rect;
-	v_rect.resize(sl.size());
-
-	for (int i = 0; i < sl.size(); i++) {
-		// Name uses the normal font.
-		// Description lines use a slightly smaller font.
-		QString &line = sl[i];
-		QRect &rect = v_rect[i];
-
-		const QFontMetrics fm(i == 0 ? fontGameDesc : fontFileDesc);
-		line = fm.elidedText(line, Qt::ElideRight, textRect.width()-1);
-		QRect tmpRect(textRect.x(), textRect.y() + textHeight, textRect.width(), fm.height());
-		textHeight += fm.height();
-		rect = fm.boundingRect(tmpRect, (textAlignment & HALIGN_FLAGS), line);
-	}
-
-	// Adjust for vertical alignment.
-	int diff = 0;
-	switch (textAlignment & VALIGN_FLAGS) {
-		default:
-		case Qt::AlignTop:
-			// No adjustment is necessary.
-			break;
-
-		case Qt::AlignBottom:
-			// Bottom alignment.
-			diff = (textRect.height() - textHeight);
-			break;
-
-		case Qt::AlignVCenter:
-			// Center alignment.
-			diff = (textRect.height() - textHeight);
-			diff /= 2;
-			break;
-	}
-
-	if (diff != 0) {
-		std::for_each(v_rect.begin(), v_rect.end(),
-			[diff](QRect &rect) {
-				rect.translate(0, diff);
-			}
-		);
-	}
+	// Elide the text and calculate the line rects.
+	// NOTE: This is cached until the item size or text changes.
+	d->calcElided(layout, option.rect.size(), textAlignment);
 
 	painter->save();
 
@@ -337,16 +535,11 @@ void MemCardItemDelegate::paint(QPainter *painter,
 	}
 
 	// Draw the text lines.
-	painter->setFont(fontGameDesc);
-	int i = 0;
-	auto iter_rect = v_rect.cbegin();
-	const auto iter_sl_cend = sl.cend();
-	for (auto iter_sl = sl.cbegin(); iter_sl != iter_sl_cend; ++iter_sl, ++iter_rect, ++i) {
-		if (i == 1) {
-			painter->setFont(fontFileDesc);
-		}
-		painter->drawText(*iter_rect, *iter_sl);
-	}
+	const QPoint topLeft = option.rect.topLeft();
+	painter->setFont(d->m_fontGameDesc);
+	painter->drawText(layout->rects[0].translated(topLeft), layout->elided[0]);
+	painter->setFont(d->m_fontFileDesc);
+	painter->drawText(layout->rects[1].translated(topLeft), layout->elided[1]);
 
 	painter->restore();
 }
@@ -366,14 +559,12 @@ QSize MemCardItemDelegate::sizeHint(const QStyleOptionViewItem &option,
 		return sz;
 	}
 
-	// TODO: Combine code with paint().
-
 	// GCN file comments: "GameDesc\0FileDesc"
 	// If no '\0' is present, assume this is regular text
-	// and use the default paint().
-	QString s_fileComments = index.data().toString();
-	QStringList sl = s_fileComments.split(QChar(L'\0'));
-	if (sl.size() != 2) {
+	// and use the default sizeHint().
+	Q_D(const MemCardItemDelegate);
+	MemCardItemDelegatePrivate::TextLayout *const layout = d->getLayout(option, index);
+	if (!layout) {
 		// No '\0' is present.
 		// TODO: Combine with !index.isValid() case.
 		QSize sz = super::sizeHint(option, index);
@@ -385,33 +576,9 @@ QSize MemCardItemDelegate::sizeHint(const QStyleOptionViewItem &option,
 		return sz;
 	}
 
-	// Get the fonts.
-	Q_D(const MemCardItemDelegate);
-	QFont fontGameDesc = d->fontGameDesc(option.widget);
-	QFont fontFileDesc = d->fontFileDesc(option.widget);
-
-	QSize sz;
-	for (int i = 0; i < sl.size(); i++) {
-		// Game description uses the normal font.
-		// File description lines use a slightly smaller font.
-		const QString &line = sl[i];
-
-		const QFontMetrics fm(i == 0 ? fontGameDesc : fontFileDesc);
-		QSize szLine = fm.size(0, line);
-		sz.setHeight(sz.height() + szLine.height());
-
-		if (szLine.width() > sz.width()) {
-			sz.setWidth(szLine.width());
-		}
-	}
-
-	// Increase width by 1 to prevent accidental eliding.
-	// NOTE: We can't just remove the "-1" from paint(),
-	// because that still causes weird wordwrapping.
-	if (sz.width() > 0)
-		sz.setWidth(sz.width() + 1);
-
-	return sz;
+	// NOTE: This is cached until the text or font changes.
+	d->calcSizeHint(layout);
+	return layout->sizeHint;
 }
 
 /** Slots. **/
@@ -421,9 +588,24 @@ QSize MemCardItemDelegate::sizeHint(const QStyleOptionViewItem &option,
  */
 void MemCardItemDelegate::themeChanged_slot(void)
 {
+	Q_D(MemCardItemDelegate);
 #ifdef Q_OS_WIN
 	// Update the XP theming info.
-	Q_D(MemCardItemDelegate);
 	d->isXPTheme(true);
 #endif
+
+	// Font metrics may have changed.
+	// Force the fonts to be reloaded.
+	d->m_fontsValid = false;
+	d->layoutCache.clear();
+}
+
+/**
+ * Clear the text layout cache.
+ * This should be called if the model's rows have changed.
+ */
+void MemCardItemDelegate::clearLayoutCache(void)
+{
+	Q_D(MemCardItemDelegate);
+	d->layoutCache.clear();
 }
@@ -33,6 +33,13 @@ class MemCardItemDelegate : public QStyledItemDelegate
 		QSize sizeHint(const QStyleOptionViewItem &option,
 			       const QModelIndex &index) const final;
 
+	public slots:
+		/**
+		 * Clear the text layout cache.
+		 * This should be called if the model's rows have changed.
+		 */
+		void clearLayoutCache(void);
+
 	private slots:
 		/**
 		 * The system theme has changed.
@@ -16,16 +16,16 @@
 #include "card.h"
 #include "util/array_size.h"
 
-// Icon animation helper.
-#include "IconAnimHelper.hpp"
+// Icon animation.
+#include "IconAnimClock.hpp"
+#include "IconAnimSchedule.hpp"
 
 // C includes. (C++ namespace)
 #include <cassert>
 #include <climits>
 
 // Qt includes.
-#include <QtCore/QHash>
-#include <QtCore/QTimer>
+#include <QtCore/QVector>
 #include <QApplication>
 #include <QtGui/QColor>
 #include <QtGui/QFont>
@@ -50,7 +50,25 @@ private:
 public:
 	Card *card;
 
-	QHash<const File*, IconAnimHelper*> animState;
+	// Animation state for a single row.
+	struct AnimRow {
+		AnimRow() : icon(0), visible(true) { }
+
+		IconAnimSchedule schedule;
+		uint8_t icon;	// Current icon index.
+		bool visible;	// Is this row visible in the view?
+	};
+
+	/**
+	 * Animation state, indexed by row.
+	 * Non-animated files have an empty schedule.
+	 * Only visible rows are updated on each tick.
+	 */
+	QVector<AnimRow> animRows;
+	// Number of visible rows with animated icons.
+	int visibleAnimCount;
+	// First tick at which any animated icon changes.
+	quint32 nextAnimTick;
 
 	/**
 	 * Initialize the animation state for all files.
@@ -58,19 +76,19 @@ public:
 	void initAnimState(void);
 
 	/**
-	 * Initialize the animation state for a given file.
-	 * @param file File
+	 * Initialize the animation state for a range of rows.
+	 * The rows must already exist in animRows.
+	 * @param start First row
+	 * @param end Last row
 	 */
-	void initAnimState(const File *file);
+	void initAnimState(int start, int end);
 
 	/**
 	 * Update the animation timer state.
-	 * Starts the timer if animated icons are present; stops the timer if not.
+	 * Registers with IconAnimClock if animated icons are present; unregisters if not.
 	 */
 	void updateAnimTimerState(void);
 
-	// Animation timer
-	QTimer *animTimer;
 	// Pause count. If >0, animation is paused.
 	int pauseCounter;
 
@@ -84,36 +102,16 @@ public:
 		// Background colors for "lost" files.
 		QBrush brush_lostFile;
 		QBrush brush_lostFile_alt;
-
-		// Icon IDs
-		enum class IconID {
-			Unknown = 0,	// Checksum is unknown
-			Invalid,	// Checksum is invalid
-			Good,		// Checksum is good
-
-			Max
-		};
-
-		/**
-		 * Load an icon.
-		 * @param id Icon ID
-		 * @return Icon
-		 */
-		QIcon getIcon(IconID id) const;
-
-	private:
-		/**
-		 * Load an icon from the Qt resources.
-		 * @param dir Base directory
-		 * @param name Icon name
-		 */
-		static QIcon loadIcon(const QString &dir, const QString &name);
-
-		// Icons for COL_TYPE
-		mutable QIcon m_icons[static_cast<int>(IconID::Max)];
 	};
 	style_t style;
 
+	/**
+	 * Load an icon from the Qt resources.
+	 * @param dir Base directory
+	 * @param name Icon name
+	 */
+	static QIcon loadIcon(const QString &dir, const QString &name);
+
 	/**
 	 * Cached copy of card->fileCount().
 	 * This value is needed after the card is destroyed,
@@ -130,14 +128,15 @@ public:
 MemCardModelPrivate::MemCardModelPrivate(MemCardModel *q)
 	: q_ptr(q)
 	, card(nullptr)
-	, animTimer(new QTimer(q))
+	, visibleAnimCount(0)
+	, nextAnimTick(0)
 	, pauseCounter(0)
 	, fileCount(0)
 	, insertStart(-1)
 	, insertEnd(-1)
 {
-	// Connect animTimer's timeout() signal.
-	QObject::connect(animTimer, &QTimer::timeout,
+	// Connect the animation clock's ticked() signal.
+	QObject::connect(IconAnimClock::instance(), &IconAnimClock::ticked,
 			 q, &MemCardModel::animTimerSlot);
 
 	// Initialize the style variables.
@@ -176,39 +175,12 @@ void MemCardModelPrivate::style_t::init(void)
 	brush_lostFile_alt = QBrush(bgColor_lostFile_alt);
 }
 
-/**
- * Load an icon.
- * @param id Icon ID
- * @return Icon
- */
-QIcon MemCardModelPrivate::style_t::getIcon(IconID id) const
-{
-	assert((int)id >= 0);
-	assert(id < IconID::Max);
-	if ((int)id < 0 || id >= IconID::Max) {
-		return QIcon();
-	}
-
-	if (m_icons[(int)id].isNull()) {
-		static const char *const names[] = {
-			"dialog-question",
-			"dialog-error",
-			"dialog-ok-apply"
-		};
-		static_assert(ARRAY_SIZE(names) == (int)IconID::Max, "names[] needs to be updated!");
-		m_icons[(int)id] = loadIcon(QLatin1String("oxygen"), QLatin1String(names[(int)id]));
-		assert(!m_icons[(int)id].isNull());
-	}
-
-	return m_icons[(int)id];
-}
-
 /**
  * Load an icon from the Qt resources.
  * @param dir Base directory
  * @param name Icon name
  */
-QIcon MemCardModelPrivate::style_t::loadIcon(const QString &dir, const QString &name)
+QIcon MemCardModelPrivate::loadIcon(const QString &dir, const QString &name)
 {
 	// Icon sizes.
 	// NOTE: Not including 256x256 here.
@@ -232,12 +204,8 @@ QIcon MemCardModelPrivate::style_t::loadIcon(const QString &dir, const QString &
 
 MemCardModelPrivate::~MemCardModelPrivate()
 {
-	animTimer->stop();
-	delete animTimer;
-
-	// TODO: Check for race conditions.
-	qDeleteAll(animState);
-	animState.clear();
+	Q_Q(MemCardModel);
+	IconAnimClock::instance()->removeClient(q);
 }
 
 /**
@@ -245,58 +213,54 @@ MemCardModelPrivate::~MemCardModelPrivate()
  */
 void MemCardModelPrivate::initAnimState(void)
 {
-	animTimer->stop();
+	animRows.clear();
+	visibleAnimCount = 0;
 
-	// TODO: Check for race conditions.
-	qDeleteAll(animState);
-	animState.clear();
-
-	if (!card)
-		return;
-
-	// Initialize the animation state.
-	for (int i = 0; i < fileCount; i++) {
-		const File *file = card->getFile(i);
-		initAnimState(file);
+	if (card && fileCount > 0) {
+		// Initialize the animation state.
+		animRows.resize(fileCount);
+		initAnimState(0, fileCount - 1);
 	}
 
-	// Start the timer if animated icons are present.
+	// Register with the animation clock if animated icons are present.
 	updateAnimTimerState();
 }
 
 /**
- * Initialize the animation state for a given file.
- * @param file File
+ * Initialize the animation state for a range of rows.
+ * The rows must already exist in animRows.
+ * @param start First row
+ * @param end Last row
  */
-void MemCardModelPrivate::initAnimState(const File *file)
+void MemCardModelPrivate::initAnimState(int start, int end)
 {
-	int numIcons = file->iconCount();
-	if (numIcons <= 1) {
-		// Not an animated icon.
-		animState.remove(file);
-		return;
+	const quint32 tick = IconAnimClock::instance()->tick();
+	for (int i = start; i <= end; i++) {
+		AnimRow &row = animRows[i];
+		row.schedule.setFile(card->getFile(i));
+		row.icon = (uint8_t)row.schedule.iconAt(tick);
+		if (row.visible && row.schedule.isAnimated()) {
+			visibleAnimCount++;
+		}
 	}
 
-	IconAnimHelper *helper = new IconAnimHelper(file);
-	animState.insert(file, helper);
+	// Recalculate the next tick on the next timer tick.
+	nextAnimTick = 0;
 }
 
 /**
  * Update the animation timer state.
- * Starts the timer if animated icons are present; stops the timer if not.
+ * Registers with IconAnimClock if animated icons are present; unregisters if not.
  */
 void MemCardModelPrivate::updateAnimTimerState(void)
 {
-	if (pauseCounter <= 0 && !animState.isEmpty()) {
-		// Animation is not paused, and we have animated icons.
-		// Start the timer.
-		// FIXME: Support PAL; handle extra beginning frame and reduced ending frame.
-		// FIXME: Dreamcast animation timing?
-		animTimer->start(67 /*4*1000/60*/);
+	Q_Q(MemCardModel);
+	if (pauseCounter <= 0 && visibleAnimCount > 0) {
+		// Animation is not paused, and we have visible animated icons.
+		IconAnimClock::instance()->addClient(q);
 	} else {
-		// Either animation is paused, or we don't have animated icons.
-		// Stop the timer.
-		animTimer->stop();
+		// Either animation is paused, or we don't have visible animated icons.
+		IconAnimClock::instance()->removeClient(q);
 	}
 }
 
@@ -372,29 +336,23 @@ QVariant MemCardModel::data(const QModelIndex& index, int role) const
 			switch (index.column()) {
 				case COL_ICON:
 					// Check if this is an animated icon.
-					if (d->animState.contains(file)) {
-						// Animated icon.
-						IconAnimHelper *helper = d->animState.value(file);
-						return helper->icon();
-					} else {
-						// Not an animated icon.
-						// Return the first icon.
-						return file->icon(0);
+					if (index.row() < d->animRows.size()) {
+						// If the icon isn't animated, this will be icon 0.
+						const MemCardModelPrivate::AnimRow &row = d->animRows.at(index.row());
+						if (!row.visible) {
+							// Hidden rows aren't updated on each tick.
+							// Get the icon for the current tick.
+							return file->icon(row.schedule.iconAt(IconAnimClock::instance()->tick()));
+						}
+						return file->icon(row.icon);
 					}
+					return file->icon(0);
 
 				case COL_BANNER:
 					return file->banner();
 
 				case COL_ISVALID:
-					switch (file->checksumStatus()) {
-						default:
-						case Checksum::ChkStatus::Unknown:
-							return d->style.getIcon(MemCardModelPrivate::style_t::IconID::Unknown);
-						case Checksum::ChkStatus::Invalid:
-							return  d->style.getIcon(MemCardModelPrivate::style_t::IconID::Invalid);
-						case Checksum::ChkStatus::Good:
-							return  d->style.getIcon(MemCardModelPrivate::style_t::IconID::Good);
-					}
+					return checksumStatusIcon(file->checksumStatus());
 
 				default:
 					break;
@@ -443,6 +401,12 @@ QVariant MemCardModel::data(const QModelIndex& index, int role) const
 			}
 			break;
 
+		case ChecksumStatusRole:
+			return static_cast<int>(file->checksumStatus());
+
+		case LostFileRole:
+			return file->isLostFile();
+
 		case Qt::SizeHintRole: {
 			// Increase row height by 4px.
 			// HACK: Increase icon/banner width on Windows.
@@ -559,6 +523,7 @@ void MemCardModel::setCard(Card *card)
 
 		// Done removing rows.
 		d->fileCount = 0;
+		d->initAnimState();
 		if (fileCount > 0)
 			endRemoveRows();
 	}
@@ -595,6 +560,93 @@ void MemCardModel::setCard(Card *card)
 	}
 }
 
+/**
+ * Set the rows that are visible in the view.
+ *
+ * Only visible rows are animated. Hidden rows jump to
+ * the correct frame when they become visible again.
+ *
+ * All rows are considered visible until this function is called.
+ *
+ * @param rows Visible rows (model rows, not proxy rows)
+ */
+void MemCardModel::setVisibleRows(const QVector<int> &rows)
+{
+	Q_D(MemCardModel);
+	const int rowCount = d->animRows.size();
+	QVector<bool> isVisible(rowCount, false);
+	for (int row : rows) {
+		if (row >= 0 && row < rowCount) {
+			isVisible[row] = true;
+		}
+	}
+
+	const quint32 tick = IconAnimClock::instance()->tick();
+	d->visibleAnimCount = 0;
+	for (int i = 0; i < rowCount; i++) {
+		MemCardModelPrivate::AnimRow &row = d->animRows[i];
+		if (!row.schedule.isAnimated()) {
+			row.visible = isVisible[i];
+			continue;
+		}
+
+		if (isVisible[i]) {
+			if (!row.visible) {
+				// Row is now visible. Jump to the current frame.
+				const uint8_t icon = (uint8_t)row.schedule.iconAt(tick);
+				if (icon != row.icon) {
+					row.icon = icon;
+					const QModelIndex iconIndex = createIndex(i, COL_ICON);
+					emit dataChanged(iconIndex, iconIndex);
+				}
+			}
+			d->visibleAnimCount++;
+		}
+		row.visible = isVisible[i];
+	}
+
+	// Recalculate the next tick on the next timer tick.
+	d->nextAnimTick = 0;
+	d->updateAnimTimerState();
+}
+
+/**
+ * Get the icon for a checksum status.
+ * @param status Checksum status
+ * @return Icon
+ */
+QIcon MemCardModel::checksumStatusIcon(Checksum::ChkStatus status)
+{
+	// Icons for COL_ISVALID
+	static const char *const names[] = {
+		"dialog-question",	// Checksum is unknown
+		"dialog-error",		// Checksum is invalid
+		"dialog-ok-apply",	// Checksum is good
+	};
+	static QIcon icons[ARRAY_SIZE(names)];
+
+	int id;
+	switch (status) {
+		default:
+		case Checksum::ChkStatus::Unknown:
+			id = 0;
+			break;
+		case Checksum::ChkStatus::Invalid:
+			id = 1;
+			break;
+		case Checksum::ChkStatus::Good:
+			id = 2;
+			break;
+	}
+
+	if (icons[id].isNull()) {
+		icons[id] = MemCardModelPrivate::loadIcon(QLatin1String("oxygen"), QLatin1String(names[id]));
+		assert(!icons[id].isNull());
+	}
+
+	return icons[id];
+}
+
 /** Public slots. **/
 
 /**
@@ -633,32 +685,54 @@ void MemCardModel::resumeAnimation(void)
 
 /**
  * Animation timer slot.
+ * @param tick Animation tick
  */
-void MemCardModel::animTimerSlot(void)
+void MemCardModel::animTimerSlot(quint32 tick)
 {
 	Q_D(MemCardModel);
-	if (!d->card) {
-		d->animTimer->stop();
+	if (!d->card || d->visibleAnimCount <= 0 || d->pauseCounter > 0)
+		return;
+	if (tick < d->nextAnimTick) {
+		// No icons have changed yet.
 		return;
 	}
 
 	// Check for icon animations.
-	for (int i = 0; i < d->fileCount; i++) {
-		const File *file = d->card->getFile(i);
-		IconAnimHelper *helper = d->animState.value(file);
-		if (!helper)
-			continue;
+	// Only visible rows are checked. Changed icons in
+	// consecutive rows are reported as a single dataChanged() range.
+	quint32 nextAnimTick = ~0U;
+	int changedStart = -1;
+	const int rows = d->animRows.size();
+	for (int i = 0; i < rows; i++) {
+		MemCardModelPrivate::AnimRow &row = d->animRows[i];
+		bool changed = false;
+		if (row.visible && row.schedule.isAnimated()) {
+			quint32 rowNextTick;
+			const uint8_t icon = (uint8_t)row.schedule.iconAt(tick, &rowNextTick);
+			if (rowNextTick < nextAnimTick) {
+				nextAnimTick = rowNextTick;
+			}
+			if (icon != row.icon) {
+				row.icon = icon;
+				changed = true;
+			}
+		}
 
-		// Tell the IconAnimHelper that a timer tick has occurred.
-		// TODO: Connect the timer to the IconAnimHelper directly?
-		bool iconUpdated = helper->tick();
-		if (iconUpdated) {
-			// Icon has been updated.
-			// Notify the UI that the icon has changed.
-			QModelIndex iconIndex = createIndex(i, MemCardModel::COL_ICON);
-			emit dataChanged(iconIndex, iconIndex);
+		if (changed) {
+			if (changedStart < 0) {
+				changedStart = i;
+			}
+		} else if (changedStart >= 0) {
+			// End of a range of changed icons.
+			emit dataChanged(createIndex(changedStart, COL_ICON), createIndex(i - 1, COL_ICON));
+			changedStart = -1;
 		}
 	}
+	if (changedStart >= 0) {
+		emit dataChanged(createIndex(changedStart, COL_ICON), createIndex(rows - 1, COL_ICON));
+	}
+
+	d->nextAnimTick = nextAnimTick;
 }
 
 /**
@@ -676,6 +750,7 @@ void MemCardModel::card_destroyed_slot(QObject *obj)
 		if (old_fileCount > 0)
 			beginRemoveRows(QModelIndex(), 0, (old_fileCount - 1));
 		d->fileCount = 0;
+		d->initAnimState();
 		if (old_fileCount > 0)
 			endRemoveRows();
 	}
@@ -705,11 +780,11 @@ void MemCardModel::card_filesInserted_slot(void)
 	Q_D(MemCardModel);
 
 	// If these files have animated icons, add them.
-	if (d->insertStart >= 0 && d->insertEnd >= 0) {
-		for (int i = d->insertStart; i <= d->insertEnd; i++) {
-			const File *file = d->card->getFile(i);
-			d->initAnimState(file);
-		}
+	if (d->card && d->insertStart >= 0 && d->insertEnd >= 0) {
+		d->animRows.insert(d->insertStart,
+			d->insertEnd - d->insertStart + 1,
+			MemCardModelPrivate::AnimRow());
+		d->initAnimState(d->insertStart, d->insertEnd);
 
 		// Reset the row insert start/end indexes.
 		d->insertStart = -1;
@@ -739,10 +814,16 @@ void MemCardModel::card_filesAboutToBeRemoved_slot(int start, int end)
 
 	// Remove animation states for these files.
 	Q_D(MemCardModel);
+	if (start < 0 || end >= d->animRows.size())
+		return;
 	for (int i = start; i <= end; i++) {
-		const File *file = d->card->getFile(i);
-		d->animState.remove(file);
+		const MemCardModelPrivate::AnimRow &row = d->animRows.at(i);
+		if (row.visible && row.schedule.isAnimated()) {
+			d->visibleAnimCount--;
+		}
 	}
+	d->animRows.remove(start, end - start + 1);
+	d->updateAnimTimerState();
 }
 
 /**
@@ -9,9 +9,12 @@
 #pragma once
 
 class Card;
+#include "Checksum.hpp"
 
 // Qt includes.
 #include <QtCore/QAbstractListModel>
+#include <QtCore/QVector>
+#include <QtGui/QIcon>
 
 class MemCardModelPrivate;
 
@@ -45,6 +48,12 @@ class MemCardModel : public QAbstractListModel
 			COL_MAX
 		};
 
+		// Custom roles. (Column-independent)
+		enum Role {
+			ChecksumStatusRole = Qt::UserRole,	// Checksum status (int; Checksum::ChkStatus)
+			LostFileRole,				// Is this a "lost" file? (bool)
+		};
+
 		// Qt Model/View interface.
 		int rowCount(const QModelIndex& parent = QModelIndex()) const final;
 		int columnCount(const QModelIndex& parent = QModelIndex()) const final;
@@ -58,6 +67,25 @@ class MemCardModel : public QAbstractListModel
 		 */
 		void setCard(Card *card);
 
+		/**
+		 * Set the rows that are visible in the view.
+		 *
+		 * Only visible rows are animated. Hidden rows jump to
+		 * the correct frame when they become visible again.
+		 *
+		 * All rows are considered visible until this function is called.
+		 *
+		 * @param rows Visible rows (model rows, not proxy rows)
+		 */
+		void setVisibleRows(const QVector<int> &rows);
+
+		/**
+		 * Get the icon for a checksum status.
+		 * @param status Checksum status
+		 * @return Icon
+		 */
+		static QIcon checksumStatusIcon(Checksum::ChkStatus status);
+
 	public slots:
 		/**
 		 * Pause animation.
@@ -78,9 +106,9 @@ class MemCardModel : public QAbstractListModel
 	private slots:
 		/**
 		 * Animation timer slot.
-		 * Wrapper for MemCardModelPrivate::animTimerSlot().
+		 * @param tick Animation tick
 		 */
-		void animTimerSlot(void);
+		void animTimerSlot(quint32 tick);
 
 		/**
 		 * Card object was destroyed.
@@ -2,44 +2,489 @@
  * GameCube Memory Card Recovery Program [libmemcard]                      *
  * MemCardSortFilterProxyModel.hpp: MemCardModel sort filter proxy.        *
  *                                                                         *
- * Copyright (c) 2012-2018 by David Korth.                                 *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
 #include "MemCardSortFilterProxyModel.hpp"
+#include "MemCardModel.hpp"
+#include "FileFilterIndex.hpp"
+
+// Qt includes.
+#include <QtCore/QDateTime>
+#include <QtCore/QVector>
+
+/** MemCardSortFilterProxyModelPrivate **/
+
+class MemCardSortFilterProxyModelPrivate
+{
+	public:
+		explicit MemCardSortFilterProxyModelPrivate(MemCardSortFilterProxyModel *q);
+
+	protected:
+		MemCardSortFilterProxyModel *const q_ptr;
+		Q_DECLARE_PUBLIC(MemCardSortFilterProxyModel)
+	private:
+		Q_DISABLE_COPY(MemCardSortFilterProxyModelPrivate)
+
+	public:
+		/**
+		 * Sort key for a single item.
+		 */
+		struct SortKey {
+			enum class Type : uint8_t {
+				Unknown = 0,	// Use QSortFilterProxyModel::lessThan().
+				String,		// Case-folded string
+				Number,		// Integer or timestamp
+			};
+
+			Type type;
+			QString str;	// Case-folded string
+			qint64 num;	// Integer, or msecs since Epoch
+		};
+
+		/**
+		 * Sort keys for a single column, indexed by source row.
+		 * Columns are only built once they're used for sorting.
+		 */
+		struct ColumnKeys {
+			ColumnKeys() : valid(false) { }
+
+			bool valid;
+			QVector<SortKey> keys;
+		};
+		mutable QVector<ColumnKeys> columns;
+
+		/**
+		 * Build the sort key for a source model item.
+		 * @param index Source model index
+		 * @return Sort key
+		 */
+		static SortKey buildKey(const QModelIndex &index);
+
+		/**
+		 * Get the sort keys for a column.
+		 * The keys are built if they haven't been built yet.
+		 * @param column Column
+		 * @return Column keys
+		 */
+		const ColumnKeys &columnKeys(int column) const;
+
+		/**
+		 * Discard all sort keys and the filter index.
+		 */
+		void clear(void);
+
+		/** Filter **/
+
+		// Filter index, indexed by source row.
+		// Only built once a query is set; it's kept up to date
+		// as the source model changes after that.
+		mutable FileFilterIndex filterIndex;
+		mutable bool filterIndexValid;
+
+		/**
+		 * Build the filter index entry for a source model row.
+		 * @param model Source model
+		 * @param row Row
+		 * @return Filter index entry
+		 */
+		static FileFilterIndex::Entry buildFilterEntry(const QAbstractItemModel *model, int row);
+
+		/**
+		 * Build the filter index if it hasn't been built yet.
+		 */
+		void ensureFilterIndex(void) const;
+};
+
+MemCardSortFilterProxyModelPrivate::MemCardSortFilterProxyModelPrivate(MemCardSortFilterProxyModel *q)
+	: q_ptr(q)
+	, filterIndexValid(false)
+{ }
+
+/**
+ * Build the sort key for a source model item.
+ * @param index Source model index
+ * @return Sort key
+ */
+MemCardSortFilterProxyModelPrivate::SortKey MemCardSortFilterProxyModelPrivate::buildKey(const QModelIndex &index)
+{
+	SortKey key;
+	key.type = SortKey::Type::Unknown;
+	key.num = 0;
+
+	const QVariant var = index.data();
+	switch (var.userType()) {
+		case QMetaType::QString:
+			// Case-insensitive comparison.
+			// NOTE: Descriptions have an embedded '\0' separating
+			// GameDesc from FileDesc. Case folding preserves it,
+			// and QString::compare() doesn't stop at '\0'.
+			key.type = SortKey::Type::String;
+			key.str = var.toString().toCaseFolded();
+			break;
+
+		case QMetaType::Int:
+		case QMetaType::UInt:
+		case QMetaType::LongLong:
+		case QMetaType::ULongLong:
+			key.type = SortKey::Type::Number;
+			key.num = var.toLongLong();
+			break;
+
+		case QMetaType::QDateTime: {
+			const QDateTime dateTime = var.toDateTime();
+			if (dateTime.isValid()) {
+				key.type = SortKey::Type::Number;
+				key.num = dateTime.toMSecsSinceEpoch();
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	return key;
+}
+
+/**
+ * Get the sort keys for a column.
+ * The keys are built if they haven't been built yet.
+ * @param column Column
+ * @return Column keys
+ */
+const MemCardSortFilterProxyModelPrivate::ColumnKeys &MemCardSortFilterProxyModelPrivate::columnKeys(int column) const
+{
+	Q_Q(const MemCardSortFilterProxyModel);
+	if (column >= columns.size()) {
+		columns.resize(column + 1);
+	}
+
+	ColumnKeys &ck = columns[column];
+	if (!ck.valid) {
+		const QAbstractItemModel *const model = q->sourceModel();
+		const int rowCount = (model ? model->rowCount() : 0);
+		ck.keys.resize(rowCount);
+		for (int row = 0; row < rowCount; row++) {
+			ck.keys[row] = buildKey(model->index(row, column));
+		}
+		ck.valid = true;
+	}
+	return ck;
+}
+
+/**
+ * Discard all sort keys and the filter index.
+ */
+void MemCardSortFilterProxyModelPrivate::clear(void)
+{
+	columns.clear();
+	filterIndex.clear();
+	filterIndexValid = false;
+}
+
+/**
+ * Build the filter index entry for a source model row.
+ * @param model Source model
+ * @param row Row
+ * @return Filter index entry
+ */
+FileFilterIndex::Entry MemCardSortFilterProxyModelPrivate::buildFilterEntry(const QAbstractItemModel *model, int row)
+{
+	FileFilterIndex::Entry entry;
+
+	// The description has an embedded '\0' separating
+	// GameDesc from FileDesc.
+	const QString desc = model->index(row, MemCardModel::COL_DESCRIPTION).data().toString();
+	const int nulPos = desc.indexOf(QChar(L'\0'));
+	if (nulPos >= 0) {
+		entry.gameDesc = desc.left(nulPos);
+		entry.fileDesc = desc.mid(nulPos + 1);
+	} else {
+		entry.gameDesc = desc;
+	}
+
+	entry.filename = model->index(row, MemCardModel::COL_FILENAME).data().toString();
+	entry.gameID = model->index(row, MemCardModel::COL_GAMEID).data().toString();
+
+	const QModelIndex idx = model->index(row, 0);
+	entry.status = static_cast<Checksum::ChkStatus>(
+		idx.data(MemCardModel::ChecksumStatusRole).toInt());
+	entry.lost = idx.data(MemCardModel::LostFileRole).toBool();
+	return entry;
+}
+
+/**
+ * Build the filter index if it hasn't been built yet.
+ */
+void MemCardSortFilterProxyModelPrivate::ensureFilterIndex(void) const
+{
+	if (filterIndexValid)
+		return;
+
+	Q_Q(const MemCardSortFilterProxyModel);
+	const QAbstractItemModel *const model = q->sourceModel();
+	const int rowCount = (model ? model->rowCount() : 0);
+	QVector<FileFilterIndex::Entry> entries;
+	entries.reserve(rowCount);
+	for (int row = 0; row < rowCount; row++) {
+		entries.append(buildFilterEntry(model, row));
+	}
+
+	filterIndex.clear();
+	filterIndex.insertRows(0, entries);
+	filterIndexValid = true;
+}
+
+/** MemCardSortFilterProxyModel **/
 
 MemCardSortFilterProxyModel::MemCardSortFilterProxyModel(QObject *parent)
 	: super(parent)
+	, d_ptr(new MemCardSortFilterProxyModelPrivate(this))
 { }
 
+MemCardSortFilterProxyModel::~MemCardSortFilterProxyModel()
+{
+	Q_D(MemCardSortFilterProxyModel);
+	delete d;
+}
+
+void MemCardSortFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+	Q_D(MemCardSortFilterProxyModel);
+	QAbstractItemModel *const oldModel = this->sourceModel();
+	if (oldModel) {
+		disconnect(oldModel, nullptr, this, nullptr);
+	}
+	d->clear();
+
+	// NOTE: The sort keys must be updated before QSortFilterProxyModel
+	// handles the source model's signals, since it may call lessThan()
+	// for new rows. Hence, these are connected *before* setSourceModel().
+	if (sourceModel) {
+		connect(sourceModel, &QAbstractItemModel::rowsInserted,
+			this, &MemCardSortFilterProxyModel::source_rowsInserted_slot);
+		connect(sourceModel, &QAbstractItemModel::rowsRemoved,
+			this, &MemCardSortFilterProxyModel::source_rowsRemoved_slot);
+		connect(sourceModel, &QAbstractItemModel::dataChanged,
+			this, &MemCardSortFilterProxyModel::source_dataChanged_slot);
+		connect(sourceModel, &QAbstractItemModel::modelReset,
+			this, &MemCardSortFilterProxyModel::source_reset_slot);
+		connect(sourceModel, &QAbstractItemModel::layoutChanged,
+			this, &MemCardSortFilterProxyModel::source_reset_slot);
+	}
+
+	super::setSourceModel(sourceModel);
+}
+
 bool MemCardSortFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
 {
-	return super::filterAcceptsRow(source_row, source_parent);
+	Q_D(const MemCardSortFilterProxyModel);
+	if (d->filterIndex.isQueryEmpty() || source_parent.isValid()) {
+		// No query.
+		return super::filterAcceptsRow(source_row, source_parent);
+	}
+
+	d->ensureFilterIndex();
+	return d->filterIndex.acceptsRow(source_row);
 }
 
 bool MemCardSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
-	if (!left.isValid() || !right.isValid()) {
+	if (!left.isValid() || !right.isValid() ||
+	    left.column() != right.column() ||
+	    left.model() != sourceModel())
+	{
 		// One or both indexes are invalid.
 		// Use the default lessThan().
 		return super::lessThan(left, right);
 	}
 
-	const QVariant vLeft = left.data();
-	const QVariant vRight = right.data();
+	// Use the precomputed sort keys.
+	Q_D(const MemCardSortFilterProxyModel);
+	const MemCardSortFilterProxyModelPrivate::ColumnKeys &ck = d->columnKeys(left.column());
+	if (left.row() >= ck.keys.size() || right.row() >= ck.keys.size()) {
+		// Sort keys are out of date.
+		return super::lessThan(left, right);
+	}
 
-	// FIXME: Verify that this works with embedded null characters (L'\0'),
-	// which is used to separate GameDesc from FileDesc in a single QString.
-	if (vLeft.type() == QVariant::String &&
-	    vRight.type() == QVariant::String)
-	{
-		// String. Do a case-insensitive comparison.
-		QString sLeft = vLeft.toString();
-		QString sRight = vRight.toString();
-		return (sLeft.compare(sRight, Qt::CaseInsensitive) < 0);
+	typedef MemCardSortFilterProxyModelPrivate::SortKey SortKey;
+	const SortKey &kLeft = ck.keys.at(left.row());
+	const SortKey &kRight = ck.keys.at(right.row());
+	if (kLeft.type == kRight.type) {
+		switch (kLeft.type) {
+			case SortKey::Type::String:
+				return (kLeft.str.compare(kRight.str, Qt::CaseSensitive) < 0);
+			case SortKey::Type::Number:
+				return (kLeft.num < kRight.num);
+			default:
+				break;
+		}
 	}
 
 	// Unhandled type.
 	// Use the default lessThan().
 	return super::lessThan(left, right);
 }
+
+/**
+ * Get the filter query.
+ * @return Filter query
+ */
+QString MemCardSortFilterProxyModel::filterQuery(void) const
+{
+	Q_D(const MemCardSortFilterProxyModel);
+	return d->filterIndex.query();
+}
+
+/**
+ * Set the filter query.
+ * See FileFilterIndex for the query syntax.
+ * @param query Filter query, or empty string to show all files.
+ */
+void MemCardSortFilterProxyModel::setFilterQuery(const QString &query)
+{
+	Q_D(MemCardSortFilterProxyModel);
+	if (d->filterIndex.query() == query)
+		return;
+
+	d->filterIndex.setQuery(query);
+	invalidateFilter();
+}
+
+/** Private slots **/
+
+/**
+ * Source model: Rows have been inserted.
+ * @param parent Parent index
+ * @param first First row
+ * @param last Last row
+ */
+void MemCardSortFilterProxyModel::source_rowsInserted_slot(const QModelIndex &parent, int first, int last)
+{
+	Q_UNUSED(parent)
+	Q_D(MemCardSortFilterProxyModel);
+	const QAbstractItemModel *const model = sourceModel();
+
+	// Build keys for the new rows only.
+	// QSortFilterProxyModel inserts them at their sorted
+	// positions, so the existing rows aren't re-sorted.
+	const int count = last - first + 1;
+	for (int column = 0; column < d->columns.size(); column++) {
+		MemCardSortFilterProxyModelPrivate::ColumnKeys &ck = d->columns[column];
+		if (!ck.valid)
+			continue;
+		if (first > ck.keys.size()) {
+			// Keys are out of date.
+			ck.valid = false;
+			continue;
+		}
+
+		ck.keys.insert(first, count, MemCardSortFilterProxyModelPrivate::SortKey());
+		for (int row = first; row <= last; row++) {
+			ck.keys[row] = MemCardSortFilterProxyModelPrivate::buildKey(model->index(row, column));
+		}
+	}
+
+	// Index the new rows.
+	// QSortFilterProxyModel filters them after this.
+	if (d->filterIndexValid) {
+		if (first > d->filterIndex.rowCount()) {
+			// Filter index is out of date.
+			d->filterIndex.clear();
+			d->filterIndexValid = false;
+		} else {
+			QVector<FileFilterIndex::Entry> entries;
+			entries.reserve(count);
+			for (int row = first; row <= last; row++) {
+				entries.append(MemCardSortFilterProxyModelPrivate::buildFilterEntry(model, row));
+			}
+			d->filterIndex.insertRows(first, entries);
+		}
+	}
+}
+
+/**
+ * Source model: Rows have been removed.
+ * @param parent Parent index
+ * @param first First row
+ * @param last Last row
+ */
+void MemCardSortFilterProxyModel::source_rowsRemoved_slot(const QModelIndex &parent, int first, int last)
+{
+	Q_UNUSED(parent)
+	Q_D(MemCardSortFilterProxyModel);
+	for (int column = 0; column < d->columns.size(); column++) {
+		MemCardSortFilterProxyModelPrivate::ColumnKeys &ck = d->columns[column];
+		if (!ck.valid)
+			continue;
+		if (last >= ck.keys.size()) {
+			// Keys are out of date.
+			ck.valid = false;
+			continue;
+		}
+		ck.keys.remove(first, last - first + 1);
+	}
+
+	if (d->filterIndexValid) {
+		if (last >= d->filterIndex.rowCount()) {
+			// Filter index is out of date.
+			d->filterIndex.clear();
+			d->filterIndexValid = false;
+		} else {
+			d->filterIndex.removeRows(first, last - first + 1);
+		}
+	}
+}
+
+/**
+ * Source model: Data has changed.
+ * @param topLeft Top-left index
+ * @param bottomRight Bottom-right index
+ */
+void MemCardSortFilterProxyModel::source_dataChanged_slot(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+	// NOTE: Icon animations only change COL_ICON, which
+	// normally doesn't have sort keys, so this is cheap.
+	Q_D(MemCardSortFilterProxyModel);
+	const QAbstractItemModel *const model = sourceModel();
+	const int lastColumn = qMin(bottomRight.column(), d->columns.size() - 1);
+	for (int column = topLeft.column(); column <= lastColumn; column++) {
+		MemCardSortFilterProxyModelPrivate::ColumnKeys &ck = d->columns[column];
+		if (!ck.valid)
+			continue;
+		if (bottomRight.row() >= ck.keys.size()) {
+			// Keys are out of date.
+			ck.valid = false;
+			continue;
+		}
+
+		for (int row = topLeft.row(); row <= bottomRight.row(); row++) {
+			ck.keys[row] = MemCardSortFilterProxyModelPrivate::buildKey(model->index(row, column));
+		}
+	}
+
+	// Re-index the rows if any text columns changed.
+	if (d->filterIndexValid && bottomRight.column() >= MemCardModel::COL_DESCRIPTION) {
+		if (bottomRight.row() >= d->filterIndex.rowCount()) {
+			// Filter index is out of date.
+			d->filterIndex.clear();
+			d->filterIndexValid = false;
+		} else {
+			for (int row = topLeft.row(); row <= bottomRight.row(); row++) {
+				d->filterIndex.updateRow(row, MemCardSortFilterProxyModelPrivate::buildFilterEntry(model, row));
+			}
+		}
+	}
+}
+
+/**
+ * Source model: The model was reset, or its layout has changed.
+ * All sort keys and the filter index are discarded.
+ */
+void MemCardSortFilterProxyModel::source_reset_slot(void)
+{
+	Q_D(MemCardSortFilterProxyModel);
+	d->clear();
+}
@@ -10,6 +10,7 @@
 
 #include <QSortFilterProxyModel>
 
+class MemCardSortFilterProxyModelPrivate;
 class MemCardSortFilterProxyModel : public QSortFilterProxyModel
 {
 	Q_OBJECT
@@ -17,11 +18,60 @@ class MemCardSortFilterProxyModel : public QSortFilterProxyModel
 
 	public:
 		explicit MemCardSortFilterProxyModel(QObject *parent = 0);
+		virtual ~MemCardSortFilterProxyModel();
 
+	protected:
+		MemCardSortFilterProxyModelPrivate *const d_ptr;
+		Q_DECLARE_PRIVATE(MemCardSortFilterProxyModel)
 	private:
 		Q_DISABLE_COPY(MemCardSortFilterProxyModel)
 
 	public:
+		void setSourceModel(QAbstractItemModel *sourceModel) final;
+
 		bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const final;
 		bool lessThan(const QModelIndex &left, const QModelIndex &right) const final;
+
+		/**
+		 * Get the filter query.
+		 * @return Filter query
+		 */
+		QString filterQuery(void) const;
+
+		/**
+		 * Set the filter query.
+		 * See FileFilterIndex for the query syntax.
+		 * @param query Filter query, or empty string to show all files.
+		 */
+		void setFilterQuery(const QString &query);
+
+	private slots:
+		/**
+		 * Source model: Rows have been inserted.
+		 * @param parent Parent index
+		 * @param first First row
+		 * @param last Last row
+		 */
+		void source_rowsInserted_slot(const QModelIndex &parent, int first, int last);
+
+		/**
+		 * Source model: Rows have been removed.
+		 * @param parent Parent index
+		 * @param first First row
+		 * @param last Last row
+		 */
+		void source_rowsRemoved_slot(const QModelIndex &parent, int first, int last);
+
+		/**
+		 * Source model: Data has changed.
+		 * @param topLeft Top-left index
+		 * @param bottomRight Bottom-right index
+		 */
+		void source_dataChanged_slot(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+		/**
+		 * Source model: The model was reset, or its layout has changed.
+		 * All sort keys and the filter index are discarded.
+		 */
+		void source_reset_slot(void);
 };
@@ -19,8 +19,14 @@
 #include <cerrno>
 
 // C++ includes.
+#include <algorithm>
 #include <limits>
 
+// Qt includes.
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
 #define NUM_ELEMENTS(x) ((int)(sizeof(x) / sizeof(x[0])))
 
 // VMU card definitions.
@@ -97,6 +103,28 @@ class VmuCardPrivate : public CardPrivate
 		 * Load the File list.
 		 */
 		void loadFileList(void);
+
+		/**
+		 * Worker for parsing VmuFiles in parallel.
+		 */
+		class FileParser : public QRunnable
+		{
+			public:
+				FileParser(VmuFile *const *files, int count)
+					: files(files)
+					, count(count) { }
+
+				void run(void) final
+				{
+					for (int i = 0; i < count; i++) {
+						files[i]->parse();
+					}
+				}
+
+			private:
+				VmuFile *const *const files;
+				const int count;
+		};
 };
 
 VmuCardPrivate::VmuCardPrivate(VmuCard *q)
@@ -160,6 +188,12 @@ int VmuCardPrivate::open(const QString &filename)
 		return ret;
 	}
 
+	// VMU images are only 128 KB, so load the entire
+	// image into memory. This way, the system information
+	// and all VmuFile reads are memcpy()s instead of seeks.
+	// NOTE: If this fails, readBlock() falls back to the file.
+	loadImage();
+
 	// Load the VMU-specific data.
 
 	// Load the memory card system information.
@@ -212,9 +246,9 @@ int VmuCardPrivate::loadSysInfo(void)
 	bat_info.valid_freeblocks = 1;
 
 	// Root block.
-	file->seek(VMU_ROOT_BLOCK_ADDRESS * blockSize);
-	qint64 sz = file->read((char*)&mc_root, sizeof(mc_root));
-	if (sz < (qint64)sizeof(mc_root)) {
+	Q_Q(VmuCard);
+	int sz = q->readBlock(&mc_root, sizeof(mc_root), VMU_ROOT_BLOCK_ADDRESS);
+	if (sz < (int)sizeof(mc_root)) {
 		// Error reading the root block.
 		// Zero the root block, directory, and FAT.
 		memset(&mc_root, 0x00, sizeof(mc_root));
@@ -338,9 +372,9 @@ int VmuCardPrivate::loadFat(void)
 		return -2;
 	}
 
-	file->seek(mc_root.fat_addr * blockSize);
-	quint64 sz = file->read((char*)&mc_fat, sizeof(mc_fat));
-	if (sz != sizeof(mc_fat)) {
+	Q_Q(VmuCard);
+	int sz = q->readBlock(&mc_fat, sizeof(mc_fat), mc_root.fat_addr);
+	if (sz != (int)sizeof(mc_fat)) {
 		// Error reading the FAT.
 		return -3;
 	}
@@ -402,14 +436,13 @@ int VmuCardPrivate::loadDir(void)
 	// NOTE: The VMS file system likes to store files backwards.
 	// Block 253 is the first block of directory;
 	// Block 252 is the second block, etc.
+	Q_Q(VmuCard);
 	const int lastBlock = (mc_root.dir_addr - mc_root.dir_size + 1);
 	vmu_dir_entry *dir = mc_dir;
 	for (int block = mc_root.dir_addr; block >= lastBlock;
 	     block--, dir += (VMU_BLOCK_SIZE / sizeof(*dir))) {
-		const int address = (block * blockSize);
-		file->seek(address);
-		qint64 sz = file->read((char*)dir, VMU_BLOCK_SIZE);
-		if (sz < (qint64)VMU_BLOCK_SIZE) {
+		int sz = q->readBlock(dir, VMU_BLOCK_SIZE, (uint16_t)block);
+		if (sz < VMU_BLOCK_SIZE) {
 			// Error reading the directory table.
 			return -3;
 		}
@@ -454,7 +487,9 @@ void VmuCardPrivate::loadFileList(void)
 	QVector<File*> lstFiles_new;
 	lstFiles_new.reserve(NUM_ELEMENTS(mc_dir));
 
-	// Byteswap the directory table contents.
+	// Create the VmuFiles.
+	QVector<VmuFile*> vmuFiles;
+	vmuFiles.reserve(NUM_ELEMENTS(mc_dir));
 	for (int i = 0; i < NUM_ELEMENTS(mc_dir); i++) {
 		const vmu_dir_entry *dirEntry = &mc_dir[i];
 
@@ -463,7 +498,28 @@ void VmuCardPrivate::loadFileList(void)
 			continue;
 
 		// Valid directory entry.
-		VmuFile *vmuFile = new VmuFile(q, dirEntry, &mc_fat);
+		vmuFiles.append(new VmuFile(q, dirEntry, &mc_fat));
+	}
+
+	// Parse the files in parallel.
+	// The card image is in memory, so this is mostly
+	// image decoding and checksum calculation.
+	// NOTE: Using a local thread pool so we don't wait on
+	// other tasks that might be using the global instance.
+	if (!vmuFiles.isEmpty()) {
+		QThreadPool pool;
+		const int threads = std::max(1, QThread::idealThreadCount());
+		const int fileCount = (int)vmuFiles.size();
+		const int perThread = (fileCount + threads - 1) / threads;
+		for (int i = 0; i < fileCount; i += perThread) {
+			const int count = std::min(perThread, fileCount - i);
+			pool.start(new FileParser(vmuFiles.data() + i, count));
+		}
+		pool.waitForDone();
+	}
+
+	for (int i = 0; i < vmuFiles.size(); i++) {
+		VmuFile *const vmuFile = vmuFiles.at(i);
 		lstFiles_new.append(vmuFile);
 
 		// Is this file ICONDATA_VMS?
@@ -522,7 +578,9 @@ VmuCard::VmuCard(QObject *parent)
 
 VmuCard::~VmuCard()
 {
-	// TODO: Is this needed anymore?
+	// Write any uncommitted blocks.
+	// NOTE: ~Card() discards them.
+	commit();
 }
 
 /**
@@ -284,8 +284,8 @@ void VmuFilePrivate::loadFileInfo(void)
 		description = filename + QChar(L'\0') + dc_desc;
 	}
 
-	// Load the banner and icon images.
-	loadImages();
+	// NOTE: The banner and icon images are loaded by
+	// VmuFile::parse(), or on demand by FilePrivate.
 }
 
 /**
@@ -533,10 +533,9 @@ VmuFile::VmuFile(VmuCard *card,
 		checksumDef.length = (this->size() * card->blockSize());
 		checksumDef.endian = Checksum::ChkEndian::Little;
 
-		// TODO: Optimize this?
-		std::vector<Checksum::ChecksumDef> checksumDefs;
-		checksumDefs.push_back(checksumDef);
-		setChecksumDefs(checksumDefs);
+		// NOTE: The checksum is calculated by parse().
+		d->checksumDefs.clear();
+		d->checksumDefs.push_back(checksumDef);
 	}
 }
 
@@ -544,6 +543,18 @@ VmuFile::VmuFile(VmuCard *card,
 VmuFile::~VmuFile()
 { }
 
+/**
+ * Load the banner and icon images and calculate the checksum.
+ * This only reads from the card, and doesn't create any QPixmaps,
+ * so VmuCard can parse multiple files in parallel.
+ */
+void VmuFile::parse(void)
+{
+	Q_D(VmuFile);
+	d->ensureGcImagesLoaded();
+	d->calculateChecksum();
+}
+
 /**
  * Get the file's mode as a string.
  * This is system-specific.
@@ -31,6 +31,7 @@ class VmuFile : public File
 		/**
 		 * Create a VmuFile for a VmuCard.
 		 * This constructor is for valid files.
+		 * NOTE: parse() must be called afterwards.
 		 * @param card VmuCard.
 		 * @param direntry Directory Entry pointer.
 		 * @param mc_fat VMU FAT.
@@ -41,6 +42,13 @@ class VmuFile : public File
 
 		virtual ~VmuFile();
 
+		/**
+		 * Load the banner and icon images and calculate the checksum.
+		 * This only reads from the card, and doesn't create any QPixmaps,
+		 * so VmuCard can parse multiple files in parallel.
+		 */
+		void parse(void);
+
 	protected:
 		Q_DECLARE_PRIVATE(VmuFile)
 	private:
@@ -0,0 +1,273 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]: Unit tests.         *
+ * CardDiffTest.cpp: CardDiff tests.                                       *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "CardDiff.hpp"
+#include "GcnCard.hpp"
+#include "File.hpp"
+
+#include "GcnCardBuilder.hpp"
+
+// C includes (C++ namespace)
+#include <cerrno>
+#include <cstring>
+
+// C++ includes
+#include <vector>
+using std::vector;
+
+// Qt includes
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+
+class CardDiffTest : public QObject
+{
+	Q_OBJECT
+
+	private:
+		QTemporaryDir tmpDir;
+		QScopedPointer<GcnCard> cardA;
+		QScopedPointer<GcnCard> cardB;
+
+		/**
+		 * Create a block list.
+		 * @param first First block
+		 * @param count Number of blocks
+		 * @return Block list
+		 */
+		static vector<uint16_t> blocks(uint16_t first, int count = 1)
+		{
+			vector<uint16_t> ret;
+			for (int i = 0; i < count; i++) {
+				ret.push_back((uint16_t)(first + i));
+			}
+			return ret;
+		}
+
+		/**
+		 * Get the file differences, indexed by filename.
+		 * @param diffs File differences
+		 * @return Hash of filename to file difference
+		 */
+		static QHash<QString, CardDiff::FileDiff> byFilename(const QVector<CardDiff::FileDiff> &diffs)
+		{
+			QHash<QString, CardDiff::FileDiff> ret;
+			foreach (const CardDiff::FileDiff &diff, diffs) {
+				ret.insert(diff.filename, diff);
+			}
+			return ret;
+		}
+
+	private slots:
+		void initTestCase(void);
+
+		void compareFiles(void);
+		void compareBlocks(void);
+		void sameCard(void);
+		void invalidCards(void);
+};
+
+/**
+ * Create the two Memory Card images.
+ *
+ * Card B is card A with the following changes:
+ * - "moved": Same data, stored in different blocks.
+ * - "modified": Two byte ranges in the first block changed.
+ * - "removed": Removed.
+ * - "added": Added.
+ * - "metadata": Timestamp changed.
+ * - "grown": Second block added.
+ * - "unchanged": Unchanged.
+ */
+void CardDiffTest::initTestCase(void)
+{
+	QVERIFY(tmpDir.isValid());
+
+	GcnCardBuilder builderA, builderB;
+	const char *const gamecode = "GALE";
+	const char *const company = "01";
+
+	// File data. Each file has its own byte pattern.
+	for (uint16_t i = 5; i < 32; i++) {
+		builderA.fillBlock(i, (uint8_t)i);
+		builderB.fillBlock(i, (uint8_t)i);
+	}
+
+	// "moved": A[5,6] -> B[20,21]
+	builderA.addFile(gamecode, company, "moved", blocks(5, 2));
+	builderB.addFile(gamecode, company, "moved", blocks(20, 2));
+	memcpy(builderB.block(20), builderA.block(5), GcnCardBuilder::BLOCK_SIZE);
+	memcpy(builderB.block(21), builderA.block(6), GcnCardBuilder::BLOCK_SIZE);
+
+	// "modified": A[7] -> B[7], with 0x10-0x13 and 0x100 changed.
+	builderA.addFile(gamecode, company, "modified", blocks(7));
+	builderB.addFile(gamecode, company, "modified", blocks(7));
+	for (int i = 0x10; i < 0x14; i++) {
+		builderB.block(7)[i] ^= 0xFF;
+	}
+	builderB.block(7)[0x100] ^= 0xFF;
+
+	// "removed": A[8]
+	builderA.addFile(gamecode, company, "removed", blocks(8));
+
+	// "added": B[12]
+	builderB.addFile(gamecode, company, "added", blocks(12));
+
+	// "metadata": A[9] -> B[9], with a different timestamp.
+	builderA.addFile(gamecode, company, "metadata", blocks(9), 100);
+	builderB.addFile(gamecode, company, "metadata", blocks(9), 200);
+
+	// "grown": A[13] -> B[13,14]
+	builderA.addFile(gamecode, company, "grown", blocks(13));
+	builderB.addFile(gamecode, company, "grown", blocks(13, 2));
+
+	// "unchanged": A[10,11] -> B[10,11]
+	builderA.addFile(gamecode, company, "unchanged", blocks(10, 2));
+	builderB.addFile(gamecode, company, "unchanged", blocks(10, 2));
+
+	const QString filenameA = tmpDir.path() + QLatin1String("/a.raw");
+	const QString filenameB = tmpDir.path() + QLatin1String("/b.raw");
+	QVERIFY(builderA.save(filenameA));
+	QVERIFY(builderB.save(filenameB));
+
+	cardA.reset(GcnCard::open(filenameA, nullptr));
+	cardB.reset(GcnCard::open(filenameB, nullptr));
+	QVERIFY(cardA && cardA->isOpen());
+	QVERIFY(cardB && cardB->isOpen());
+	QCOMPARE(cardA->fileCount(), 6);
+	QCOMPARE(cardB->fileCount(), 6);
+}
+
+/**
+ * Files are matched by game ID and filename,
+ * and each type of difference is reported.
+ */
+void CardDiffTest::compareFiles(void)
+{
+	CardDiff cardDiff(cardA.data(), cardB.data());
+	QVector<CardDiff::FileDiff> diffs;
+	QCOMPARE(cardDiff.compareFiles(diffs), 0);
+
+	// Unchanged files aren't reported.
+	const QHash<QString, CardDiff::FileDiff> diffMap = byFilename(diffs);
+	QCOMPARE(diffs.size(), 6);
+	QCOMPARE(diffMap.size(), 6);
+	QVERIFY(!diffMap.contains(QLatin1String("unchanged")));
+
+	CardDiff::FileDiff diff = diffMap.value(QLatin1String("moved"));
+	QCOMPARE(diff.flags, CardDiff::DiffFlags(CardDiff::DIFF_MOVED));
+	QCOMPARE(diff.gameID, QString(QLatin1String("GALE01")));
+	QVERIFY(diff.fileA != nullptr);
+	QVERIFY(diff.fileB != nullptr);
+	QVERIFY(diff.ranges.isEmpty());
+
+	diff = diffMap.value(QLatin1String("modified"));
+	QCOMPARE(diff.flags, CardDiff::DiffFlags(CardDiff::DIFF_MODIFIED));
+	QCOMPARE(diff.ranges.size(), 2);
+	QCOMPARE(diff.ranges[0].offset, 0x10U);
+	QCOMPARE(diff.ranges[0].length, 4U);
+	QCOMPARE(diff.ranges[1].offset, 0x100U);
+	QCOMPARE(diff.ranges[1].length, 1U);
+
+	diff = diffMap.value(QLatin1String("removed"));
+	QCOMPARE(diff.flags, CardDiff::DiffFlags(CardDiff::DIFF_REMOVED));
+	QVERIFY(diff.fileA != nullptr);
+	QVERIFY(diff.fileB == nullptr);
+	QCOMPARE(diff.ranges.size(), 1);
+	QCOMPARE(diff.ranges[0].offset, 0U);
+	QCOMPARE(diff.ranges[0].length, (uint32_t)GcnCardBuilder::BLOCK_SIZE);
+
+	diff = diffMap.value(QLatin1String("added"));
+	QCOMPARE(diff.flags, CardDiff::DiffFlags(CardDiff::DIFF_ADDED));
+	QVERIFY(diff.fileA == nullptr);
+	QVERIFY(diff.fileB != nullptr);
+	QCOMPARE(diff.ranges.size(), 1);
+	QCOMPARE(diff.ranges[0].offset, 0U);
+	QCOMPARE(diff.ranges[0].length, (uint32_t)GcnCardBuilder::BLOCK_SIZE);
+
+	diff = diffMap.value(QLatin1String("metadata"));
+	QCOMPARE(diff.flags, CardDiff::DiffFlags(CardDiff::DIFF_METADATA));
+	QVERIFY(diff.ranges.isEmpty());
+
+	// The directory entry's length changed, too.
+	diff = diffMap.value(QLatin1String("grown"));
+	QCOMPARE(diff.flags, CardDiff::DiffFlags(CardDiff::DIFF_MODIFIED |
+		CardDiff::DIFF_MOVED | CardDiff::DIFF_METADATA));
+	QCOMPARE(diff.ranges.size(), 1);
+	QCOMPARE(diff.ranges[0].offset, (uint32_t)GcnCardBuilder::BLOCK_SIZE);
+	QCOMPARE(diff.ranges[0].length, (uint32_t)GcnCardBuilder::BLOCK_SIZE);
+}
+
+/**
+ * Physical blocks are compared directly.
+ */
+void CardDiffTest::compareBlocks(void)
+{
+	CardDiff cardDiff(cardA.data(), cardB.data());
+	QVector<uint16_t> diffBlocks;
+	QCOMPARE(cardDiff.compareBlocks(diffBlocks), 0);
+
+	// Compare the images directly.
+	QFile fileA(cardA->filename());
+	QFile fileB(cardB->filename());
+	QVERIFY(fileA.open(QIODevice::ReadOnly));
+	QVERIFY(fileB.open(QIODevice::ReadOnly));
+	QVector<uint16_t> expected;
+	for (int i = 0; i < cardA->totalPhysBlocks(); i++) {
+		const QByteArray blockA = fileA.read(GcnCardBuilder::BLOCK_SIZE);
+		const QByteArray blockB = fileB.read(GcnCardBuilder::BLOCK_SIZE);
+		if (blockA != blockB) {
+			expected.append((uint16_t)i);
+		}
+	}
+	QCOMPARE(diffBlocks, expected);
+
+	// Header and data blocks for the "moved" file are the same.
+	// The directory and block tables, and the modified data, aren't.
+	QVERIFY(!diffBlocks.contains(0));
+	QVERIFY(diffBlocks.contains(1));
+	QVERIFY(diffBlocks.contains(3));
+	QVERIFY(!diffBlocks.contains(5));
+	QVERIFY(diffBlocks.contains(7));
+	QVERIFY(!diffBlocks.contains(10));
+}
+
+/**
+ * Comparing a card to itself doesn't find any differences.
+ */
+void CardDiffTest::sameCard(void)
+{
+	CardDiff cardDiff(cardA.data(), cardA.data());
+	QVector<CardDiff::FileDiff> diffs;
+	QCOMPARE(cardDiff.compareFiles(diffs), 0);
+	QVERIFY(diffs.isEmpty());
+
+	QVector<uint16_t> diffBlocks;
+	QCOMPARE(cardDiff.compareBlocks(diffBlocks), 0);
+	QVERIFY(diffBlocks.isEmpty());
+}
+
+/**
+ * Missing cards are rejected.
+ */
+void CardDiffTest::invalidCards(void)
+{
+	CardDiff cardDiff(cardA.data(), nullptr);
+	QVector<CardDiff::FileDiff> diffs;
+	QCOMPARE(cardDiff.compareFiles(diffs), -EINVAL);
+
+	QVector<uint16_t> diffBlocks;
+	QCOMPARE(cardDiff.compareBlocks(diffBlocks), -EINVAL);
+}
+
+QTEST_MAIN(CardDiffTest)
+
+#include "CardDiffTest.moc"
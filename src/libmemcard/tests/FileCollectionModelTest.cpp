@@ -0,0 +1,282 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]: Unit tests.         *
+ * FileCollectionModelTest.cpp: FileCollectionModel tests.                 *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "FileCollectionModel.hpp"
+#include "MemCardModel.hpp"
+#include "GcnCard.hpp"
+#include "GcnFile.hpp"
+
+#include "GcnCardBuilder.hpp"
+
+// C includes (C++ namespace)
+#include <cstring>
+
+// C++ includes
+#include <vector>
+using std::vector;
+
+// Qt includes
+#include <QtCore/QObject>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QStringList>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+
+class FileCollectionModelTest : public QObject
+{
+	Q_OBJECT
+
+	private:
+		QTemporaryDir tmpDir;
+		QString filenameA;
+		QString filenameB;
+		QScopedPointer<GcnCard> cardA;
+		QScopedPointer<GcnCard> cardB;
+
+		/**
+		 * Get the filenames of all rows in a model.
+		 * @param model Model
+		 * @return Filenames, in row order
+		 */
+		static QStringList filenames(const FileCollectionModel &model)
+		{
+			QStringList ret;
+			for (int row = 0; row < model.rowCount(); row++) {
+				ret.append(model.index(row, MemCardModel::COL_FILENAME).data().toString());
+			}
+			return ret;
+		}
+
+		/**
+		 * Add a "lost" file to card A.
+		 * @param filename Filename
+		 * @param block Block
+		 */
+		void addLostFile(const char *filename, uint16_t block)
+		{
+			const GcnFile *const src = qobject_cast<const GcnFile*>(cardA->getFile(0));
+			QVERIFY(src != nullptr);
+			card_direntry dirEntry = *src->dirEntry();
+			memset(dirEntry.filename, 0, sizeof(dirEntry.filename));
+			strncpy(dirEntry.filename, filename, sizeof(dirEntry.filename));
+			dirEntry.block = block;
+			QVERIFY(cardA->addLostFile(&dirEntry, vector<uint16_t>(1, block)) != nullptr);
+		}
+
+	private slots:
+		void initTestCase(void);
+		void init(void);
+		void cleanup(void);
+
+		void addCards(void);
+		void filesInserted(void);
+		void filesRemoved(void);
+		void removeCard(void);
+		void cardDestroyed(void);
+		void residentImages(void);
+};
+
+/**
+ * Create the two Memory Card images.
+ * Card A has "a0" through "a2"; card B has "b0" and "b1".
+ */
+void FileCollectionModelTest::initTestCase(void)
+{
+	QVERIFY(tmpDir.isValid());
+	filenameA = tmpDir.path() + QLatin1String("/a.raw");
+	filenameB = tmpDir.path() + QLatin1String("/b.raw");
+
+	GcnCardBuilder builderA, builderB;
+	static const char *const namesA[] = {"a0", "a1", "a2"};
+	static const char *const namesB[] = {"b0", "b1"};
+	for (int i = 0; i < 3; i++) {
+		builderA.fillBlock((uint16_t)(5 + i), (uint8_t)i);
+		builderA.addFile("GALE", "01", namesA[i], vector<uint16_t>(1, (uint16_t)(5 + i)), 100 * i);
+	}
+	for (int i = 0; i < 2; i++) {
+		builderB.fillBlock((uint16_t)(5 + i), (uint8_t)(0x80 + i));
+		builderB.addFile("GALE", "01", namesB[i], vector<uint16_t>(1, (uint16_t)(5 + i)), 100 * i);
+	}
+	QVERIFY(builderA.save(filenameA));
+	QVERIFY(builderB.save(filenameB));
+}
+
+void FileCollectionModelTest::init(void)
+{
+	cardA.reset(GcnCard::open(filenameA, nullptr));
+	cardB.reset(GcnCard::open(filenameB, nullptr));
+	QVERIFY(cardA && cardA->isOpen());
+	QVERIFY(cardB && cardB->isOpen());
+	QCOMPARE(cardA->fileCount(), 3);
+	QCOMPARE(cardB->fileCount(), 2);
+}
+
+void FileCollectionModelTest::cleanup(void)
+{
+	cardA.reset();
+	cardB.reset();
+}
+
+/**
+ * Files from multiple cards are shown in card order,
+ * and each row maps to the correct File.
+ */
+void FileCollectionModelTest::addCards(void)
+{
+	FileCollectionModel model;
+	model.addCard(cardA.data());
+	model.addCard(cardB.data());
+	// Adding a card twice doesn't do anything.
+	model.addCard(cardA.data());
+
+	QCOMPARE(model.cardCount(), 2);
+	QCOMPARE(model.rowCount(), 5);
+	QCOMPARE(model.columnCount(), (int)MemCardModel::COL_MAX);
+	QCOMPARE(filenames(model), QStringList() << QLatin1String("a0") << QLatin1String("a1")
+		<< QLatin1String("a2") << QLatin1String("b0") << QLatin1String("b1"));
+
+	for (int i = 0; i < 3; i++) {
+		QCOMPARE(model.file(i), cardA->getFile(i));
+	}
+	for (int i = 0; i < 2; i++) {
+		QCOMPARE(model.file(3 + i), cardB->getFile(i));
+	}
+	QVERIFY(model.file(5) == nullptr);
+
+	// Metadata matches the Files.
+	for (int row = 0; row < model.rowCount(); row++) {
+		const File *const file = model.file(row);
+		QCOMPARE(model.index(row, MemCardModel::COL_DESCRIPTION).data().toString(), file->description());
+		QCOMPARE(model.index(row, MemCardModel::COL_SIZE).data().toInt(), file->size());
+		QCOMPARE(model.index(row, MemCardModel::COL_MTIME).data().toDateTime(), file->mtime());
+		QCOMPARE(model.index(row, MemCardModel::COL_GAMEID).data().toString(), file->gameID());
+		QCOMPARE(model.index(row, 0).data(MemCardModel::ChecksumStatusRole).toInt(),
+			static_cast<int>(file->checksumStatus()));
+		QCOMPARE(model.index(row, 0).data(MemCardModel::LostFileRole).toBool(), false);
+	}
+}
+
+/**
+ * Files added to a card are inserted after its existing rows.
+ */
+void FileCollectionModelTest::filesInserted(void)
+{
+	FileCollectionModel model;
+	model.addCard(cardA.data());
+	model.addCard(cardB.data());
+
+	// Load the metadata before inserting rows.
+	QCOMPARE(filenames(model).size(), 5);
+
+	QSignalSpy spy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+	addLostFile("lost", 20);
+	QCOMPARE(spy.count(), 1);
+	QCOMPARE(spy.at(0).at(1).toInt(), 3);
+	QCOMPARE(spy.at(0).at(2).toInt(), 3);
+
+	QCOMPARE(model.rowCount(), 6);
+	QCOMPARE(filenames(model), QStringList() << QLatin1String("a0") << QLatin1String("a1")
+		<< QLatin1String("a2") << QLatin1String("lost") << QLatin1String("b0") << QLatin1String("b1"));
+	QCOMPARE(model.file(3), cardA->getFile(3));
+	QCOMPARE(model.index(3, 0).data(MemCardModel::LostFileRole).toBool(), true);
+	QCOMPARE(model.file(4), cardB->getFile(0));
+}
+
+/**
+ * Files removed from a card are removed from the model.
+ */
+void FileCollectionModelTest::filesRemoved(void)
+{
+	addLostFile("lost", 20);
+
+	FileCollectionModel model;
+	model.addCard(cardA.data());
+	model.addCard(cardB.data());
+	QCOMPARE(model.rowCount(), 6);
+
+	cardA->removeLostFiles();
+	QCOMPARE(model.rowCount(), 5);
+	QCOMPARE(filenames(model), QStringList() << QLatin1String("a0") << QLatin1String("a1")
+		<< QLatin1String("a2") << QLatin1String("b0") << QLatin1String("b1"));
+	QCOMPARE(model.file(3), cardB->getFile(0));
+}
+
+/**
+ * Removing a card removes its rows.
+ */
+void FileCollectionModelTest::removeCard(void)
+{
+	FileCollectionModel model;
+	model.addCard(cardA.data());
+	model.addCard(cardB.data());
+
+	model.removeCard(cardA.data());
+	QCOMPARE(model.cardCount(), 1);
+	QCOMPARE(model.rowCount(), 2);
+	QCOMPARE(model.file(0), cardB->getFile(0));
+	QCOMPARE(filenames(model), QStringList() << QLatin1String("b0") << QLatin1String("b1"));
+
+	// The card's signals are disconnected.
+	addLostFile("lost", 20);
+	QCOMPARE(model.rowCount(), 2);
+
+	model.clear();
+	QCOMPARE(model.cardCount(), 0);
+	QCOMPARE(model.rowCount(), 0);
+}
+
+/**
+ * Deleting a card removes its rows.
+ */
+void FileCollectionModelTest::cardDestroyed(void)
+{
+	FileCollectionModel model;
+	model.addCard(cardA.data());
+	model.addCard(cardB.data());
+
+	// Load the images for card A's files.
+	for (int row = 0; row < 3; row++) {
+		model.index(row, MemCardModel::COL_ICON).data(Qt::DecorationRole);
+	}
+
+	cardA.reset();
+	QCOMPARE(model.cardCount(), 1);
+	QCOMPARE(model.rowCount(), 2);
+	QCOMPARE(model.file(0), cardB->getFile(0));
+
+	// Trimming the images must not touch card A's deleted Files.
+	model.setMaxResidentImages(1);
+	QCOMPARE(model.maxResidentImages(), 1);
+}
+
+/**
+ * Images are reloaded after they're unloaded.
+ */
+void FileCollectionModelTest::residentImages(void)
+{
+	FileCollectionModel model;
+	model.setMaxResidentImages(1);
+	model.addCard(cardA.data());
+
+	// The files have no banners or icons, so the images
+	// are null, but they're still loaded and unloaded.
+	for (int pass = 0; pass < 2; pass++) {
+		for (int row = 0; row < model.rowCount(); row++) {
+			QVERIFY(model.index(row, MemCardModel::COL_ICON).data(Qt::DecorationRole).isValid());
+			QVERIFY(model.index(row, MemCardModel::COL_BANNER).data(Qt::DecorationRole).isValid());
+		}
+	}
+
+	// The metadata is still available.
+	QCOMPARE(filenames(model), QStringList() << QLatin1String("a0")
+		<< QLatin1String("a1") << QLatin1String("a2"));
+}
+
+QTEST_MAIN(FileCollectionModelTest)
+
+#include "FileCollectionModelTest.moc"
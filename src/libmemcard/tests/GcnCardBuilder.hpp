@@ -0,0 +1,232 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libmemcard]: Unit tests.         *
+ * GcnCardBuilder.hpp: Build GameCube Memory Card images for testing.      *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+#include "card.h"
+#include "Checksum.hpp"
+#include "util/byteswap.h"
+
+// C includes (C++ namespace)
+#include <cstring>
+
+// C++ includes
+#include <vector>
+
+// Qt includes
+#include <QtCore/QFile>
+#include <QtCore/QString>
+
+/**
+ * Build a GameCube Memory Card image with valid system blocks.
+ * Files are added to the directory and block tables, and
+ * their data blocks can be modified using block().
+ *
+ * Both directory tables and both block tables are identical.
+ */
+class GcnCardBuilder
+{
+	public:
+		static const int BLOCK_SIZE = 0x2000;
+
+		/**
+		 * Create a blank Memory Card image.
+		 * All user blocks are filled with 0x00.
+		 * @param totalPhysBlocks Total number of blocks, including system blocks.
+		 */
+		explicit GcnCardBuilder(int totalPhysBlocks = 256)
+			: totalPhysBlocks(totalPhysBlocks)
+			, image((size_t)totalPhysBlocks * BLOCK_SIZE, 0)
+		{ }
+
+	private:
+		Q_DISABLE_COPY(GcnCardBuilder)
+
+	public:
+		/**
+		 * Add a file.
+		 * @param gamecode Game code (4 characters)
+		 * @param company Company code (2 characters)
+		 * @param filename Filename
+		 * @param fatEntries FAT entries
+		 * @param lastModified Last modified time (seconds since 2000/01/01)
+		 */
+		void addFile(const char *gamecode, const char *company, const char *filename,
+			const std::vector<uint16_t> &fatEntries, uint32_t lastModified = 0)
+		{
+			File file;
+			memset(&file.dirEntry, 0xFF, sizeof(file.dirEntry));
+			memcpy(file.dirEntry.gamecode, gamecode, sizeof(file.dirEntry.gamecode));
+			memcpy(file.dirEntry.company, company, sizeof(file.dirEntry.company));
+			memset(file.dirEntry.filename, 0, sizeof(file.dirEntry.filename));
+			strncpy(file.dirEntry.filename, filename, sizeof(file.dirEntry.filename));
+			file.dirEntry.bannerfmt = CARD_BANNER_NONE;
+			file.dirEntry.lastmodified = lastModified;
+			file.dirEntry.iconaddr = 0xFFFFFFFF;
+			file.dirEntry.iconfmt = 0;
+			file.dirEntry.iconspeed = 0;
+			file.dirEntry.permission = CARD_ATTRIB_PUBLIC;
+			file.dirEntry.copytimes = 0;
+			file.dirEntry.block = (fatEntries.empty() ? 0xFFFF : fatEntries[0]);
+			file.dirEntry.length = (uint16_t)fatEntries.size();
+			file.dirEntry.commentaddr = 0;
+			file.fatEntries = fatEntries;
+			files.push_back(file);
+		}
+
+		/**
+		 * Get a block's data.
+		 * System blocks are overwritten by save().
+		 * @param blockIdx Block index
+		 * @return Block data (BLOCK_SIZE bytes)
+		 */
+		uint8_t *block(uint16_t blockIdx)
+		{
+			return &image[(size_t)blockIdx * BLOCK_SIZE];
+		}
+
+		/**
+		 * Fill a block with a byte pattern.
+		 * @param blockIdx Block index
+		 * @param seed Pattern seed
+		 */
+		void fillBlock(uint16_t blockIdx, uint8_t seed)
+		{
+			uint8_t *const data = block(blockIdx);
+			for (int i = 0; i < BLOCK_SIZE; i++) {
+				data[i] = (uint8_t)(seed + (i * 7));
+			}
+		}
+
+		/**
+		 * Write the Memory Card image to a file.
+		 * The system blocks are generated first.
+		 * @param filename Filename
+		 * @return True on success; false on error.
+		 */
+		bool save(const QString &filename)
+		{
+			buildHeader();
+			buildDirTable();
+			buildBlockTable();
+
+			QFile file(filename);
+			if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+				return false;
+			return (file.write(reinterpret_cast<const char*>(image.data()),
+				(qint64)image.size()) == (qint64)image.size());
+		}
+
+	private:
+		/**
+		 * Set a big-endian AddInvDual16 checksum.
+		 * @param chksum1 [out] Checksum 1 (big-endian)
+		 * @param chksum2 [out] Checksum 2 (big-endian)
+		 * @param data Data to checksum
+		 * @param siz Size of data
+		 */
+		static void setChecksum(uint16_t *chksum1, uint16_t *chksum2, const void *data, uint32_t siz)
+		{
+			const uint32_t chk = Checksum::AddInvDual16(
+				static_cast<const uint16_t*>(data), siz, Checksum::ChkEndian::Big);
+			*chksum1 = cpu_to_be16((uint16_t)(chk >> 16));
+			*chksum2 = cpu_to_be16((uint16_t)(chk & 0xFFFF));
+		}
+
+		/**
+		 * Build the header. (block 0)
+		 */
+		void buildHeader(void)
+		{
+			card_header header;
+			memset(&header, 0xFF, sizeof(header));
+			memset(header.serial, 0, sizeof(header.serial));
+			memset(&header.formatTime, 0, sizeof(header.formatTime));
+			header.sramBias = cpu_to_be32(0x17CA2A85U);
+			header.sramLang = cpu_to_be32(0);
+			memset(header.reserved1, 0, sizeof(header.reserved1));
+			header.device_id = cpu_to_be16(0);
+			header.size = cpu_to_be16((uint16_t)(totalPhysBlocks / 16));
+			header.encoding = cpu_to_be16(SYS_FONT_ENCODING_ANSI);
+			setChecksum(&header.chksum1, &header.chksum2, &header, 0x1FC);
+
+			memset(block(0), 0xFF, BLOCK_SIZE);
+			memcpy(block(0), &header, sizeof(header));
+		}
+
+		/**
+		 * Build the directory tables. (blocks 1, 2)
+		 */
+		void buildDirTable(void)
+		{
+			card_dat dat;
+			memset(&dat, 0xFF, sizeof(dat));
+			for (size_t i = 0; i < files.size() && i < CARD_MAXFILES; i++) {
+				card_direntry dirEntry = files[i].dirEntry;
+				dirEntry.lastmodified	= cpu_to_be32(dirEntry.lastmodified);
+				dirEntry.iconaddr	= cpu_to_be32(dirEntry.iconaddr);
+				dirEntry.iconfmt	= cpu_to_be16(dirEntry.iconfmt);
+				dirEntry.iconspeed	= cpu_to_be16(dirEntry.iconspeed);
+				dirEntry.block		= cpu_to_be16(dirEntry.block);
+				dirEntry.length		= cpu_to_be16(dirEntry.length);
+				dirEntry.commentaddr	= cpu_to_be32(dirEntry.commentaddr);
+				dat.entries[i] = dirEntry;
+			}
+			dat.dircntrl.updated = cpu_to_be16(0);
+			setChecksum(&dat.dircntrl.chksum1, &dat.dircntrl.chksum2, &dat, sizeof(dat) - 4);
+
+			memcpy(block(1), &dat, sizeof(dat));
+			memcpy(block(2), &dat, sizeof(dat));
+		}
+
+		/**
+		 * Build the block tables. (blocks 3, 4)
+		 */
+		void buildBlockTable(void)
+		{
+			std::vector<uint16_t> fat(totalPhysBlocks, 0);
+			uint16_t lastAlloc = 4;
+			for (const File &file : files) {
+				const size_t count = file.fatEntries.size();
+				for (size_t i = 0; i < count; i++) {
+					const uint16_t blockIdx = file.fatEntries[i];
+					fat[blockIdx] = (i + 1 < count ? file.fatEntries[i + 1] : 0xFFFF);
+					if (blockIdx > lastAlloc) {
+						lastAlloc = blockIdx;
+					}
+				}
+			}
+
+			card_bat bat;
+			memset(&bat, 0, sizeof(bat));
+			int freeBlocks = 0;
+			for (int i = 5; i < totalPhysBlocks; i++) {
+				bat.fat[i - 5] = cpu_to_be16(fat[i]);
+				if (fat[i] == 0) {
+					freeBlocks++;
+				}
+			}
+			bat.updated = cpu_to_be16(0);
+			bat.freeblocks = cpu_to_be16((uint16_t)freeBlocks);
+			bat.lastalloc = cpu_to_be16(lastAlloc);
+			setChecksum(&bat.chksum1, &bat.chksum2,
+				reinterpret_cast<const uint16_t*>(&bat) + 2, sizeof(bat) - 4);
+
+			memcpy(block(3), &bat, sizeof(bat));
+			memcpy(block(4), &bat, sizeof(bat));
+		}
+
+		struct File {
+			card_direntry dirEntry;		// Host-endian
+			std::vector<uint16_t> fatEntries;
+		};
+
+		int totalPhysBlocks;
+		std::vector<uint8_t> image;
+		std::vector<File> files;
+};
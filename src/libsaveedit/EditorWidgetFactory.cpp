@@ -12,9 +12,166 @@
 // Files.
 #include "libmemcard/File.hpp"
 
+// Qt includes.
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
 // Editor widgets.
 #include "SonicAdventure/SAEditor.hpp"
 
+/** Editor registry. **/
+
+/**
+ * Create an editor widget.
+ * @return Editor widget
+ */
+template<typename T>
+static EditorWidget *createEditor(void)
+{
+	return new T();
+}
+
+// Sonic Adventure
+static const char *const sa_gameIDs[] = {
+	// Sonic Adventure DX (GCN), all regions
+	// NOTE: Must match SAEditor::isFileSupported().
+	"GXS",
+	nullptr
+};
+static const char *const sa_filenames[] = {
+	// Sonic Adventure (DC)
+	"SONICADV_SYS", "SONICADV_INT",
+	nullptr
+};
+
+/**
+ * Registered editors.
+ * Add new editors here.
+ */
+static const EditorWidgetFactory::EditorDesc editors[] = {
+	{"Sonic Adventure", sa_gameIDs, sa_filenames,
+		SAEditor::isFileSupported, createEditor<SAEditor>},
+};
+
+/**
+ * Editor lookup tables.
+ * Built on first use.
+ */
+class EditorRegistry
+{
+	public:
+		EditorRegistry();
+
+	private:
+		Q_DISABLE_COPY(EditorRegistry)
+
+	public:
+		/**
+		 * Get the editor registry.
+		 * @return Editor registry
+		 */
+		static const EditorRegistry *instance(void);
+
+		/**
+		 * Find the first editor that supports the specified file.
+		 * @param file File
+		 * @return Editor descriptor, or nullptr if no editors support this file.
+		 */
+		const EditorWidgetFactory::EditorDesc *find(const File *file) const;
+
+	private:
+		typedef QVector<const EditorWidgetFactory::EditorDesc*> EditorList;
+
+		// Game ID (ID3, ID4, or ID6) -> editors
+		QHash<QString, EditorList> m_byGameID;
+		// Filename -> editors (for files without game IDs)
+		QHash<QString, EditorList> m_byFilename;
+
+		/**
+		 * Check the editors in a list.
+		 * @param list Editor list
+		 * @param file File
+		 * @return First editor that supports the file, or nullptr if none.
+		 */
+		static const EditorWidgetFactory::EditorDesc *check(const EditorList &list, const File *file);
+};
+
+EditorRegistry::EditorRegistry()
+{
+	for (const EditorWidgetFactory::EditorDesc &desc : editors) {
+		if (desc.gameIDs) {
+			for (const char *const *p = desc.gameIDs; *p != nullptr; p++) {
+				m_byGameID[QLatin1String(*p)].append(&desc);
+			}
+		}
+		if (desc.filenames) {
+			for (const char *const *p = desc.filenames; *p != nullptr; p++) {
+				m_byFilename[QLatin1String(*p)].append(&desc);
+			}
+		}
+	}
+}
+
+/**
+ * Get the editor registry.
+ * @return Editor registry
+ */
+const EditorRegistry *EditorRegistry::instance(void)
+{
+	// NOTE: Function-local statics are thread-safe in C++11.
+	static const EditorRegistry registry;
+	return &registry;
+}
+
+/**
+ * Check the editors in a list.
+ * @param list Editor list
+ * @param file File
+ * @return First editor that supports the file, or nullptr if none.
+ */
+const EditorWidgetFactory::EditorDesc *EditorRegistry::check(const EditorList &list, const File *file)
+{
+	for (const EditorWidgetFactory::EditorDesc *desc : list) {
+		if (desc->isFileSupported(file)) {
+			return desc;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Find the first editor that supports the specified file.
+ * @param file File
+ * @return Editor descriptor, or nullptr if no editors support this file.
+ */
+const EditorWidgetFactory::EditorDesc *EditorRegistry::find(const File *file) const
+{
+	const QString gameID = file->gameID();
+	if (gameID.isEmpty()) {
+		// No game ID. (e.g. Dreamcast VMU files)
+		// Look up the filename instead.
+		auto iter = m_byFilename.constFind(file->filename());
+		return (iter != m_byFilename.constEnd() ? check(*iter, file) : nullptr);
+	}
+
+	// Check ID6 first, then ID4, then ID3.
+	static const int idLengths[] = {6, 4, 3};
+	for (int len : idLengths) {
+		if (gameID.size() < len)
+			continue;
+		auto iter = m_byGameID.constFind(gameID.left(len));
+		if (iter != m_byGameID.constEnd()) {
+			const EditorWidgetFactory::EditorDesc *desc = check(*iter, file);
+			if (desc)
+				return desc;
+		}
+	}
+	return nullptr;
+}
+
+/** EditorWidgetFactory **/
+
 /**
  * Create an EditorWidget for the specified file.
  * @param file File to edit
@@ -22,20 +179,21 @@
  */
 EditorWidget *EditorWidgetFactory::createWidget(File *file)
 {
-	// Check if the file is supported by the various editors.
-	EditorWidget *widget = nullptr;
-	if (SAEditor::isFileSupported(file)) {
-		widget = new SAEditor();
+	// Check if the file is supported by the registered editors.
+	const EditorDesc *desc = EditorRegistry::instance()->find(file);
+	if (!desc) {
+		// No editors support this file.
+		return nullptr;
 	}
 
-	if (widget) {
-		// Found an EditorWidget that accepts this file.
-		if (widget->setFile(file) != 0) {
-			// Error opening the file...
-			// TODO: Error code.
-			delete widget;
-			widget = nullptr;
-		}
+	// Found an editor that accepts this file.
+	// The editor widget is only created here.
+	EditorWidget *widget = desc->create();
+	if (widget->setFile(file) != 0) {
+		// Error opening the file...
+		// TODO: Error code.
+		delete widget;
+		widget = nullptr;
 	}
 
 	return widget;
@@ -48,13 +206,5 @@ EditorWidget *EditorWidgetFactory::createWidget(File *file)
  */
 bool EditorWidgetFactory::isEditorAvailable(const File *file)
 {
-	// TODO: Register all editor widgets somewhere?
-
-	// Check if the file is supported by the various editors.
-	if (SAEditor::isFileSupported(file)) {
-		return true;
-	}
-
-	// No editors are available for this file.
-	return false;
+	return (EditorRegistry::instance()->find(file) != nullptr);
 }
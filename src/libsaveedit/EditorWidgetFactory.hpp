@@ -25,6 +25,21 @@ private:
 	Q_DISABLE_COPY(EditorWidgetFactory)
 
 public:
+	/**
+	 * Editor descriptor.
+	 * Editors are looked up by game ID (ID6, ID4, or ID3), or by
+	 * filename for files that don't have a game ID.
+	 * ID3 omits the region code, and matches all regions.
+	 * isFileSupported() is only called for matching editors.
+	 */
+	struct EditorDesc {
+		const char *name;			// Editor name
+		const char *const *gameIDs;		// ID3/ID4/ID6 (NULL-terminated)
+		const char *const *filenames;		// Filenames (NULL-terminated)
+		bool (*isFileSupported)(const File *file);
+		EditorWidget *(*create)(void);		// Create the editor widget.
+	};
+
 	/**
 	 * Create an EditorWidget for the specified file.
 	 * @param file File to edit
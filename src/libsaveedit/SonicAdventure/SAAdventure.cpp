@@ -22,6 +22,7 @@
 
 // Sonic Adventure save file definitions.
 #include "sa_defs.h"
+#include "SASlotView.hpp"
 
 // Common data.
 #include "SAData.h"
@@ -339,14 +340,14 @@ void SAAdventure::changeEvent(QEvent *event)
 
 /**
  * Load data from a Sonic Adventure save slot.
- * @param sa_save Sonic Adventure save slot.
- * The data must have already been byteswapped to host-endian.
+ * @param sa_view Sonic Adventure save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SAAdventure::load(const sa_save_slot *sa_save)
+int SAAdventure::load(const SASlotView &sa_view)
 {
 	Q_D(SAAdventure);
 	suspendHasBeenModified();
+	const sa_save_slot *const sa_save = sa_view.slot();
 
 	// Life counters.
 	for (int i = SAAdventurePrivate::TOTAL_CHARACTERS-1; i >= 0; i--) {
@@ -379,20 +380,16 @@ int SAAdventure::load(const sa_save_slot *sa_save)
 		d->characters[i].cboTimeOfDay->setCurrentIndex(
 			sa_save->adventure_mode.chr[chr].time_of_day);
 		d->characters[i].spnEntrance->setValue(
-			sa_save->adventure_mode.chr[chr].start_entrance);
-		d->characters[i].cboLevelName->setCurrentIndex(
-			sa_save->adventure_mode.chr[chr].start_level_and_act >> 8);
-		d->characters[i].spnLevelAct->setValue(
-			sa_save->adventure_mode.chr[chr].start_level_and_act & 0xFF);
+			sa_view.advStartEntrance(chr));
+		const uint16_t start_level_and_act = sa_view.advStartLevelAndAct(chr);
+		d->characters[i].cboLevelName->setCurrentIndex(start_level_and_act >> 8);
+		d->characters[i].spnLevelAct->setValue(start_level_and_act & 0xFF);
 
 #ifndef DONT_SHOW_UNKNOWN
 		// "Unknown" values.
-		d->characters[i].spnUnknown[0]->setValue(
-			sa_save->adventure_mode.chr[chr].unknown1);
-		d->characters[i].spnUnknown[1]->setValue(
-			sa_save->adventure_mode.chr[chr].unknown2);
-		d->characters[i].spnUnknown[2]->setValue(
-			sa_save->adventure_mode.chr[chr].unknown3);
+		d->characters[i].spnUnknown[0]->setValue(sa_view.advUnknown1(chr));
+		d->characters[i].spnUnknown[1]->setValue(sa_view.advUnknown2(chr));
+		d->characters[i].spnUnknown[2]->setValue(sa_view.advUnknown3(chr));
 #endif
 	}
 
@@ -403,13 +400,13 @@ int SAAdventure::load(const sa_save_slot *sa_save)
 
 /**
  * Save data to a Sonic Adventure save slot.
- * @param sa_save Sonic Adventure save slot.
- * The data will be in host-endian format.
+ * @param sa_view Sonic Adventure save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SAAdventure::save(sa_save_slot *sa_save)
+int SAAdventure::save(SASlotView &sa_view)
 {
 	Q_D(const SAAdventure);
+	sa_save_slot *const sa_save = sa_view.slot();
 
 	// Life counters.
 	for (int i = SAAdventurePrivate::TOTAL_CHARACTERS-1; i >= 0; i--) {
@@ -444,21 +441,18 @@ int SAAdventure::save(sa_save_slot *sa_save)
 		// TODO: Validate the data.
 		sa_save->adventure_mode.chr[chr].time_of_day =
 			d->characters[i].cboTimeOfDay->currentIndex();
-		sa_save->adventure_mode.chr[chr].start_entrance =
+		sa_view.advStartEntrance(chr) =
 			d->characters[i].spnEntrance->value();
 		// TODO: Masking is probably not needed here.
-		sa_save->adventure_mode.chr[chr].start_level_and_act =
+		sa_view.advStartLevelAndAct(chr) =
 			((d->characters[i].cboLevelName->currentIndex() & 0xFF) << 8) |
 			 (d->characters[i].spnLevelAct->value() & 0xFF);
 
 #ifndef DONT_SHOW_UNKNOWN
 		// "Unknown" values.
-		sa_save->adventure_mode.chr[chr].unknown1 =
-			d->characters[i].spnUnknown[0]->value();
-		sa_save->adventure_mode.chr[chr].unknown2 =
-			d->characters[i].spnUnknown[1]->value();
-		sa_save->adventure_mode.chr[chr].unknown3 =
-			d->characters[i].spnUnknown[2]->value();
+		sa_view.advUnknown1(chr) = d->characters[i].spnUnknown[0]->value();
+		sa_view.advUnknown2(chr) = d->characters[i].spnUnknown[1]->value();
+		sa_view.advUnknown3(chr) = d->characters[i].spnUnknown[2]->value();
 #endif
 	}
 
@@ -10,7 +10,7 @@
 
 #include "SAEditWidget.hpp"
 
-struct _sadx_extra_save_slot;
+class SADXSlotView;
 
 class SADXEditWidget : public SAEditWidget
 {
@@ -27,18 +27,18 @@ class SADXEditWidget : public SAEditWidget
 	public:
 		/**
 		 * Load data from a Sonic Adventure DX extra save slot.
-		 * @param sadx_extra_save Sonic Adventure DX extra save slot.
-		 * The data must have already been byteswapped to host-endian.
-		 * If nullptr, SADX editor components will be hidden.
+		 * @param sadx_view Sonic Adventure DX extra save slot view.
+		 * Multi-byte fields must be read using the view's accessors.
+		 * If the view is null, SADX editor components will be hidden.
 		 * @return 0 on success; non-zero on error.
 		 */
-		virtual int loadDX(const _sadx_extra_save_slot *sadx_extra_save) = 0;
+		virtual int loadDX(const SADXSlotView &sadx_view) = 0;
 
 		/**
 		 * Save data to a Sonic Adventure DX extra save slot.
-		 * @param sadx_extra_save Sonic Adventure DX extra save slot.
-		 * The data will be in host-endian format.
+		 * @param sadx_view Sonic Adventure DX extra save slot view.
+		 * Multi-byte fields must be written using the view's accessors.
 		 * @return 0 on success; non-zero on error.
 		 */
-		virtual int saveDX(_sadx_extra_save_slot *sadx_extra_save) = 0;
+		virtual int saveDX(SADXSlotView &sadx_view) = 0;
 };
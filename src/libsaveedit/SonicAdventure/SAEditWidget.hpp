@@ -11,7 +11,7 @@
 #include <QWidget>
 #include <cassert>
 
-struct _sa_save_slot;
+class SASlotView;
 
 class SAEditWidget : public QWidget
 {
@@ -105,17 +105,17 @@ class SAEditWidget : public QWidget
 	public:
 		/**
 		 * Load data from a Sonic Adventure save slot.
-		 * @param sa_save Sonic Adventure save slot.
-		 * The data must have already been byteswapped to host-endian.
+		 * @param sa_view Sonic Adventure save slot view.
+		 * Multi-byte fields must be read using the view's accessors.
 		 * @return 0 on success; non-zero on error.
 		 */
-		virtual int load(const _sa_save_slot *sa_save) = 0;
+		virtual int load(const SASlotView &sa_view) = 0;
 
 		/**
 		 * Save data to a Sonic Adventure save slot.
-		 * @param sa_save Sonic Adventure save slot.
-		 * The data will be in host-endian format.
+		 * @param sa_view Sonic Adventure save slot view.
+		 * Multi-byte fields must be written using the view's accessors.
 		 * @return 0 on success; non-zero on error.
 		 */
-		virtual int save(_sa_save_slot *sa_save) = 0;
+		virtual int save(SASlotView &sa_view) = 0;
 };
@@ -11,6 +11,8 @@
 // C includes (C++ namespace)
 #include <cstdlib>
 #include <cassert>
+#include <cerrno>
+#include <cstring>
 
 // C++ includes
 #include <vector>
@@ -26,6 +28,7 @@ using std::vector;
 
 #include "util/byteswap.h"
 #include "sa_defs.h"
+#include "SASlotView.hpp"
 
 // BitFlags
 #include "../models/BitFlagsModel.hpp"
@@ -60,9 +63,26 @@ private:
 public:
 	Ui::SAEditor ui;
 
-	// sa_save_slot structs
-	vector<sa_save_slot*> data_main;
-	vector<sadx_extra_save_slot*> data_sadx;
+	// File data.
+	// The save slots are edited in place, in file byte order.
+	QByteArray fileData;
+
+	// File format.
+	enum class Format {
+		None,
+		DC,	// Dreamcast (three slots, little-endian)
+		GCN,	// GameCube (one slot plus SADX extras, big-endian)
+	};
+	Format format;
+
+	// Save slots. (views of fileData)
+	// data_sadx has null views if the file doesn't have SADX extras.
+	vector<SASlotView> data_main;
+	vector<SADXSlotView> data_sadx;
+
+	// Save slots that may have been modified. (bitfield)
+	// Only these slots have their checksums recalculated.
+	unsigned int dirtySlots;
 
 	// Editor widgets (non-flags)
 	vector<SAEditWidget*> saEditWidgets;
@@ -90,7 +110,7 @@ public:
 	int load(File *file);
 
 	/**
-	 * Clear the sa_save_slot structs.
+	 * Clear the file data and save slots.
 	 */
 	void clear(void);
 
@@ -103,22 +123,12 @@ public:
 	 * Save data for the current slot.
 	 */
 	void saveCurrentSlot(void);
-
-	/**
-	 * Byteswap an sa_save_slot.
-	 * @param sa_save sa_save_slot
-	 */
-	static void byteswap_sa_save_slot(sa_save_slot *sa_save);
-
-	/**
-	 * Byteswap an sadx_extra_save_slot.
-	 * @param sadx_extra_save sadx_extra_save_slot
-	 */
-	static void byteswap_sadx_extra_save_slot(sadx_extra_save_slot *sadx_extra_save);
 };
 
 SAEditorPrivate::SAEditorPrivate(SAEditor* q)
 	: super(q)
+	, format(Format::None)
+	, dirtySlots(0)
 	, saEventFlagsModel(nullptr)
 	, saNPCFlagsModel(nullptr)
 	, sadxMissionFlagsModel(nullptr)
@@ -141,7 +151,8 @@ int SAEditorPrivate::load(File *file)
 	clear();
 
 	// Read the new file.
-	QByteArray data = file->loadFileData();
+	// The save slots are edited in place within this buffer.
+	fileData = file->loadFileData();
 
 	// Determine which version of the game this save file is for.
 	// TODO: Test for GCN first, then DC?
@@ -151,51 +162,46 @@ int SAEditorPrivate::load(File *file)
 		// DC version.
 
 		// Three, count 'em, *three* save slots!
+		if (fileData.size() < (int)(SA_SAVE_ADDRESS_DC_0 + (sizeof(sa_save_slot) * 3))) {
+			// File is too small.
+			ret = -EIO;
+			goto end;
+		}
+
+		format = Format::DC;
 		data_main.reserve(3);
 		data_sadx.reserve(3);
-		const char *src = (data.data() + SA_SAVE_ADDRESS_DC_0);
+		char *src = (fileData.data() + SA_SAVE_ADDRESS_DC_0);
 		for (int i = 0; i < 3; i++, src += sizeof(sa_save_slot)) {
-			sa_save_slot *const sa_save = new sa_save_slot;
-			memcpy(sa_save, src, sizeof(*sa_save));
-			data_main.push_back(sa_save);
-			data_sadx.push_back(nullptr);	// DC version - no SADX extras.
-#if SYS_BYTEORDER == SYS_BIG_ENDIAN
-			// Byteswap the data.
 			// Dreamcast's SH-4 is little-endian.
-			byteswap_sa_save_slot(sa_save);
-#endif /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
-
-			// Loaded successfully.
-			ret = 0;
+			data_main.push_back(SASlotView(src, SYS_LIL_ENDIAN));
+			data_sadx.push_back(SADXSlotView());	// DC version - no SADX extras.
 		}
+
+		// Loaded successfully.
+		ret = 0;
 	} else if (qobject_cast<GcnFile*>(file) != nullptr) {
 		// GameCube verison.
 
 		// Only one save slot.
-		sa_save_slot *const sa_save = new sa_save_slot;
-		memcpy(sa_save, (data.data() + SA_SAVE_ADDRESS_GCN), sizeof(*sa_save));
-		data_main.push_back(sa_save);
+		if (fileData.size() < (int)(SA_SAVE_ADDRESS_GCN + sizeof(sa_save_slot))) {
+			// File is too small.
+			ret = -EIO;
+			goto end;
+		}
 
-#if SYS_BYTEORDER == SYS_LIL_ENDIAN
-		// Byteswap the data.
+		format = Format::GCN;
 		// GameCube's PowerPC 750 is big-endian.
-		byteswap_sa_save_slot(sa_save);
-#endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
+		char *const src = (fileData.data() + SA_SAVE_ADDRESS_GCN);
+		data_main.push_back(SASlotView(src, SYS_BIG_ENDIAN));
 
 		// Check for SADX extras.
-		if (data.size() >= (int)(SA_SAVE_ADDRESS_GCN + sizeof(*sa_save) + sizeof(sadx_extra_save_slot))) {
+		if (fileData.size() >= (int)(SA_SAVE_ADDRESS_GCN + sizeof(sa_save_slot) + sizeof(sadx_extra_save_slot))) {
 			// Found SADX extras.
-			sadx_extra_save_slot *const sadx_extra_save = new sadx_extra_save_slot;
-			memcpy(sadx_extra_save, (data.data() + SA_SAVE_ADDRESS_GCN + sizeof(*sa_save)), sizeof(*sadx_extra_save));
-			data_sadx.push_back(sadx_extra_save);
-#if SYS_BYTEORDER == SYS_LIL_ENDIAN
-			// Byteswap the data.
-			// GameCube's PowerPC 750 is big-endian.
-			byteswap_sadx_extra_save_slot(sadx_extra_save);
-#endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
+			data_sadx.push_back(SADXSlotView(src + sizeof(sa_save_slot), SYS_BIG_ENDIAN));
 		} else {
 			// No SADX extras.
-			data_sadx.push_back(nullptr);
+			data_sadx.push_back(SADXSlotView());
 		}
 
 		// Loaded successfully.
@@ -211,6 +217,9 @@ end:
 	if (ret == 0) {
 		// File loaded successfully.
 		this->file = file;
+	} else {
+		// Error loading the file.
+		clear();
 	}
 
 	// Update the display.
@@ -218,28 +227,24 @@ end:
 	setSaveSlots(data_main.size());
 	setGeneralSettings(false);
 	q->setCurrentSaveSlot(0);
-	updateDisplay();
+	if (!data_main.empty()) {
+		updateDisplay();
+	}
 	return ret;
 }
 
 /**
- * Clear the sa_save_slot structs.
+ * Clear the file data and save slots.
  */
 void SAEditorPrivate::clear(void)
 {
-	// Delete all loaded sa_save_slot structs.
-	// NOTE: sa_save_slot is allocated using new, so use delete.
-	for (sa_save_slot *sa_save : data_main) {
-		delete sa_save;
-	}
+	// NOTE: The save slots point into fileData,
+	// so they don't need to be deleted.
 	data_main.clear();
-
-	// Delete loaded SADX extra save structs.
-	// NOTE: sadx_extra_save_slot is allocated using new, so use delete.
-	for (sadx_extra_save_slot *sadx_extra_save : data_sadx) {
-		delete sadx_extra_save;
-	}
 	data_sadx.clear();
+	fileData.clear();
+	format = Format::None;
+	dirtySlots = 0;
 }
 
 /**
@@ -250,12 +255,13 @@ void SAEditorPrivate::updateDisplay(void)
 	assert(this->currentSaveSlot >= 0 && this->currentSaveSlot < this->saveSlots);
 
 	// Display the data.
-	const sa_save_slot *sa_save = data_main.at(this->currentSaveSlot);
+	const SASlotView &sa_view = data_main.at(this->currentSaveSlot);
 	for (SAEditWidget *saEditWidget : saEditWidgets) {
-		saEditWidget->load(sa_save);
+		saEditWidget->load(sa_view);
 	}
 
 	// Bit flags.
+	const sa_save_slot *const sa_save = sa_view.slot();
 	saEventFlags.setAllFlags(&sa_save->events.all[0], NUM_ELEMENTS(sa_save->events.all));
 	saNPCFlags.setAllFlags(&sa_save->npc.all[0], NUM_ELEMENTS(sa_save->npc.all));
 
@@ -266,17 +272,18 @@ void SAEditorPrivate::updateDisplay(void)
 	// http://qt-project.org/forums/viewthread/24364
 	Q_Q(SAEditor);
 	const int missions_tab_idx = ui.tabWidget->indexOf(ui.tabMissions);
-	const sadx_extra_save_slot *sadx_extra_save = nullptr;
-	if (this->currentSaveSlot < data_sadx.size()) {
-		sadx_extra_save = data_sadx.at(this->currentSaveSlot);
+	SADXSlotView sadx_view;
+	if (this->currentSaveSlot < (int)data_sadx.size()) {
+		sadx_view = data_sadx.at(this->currentSaveSlot);
 	}
-	if (sadx_extra_save) {
+	if (!sadx_view.isNull()) {
 		// SADX extra data found. Load it.
 		for (SADXEditWidget *sadxEditWidget : sadxEditWidgets) {
-			sadxEditWidget->loadDX(sadx_extra_save);
+			sadxEditWidget->loadDX(sadx_view);
 		}
 
 		// Missions.
+		const sadx_extra_save_slot *const sadx_extra_save = sadx_view.slot();
 		sadxMissionFlags.setAllFlags(&sadx_extra_save->missions[0],
 				NUM_ELEMENTS(sadx_extra_save->missions));
 
@@ -289,7 +296,7 @@ void SAEditorPrivate::updateDisplay(void)
 		// No SADX extra data.
 		// Make sure the SADX sections are hidden.
 		for (SADXEditWidget *sadxEditWidget : sadxEditWidgets) {
-			sadxEditWidget->loadDX(nullptr);
+			sadxEditWidget->loadDX(sadx_view);
 		}
 
 		if (missions_tab_idx >= 0) {
@@ -311,9 +318,13 @@ void SAEditorPrivate::saveCurrentSlot(void)
 	assert(this->currentSaveSlot >= 0 && this->currentSaveSlot < this->saveSlots);
 
 	// Save the data.
-	sa_save_slot *sa_save = data_main[this->currentSaveSlot];
+	// A copy of the slot is kept so we can tell if anything changed.
+	// Switching slots without editing anything doesn't dirty the slot.
+	SASlotView &sa_view = data_main[this->currentSaveSlot];
+	sa_save_slot *const sa_save = sa_view.slot();
+	const sa_save_slot sa_save_old = *sa_save;
 	for (SAEditWidget *saEditWidget : saEditWidgets) {
-		saEditWidget->save(sa_save);
+		saEditWidget->save(sa_view);
 	}
 
 	// Bit flags.
@@ -321,90 +332,29 @@ void SAEditorPrivate::saveCurrentSlot(void)
 	saNPCFlags.allFlags(&sa_save->npc.all[0], NUM_ELEMENTS(sa_save->npc.all));
 
 	// SADX extra data?
-	sadx_extra_save_slot *sadx_extra_save = nullptr;
-	if (this->currentSaveSlot < data_sadx.size()) {
-		sadx_extra_save = data_sadx.at(this->currentSaveSlot);
+	SADXSlotView sadx_view;
+	if (this->currentSaveSlot < (int)data_sadx.size()) {
+		sadx_view = data_sadx.at(this->currentSaveSlot);
 	}
-	if (sadx_extra_save) {
+	bool modified = (memcmp(&sa_save_old, sa_save, sizeof(*sa_save)) != 0);
+	if (!sadx_view.isNull()) {
 		// SADX extra data found. Save it.
+		sadx_extra_save_slot *const sadx_extra_save = sadx_view.slot();
+		const sadx_extra_save_slot sadx_extra_save_old = *sadx_extra_save;
 		for (SADXEditWidget *sadxEditWidget : sadxEditWidgets) {
-			sadxEditWidget->saveDX(sadx_extra_save);
+			sadxEditWidget->saveDX(sadx_view);
 		}
 
 		// Missions.
 		sadxMissionFlags.allFlags(&sadx_extra_save->missions[0],
 				NUM_ELEMENTS(sadx_extra_save->missions));
-	}
-}
 
-/**
- * Byteswap an sa_save_slot.
- * @param sa_save sa_save_slot
- */
-void SAEditorPrivate::byteswap_sa_save_slot(sa_save_slot *sa_save)
-{
-	sa_save->playTime = __swab32(sa_save->playTime);
-
-	// TODO: Combine a few of these loops?
-	for (int i = 0; i < NUM_ELEMENTS(sa_save->scores.all); i++) {
-		sa_save->scores.all[i] = __swab32(sa_save->scores.all[i]);
-	}
-	for (int i = 0; i < NUM_ELEMENTS(sa_save->weights.all); i++) {
-		sa_save->weights.all[i] = __swab16(sa_save->weights.all[i]);
-	}
-	for (int i = 0; i < NUM_ELEMENTS(sa_save->rings.all); i++) {
-		sa_save->rings.all[i] = __swab16(sa_save->rings.all[i]);
-	}
-	for (int i = 0; i < NUM_ELEMENTS(sa_save->mini_game_scores.all); i++) {
-		sa_save->mini_game_scores.all[i] = __swab32(sa_save->mini_game_scores.all[i]);
-	}
-
-	sa_save->last_level = __swab16(sa_save->last_level);
-
-	// Adventure mode.
-	for (int i = 0; i < NUM_ELEMENTS(sa_save->adventure_mode.chr); i++) {
-		// NOTE: We can't use __swab16() to byteswap
-		// int16_t due to sign extension.
-		// TODO: Move to byteswap.h?
-		#define signed_swab16(x) ((((x) >> 8) & 0xFF) | (((x) & 0xFF) << 8))
-		sa_save->adventure_mode.chr[i].unknown1 =
-			signed_swab16(sa_save->adventure_mode.chr[i].unknown1);
-		sa_save->adventure_mode.chr[i].unknown2 =
-			signed_swab16(sa_save->adventure_mode.chr[i].unknown2);
-		sa_save->adventure_mode.chr[i].start_entrance =
-			__swab16(sa_save->adventure_mode.chr[i].start_entrance);
-		sa_save->adventure_mode.chr[i].start_level_and_act =
-			__swab16(sa_save->adventure_mode.chr[i].start_level_and_act);
-		sa_save->adventure_mode.chr[i].unknown3 =
-			signed_swab16(sa_save->adventure_mode.chr[i].unknown3);
-	}
-}
-
-/**
- * Byteswap an sadx_extra_save_slot.
- * @param sadx_extra_save sadx_extra_save_slot
- */
-void SAEditorPrivate::byteswap_sadx_extra_save_slot(sadx_extra_save_slot *sadx_extra_save)
-{
-	// Black Market rings.
-	sadx_extra_save->rings_black_market = __swab32(sadx_extra_save->rings_black_market);
-
-	// Metal Sonic level stats.
-	for (int i = 0; i < 10; i++) {
-		sadx_extra_save->scores_metal[i] =
-			__swab32(sadx_extra_save->scores_metal[i]);
-		sadx_extra_save->rings_metal[i]  =
-			__swab16(sadx_extra_save->rings_metal[i]);
+		modified |= (memcmp(&sadx_extra_save_old, sadx_extra_save, sizeof(*sadx_extra_save)) != 0);
 	}
 
-	// Metal Sonic mini-game scores.
-	for (int i = 0; i < NUM_ELEMENTS(sadx_extra_save->mini_game_scores_metal.all); i++) {
-		sadx_extra_save->mini_game_scores_metal.all[i] =
-			__swab32(sadx_extra_save->mini_game_scores_metal.all[i]);
+	if (modified) {
+		dirtySlots |= (1U << this->currentSaveSlot);
 	}
-
-	// Metal Sonic emblems. (32-bit bitfield, host-endian.)
-	sadx_extra_save->emblems_metal = __swab32(sadx_extra_save->emblems_metal);
 }
 
 /** SAEditor **/
@@ -593,113 +543,77 @@ int SAEditor::save(void)
 		return -EROFS;
 
 	// Make sure the current slot is saved.
+	// NOTE: The save slots are edited in place in fileData,
+	// in file byte order, so the data doesn't need to be
+	// copied or byteswapped.
 	d->saveCurrentSlot();
 
-	// Read the existing file data first.
-	QByteArray data = d->file->loadFileData();
-
-	// Determine which version of the game this save file is for.
-	// TODO: Test for GCN first, then DC?
-	int ret = -EINVAL;
-	if (qobject_cast<VmuFile*>(d->file) != nullptr) {
-		// DC version.
-
-		// Three, count 'em, *three* save slots!
-		char *dest = (data.data() + SA_SAVE_ADDRESS_DC_0);
-		for (size_t i = 0; i < 3; i++, dest += sizeof(sa_save_slot)) {
-			sa_save_slot *const sa_save = reinterpret_cast<sa_save_slot*>(dest);
-			assert(d->data_main.size() > i);
-			if (d->data_main.size() > i) {
-				// Save the slot.
-				memcpy(sa_save, d->data_main.at(i), sizeof(*sa_save));
-#if SYS_BYTEORDER == SYS_BIG_ENDIAN
-				// Byteswap the data.
-				// Dreamcast's SH-4 is little-endian.
-				d->byteswap_sa_save_slot(sa_save);
-#endif /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
-			} else {
-				// No save slot available...
-				// Zero out the data.
-				memset(sa_save, 0, sizeof(*sa_save));
-			}
-
-			// Update the checksums.
-			// TODO: Not tested!
+	// Update the checksums.
+	int ret;
+	switch (d->format) {
+		case SAEditorPrivate::Format::DC: {
+			// DC version.
 			// Note that there are two sets of checksums:
 			// - Game checksum (CRC-16) [one per slot]
 			// - VMS checksum (custom)
-			uint8_t *src = (uint8_t*)data.data() + SA_SAVE_ADDRESS_DC_0;
-			for (int i = 0; i < 3; i++, src += sizeof(*sa_save)) {
-				uint16_t crc16 = Checksum::Crc16(src + 4, sizeof(*sa_save) - 4);
+			// TODO: Not tested!
+
+			// Game checksums. Unmodified slots keep their checksums.
+			for (size_t i = 0; i < d->data_main.size(); i++) {
+				if (!(d->dirtySlots & (1U << i)))
+					continue;
+				uint8_t *const src = reinterpret_cast<uint8_t*>(d->data_main[i].slot());
+				uint16_t crc16 = Checksum::Crc16(src + 4, sizeof(sa_save_slot) - 4);
 				crc16 = cpu_to_le16(crc16);
 				memcpy(src + 2, &crc16, sizeof(crc16));
 			}
 
-			// VMS checksum.
-			uint16_t vmschk = Checksum::DreamcastVMU(src, data.size(), 0x46);
+			// VMS checksum. (in the VMS header at the start of the file)
+			uint8_t *const data = reinterpret_cast<uint8_t*>(d->fileData.data());
+			uint16_t vmschk = Checksum::DreamcastVMU(data, d->fileData.size(), 0x46);
 			vmschk = cpu_to_le16(vmschk);
-			memcpy(&src[0x46], &vmschk, sizeof(vmschk));
-
-			// Save slots copied.
-			// Now it needs to be written to the file.
+			memcpy(&data[0x46], &vmschk, sizeof(vmschk));
+			ret = 0;
+			break;
 		}
-	} else if (qobject_cast<GcnFile*>(d->file) != nullptr) {
-		// GameCube verison.
 
-		// Only one save slot.
-		sa_save_slot *const sa_save = reinterpret_cast<sa_save_slot*>
-			(data.data() + SA_SAVE_ADDRESS_GCN);
-		assert(d->data_main.size() > 0);
-		if (d->data_main.size() > 0) {
-			memcpy(sa_save, d->data_main.at(0), sizeof(*sa_save));
-#if SYS_BYTEORDER == SYS_LIL_ENDIAN
-			// Byteswap the data.
-			// GameCube's PowerPC 750 is big-endian.
-			d->byteswap_sa_save_slot(sa_save);
-#endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
-		} else {
-			// No save slot available...
-			// Zero out the data.
-			memset(sa_save, 0, sizeof(*sa_save));
+		case SAEditorPrivate::Format::GCN: {
+			// GameCube version.
+			// The checksum covers the save slot and the SADX extras.
+			uint32_t len = sizeof(sa_save_slot);
+			if (!d->data_sadx.empty() && !d->data_sadx.at(0).isNull()) {
+				len += sizeof(sadx_extra_save_slot);
+			}
+			uint16_t crc16 = Checksum::Crc16(
+				reinterpret_cast<const uint8_t*>(d->fileData.constData()) + SA_SAVE_ADDRESS_GCN + 4, len - 4);
+			crc16 = cpu_to_be16(crc16);
+			memcpy(d->fileData.data() + SA_SAVE_ADDRESS_GCN + 2, &crc16, sizeof(crc16));
+			ret = 0;
+			break;
 		}
 
-		// Check for SADX extras.
-		sadx_extra_save_slot *const sadx_extra_save = reinterpret_cast<sadx_extra_save_slot*>
-			(data.data() + SA_SAVE_ADDRESS_GCN + sizeof(*sa_save));
-		if (d->data_sadx.size() > 0) {
-			// Found SADX extras.
-			memcpy(sadx_extra_save, d->data_sadx.at(0), sizeof(*sadx_extra_save));
-#if SYS_BYTEORDER == SYS_LIL_ENDIAN
-			// Byteswap the data.
-			// GameCube's PowerPC 750 is big-endian.
-			d->byteswap_sadx_extra_save_slot(sadx_extra_save);
-#endif /* SYS_BYTEORDER == SYS_LIL_ENDIAN */
+		default:
+			// Unsupported file.
+			// TODO: Add support for the Windows version.
+			ret = -ENOSYS;
+			break;
+	}
+
+	if (ret == 0) {
+		// Write the data.
+		ret = d->file->write(0, d->fileData.constData(), d->fileData.size());
+		if (ret == 0) {
+			// Commit the changes to the card image.
+			ret = d->file->card()->commit();
 		} else {
-			// No SADX extras.
-			// Zero out the data.
-			memset(sadx_extra_save, 0, sizeof(*sadx_extra_save));
+			// Discard the partial write.
+			d->file->card()->rollback();
 		}
-
-		// Update the checksum.
-		uint16_t crc16 = Checksum::Crc16((const uint8_t*)data.data() + SA_SAVE_ADDRESS_GCN + 4,
-			sizeof(*sa_save) + sizeof(*sadx_extra_save) - 4);
-		crc16 = cpu_to_be16(crc16);
-		memcpy(data.data() + 0x1442, &crc16, sizeof(crc16));
-
-		// Save slots copied.
-		// Now it needs to be written to the file.
-		ret = 0;
-	} else {
-		// Unsupported file.
-		// TODO: Add support for the Windows version.
-		ret = -ENOSYS;
-		goto end;
 	}
 
-	// Write the data.
-	ret = d->file->write(0, data.data(), data.size());
-
-end:
+	if (ret == 0) {
+		d->dirtySlots = 0;
+	}
 	return ret;
 }
 
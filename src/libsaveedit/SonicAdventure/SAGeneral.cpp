@@ -13,6 +13,7 @@
 
 // Sonic Adventure save file definitions.
 #include "sa_defs.h"
+#include "SASlotView.hpp"
 
 // Common data.
 #include "SAData.h"
@@ -115,19 +116,19 @@ void SAGeneral::changeEvent(QEvent *event)
 
 /**
  * Load data from a Sonic Adventure save slot.
- * @param sa_save Sonic Adventure save slot.
- * The data must have already been byteswapped to host-endian.
+ * @param sa_view Sonic Adventure save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SAGeneral::load(const sa_save_slot *sa_save)
+int SAGeneral::load(const SASlotView &sa_view)
 {
 	Q_D(SAGeneral);
 	suspendHasBeenModified();
+	const sa_save_slot *const sa_save = sa_view.slot();
 
 	// Play time.
 	// Stored in NTSC frames. (1/60th of a second)
 	// TODO: Verify for PAL?
-	d->ui.tcePlayTime->setValueInNtscFrames(sa_save->playTime);
+	d->ui.tcePlayTime->setValueInNtscFrames(sa_view.playTime());
 
 	// Options byte.
 	d->ui.cboMessages->setCurrentIndex(SA_OPTIONS_MSG_VALUE(sa_save->options));
@@ -141,7 +142,7 @@ int SAGeneral::load(const sa_save_slot *sa_save)
 	// Last character and level.
 	d->ui.cboLastCharacter->setCurrentIndex(sa_save->last_char);
 	// TODO: Verify this...
-	int last_level = sa_save->last_level;
+	int last_level = sa_view.lastLevel();
 	if (last_level >= d->ui.cboLastLevel->count())
 		last_level = 0;
 	d->ui.cboLastLevel->setCurrentIndex(last_level);
@@ -153,18 +154,18 @@ int SAGeneral::load(const sa_save_slot *sa_save)
 
 /**
  * Save data to a Sonic Adventure save slot.
- * @param sa_save Sonic Adventure save slot.
- * The data will be in host-endian format.
+ * @param sa_view Sonic Adventure save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SAGeneral::save(sa_save_slot *sa_save)
+int SAGeneral::save(SASlotView &sa_view)
 {
 	Q_D(const SAGeneral);
+	sa_save_slot *const sa_save = sa_view.slot();
 
 	// Play time.
 	// Stored in NTSC frames. (1/60th of a second)
 	// TODO: Verify for PAL?
-	sa_save->playTime = d->ui.tcePlayTime->valueInNtscFrames();
+	sa_view.playTime() = d->ui.tcePlayTime->valueInNtscFrames();
 
 	// Options byte.
 	// TODO: Bit-shifting macros like SA_OPTIONS_*_VALUE()?
@@ -181,7 +182,7 @@ int SAGeneral::save(sa_save_slot *sa_save)
 	if (d->ui.cboLastCharacter->currentIndex() >= 0)
 		sa_save->last_char = d->ui.cboLastCharacter->currentIndex();
 	if (d->ui.cboLastLevel->currentIndex() >= 0)
-		sa_save->last_level = d->ui.cboLastLevel->currentIndex();
+		sa_view.lastLevel() = d->ui.cboLastLevel->currentIndex();
 
 	setModified(false);
 	return 0;
@@ -189,20 +190,19 @@ int SAGeneral::save(sa_save_slot *sa_save)
 
 /**
  * Load data from a Sonic Adventure DX extra save slot.
- * @param sadx_extra_save Sonic Adventure DX extra save slot.
- * The data must have already been byteswapped to host-endian.
- * If nullptr, SADX editor components will be hidden.
+ * @param sadx_view Sonic Adventure DX extra save slot view.
+ * If the view is null, SADX editor components will be hidden.
  * @return 0 on success; non-zero on error.
  */
-int SAGeneral::loadDX(const sadx_extra_save_slot *sadx_extra_save)
+int SAGeneral::loadDX(const SADXSlotView &sadx_view)
 {
 	Q_D(SAGeneral);
 	suspendHasBeenModified();
 
-	if (sadx_extra_save) {
+	if (!sadx_view.isNull()) {
 		// The only SADX information here is the "Black Market Rings".
 		// TODO: Validate the value?
-		d->ui.spnBlackMarketRings->setValue(sadx_extra_save->rings_black_market);
+		d->ui.spnBlackMarketRings->setValue(sadx_view.blackMarketRings());
 
 		// Make sure the "Black Market Rings" widgets are visible.
 		d->ui.lblBlackMarketRings->show();
@@ -221,17 +221,16 @@ int SAGeneral::loadDX(const sadx_extra_save_slot *sadx_extra_save)
 
 /**
  * Save data to a Sonic Adventure DX extra save slot.
- * @param sadx_extra_save Sonic Adventure DX extra save slot.
- * The data will be in host-endian format.
+ * @param sadx_view Sonic Adventure DX extra save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SAGeneral::saveDX(sadx_extra_save_slot *sadx_extra_save)
+int SAGeneral::saveDX(SADXSlotView &sadx_view)
 {
 	Q_D(const SAGeneral);
 
 	// The only SADX information here is the "Black Market Rings".
 	// TODO: Validate the value?
-	sadx_extra_save->rings_black_market = d->ui.spnBlackMarketRings->value();
+	sadx_view.blackMarketRings() = d->ui.spnBlackMarketRings->value();
 
 	setModified(false);
 	return 0;
@@ -25,6 +25,7 @@
 
 // Sonic Adventure save file definitions.
 #include "sa_defs.h"
+#include "SASlotView.hpp"
 
 // Common data.
 #include "SAData.h"
@@ -343,14 +344,13 @@ void SALevelClearCount::changeEvent(QEvent *event)
 
 /**
  * Load data from a Sonic Adventure save slot.
- * @param sa_save Sonic Adventure save slot.
- * The data must have already been byteswapped to host-endian.
+ * @param sa_view Sonic Adventure save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SALevelClearCount::load(const sa_save_slot *sa_save)
+int SALevelClearCount::load(const SASlotView &sa_view)
 {
 	Q_D(SALevelClearCount);
-	memcpy(&d->clear_count, &sa_save->clear_count, sizeof(d->clear_count));
+	memcpy(&d->clear_count, &sa_view.slot()->clear_count, sizeof(d->clear_count));
 
 	// Update the display.
 	d->updateDisplay();
@@ -360,14 +360,13 @@ int SALevelClearCount::load(const sa_save_slot *sa_save)
 
 /**
  * Save data to a Sonic Adventure save slot.
- * @param sa_save Sonic Adventure save slot.
- * The data will be in host-endian format.
+ * @param sa_view Sonic Adventure save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SALevelClearCount::save(sa_save_slot *sa_save)
+int SALevelClearCount::save(SASlotView &sa_view)
 {
 	Q_D(const SALevelClearCount);
-	memcpy(&sa_save->clear_count, &d->clear_count, sizeof(sa_save->clear_count));
+	memcpy(&sa_view.slot()->clear_count, &d->clear_count, sizeof(d->clear_count));
 	setModified(false);
 	return 0;
 }
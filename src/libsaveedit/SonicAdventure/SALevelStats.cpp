@@ -19,6 +19,7 @@
 
 // Sonic Adventure save file definitions.
 #include "sa_defs.h"
+#include "SASlotView.hpp"
 
 // Common data.
 #include "SAData.h"
@@ -552,18 +553,18 @@ void SALevelStats::on_cboCharacter_currentIndexChanged(int index)
 
 /**
  * Load data from a Sonic Adventure save slot.
- * @param sa_save Sonic Adventure save slot.
- * The data must have already been byteswapped to host-endian.
+ * @param sa_view Sonic Adventure save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SALevelStats::load(const sa_save_slot *sa_save)
+int SALevelStats::load(const SASlotView &sa_view)
 {
 	Q_D(SALevelStats);
 	suspendHasBeenModified();
-	memcpy(&d->scores,  &sa_save->scores,  sizeof(d->scores));
-	memcpy(&d->times,   &sa_save->times,   sizeof(d->times));
-	memcpy(&d->weights, &sa_save->weights, sizeof(d->weights));
-	memcpy(&d->rings,   &sa_save->rings,   sizeof(d->rings));
+	const sa_save_slot *const sa_save = sa_view.slot();
+	sa_view.scores().copyTo(d->scores.all);
+	memcpy(&d->times, &sa_save->times, sizeof(d->times));
+	sa_view.weights().copyTo(d->weights.all);
+	sa_view.rings().copyTo(d->rings.all);
 
 	// Emblems are stored as a bitmask. (LSB is emblem 0.)
 	// Convert to a bool array to make it easier to access.
@@ -585,11 +586,10 @@ int SALevelStats::load(const sa_save_slot *sa_save)
 
 /**
  * Save data to a Sonic Adventure save slot.
- * @param sa_save Sonic Adventure save slot.
- * The data will be in host-endian format.
+ * @param sa_view Sonic Adventure save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SALevelStats::save(sa_save_slot *sa_save)
+int SALevelStats::save(SASlotView &sa_view)
 {
 	Q_D(const SALevelStats);
 
@@ -597,10 +597,11 @@ int SALevelStats::save(sa_save_slot *sa_save)
 	// TODO: Use modification signals to make this unnecessary.
 	const_cast<SALevelStatsPrivate*>(d)->saveCurrentStats();
 
-	memcpy(&sa_save->scores,  &d->scores,  sizeof(sa_save->scores));
-	memcpy(&sa_save->times,   &d->times,   sizeof(sa_save->times));
-	memcpy(&sa_save->weights, &d->weights, sizeof(sa_save->weights));
-	memcpy(&sa_save->rings,   &d->rings,   sizeof(sa_save->rings));
+	sa_save_slot *const sa_save = sa_view.slot();
+	sa_view.scores().copyFrom(d->scores.all);
+	memcpy(&sa_save->times, &d->times, sizeof(sa_save->times));
+	sa_view.weights().copyFrom(d->weights.all);
+	sa_view.rings().copyFrom(d->rings.all);
 
 	// Emblems are stored as a bitmask. (LSB is emblem 0.)
 	// We're using a bool array internally.
@@ -620,26 +621,25 @@ int SALevelStats::save(sa_save_slot *sa_save)
 
 /**
  * Load data from a Sonic Adventure DX extra save slot.
- * @param sadx_extra_save Sonic Adventure DX extra save slot.
- * The data must have already been byteswapped to host-endian.
- * If nullptr, SADX editor components will be hidden.
+ * @param sadx_view Sonic Adventure DX extra save slot view.
+ * If the view is null, SADX editor components will be hidden.
  * @return 0 on success; non-zero on error.
  */
-int SALevelStats::loadDX(const sadx_extra_save_slot *sadx_extra_save)
+int SALevelStats::loadDX(const SADXSlotView &sadx_view)
 {
 	Q_D(SALevelStats);
 	suspendHasBeenModified();
 
-	if (sadx_extra_save) {
-		memcpy(&d->metal_sonic.scores, &sadx_extra_save->scores_metal, sizeof(d->metal_sonic.scores));
-		memcpy(&d->metal_sonic.times,  &sadx_extra_save->times_metal,  sizeof(d->metal_sonic.times));
-		memcpy(&d->metal_sonic.rings,  &sadx_extra_save->rings_metal,  sizeof(d->metal_sonic.rings));
+	if (!sadx_view.isNull()) {
+		sadx_view.metalScores().copyTo(d->metal_sonic.scores);
+		memcpy(&d->metal_sonic.times, &sadx_view.slot()->times_metal, sizeof(d->metal_sonic.times));
+		sadx_view.metalRings().copyTo(d->metal_sonic.rings);
 
 		// Emblems are stored as a bitmask. (LSB is emblem 0.)
 		// We're using a bool array internally.
 		// TODO: Verify byte ordering on GCN and PC.
 		bool *emblem = &d->metal_sonic.emblems[0];
-		uint32_t metal_emblems = sadx_extra_save->emblems_metal;
+		uint32_t metal_emblems = sadx_view.metalEmblems();
 		for (int i = 0; i < NUM_ELEMENTS(d->metal_sonic.emblems); i++) {
 			// TODO: Is the !! needed?
 			*emblem++ = !!(metal_emblems & 1);
@@ -667,11 +667,10 @@ int SALevelStats::loadDX(const sadx_extra_save_slot *sadx_extra_save)
 
 /**
  * Save data to a Sonic Adventure DX extra save slot.
- * @param sadx_extra_save Sonic Adventure DX extra save slot.
- * The data will be in host-endian format.
+ * @param sadx_view Sonic Adventure DX extra save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SALevelStats::saveDX(sadx_extra_save_slot *sadx_extra_save)
+int SALevelStats::saveDX(SADXSlotView &sadx_view)
 {
 	Q_D(SALevelStats);
 
@@ -680,9 +679,9 @@ int SALevelStats::saveDX(sadx_extra_save_slot *sadx_extra_save)
 	// TODO: Only do this if the current character is Metal Sonic.
 	const_cast<SALevelStatsPrivate*>(d)->saveCurrentStats();
 
-	memcpy(&sadx_extra_save->scores_metal, &d->metal_sonic.scores, sizeof(sadx_extra_save->scores_metal));
-	memcpy(&sadx_extra_save->times_metal,  &d->metal_sonic.times,  sizeof(sadx_extra_save->times_metal));
-	memcpy(&sadx_extra_save->rings_metal,  &d->metal_sonic.rings,  sizeof(sadx_extra_save->rings_metal));
+	sadx_view.metalScores().copyFrom(d->metal_sonic.scores);
+	memcpy(&sadx_view.slot()->times_metal, &d->metal_sonic.times, sizeof(d->metal_sonic.times));
+	sadx_view.metalRings().copyFrom(d->metal_sonic.rings);
 
 	// Emblems are stored as a bitmask. (LSB is emblem 0.)
 	// We're using a bool array internally.
@@ -694,7 +693,7 @@ int SALevelStats::saveDX(sadx_extra_save_slot *sadx_extra_save)
 		// TODO: Test this.
 		metal_emblems |= (*emblem++ ? (1 << NUM_ELEMENTS(d->metal_sonic.emblems)) : 0);
 	}
-	sadx_extra_save->emblems_metal = metal_emblems;
+	sadx_view.metalEmblems() = metal_emblems;
 
 	setModified(false);
 	return 0;
@@ -10,8 +10,8 @@
 
 #include "SADXEditWidget.hpp"
 
-struct _sa_save_slot;
-struct _sadx_extra_save_slot;
+class SASlotView;
+class SADXSlotView;
 
 class SALevelStatsPrivate;
 class SALevelStats : public SADXEditWidget
@@ -41,37 +41,33 @@ class SALevelStats : public SADXEditWidget
 	public:
 		/**
 		 * Load data from a Sonic Adventure save slot.
-		 * @param sa_save Sonic Adventure save slot.
-		 * The data must have already been byteswapped to host-endian.
+		 * @param sa_view Sonic Adventure save slot view.
 		 * @return 0 on success; non-zero on error.
 		 */
-		int load(const _sa_save_slot *sa_save) final;
+		int load(const SASlotView &sa_view) final;
 
 		/**
 		 * Save data to a Sonic Adventure save slot.
-		 * @param sa_save Sonic Adventure save slot.
-		 * The data will be in host-endian format.
+		 * @param sa_view Sonic Adventure save slot view.
 		 * @return 0 on success; non-zero on error.
 		 */
-		int save(_sa_save_slot *sa_save) final;
+		int save(SASlotView &sa_view) final;
 
 	public:
 		/**
 		 * Load data from a Sonic Adventure DX extra save slot.
-		 * @param sadx_extra_save Sonic Adventure DX extra save slot.
-		 * The data must have already been byteswapped to host-endian.
-		 * If nullptr, SADX editor components will be hidden.
+		 * @param sadx_view Sonic Adventure DX extra save slot view.
+		 * If the view is null, SADX editor components will be hidden.
 		 * @return 0 on success; non-zero on error.
 		 */
-		int loadDX(const _sadx_extra_save_slot *sadx_extra_save) final;
+		int loadDX(const SADXSlotView &sadx_view) final;
 
 		/**
 		 * Save data to a Sonic Adventure DX extra save slot.
-		 * @param sadx_extra_save Sonic Adventure DX extra save slot.
-		 * The data will be in host-endian format.
+		 * @param sadx_view Sonic Adventure DX extra save slot view.
 		 * @return 0 on success; non-zero on error.
 		 */
-		int saveDX(_sadx_extra_save_slot *sadx_extra_save) final;
+		int saveDX(SADXSlotView &sadx_view) final;
 
 	protected slots:
 		/**
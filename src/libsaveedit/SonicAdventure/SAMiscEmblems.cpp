@@ -22,6 +22,7 @@
 
 // Sonic Adventure save file definitions.
 #include "sa_defs.h"
+#include "SASlotView.hpp"
 
 // Common data.
 #include "SAData.h"
@@ -149,14 +150,14 @@ void SAMiscEmblems::changeEvent(QEvent *event)
 
 /**
  * Load data from a Sonic Adventure save slot.
- * @param sa_save Sonic Adventure save slot.
- * The data must have already been byteswapped to host-endian.
+ * @param sa_view Sonic Adventure save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SAMiscEmblems::load(const sa_save_slot *sa_save)
+int SAMiscEmblems::load(const SASlotView &sa_view)
 {
 	Q_D(SAMiscEmblems);
 	suspendHasBeenModified();
+	const sa_save_slot *const sa_save = sa_view.slot();
 
 	// Chao Race emblems.
 	d->chkChaoRace[0]->setChecked(SA_TEST_EMBLEM(sa_save->emblems, 106));
@@ -186,13 +187,13 @@ int SAMiscEmblems::load(const sa_save_slot *sa_save)
 
 /**
  * Save data to a Sonic Adventure save slot.
- * @param sa_save Sonic Adventure save slot.
- * The data will be in host-endian format.
+ * @param sa_view Sonic Adventure save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SAMiscEmblems::save(sa_save_slot *sa_save)
+int SAMiscEmblems::save(SASlotView &sa_view)
 {
 	Q_D(const SAMiscEmblems);
+	sa_save_slot *const sa_save = sa_view.slot();
 
 	// Chao Race emblems.
 	// TODO: Helper function to get emblem by index.
@@ -10,7 +10,7 @@
 
 #include "SAEditWidget.hpp"
 
-struct _sa_save_slot;
+class SASlotView;
 
 class SAMiscEmblemsPrivate;
 class SAMiscEmblems : public SAEditWidget
@@ -34,17 +34,15 @@ class SAMiscEmblems : public SAEditWidget
 	public:
 		/**
 		 * Load data from a Sonic Adventure save slot.
-		 * @param sa_save Sonic Adventure save slot.
-		 * The data must have already been byteswapped to host-endian.
+		 * @param sa_view Sonic Adventure save slot view.
 		 * @return 0 on success; non-zero on error.
 		 */
-		int load(const _sa_save_slot *sa_save) final;
+		int load(const SASlotView &sa_view) final;
 
 		/**
 		 * Save data to a Sonic Adventure save slot.
-		 * @param sa_save Sonic Adventure save slot.
-		 * The data will be in host-endian format.
+		 * @param sa_view Sonic Adventure save slot view.
 		 * @return 0 on success; non-zero on error.
 		 */
-		int save(_sa_save_slot *sa_save) final;
+		int save(SASlotView &sa_view) final;
 };
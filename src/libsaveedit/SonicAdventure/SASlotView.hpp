@@ -0,0 +1,325 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program [libsaveedit]                     *
+ * SASlotView.hpp: Sonic Adventure - in-place save slot views.             *
+ *                                                                         *
+ * Copyright (c) 2015-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+// C includes (C++ namespace)
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "util/byteswap.h"
+#include "sa_defs.h"
+
+/**
+ * Byteswap a save slot field value.
+ * Specialized for each multi-byte field type in sa_defs.h.
+ * @param x Value
+ * @return Byteswapped value
+ */
+template<typename T> inline T sa_swab(T x);
+template<> inline uint16_t sa_swab<uint16_t>(uint16_t x)
+{
+	return __swab16(x);
+}
+template<> inline int16_t sa_swab<int16_t>(int16_t x)
+{
+	// NOTE: Swapping as uint16_t to prevent sign extension.
+	return (int16_t)__swab16((uint16_t)x);
+}
+template<> inline uint32_t sa_swab<uint32_t>(uint32_t x)
+{
+	return __swab32(x);
+}
+
+/**
+ * Multi-byte field within a save slot.
+ *
+ * The field is stored in the file's byte order.
+ * Reading the field returns the value in host byte order,
+ * and assigning to it stores the value in file byte order.
+ *
+ * @tparam T Field type
+ */
+template<typename T>
+class SAField
+{
+	public:
+		/**
+		 * Create a field accessor.
+		 * @param ptr Pointer to the field within the file buffer
+		 * @param swap If true, the file byte order doesn't match the host byte order.
+		 */
+		SAField(T *ptr, bool swap)
+			: m_ptr(ptr)
+			, m_swap(swap)
+		{ }
+
+		SAField(const SAField &other) = default;
+
+	public:
+		/**
+		 * Get the field value.
+		 * @return Value, in host byte order
+		 */
+		inline operator T(void) const
+		{
+			return (m_swap ? sa_swab<T>(*m_ptr) : *m_ptr);
+		}
+
+		/**
+		 * Set the field value.
+		 * @param value Value, in host byte order
+		 */
+		inline SAField &operator=(T value)
+		{
+			*m_ptr = (m_swap ? sa_swab<T>(value) : value);
+			return *this;
+		}
+
+		/**
+		 * Set the field value from another field.
+		 * NOTE: This copies the value, not the field pointer.
+		 * @param other Other field
+		 */
+		inline SAField &operator=(const SAField &other)
+		{
+			return operator=(static_cast<T>(other));
+		}
+
+	private:
+		T *m_ptr;
+		bool m_swap;
+};
+
+/**
+ * Array of multi-byte fields within a save slot.
+ * @tparam T Field type
+ */
+template<typename T>
+class SAFieldArray
+{
+	public:
+		/**
+		 * Create a field array accessor.
+		 * @param ptr Pointer to the array within the file buffer
+		 * @param count Number of elements
+		 * @param swap If true, the file byte order doesn't match the host byte order.
+		 */
+		SAFieldArray(T *ptr, int count, bool swap)
+			: m_ptr(ptr)
+			, m_count(count)
+			, m_swap(swap)
+		{ }
+
+	public:
+		/**
+		 * Get the number of elements.
+		 * @return Number of elements
+		 */
+		inline int size(void) const
+		{
+			return m_count;
+		}
+
+		/**
+		 * Get an element.
+		 * @param idx Element index
+		 * @return Field accessor
+		 */
+		inline SAField<T> operator[](int idx) const
+		{
+			assert(idx >= 0 && idx < m_count);
+			return SAField<T>(&m_ptr[idx], m_swap);
+		}
+
+		/**
+		 * Copy all elements to a host-endian array.
+		 * @param dest Destination array (must have size() elements)
+		 */
+		inline void copyTo(T *dest) const
+		{
+			for (int i = 0; i < m_count; i++) {
+				dest[i] = (m_swap ? sa_swab<T>(m_ptr[i]) : m_ptr[i]);
+			}
+		}
+
+		/**
+		 * Copy all elements from a host-endian array.
+		 * @param src Source array (must have size() elements)
+		 */
+		inline void copyFrom(const T *src) const
+		{
+			for (int i = 0; i < m_count; i++) {
+				m_ptr[i] = (m_swap ? sa_swab<T>(src[i]) : src[i]);
+			}
+		}
+
+	private:
+		T *m_ptr;
+		int m_count;
+		bool m_swap;
+};
+
+/**
+ * View of a save slot within a file buffer.
+ *
+ * The slot is accessed in place; nothing is copied or byteswapped.
+ * Single-byte fields are accessed directly using slot().
+ * Multi-byte fields must be accessed using the subclass's
+ * field accessors, which convert to and from host byte order.
+ *
+ * NOTE: Like a pointer, a const view can still modify the slot.
+ *
+ * @tparam Slot Save slot struct
+ */
+template<typename Slot>
+class SAView
+{
+	public:
+		/**
+		 * Create a null view.
+		 */
+		SAView()
+			: m_slot(nullptr)
+			, m_swap(false)
+		{ }
+
+		/**
+		 * Create a view of a save slot.
+		 * @param ptr Pointer to the save slot within the file buffer
+		 * @param fileByteOrder File byte order (SYS_LIL_ENDIAN or SYS_BIG_ENDIAN)
+		 */
+		SAView(void *ptr, int fileByteOrder)
+			: m_slot(reinterpret_cast<Slot*>(ptr))
+			, m_swap(fileByteOrder != SYS_BYTEORDER)
+		{ }
+
+	public:
+		/**
+		 * Is this a null view?
+		 * @return True if null; false if not.
+		 */
+		inline bool isNull(void) const
+		{
+			return (m_slot == nullptr);
+		}
+
+		/**
+		 * Get the save slot.
+		 * Multi-byte fields are in file byte order.
+		 * @return Save slot
+		 */
+		inline Slot *slot(void) const
+		{
+			return m_slot;
+		}
+
+	protected:
+		/**
+		 * Get an accessor for a multi-byte field.
+		 * @param ref Field within m_slot
+		 * @return Field accessor
+		 */
+		template<typename T>
+		inline SAField<T> field(T &ref) const
+		{
+			return SAField<T>(&ref, m_swap);
+		}
+
+		/**
+		 * Get an accessor for an array of multi-byte fields.
+		 * @param arr Array within m_slot
+		 * @return Field array accessor
+		 */
+		template<typename T, size_t N>
+		inline SAFieldArray<T> fieldArray(T (&arr)[N]) const
+		{
+			return SAFieldArray<T>(arr, (int)N, m_swap);
+		}
+
+		Slot *m_slot;
+		bool m_swap;
+};
+
+/**
+ * View of a Sonic Adventure save slot.
+ */
+class SASlotView : public SAView<sa_save_slot>
+{
+	public:
+		SASlotView() { }
+		SASlotView(void *ptr, int fileByteOrder)
+			: SAView<sa_save_slot>(ptr, fileByteOrder)
+		{ }
+
+	public:
+		// Play time. (1/60ths of a second)
+		inline SAField<uint32_t> playTime(void) const
+			{ return field(m_slot->playTime); }
+
+		// Level stats.
+		inline SAFieldArray<uint32_t> scores(void) const
+			{ return fieldArray(m_slot->scores.all); }
+		inline SAFieldArray<uint16_t> weights(void) const
+			{ return fieldArray(m_slot->weights.all); }
+		inline SAFieldArray<uint16_t> rings(void) const
+			{ return fieldArray(m_slot->rings.all); }
+
+		// Mini-game scores.
+		inline SAFieldArray<uint32_t> miniGameScores(void) const
+			{ return fieldArray(m_slot->mini_game_scores.all); }
+
+		// Last completed level. (100 == none)
+		inline SAField<uint16_t> lastLevel(void) const
+			{ return field(m_slot->last_level); }
+
+		// Adventure mode. (per character)
+		inline SAField<int16_t> advUnknown1(int chr) const
+			{ return field(m_slot->adventure_mode.chr[chr].unknown1); }
+		inline SAField<int16_t> advUnknown2(int chr) const
+			{ return field(m_slot->adventure_mode.chr[chr].unknown2); }
+		inline SAField<uint16_t> advStartEntrance(int chr) const
+			{ return field(m_slot->adventure_mode.chr[chr].start_entrance); }
+		inline SAField<uint16_t> advStartLevelAndAct(int chr) const
+			{ return field(m_slot->adventure_mode.chr[chr].start_level_and_act); }
+		inline SAField<int16_t> advUnknown3(int chr) const
+			{ return field(m_slot->adventure_mode.chr[chr].unknown3); }
+};
+
+/**
+ * View of a Sonic Adventure DX extra save slot.
+ * A null view indicates the file doesn't have SADX extras.
+ */
+class SADXSlotView : public SAView<sadx_extra_save_slot>
+{
+	public:
+		SADXSlotView() { }
+		SADXSlotView(void *ptr, int fileByteOrder)
+			: SAView<sadx_extra_save_slot>(ptr, fileByteOrder)
+		{ }
+
+	public:
+		// Black Market rings.
+		inline SAField<uint32_t> blackMarketRings(void) const
+			{ return field(m_slot->rings_black_market); }
+
+		// Metal Sonic level stats.
+		inline SAFieldArray<uint32_t> metalScores(void) const
+			{ return fieldArray(m_slot->scores_metal); }
+		inline SAFieldArray<uint16_t> metalRings(void) const
+			{ return fieldArray(m_slot->rings_metal); }
+
+		// Metal Sonic mini-game scores.
+		inline SAFieldArray<uint32_t> metalMiniGameScores(void) const
+			{ return fieldArray(m_slot->mini_game_scores_metal.all); }
+
+		// Metal Sonic emblems. (32-bit bitfield)
+		inline SAField<uint32_t> metalEmblems(void) const
+			{ return field(m_slot->emblems_metal); }
+};
@@ -14,6 +14,7 @@
 
 // Sonic Adventure save file definitions.
 #include "sa_defs.h"
+#include "SASlotView.hpp"
 
 // Common data.
 #include "SAData.h"
@@ -543,17 +544,17 @@ void SASubGames::on_cboCharacter_currentIndexChanged(int index)
 
 /**
  * Load data from a Sonic Adventure save slot.
- * @param sa_save Sonic Adventure save slot.
- * The data must have already been byteswapped to host-endian.
+ * @param sa_view Sonic Adventure save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SASubGames::load(const sa_save_slot *sa_save)
+int SASubGames::load(const SASlotView &sa_view)
 {
 	Q_D(SASubGames);
 	suspendHasBeenModified();
-	memcpy(&d->mini_game_scores, &sa_save->mini_game_scores, sizeof(d->mini_game_scores));
-	memcpy(&d->twinkle_circuit,  &sa_save->twinkle_circuit,  sizeof(d->twinkle_circuit));
-	memcpy(&d->boss_attack,      &sa_save->boss_attack,      sizeof(d->boss_attack));
+	const sa_save_slot *const sa_save = sa_view.slot();
+	sa_view.miniGameScores().copyTo(d->mini_game_scores.all);
+	memcpy(&d->twinkle_circuit, &sa_save->twinkle_circuit, sizeof(d->twinkle_circuit));
+	memcpy(&d->boss_attack,     &sa_save->boss_attack,     sizeof(d->boss_attack));
 	// TODO: Metal Sonic.
 
 	// Emblems. (Yes, it's in a weird order; no, I don't know why.)
@@ -578,11 +579,10 @@ int SASubGames::load(const sa_save_slot *sa_save)
 
 /**
  * Save data to a Sonic Adventure save slot.
- * @param sa_save Sonic Adventure save slot.
- * The data will be in host-endian format.
+ * @param sa_view Sonic Adventure save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SASubGames::save(sa_save_slot *sa_save)
+int SASubGames::save(SASlotView &sa_view)
 {
 	Q_D(const SASubGames);
 
@@ -590,9 +590,10 @@ int SASubGames::save(sa_save_slot *sa_save)
 	// TODO: Use modification signals to make this unnecessary.
 	const_cast<SASubGamesPrivate*>(d)->saveCurrentStats();
 
-	memcpy(&sa_save->mini_game_scores, &d->mini_game_scores, sizeof(sa_save->mini_game_scores));
-	memcpy(&sa_save->twinkle_circuit,  &d->twinkle_circuit,  sizeof(sa_save->twinkle_circuit));
-	memcpy(&sa_save->boss_attack,      &d->boss_attack,      sizeof(sa_save->boss_attack));
+	sa_save_slot *const sa_save = sa_view.slot();
+	sa_view.miniGameScores().copyFrom(d->mini_game_scores.all);
+	memcpy(&sa_save->twinkle_circuit, &d->twinkle_circuit, sizeof(sa_save->twinkle_circuit));
+	memcpy(&sa_save->boss_attack,     &d->boss_attack,     sizeof(sa_save->boss_attack));
 
 	// Emblems. (Yes, it's in a weird order; no, I don't know why.)
 	// TODO: Verify these. (Source: https://info.sonicretro.org/SCHG:Sonic_Adventure/Main_Save_File)
@@ -616,20 +617,20 @@ int SASubGames::save(sa_save_slot *sa_save)
 
 /**
  * Load data from a Sonic Adventure DX extra save slot.
- * @param sadx_extra_save Sonic Adventure DX extra save slot.
- * The data must have already been byteswapped to host-endian.
- * If nullptr, SADX editor components will be hidden.
+ * @param sadx_view Sonic Adventure DX extra save slot view.
+ * If the view is null, SADX editor components will be hidden.
  * @return 0 on success; non-zero on error.
  */
-int SASubGames::loadDX(const sadx_extra_save_slot *sadx_extra_save)
+int SASubGames::loadDX(const SADXSlotView &sadx_view)
 {
 	Q_D(SASubGames);
 	suspendHasBeenModified();
 
-	if (sadx_extra_save) {
-		memcpy(&d->metal_sonic.mini_game_scores, &sadx_extra_save->mini_game_scores_metal, sizeof(d->metal_sonic.mini_game_scores));
-		memcpy(&d->metal_sonic.twinkle_circuit,  &sadx_extra_save->twinkle_circuit_metal,  sizeof(d->metal_sonic.twinkle_circuit));
-		memcpy(&d->metal_sonic.boss_attack,      &sadx_extra_save->boss_attack_metal,      sizeof(d->metal_sonic.boss_attack));
+	if (!sadx_view.isNull()) {
+		const sadx_extra_save_slot *const sadx_extra_save = sadx_view.slot();
+		sadx_view.metalMiniGameScores().copyTo(d->metal_sonic.mini_game_scores.all);
+		memcpy(&d->metal_sonic.twinkle_circuit, &sadx_extra_save->twinkle_circuit_metal, sizeof(d->metal_sonic.twinkle_circuit));
+		memcpy(&d->metal_sonic.boss_attack,     &sadx_extra_save->boss_attack_metal,     sizeof(d->metal_sonic.boss_attack));
 
 		// If the Characters dropdown doesn't have Metal Sonic, add him now.
 		if (d->ui.cboCharacter->count() < 7) {
@@ -645,7 +646,7 @@ int SASubGames::loadDX(const sadx_extra_save_slot *sadx_extra_save)
 	}
 
 	// Update the display.
-	// OPTIMIZE: If Metal Sonic was selected, and !sadx_extra_save,
+	// OPTIMIZE: If Metal Sonic was selected, and the view is null,
 	// this will have been called already. This is an unlikely
 	// possibility, though, since the editor's file usually
 	// isn't changed after it's loaded, and all slots either
@@ -658,11 +659,10 @@ int SASubGames::loadDX(const sadx_extra_save_slot *sadx_extra_save)
 
 /**
  * Save data to a Sonic Adventure DX extra save slot.
- * @param sadx_extra_save Sonic Adventure DX extra save slot.
- * The data will be in host-endian format.
+ * @param sadx_view Sonic Adventure DX extra save slot view.
  * @return 0 on success; non-zero on error.
  */
-int SASubGames::saveDX(sadx_extra_save_slot *sadx_extra_save)
+int SASubGames::saveDX(SADXSlotView &sadx_view)
 {
 	Q_D(const SASubGames);
 
@@ -671,9 +671,10 @@ int SASubGames::saveDX(sadx_extra_save_slot *sadx_extra_save)
 	// TODO: Only do this if the current character is Metal Sonic.
 	const_cast<SASubGamesPrivate*>(d)->saveCurrentStats();
 
-	memcpy(&sadx_extra_save->mini_game_scores_metal, &d->metal_sonic.mini_game_scores, sizeof(sadx_extra_save->mini_game_scores_metal));
-	memcpy(&sadx_extra_save->twinkle_circuit_metal,  &d->metal_sonic.twinkle_circuit,  sizeof(sadx_extra_save->twinkle_circuit_metal));
-	memcpy(&sadx_extra_save->boss_attack_metal,      &d->metal_sonic.boss_attack,      sizeof(sadx_extra_save->boss_attack_metal));
+	sadx_extra_save_slot *const sadx_extra_save = sadx_view.slot();
+	sadx_view.metalMiniGameScores().copyFrom(d->metal_sonic.mini_game_scores.all);
+	memcpy(&sadx_extra_save->twinkle_circuit_metal, &d->metal_sonic.twinkle_circuit, sizeof(sadx_extra_save->twinkle_circuit_metal));
+	memcpy(&sadx_extra_save->boss_attack_metal,     &d->metal_sonic.boss_attack,     sizeof(sadx_extra_save->boss_attack_metal));
 
 	setModified(false);
 	return 0;
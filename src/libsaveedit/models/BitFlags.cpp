@@ -45,12 +45,41 @@ class BitFlagsPrivate
 		// of said class are deleted?
 		QVector<const char*> flags_desc;
 
-		// Flags.
-		// NOTE: QVector<bool> does not have bit "optimization".
-		QVector<bool> flags;
+		// Flags, packed into 64-bit words.
+		// Flag n is bit (n % 64) of words[n / 64].
+		// NOTE: Bits past flagCount are always 0.
+		QVector<quint64> words;
+		int flagCount;
 
 		// Translation context for bit flags.
 		const char *tr_ctx;
+
+		/**
+		 * Get the bit for a flag within its word.
+		 * @param flag Flag ID.
+		 * @return Bit.
+		 */
+		static inline quint64 bit(int flag)
+		{
+			return (1ULL << (flag & 63));
+		}
+
+		/**
+		 * Get the mask for a range of flags within a word.
+		 * @param word Word index.
+		 * @param firstFlag First flag. (inclusive)
+		 * @param lastFlag Last flag. (inclusive)
+		 * @return Mask.
+		 */
+		static quint64 rangeMask(int word, int firstFlag, int lastFlag);
+
+		/**
+		 * Clamp a range of flags to the valid flag IDs.
+		 * @param firstFlag	[in/out] First flag. (inclusive)
+		 * @param lastFlag	[in/out] Last flag. (inclusive)
+		 * @return True if the range is not empty; false if it is.
+		 */
+		bool clampRange(int &firstFlag, int &lastFlag) const;
 };
 
 /**
@@ -62,7 +91,8 @@ class BitFlagsPrivate
  */
 BitFlagsPrivate::BitFlagsPrivate(int total_flags, const char *tr_ctx,
 				 const bit_flag_t *bit_flags, int count)
-	: tr_ctx(tr_ctx)
+	: flagCount(total_flags)
+	, tr_ctx(tr_ctx)
 {
 	// This is initialized by a derived private class.
 	assert(total_flags > 0);
@@ -70,8 +100,8 @@ BitFlagsPrivate::BitFlagsPrivate(int total_flags, const char *tr_ctx,
 	assert(count >= 0);
 
 	// Initialize flags.
-	// QVector automatically initializes the new elements to false.
-	flags.resize(total_flags);
+	// QVector automatically initializes the new elements to 0.
+	words.resize((total_flags + 63) / 64);
 
 	// Initialize flags_desc.
 	// TODO: Once per derived class, rather than once per instance?
@@ -88,6 +118,40 @@ BitFlagsPrivate::BitFlagsPrivate(int total_flags, const char *tr_ctx,
 	}
 }
 
+/**
+ * Get the mask for a range of flags within a word.
+ * @param word Word index.
+ * @param firstFlag First flag. (inclusive)
+ * @param lastFlag Last flag. (inclusive)
+ * @return Mask.
+ */
+quint64 BitFlagsPrivate::rangeMask(int word, int firstFlag, int lastFlag)
+{
+	const int base = word * 64;
+	const int lo = qMax(firstFlag, base) - base;
+	const int hi = qMin(lastFlag, base + 63) - base;
+	if (lo > hi)
+		return 0;
+
+	const quint64 hiMask = (hi == 63 ? ~0ULL : ((1ULL << (hi + 1)) - 1));
+	return hiMask & ~((1ULL << lo) - 1);
+}
+
+/**
+ * Clamp a range of flags to the valid flag IDs.
+ * @param firstFlag	[in/out] First flag. (inclusive)
+ * @param lastFlag	[in/out] Last flag. (inclusive)
+ * @return True if the range is not empty; false if it is.
+ */
+bool BitFlagsPrivate::clampRange(int &firstFlag, int &lastFlag) const
+{
+	if (firstFlag < 0)
+		firstFlag = 0;
+	if (lastFlag >= flagCount)
+		lastFlag = flagCount - 1;
+	return (firstFlag <= lastFlag);
+}
+
 /** BitFlags **/
 
 /**
@@ -137,7 +201,7 @@ BitFlags::~BitFlags()
 int BitFlags::count(void) const
 {
 	Q_D(const BitFlags);
-	return d->flags.size();
+	return d->flagCount;
 }
 
 /**
@@ -181,7 +245,7 @@ bool BitFlags::flag(int flag) const
 		return false;
 
 	Q_D(const BitFlags);
-	return d->flags.at(flag);
+	return !!(d->words.at(flag >> 6) & BitFlagsPrivate::bit(flag));
 }
 
 /**
@@ -195,8 +259,62 @@ void BitFlags::setFlag(int flag, bool value)
 		return;
 
 	Q_D(BitFlags);
-	d->flags[flag] = value;
-	emit flagChanged(flag, value);
+	quint64 &word = d->words[flag >> 6];
+	const quint64 old = word;
+	if (value) {
+		word |= BitFlagsPrivate::bit(flag);
+	} else {
+		word &= ~BitFlagsPrivate::bit(flag);
+	}
+
+	if (word != old) {
+		emit flagChanged(flag, value);
+	}
+}
+
+/**
+ * Set or clear a range of flags.
+ * flagsChanged() is emitted once if any flags were changed.
+ * @param firstFlag First flag ID. (inclusive)
+ * @param lastFlag Last flag ID. (inclusive)
+ * @param value New flag value.
+ */
+void BitFlags::setFlags(int firstFlag, int lastFlag, bool value)
+{
+	Q_D(BitFlags);
+	if (!d->clampRange(firstFlag, lastFlag))
+		return;
+
+	bool changed = false;
+	for (int w = (firstFlag >> 6); w <= (lastFlag >> 6); w++) {
+		const quint64 mask = BitFlagsPrivate::rangeMask(w, firstFlag, lastFlag);
+		quint64 &word = d->words[w];
+		const quint64 old = word;
+		word = (value ? (old | mask) : (old & ~mask));
+		changed |= (word != old);
+	}
+
+	if (changed) {
+		emit flagsChanged(firstFlag, lastFlag);
+	}
+}
+
+/**
+ * Invert a range of flags.
+ * flagsChanged() is emitted once.
+ * @param firstFlag First flag ID. (inclusive)
+ * @param lastFlag Last flag ID. (inclusive)
+ */
+void BitFlags::invertFlags(int firstFlag, int lastFlag)
+{
+	Q_D(BitFlags);
+	if (!d->clampRange(firstFlag, lastFlag))
+		return;
+
+	for (int w = (firstFlag >> 6); w <= (lastFlag >> 6); w++) {
+		d->words[w] ^= BitFlagsPrivate::rangeMask(w, firstFlag, lastFlag);
+	}
+	emit flagsChanged(firstFlag, lastFlag);
 }
 
 /**
@@ -221,23 +339,19 @@ int BitFlags::allFlags(uint8_t *data, int sz) const
 
 	// Convert to bits.
 	int bits = sz * 8;
-	if (bits > d->flags.count())
-		bits = d->flags.count();
-
-	// TODO: Verify that this is correct.
-	const bool *flagBool = d->flags.constData();
-	for (int i = 0; i < bits; i++, flagBool++) {
-		if (i % 8 == 0) {
-			// New byte.
-			// TODO: Optimize this?
-			if (i > 0)
-				data++;
-			*data = 0;
-		}
-
-		// Get this flag.
-		*data >>= 1;
-		*data |= (*flagBool ? 0x80 : 0);
+	if (bits > d->flagCount)
+		bits = d->flagCount;
+
+	// Flag n is bit (n % 8) of byte (n / 8), which is
+	// byte (n / 8) % 8 of the little-endian word.
+	// NOTE: Unused bits in the last byte are cleared.
+	const int bytes = (bits + 7) / 8;
+	const quint64 *const words = d->words.constData();
+	for (int i = 0; i < bytes; i++) {
+		data[i] = (uint8_t)(words[i >> 3] >> ((i & 7) * 8));
+	}
+	if (bits & 7) {
+		data[bytes - 1] &= (1U << (bits & 7)) - 1;
 	}
 
 	return bits;
@@ -265,20 +379,21 @@ int BitFlags::setAllFlags(const uint8_t *data, int sz)
 
 	// Convert to bits.
 	int bits = sz * 8;
-	if (bits > d->flags.count())
-		bits = d->flags.count();
-
-	uint8_t curByte = 0;
-	bool *flagBool = d->flags.data();
-	for (int i = 0; i < bits; i++, flagBool++) {
-		if (i % 8 == 0) {
-			// New byte.
-			curByte = *data++;
+	if (bits > d->flagCount)
+		bits = d->flagCount;
+
+	// Flag n is bit (n % 8) of byte (n / 8).
+	// Load up to 8 bytes into each word.
+	const int bytes = (bits + 7) / 8;
+	for (int w = 0; w <= ((bits - 1) >> 6); w++) {
+		quint64 val = 0;
+		const int byteEnd = qMin((w + 1) * 8, bytes);
+		for (int i = w * 8; i < byteEnd; i++) {
+			val |= ((quint64)data[i] << ((i & 7) * 8));
 		}
 
-		// Set this flag.
-		*flagBool = (curByte & 0x01);
-		curByte >>= 1;
+		const quint64 mask = BitFlagsPrivate::rangeMask(w, 0, bits - 1);
+		d->words[w] = (d->words.at(w) & ~mask) | (val & mask);
 	}
 
 	emit flagsChanged(0, bits-1);
@@ -113,6 +113,23 @@ class BitFlags : public QObject
 		 */
 		void setFlag(int flag, bool value);
 
+		/**
+		 * Set or clear a range of flags.
+		 * flagsChanged() is emitted once if any flags were changed.
+		 * @param firstFlag First flag ID. (inclusive)
+		 * @param lastFlag Last flag ID. (inclusive)
+		 * @param value New flag value.
+		 */
+		void setFlags(int firstFlag, int lastFlag, bool value);
+
+		/**
+		 * Invert a range of flags.
+		 * flagsChanged() is emitted once.
+		 * @param firstFlag First flag ID. (inclusive)
+		 * @param lastFlag Last flag ID. (inclusive)
+		 */
+		void invertFlags(int firstFlag, int lastFlag);
+
 		/**
 		 * Get the bit flags as an array of bitfield data.
 		 *
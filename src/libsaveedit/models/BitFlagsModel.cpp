@@ -184,6 +184,7 @@ bool BitFlagsModel::setData(const QModelIndex &index, const QVariant &value, int
 		case Qt::CheckStateRole:
 			// Event flag value has changed.
 			// TODO: Map row to event ID.
+			// NOTE: dataChanged() is emitted by bitFlags_flagChanged_slot().
 			d->bitFlags->setFlag(index.row(), (value.toUInt() == Qt::Checked));
 			break;
 
@@ -192,8 +193,6 @@ bool BitFlagsModel::setData(const QModelIndex &index, const QVariant &value, int
 			return false;
 	}
 
-	// Data has changed.
-	emit dataChanged(index, index);
 	return true;
 }
 
@@ -298,6 +297,37 @@ QString BitFlagsModel::pageName(int page) const
 	return QString();
 }
 
+/** Bulk operations. **/
+
+/**
+ * Set or clear a range of flags.
+ * dataChanged() is emitted once for the entire range.
+ * @param firstFlag First flag ID. (inclusive)
+ * @param lastFlag Last flag ID. (inclusive)
+ * @param value New flag value.
+ */
+void BitFlagsModel::setFlags(int firstFlag, int lastFlag, bool value)
+{
+	Q_D(BitFlagsModel);
+	if (d->bitFlags) {
+		d->bitFlags->setFlags(firstFlag, lastFlag, value);
+	}
+}
+
+/**
+ * Invert a range of flags.
+ * dataChanged() is emitted once for the entire range.
+ * @param firstFlag First flag ID. (inclusive)
+ * @param lastFlag Last flag ID. (inclusive)
+ */
+void BitFlagsModel::invertFlags(int firstFlag, int lastFlag)
+{
+	Q_D(BitFlagsModel);
+	if (d->bitFlags) {
+		d->bitFlags->invertFlags(firstFlag, lastFlag);
+	}
+}
+
 /** Slots. **/
 
 /**
@@ -84,6 +84,25 @@ class BitFlagsModel : public QAbstractListModel
 		 */
 		QString pageName(int page) const;
 
+		/** Bulk operations. **/
+
+		/**
+		 * Set or clear a range of flags.
+		 * dataChanged() is emitted once for the entire range.
+		 * @param firstFlag First flag ID. (inclusive)
+		 * @param lastFlag Last flag ID. (inclusive)
+		 * @param value New flag value.
+		 */
+		void setFlags(int firstFlag, int lastFlag, bool value);
+
+		/**
+		 * Invert a range of flags.
+		 * dataChanged() is emitted once for the entire range.
+		 * @param firstFlag First flag ID. (inclusive)
+		 * @param lastFlag Last flag ID. (inclusive)
+		 */
+		void invertFlags(int firstFlag, int lastFlag);
+
 	protected slots:
 		/**
 		 * BitFlags object was destroyed.
@@ -51,6 +51,14 @@ public:
 	 * @param forceTextUpdate If true, update all tab text. Needed for language changes.
 	 */
 	void updateTabBar(bool forceTextUpdate = false);
+
+	/**
+	 * Get the range of flags on the current page.
+	 * @param pFirst	[out] First flag. (inclusive)
+	 * @param pLast		[out] Last flag. (inclusive)
+	 * @return True if the page has flags; false if not.
+	 */
+	bool currentPageRange(int *pFirst, int *pLast) const;
 };
 
 BitFlagsViewPrivate::BitFlagsViewPrivate(BitFlagsView *q)
@@ -143,6 +151,31 @@ void BitFlagsViewPrivate::updateTabBar(bool forceTextUpdate)
 	ui.tabBar->setVisible(pageFilterModel->pageCount() > 1);
 }
 
+/**
+ * Get the range of flags on the current page.
+ * @param pFirst	[out] First flag. (inclusive)
+ * @param pLast		[out] Last flag. (inclusive)
+ * @return True if the page has flags; false if not.
+ */
+bool BitFlagsViewPrivate::currentPageRange(int *pFirst, int *pLast) const
+{
+	const QAbstractItemModel *const model = pageFilterModel->sourceModel();
+	if (!model)
+		return false;
+
+	const int rowCount = model->rowCount();
+	const int pageSize = pageFilterModel->pageSize();
+	int first = 0, last = rowCount - 1;
+	if (pageSize > 0) {
+		first = pageFilterModel->currentPage() * pageSize;
+		last = qMin(first + pageSize, rowCount) - 1;
+	}
+
+	*pFirst = first;
+	*pLast = last;
+	return (first <= last);
+}
+
 /** BitFlagsView **/
 
 BitFlagsView::BitFlagsView(QWidget *parent)
@@ -175,6 +208,14 @@ BitFlagsView::BitFlagsView(QWidget *parent)
 		d->pageFilterModel, &PageFilterModel::setCurrentPage);
 	connect(d->pageFilterModel, &PageFilterModel::currentPageChanged,
 		d->ui.tabBar, &QTabBar::setCurrentIndex);
+
+	// Connect the page operation buttons.
+	connect(d->ui.btnCheckAll, &QPushButton::clicked,
+		this, &BitFlagsView::checkAllOnPage);
+	connect(d->ui.btnUncheckAll, &QPushButton::clicked,
+		this, &BitFlagsView::uncheckAllOnPage);
+	connect(d->ui.btnInvert, &QPushButton::clicked,
+		this, &BitFlagsView::invertAllOnPage);
 }
 
 BitFlagsView::~BitFlagsView()
@@ -245,3 +286,44 @@ int BitFlagsView::pageSize(void) const
 }
 
 // TODO: Page count?
+
+/** Page operations **/
+
+/**
+ * Set all flags on the current page.
+ */
+void BitFlagsView::checkAllOnPage(void)
+{
+	Q_D(BitFlagsView);
+	BitFlagsModel *const model = bitFlagsModel();
+	int first, last;
+	if (model && d->currentPageRange(&first, &last)) {
+		model->setFlags(first, last, true);
+	}
+}
+
+/**
+ * Clear all flags on the current page.
+ */
+void BitFlagsView::uncheckAllOnPage(void)
+{
+	Q_D(BitFlagsView);
+	BitFlagsModel *const model = bitFlagsModel();
+	int first, last;
+	if (model && d->currentPageRange(&first, &last)) {
+		model->setFlags(first, last, false);
+	}
+}
+
+/**
+ * Invert all flags on the current page.
+ */
+void BitFlagsView::invertAllOnPage(void)
+{
+	Q_D(BitFlagsView);
+	BitFlagsModel *const model = bitFlagsModel();
+	int first, last;
+	if (model && d->currentPageRange(&first, &last)) {
+		model->invertFlags(first, last);
+	}
+}
@@ -58,4 +58,22 @@ public:
 	int pageSize(void) const;
 
 	// TODO: Page count?
+
+public slots:
+	/** Page operations **/
+
+	/**
+	 * Set all flags on the current page.
+	 */
+	void checkAllOnPage(void);
+
+	/**
+	 * Clear all flags on the current page.
+	 */
+	void uncheckAllOnPage(void);
+
+	/**
+	 * Invert all flags on the current page.
+	 */
+	void invertAllOnPage(void);
 };
@@ -0,0 +1,466 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * FileExporter.cpp: Background file exporter.                             *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "FileExporter.hpp"
+
+// Files
+#include "libmemcard/File.hpp"
+#include "libmemcard/FileImages.hpp"
+
+// C includes (C++ namespace)
+#include <cerrno>
+
+// C++ includes
+#include <vector>
+using std::vector;
+
+// Qt includes
+#include <QtCore/QAtomicInt>
+#include <QtCore/QBuffer>
+#include <QtCore/QFile>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+/**
+ * A file being exported.
+ * Owned by whichever stage is currently processing it.
+ */
+struct ExportJob {
+	ExportJob() : file(nullptr), readError(0) { }
+
+	// Exported file data.
+	File *file;
+	QString filename;
+	QByteArray data;
+	int readError;
+
+	// Images.
+	QString bannerFilename;	// sans extension
+	QString iconFilename;	// sans extension
+	GcImageWriter::AnimImageFormat animImgf;
+	FileImages images;
+
+	// Encoded images.
+	QVector<QString> imageFilenames;
+	QVector<QByteArray> imageData;
+};
+
+/** FileExporterPrivate **/
+
+class FileExporterPrivate
+{
+public:
+	explicit FileExporterPrivate(FileExporter *q);
+	~FileExporterPrivate();
+
+protected:
+	FileExporter *const q_ptr;
+	Q_DECLARE_PUBLIC(FileExporter)
+private:
+	Q_DISABLE_COPY(FileExporterPrivate)
+
+public:
+	// Reader stage. (single thread)
+	// NOTE: Card reads are serialized by the card's I/O lock,
+	// so more reader threads wouldn't help.
+	QThreadPool readerPool;
+	// Encoder stage. (PNG, APNG, GIF)
+	QThreadPool encodePool;
+	// Writer stage. (single thread)
+	QThreadPool writerPool;
+
+	// Set when the export is cancelled.
+	// Checked by all stages.
+	QAtomicInt cancelled;
+
+	// Export status.
+	// Only accessed on the FileExporter's thread.
+	bool running;
+	int filesToExport;
+	int filesExported;
+	int filesSaved;
+
+	/**
+	 * Wait for all stages to finish.
+	 */
+	void waitForDone(void);
+
+	/**
+	 * Write data to a file.
+	 * @param filename Filename
+	 * @param data Data
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	static int writeFile(const QString &filename, const QByteArray &data);
+
+	/**
+	 * Reader stage: Read a file's data and images.
+	 * Hands the job off to the encoder stage.
+	 */
+	class ReadTask : public QRunnable
+	{
+		public:
+			ReadTask(FileExporterPrivate *d, ExportJob *job)
+				: d(d), job(job) { }
+			void run(void) final;
+		private:
+			FileExporterPrivate *const d;
+			ExportJob *const job;
+	};
+
+	/**
+	 * Encoder stage: Encode a file's images.
+	 * Hands the job off to the writer stage.
+	 */
+	class EncodeTask : public QRunnable
+	{
+		public:
+			EncodeTask(FileExporterPrivate *d, ExportJob *job)
+				: d(d), job(job) { }
+			void run(void) final;
+		private:
+			FileExporterPrivate *const d;
+			ExportJob *const job;
+	};
+
+	/**
+	 * Writer stage: Write a file and its images.
+	 * Reports the result to the FileExporter.
+	 */
+	class WriteTask : public QRunnable
+	{
+		public:
+			WriteTask(FileExporterPrivate *d, ExportJob *job)
+				: d(d), job(job) { }
+			void run(void) final;
+		private:
+			FileExporterPrivate *const d;
+			ExportJob *const job;
+	};
+};
+
+FileExporterPrivate::FileExporterPrivate(FileExporter *q)
+	: q_ptr(q)
+	, running(false)
+	, filesToExport(0)
+	, filesExported(0)
+	, filesSaved(0)
+{
+	// Only one reader thread, so files are read sequentially.
+	readerPool.setMaxThreadCount(1);
+	// Only one writer thread, so files are written sequentially.
+	writerPool.setMaxThreadCount(1);
+}
+
+FileExporterPrivate::~FileExporterPrivate()
+{
+	cancelled.storeRelease(1);
+	waitForDone();
+}
+
+/**
+ * Wait for all stages to finish.
+ */
+void FileExporterPrivate::waitForDone(void)
+{
+	// NOTE: Each stage queues tasks on the next stage,
+	// so the stages have to finish in order.
+	readerPool.waitForDone();
+	encodePool.waitForDone();
+	writerPool.waitForDone();
+}
+
+/**
+ * Write data to a file.
+ * @param filename Filename
+ * @param data Data
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FileExporterPrivate::writeFile(const QString &filename, const QByteArray &data)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		// Error opening the file.
+		// TODO: Convert QFileError to a POSIX error code.
+		return -EIO;
+	}
+
+	const qint64 ret = file.write(data);
+	file.close();
+	if (ret != (qint64)data.size()) {
+		// Error writing the file.
+		file.remove();
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/**
+ * Reader stage: Read a file's data and images.
+ * Hands the job off to the encoder stage.
+ */
+void FileExporterPrivate::ReadTask::run(void)
+{
+	if (d->cancelled.loadAcquire()) {
+		// Export was cancelled.
+		job->readError = -ECANCELED;
+	} else {
+		QBuffer buffer(&job->data);
+		buffer.open(QIODevice::WriteOnly);
+		job->readError = job->file->exportToFile(&buffer);
+		buffer.close();
+		if (job->readError > 0) {
+			// TODO: Error code constants.
+			job->readError = -EIO;
+		}
+
+		if (job->readError == 0 &&
+		    (!job->bannerFilename.isEmpty() || !job->iconFilename.isEmpty()))
+		{
+			job->file->copyImages(&job->images);
+		}
+	}
+
+	// The File isn't needed after this point.
+	job->file = nullptr;
+
+	// Hand the job off to the encoder stage.
+	d->encodePool.start(new EncodeTask(d, job));
+}
+
+/**
+ * Encoder stage: Encode a file's images.
+ * Hands the job off to the writer stage.
+ */
+void FileExporterPrivate::EncodeTask::run(void)
+{
+	if (!d->cancelled.loadAcquire() && job->readError == 0) {
+		// Banner image.
+		if (!job->bannerFilename.isEmpty() && job->images.hasBanner()) {
+			GcImageWriter gcImageWriter;
+			if (job->images.encodeBanner(&gcImageWriter) == 0) {
+				const char *ext = GcImageWriter::extForImageFormat(GcImageWriter::ImageFormat::PNG);
+				QString filename = job->bannerFilename;
+				if (ext)
+					filename += QChar(L'.') + QLatin1String(ext);
+
+				const vector<uint8_t> *pngData = gcImageWriter.memBuffer();
+				job->imageFilenames.append(filename);
+				job->imageData.append(QByteArray(
+					reinterpret_cast<const char*>(pngData->data()), (int)pngData->size()));
+			}
+		}
+
+		// Icon.
+		if (!job->iconFilename.isEmpty() && job->images.iconCount() >= 1 &&
+		    !d->cancelled.loadAcquire())
+		{
+			GcImageWriter gcImageWriter;
+			if (job->images.encodeIcon(&gcImageWriter, job->animImgf) == 0) {
+				const char *ext = job->images.iconExt(job->animImgf);
+				const int numFiles = gcImageWriter.numFiles();
+				for (int i = 0; i < numFiles; i++) {
+					QString filename = job->iconFilename;
+					if (numFiles > 1) {
+						// Multiple files.
+						// Append the file number.
+						filename += QString(QLatin1String(".%1")).arg(i+1, 2, 10, QChar(L'0'));
+					}
+					if (ext) {
+						filename += QChar(L'.') + QLatin1String(ext);
+					}
+
+					const vector<uint8_t> *imgData = gcImageWriter.memBuffer(i);
+					job->imageFilenames.append(filename);
+					job->imageData.append(QByteArray(
+						reinterpret_cast<const char*>(imgData->data()), (int)imgData->size()));
+				}
+			}
+		}
+	}
+
+	// Hand the job off to the writer stage.
+	d->writerPool.start(new WriteTask(d, job));
+}
+
+/**
+ * Writer stage: Write a file and its images.
+ * Reports the result to the FileExporter.
+ */
+void FileExporterPrivate::WriteTask::run(void)
+{
+	int ret;
+	if (d->cancelled.loadAcquire()) {
+		// Export was cancelled.
+		ret = -ECANCELED;
+	} else if (job->readError != 0) {
+		// Error reading the file.
+		ret = job->readError;
+	} else {
+		// Save the file.
+		ret = writeFile(job->filename, job->data);
+
+		// Save the images.
+		// If any of the images couldn't be saved,
+		// the file isn't counted as saved.
+		for (int i = 0; i < job->imageFilenames.size() && ret == 0; i++) {
+			ret = writeFile(job->imageFilenames.at(i), job->imageData.at(i));
+		}
+	}
+	delete job;
+
+	// NOTE: If the FileExporter is deleted, it waits for this
+	// task to finish, and pending queued calls are discarded.
+	QMetaObject::invokeMethod(d->q_ptr, "fileExported_slot",
+		Qt::QueuedConnection, Q_ARG(int, ret));
+}
+
+/** FileExporter **/
+
+FileExporter::FileExporter(QObject *parent)
+	: super(parent)
+	, d_ptr(new FileExporterPrivate(this))
+{ }
+
+FileExporter::~FileExporter()
+{
+	Q_D(FileExporter);
+	delete d;
+}
+
+/**
+ * Is an export currently running?
+ * @return True if running; false if not.
+ */
+bool FileExporter::isRunning(void) const
+{
+	Q_D(const FileExporter);
+	return d->running;
+}
+
+/**
+ * Export files.
+ *
+ * The file data and images are read by a single reader thread.
+ * Images are encoded on a thread pool, and files are
+ * written by a single writer thread.
+ *
+ * NOTE: The Files must not be deleted while the export is
+ * running. Call stop() before deleting them.
+ *
+ * The export is complete when either of the following
+ * signals are emitted:
+ * - exportFinished(): All files were processed.
+ * - exportCancelled(): The export was cancelled.
+ *
+ * @param items Files to export
+ * @param animImgf Animated image format for animated icons
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int FileExporter::start(const QVector<Item> &items, GcImageWriter::AnimImageFormat animImgf)
+{
+	Q_D(FileExporter);
+	if (d->running) {
+		// An export is already running.
+		return -EBUSY;
+	}
+
+	// Make sure the image encoders are initialized on this thread.
+	// (APNG and GIF support is loaded with dlopen() on first use.)
+	bool needImages = false;
+	foreach (const Item &item, items) {
+		if (!item.bannerFilename.isEmpty() || !item.iconFilename.isEmpty()) {
+			needImages = true;
+			break;
+		}
+	}
+	if (needImages) {
+		GcImageWriter::isAnimImageFormatSupported(animImgf);
+	}
+
+	d->cancelled.storeRelease(0);
+	d->running = true;
+	d->filesToExport = items.size();
+	d->filesExported = 0;
+	d->filesSaved = 0;
+	emit exportStarted(d->filesToExport);
+
+	if (items.isEmpty()) {
+		// Nothing to export.
+		d->running = false;
+		emit exportFinished(0);
+		return 0;
+	}
+
+	// Queue the files on the reader stage.
+	foreach (const Item &item, items) {
+		ExportJob *const job = new ExportJob();
+		job->file = item.file;
+		job->filename = item.filename;
+		job->bannerFilename = item.bannerFilename;
+		job->iconFilename = item.iconFilename;
+		job->animImgf = animImgf;
+		d->readerPool.start(new FileExporterPrivate::ReadTask(d, job));
+	}
+
+	return 0;
+}
+
+/**
+ * Cancel the current export.
+ * Files that were already written are not removed.
+ */
+void FileExporter::cancel(void)
+{
+	Q_D(FileExporter);
+	if (d->running) {
+		d->cancelled.storeRelease(1);
+	}
+}
+
+/**
+ * Cancel the current export and wait for the worker threads.
+ * This must be called before deleting any of the Files
+ * being exported, e.g. when the card is closed.
+ */
+void FileExporter::stop(void)
+{
+	Q_D(FileExporter);
+	if (d->running) {
+		d->cancelled.storeRelease(1);
+		d->waitForDone();
+	}
+}
+
+/**
+ * A file has been processed by the writer thread.
+ * @param ret 0 on success; negative POSIX error code on error.
+ */
+void FileExporter::fileExported_slot(int ret)
+{
+	Q_D(FileExporter);
+	if (!d->running)
+		return;
+
+	d->filesExported++;
+	if (ret == 0) {
+		d->filesSaved++;
+	}
+	emit exportUpdate(d->filesExported, d->filesToExport);
+
+	if (d->filesExported >= d->filesToExport) {
+		// All files have been processed.
+		d->running = false;
+		if (d->cancelled.loadAcquire()) {
+			emit exportCancelled(d->filesSaved);
+		} else {
+			emit exportFinished(d->filesSaved);
+		}
+	}
+}
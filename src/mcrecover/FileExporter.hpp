@@ -0,0 +1,123 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * FileExporter.hpp: Background file exporter.                             *
+ *                                                                         *
+ * Copyright (c) 2012-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+// GcImageWriter
+#include "GcImageWriter.hpp"
+
+// Qt includes
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+class File;
+
+class FileExporterPrivate;
+class FileExporter : public QObject
+{
+	Q_OBJECT
+	typedef QObject super;
+
+	Q_PROPERTY(bool running READ isRunning)
+
+public:
+	explicit FileExporter(QObject *parent = 0);
+	virtual ~FileExporter();
+
+protected:
+	FileExporterPrivate *const d_ptr;
+	Q_DECLARE_PRIVATE(FileExporter)
+private:
+	Q_DISABLE_COPY(FileExporter)
+
+public:
+	/**
+	 * File to export.
+	 */
+	struct Item {
+		File *file;
+		QString filename;	// Filename for the exported file
+		QString bannerFilename;	// Banner image, sans extension (empty to skip)
+		QString iconFilename;	// Icon, sans extension (empty to skip)
+	};
+
+	/**
+	 * Is an export currently running?
+	 * @return True if running; false if not.
+	 */
+	bool isRunning(void) const;
+
+	/**
+	 * Export files.
+	 *
+	 * The file data and images are read by a single reader thread.
+	 * Images are encoded on a thread pool, and files are
+	 * written by a single writer thread.
+	 *
+	 * NOTE: The Files must not be deleted while the export is
+	 * running. Call stop() before deleting them.
+	 *
+	 * The export is complete when either of the following
+	 * signals are emitted:
+	 * - exportFinished(): All files were processed.
+	 * - exportCancelled(): The export was cancelled.
+	 *
+	 * @param items Files to export
+	 * @param animImgf Animated image format for animated icons
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int start(const QVector<Item> &items, GcImageWriter::AnimImageFormat animImgf);
+
+public slots:
+	/**
+	 * Cancel the current export.
+	 * Files that were already written are not removed.
+	 */
+	void cancel(void);
+
+	/**
+	 * Cancel the current export and wait for the worker threads.
+	 * This must be called before deleting any of the Files
+	 * being exported, e.g. when the card is closed.
+	 */
+	void stop(void);
+
+signals:
+	/**
+	 * Export has started.
+	 * @param filesToExport Number of files to export
+	 */
+	void exportStarted(int filesToExport);
+
+	/**
+	 * Update export status.
+	 * @param filesExported Number of files processed so far
+	 * @param filesToExport Number of files to export
+	 */
+	void exportUpdate(int filesExported, int filesToExport);
+
+	/**
+	 * Export has completed.
+	 * @param filesSaved Number of files saved successfully
+	 */
+	void exportFinished(int filesSaved);
+
+	/**
+	 * Export has been cancelled.
+	 * @param filesSaved Number of files saved before cancelling
+	 */
+	void exportCancelled(int filesSaved);
+
+private slots:
+	/**
+	 * A file has been processed by the writer thread.
+	 * @param ret 0 on success; negative POSIX error code on error.
+	 */
+	void fileExported_slot(int ret);
+};
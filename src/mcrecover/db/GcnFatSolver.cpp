@@ -0,0 +1,665 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * GcnFatSolver.cpp: Checksum-guided FAT chain reconstruction.             *
+ *                                                                         *
+ * Copyright (c) 2013-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "GcnFatSolver.hpp"
+
+// C includes (C++ namespace)
+#include <cstring>
+
+// C++ includes
+#include <algorithm>
+#include <memory>
+#include <vector>
+using std::unique_ptr;
+using std::vector;
+
+// Qt includes
+#include <QtCore/QHash>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+
+/** GcnFatSolverPrivate **/
+
+class GcnFatSolverPrivate
+{
+public:
+	GcnFatSolverPrivate(int blockSize, const vector<Checksum::ChecksumDef> &checksumDefs);
+
+private:
+	Q_DISABLE_COPY(GcnFatSolverPrivate)
+
+public:
+	int blockSize;
+	vector<Checksum::ChecksumDef> checksumDefs;
+
+	// Blocks, in the order they were added.
+	// Index 0 is the file's first block.
+	// NOTE: Shared by all search tasks. Read-only during solve().
+	vector<uint16_t> blocks;
+	vector<uint8_t> blockData;
+	QHash<uint16_t, int> blockIndex;	// Block number -> index in blocks
+
+	/**
+	 * Checksum information.
+	 */
+	struct DefInfo {
+		const Checksum::ChecksumDef *checksumDef;
+		bool incremental;	// Can be calculated incrementally
+		int firstPos;		// First position of the checksummed area
+		int rangeLastPos;	// Last position of the checksummed area
+		int stateIdx;		// Index in SearchState::incState (incremental only)
+	};
+
+	/** Search parameters. (Set by solve().) **/
+
+	int length;		// File length, in blocks
+	int defsTotal;		// Number of valid checksum definitions
+	int incTotal;		// Number of incremental checksums
+	vector<DefInfo> defs;	// Valid checksum definitions
+	vector<int> defaultIdx;	// Default block index for each position (-1 if none)
+	vector<uint8_t> covered;	// Is this position covered by a checksum?
+	vector<vector<int> > incAtPos;	// Incremental checksums covering each position
+	vector<vector<int> > defsAtPos;	// Checksums completed at each position
+
+	static const int MAX_RANK = 1023;
+	static inline int makeKey(int good, int rank)
+	{
+		return (good * (MAX_RANK + 1)) + (MAX_RANK - rank);
+	}
+
+	/**
+	 * Search state.
+	 * Each top-level candidate gets its own copy, and only
+	 * prunes against its own best chain, so the result
+	 * doesn't depend on thread scheduling.
+	 */
+	struct SearchState {
+		vector<int> chain;	// Block index for each position
+		vector<uint8_t> used;	// Is this block index used?
+		int good;		// Number of good checksums
+		int checked;		// Number of checksums checked
+		int rank;		// Rank of the top-level candidate
+
+		// Incremental checksum state after each position.
+		// Index: (stateIdx * length) + pos
+		vector<uint32_t> incState;
+
+		// Scratch buffer for checksums that can't be
+		// calculated incrementally. (Allocated on demand.)
+		vector<uint8_t> scratch;
+
+		// Node budget.
+		unsigned int nodes;	// Nodes visited
+		unsigned int budget;	// Maximum number of nodes
+		bool exhausted;		// True if the budget ran out
+
+		// Best chain found by this search.
+		// Ties are broken by DFS order: the first chain wins.
+		int bestKey;
+		int bestGood;
+		vector<int> bestChain;
+	};
+
+	/**
+	 * Initialize the search parameters.
+	 * @param defaultChain Default FAT chain
+	 */
+	void init(const vector<uint16_t> &defaultChain);
+
+	/**
+	 * Get a pointer to a block's data.
+	 * @param idx Block index
+	 * @return Block data
+	 */
+	inline const uint8_t *blockPtr(int idx) const
+	{
+		return &blockData[(size_t)idx * blockSize];
+	}
+
+	/**
+	 * Check a completed checksum.
+	 * @param st Search state
+	 * @param info Checksum information
+	 * @param lastPos Last position that has been placed
+	 * @return True if the checksum is good.
+	 */
+	bool checkDef(SearchState &st, const DefInfo &info, int lastPos) const;
+
+	/**
+	 * Place a block at a position and check the completed checksums.
+	 * @param st Search state
+	 * @param pos Position in the file
+	 * @param idx Block index
+	 * @return Previous (good, checked) values, packed for unplace().
+	 */
+	std::pair<int, int> place(SearchState &st, int pos, int idx) const;
+
+	/**
+	 * Undo place().
+	 * @param st Search state
+	 * @param pos Position in the file
+	 * @param prev Value returned by place()
+	 */
+	static void unplace(SearchState &st, int pos, std::pair<int, int> prev);
+
+	/**
+	 * Get the default block index for a position.
+	 * This is also the first candidate for covered positions.
+	 * @param st Search state
+	 * @param pos Position in the file
+	 * @return Block index, or -1 if no blocks are available.
+	 */
+	int uncoveredIdx(const SearchState &st, int pos) const;
+
+	/**
+	 * Get the candidate block indexes for a covered position.
+	 * The default block is first.
+	 * @param st Search state
+	 * @param pos Position in the file
+	 * @return Candidate block indexes
+	 */
+	vector<int> candidates(const SearchState &st, int pos) const;
+
+	/**
+	 * Search for the best chain, starting at the specified position.
+	 * @param st Search state
+	 * @param pos Position in the file
+	 * @return True to stop searching this branch entirely.
+	 */
+	bool search(SearchState &st, int pos) const;
+
+	/**
+	 * Search task for a top-level candidate.
+	 */
+	class SearchTask : public QRunnable
+	{
+		public:
+			SearchTask(const GcnFatSolverPrivate *d, const SearchState &st, int pos, QSemaphore *done)
+				: d(d), st(st), pos(pos), done(done)
+			{
+				// Owned by solve().
+				setAutoDelete(false);
+			}
+			void run(void) final
+			{
+				d->search(st, pos);
+				done->release();
+			}
+		private:
+			const GcnFatSolverPrivate *const d;
+		public:
+			SearchState st;
+		private:
+			const int pos;
+			QSemaphore *const done;
+	};
+};
+
+GcnFatSolverPrivate::GcnFatSolverPrivate(int blockSize, const vector<Checksum::ChecksumDef> &checksumDefs)
+	: blockSize(blockSize)
+	, checksumDefs(checksumDefs)
+	, length(0)
+	, defsTotal(0)
+	, incTotal(0)
+{ }
+
+/**
+ * Initialize the search parameters.
+ * @param defaultChain Default FAT chain
+ */
+void GcnFatSolverPrivate::init(const vector<uint16_t> &defaultChain)
+{
+	length = (int)defaultChain.size();
+	defaultIdx.assign(length, -1);
+	for (int pos = 0; pos < length; pos++) {
+		auto iter = blockIndex.constFind(defaultChain[pos]);
+		if (iter != blockIndex.constEnd()) {
+			defaultIdx[pos] = *iter;
+		}
+	}
+
+	// Determine which positions each checksum covers.
+	const uint32_t fileSize = (uint32_t)length * blockSize;
+	defs.clear();
+	covered.assign(length, 0);
+	incAtPos.assign(length, vector<int>());
+	defsAtPos.assign(length, vector<int>());
+	defsTotal = 0;
+	incTotal = 0;
+	for (const Checksum::ChecksumDef &checksumDef : checksumDefs) {
+		if (checksumDef.algorithm == Checksum::ChkAlgorithm::None ||
+		    checksumDef.algorithm >= Checksum::ChkAlgorithm::Max ||
+		    checksumDef.length == 0 ||
+		    (uint64_t)checksumDef.start + checksumDef.length > fileSize)
+		{
+			// Invalid checksum definition.
+			continue;
+		}
+
+		DefInfo info;
+		info.checksumDef = &checksumDef;
+		info.incremental = Checksum::IsIncremental(checksumDef.algorithm);
+		info.stateIdx = -1;
+
+		// Checksummed area.
+		info.firstPos = (int)(checksumDef.start / blockSize);
+		info.rangeLastPos = (int)((checksumDef.start + checksumDef.length - 1) / blockSize);
+		int lastPos = info.rangeLastPos;
+
+		// Checksum field.
+		// NOTE: Pokémon XD stores the checksum in the checksummed area.
+		int fieldFirstPos = info.firstPos, fieldLastPos = info.firstPos;
+		if (checksumDef.algorithm != Checksum::ChkAlgorithm::PokemonXD) {
+			const uint32_t fieldSize = Checksum::FieldSize(checksumDef.algorithm);
+			if ((uint64_t)checksumDef.address + fieldSize > fileSize) {
+				// Checksum field is out of range.
+				continue;
+			}
+			fieldFirstPos = (int)(checksumDef.address / blockSize);
+			fieldLastPos = (int)((checksumDef.address + fieldSize - 1) / blockSize);
+			lastPos = std::max(lastPos, fieldLastPos);
+		}
+
+		const int defIdx = (int)defs.size();
+		if (info.incremental) {
+			info.stateIdx = incTotal++;
+		}
+		for (int pos = info.firstPos; pos <= info.rangeLastPos; pos++) {
+			covered[pos] = 1;
+			if (info.incremental) {
+				incAtPos[pos].push_back(defIdx);
+			}
+		}
+		for (int pos = fieldFirstPos; pos <= fieldLastPos; pos++) {
+			covered[pos] = 1;
+		}
+
+		defs.push_back(info);
+		defsAtPos[lastPos].push_back(defIdx);
+		defsTotal++;
+	}
+
+	// Position 0 is always the first block.
+	covered[0] = 0;
+}
+
+/**
+ * Check a completed checksum.
+ * @param st Search state
+ * @param info Checksum information
+ * @param lastPos Last position that has been placed
+ * @return True if the checksum is good.
+ */
+bool GcnFatSolverPrivate::checkDef(SearchState &st, const DefInfo &info, int lastPos) const
+{
+	const Checksum::ChecksumDef &checksumDef = *info.checksumDef;
+
+	if (!info.incremental) {
+		// Assemble the file data and calculate the checksum.
+		if (st.scratch.empty()) {
+			st.scratch.resize((size_t)length * blockSize);
+		}
+		for (int pos = 0; pos <= lastPos; pos++) {
+			memcpy(&st.scratch[(size_t)pos * blockSize], blockPtr(st.chain[pos]), blockSize);
+		}
+
+		Checksum::ChecksumValue value;
+		return (Checksum::Calculate(checksumDef, st.scratch.data(),
+			(uint32_t)st.scratch.size(), &value) &&
+			value.expected == value.actual);
+	}
+
+	// Get the checksum field.
+	// NOTE: The field may span two blocks.
+	uint8_t field[8];
+	const uint32_t fieldSize = Checksum::FieldSize(checksumDef.algorithm);
+	for (uint32_t i = 0; i < fieldSize; i++) {
+		const uint32_t addr = checksumDef.address + i;
+		field[i] = blockPtr(st.chain[addr / blockSize])[addr % blockSize];
+	}
+
+	const uint32_t expected = Checksum::Expected(checksumDef, field);
+	const uint32_t actual = Checksum::IncFinal(checksumDef,
+		st.incState[(info.stateIdx * length) + info.rangeLastPos]);
+	return (expected == actual);
+}
+
+/**
+ * Place a block at a position and check the completed checksums.
+ * @param st Search state
+ * @param pos Position in the file
+ * @param idx Block index
+ * @return Previous (good, checked) values, packed for unplace().
+ */
+std::pair<int, int> GcnFatSolverPrivate::place(SearchState &st, int pos, int idx) const
+{
+	const std::pair<int, int> prev(st.good, st.checked);
+	st.chain[pos] = idx;
+	st.used[idx] = 1;
+
+	// Update the running checksums.
+	// Blocks are placed in order, so the state for the
+	// previous position is always valid here.
+	const uint8_t *const data = blockPtr(idx);
+	for (int defIdx : incAtPos[pos]) {
+		const DefInfo &info = defs[defIdx];
+		const int base = info.stateIdx * length;
+		const uint32_t state = (pos == info.firstPos
+			? Checksum::IncInit(*info.checksumDef)
+			: st.incState[base + pos - 1]);
+		st.incState[base + pos] = Checksum::IncUpdate(*info.checksumDef,
+			state, data, (uint32_t)pos * blockSize, blockSize);
+	}
+
+	// Check the checksums that are now complete.
+	for (int defIdx : defsAtPos[pos]) {
+		if (checkDef(st, defs[defIdx], pos)) {
+			st.good++;
+		}
+		st.checked++;
+	}
+
+	return prev;
+}
+
+/**
+ * Undo place().
+ * @param st Search state
+ * @param pos Position in the file
+ * @param prev Value returned by place()
+ */
+void GcnFatSolverPrivate::unplace(SearchState &st, int pos, std::pair<int, int> prev)
+{
+	// NOTE: incState doesn't need to be restored, since
+	// it's recalculated when the position is placed again.
+	st.used[st.chain[pos]] = 0;
+	st.chain[pos] = -1;
+	st.good = prev.first;
+	st.checked = prev.second;
+}
+
+/**
+ * Get the default block index for a position.
+ * This is also the first candidate for covered positions.
+ * @param st Search state
+ * @param pos Position in the file
+ * @return Block index, or -1 if no blocks are available.
+ */
+int GcnFatSolverPrivate::uncoveredIdx(const SearchState &st, int pos) const
+{
+	const int idx = defaultIdx[pos];
+	if (idx >= 0 && !st.used[idx]) {
+		return idx;
+	}
+
+	// Default block is already used.
+	// Use the first available block.
+	const int count = (int)blocks.size();
+	for (int i = 1; i < count; i++) {
+		if (!st.used[i])
+			return i;
+	}
+	return -1;
+}
+
+/**
+ * Get the candidate block indexes for a covered position.
+ * The default block is first.
+ * @param st Search state
+ * @param pos Position in the file
+ * @return Candidate block indexes
+ */
+vector<int> GcnFatSolverPrivate::candidates(const SearchState &st, int pos) const
+{
+	vector<int> ret;
+	const int count = (int)blocks.size();
+	ret.reserve(count);
+
+	const int idx = defaultIdx[pos];
+	if (idx >= 0 && !st.used[idx]) {
+		ret.push_back(idx);
+	}
+	for (int i = 1; i < count; i++) {
+		if (i != idx && !st.used[i]) {
+			ret.push_back(i);
+		}
+	}
+	return ret;
+}
+
+/**
+ * Search for the best chain, starting at the specified position.
+ * @param st Search state
+ * @param pos Position in the file
+ * @return True to stop searching this branch entirely.
+ */
+bool GcnFatSolverPrivate::search(SearchState &st, int pos) const
+{
+	if (st.nodes >= st.budget) {
+		// Out of nodes.
+		st.exhausted = true;
+		return true;
+	}
+	st.nodes++;
+
+	// Bound: Assume all remaining checksums are good.
+	const int upperBound = st.good + (defsTotal - st.checked);
+	if (makeKey(upperBound, st.rank) <= st.bestKey) {
+		// This branch can't beat the best chain.
+		return false;
+	}
+
+	if (pos >= length) {
+		// Complete chain.
+		st.bestKey = makeKey(st.good, st.rank);
+		st.bestGood = st.good;
+		st.bestChain = st.chain;
+		// If all checksums are good, nothing else
+		// in this branch can beat it.
+		return (st.good == defsTotal);
+	}
+
+	if (!covered[pos]) {
+		// Not covered by any checksum. Use the default block.
+		const int idx = uncoveredIdx(st, pos);
+		if (idx < 0) {
+			// No blocks available.
+			return false;
+		}
+		const std::pair<int, int> prev = place(st, pos, idx);
+		const bool ret = search(st, pos + 1);
+		unplace(st, pos, prev);
+		return ret;
+	}
+
+	// Covered by a checksum. Try all available blocks.
+	const vector<int> cand = candidates(st, pos);
+	for (int idx : cand) {
+		const std::pair<int, int> prev = place(st, pos, idx);
+		const bool ret = search(st, pos + 1);
+		unplace(st, pos, prev);
+		if (ret)
+			return true;
+	}
+	return false;
+}
+
+/** GcnFatSolver **/
+
+/**
+ * Create a FAT chain solver.
+ * @param blockSize Block size
+ * @param checksumDefs Checksum definitions for the file
+ */
+GcnFatSolver::GcnFatSolver(int blockSize, const vector<Checksum::ChecksumDef> &checksumDefs)
+	: d_ptr(new GcnFatSolverPrivate(blockSize, checksumDefs))
+{ }
+
+GcnFatSolver::~GcnFatSolver()
+{
+	delete d_ptr;
+}
+
+/**
+ * Add a block that may be part of the file.
+ * The first block added is the file's first block.
+ * Other blocks are tried in the order they're added.
+ * @param blockIdx Block index
+ * @param data Block data (must be blockSize bytes; copied)
+ */
+void GcnFatSolver::addBlock(uint16_t blockIdx, const uint8_t *data)
+{
+	Q_D(GcnFatSolver);
+	if (d->blockIndex.contains(blockIdx)) {
+		// Block was already added.
+		return;
+	}
+
+	d->blockIndex.insert(blockIdx, (int)d->blocks.size());
+	d->blocks.push_back(blockIdx);
+	d->blockData.insert(d->blockData.end(), data, data + d->blockSize);
+}
+
+/**
+ * Find the FAT chain with the most matching checksums.
+ * @param defaultChain Default FAT chain, including the first block.
+ *                     All blocks must have been added with addBlock().
+ * @return Best FAT chain found
+ */
+GcnFatSolver::Result GcnFatSolver::solve(const vector<uint16_t> &defaultChain)
+{
+	Q_D(GcnFatSolver);
+	Result result;
+	result.fatEntries = defaultChain;
+	result.checksumsGood = 0;
+	result.checksumsTotal = 0;
+	result.confidence = 0;
+	result.complete = true;
+
+	if (defaultChain.empty() || d->blocks.empty() ||
+	    defaultChain[0] != d->blocks[0])
+	{
+		// Invalid default chain.
+		return result;
+	}
+
+	d->init(defaultChain);
+	result.checksumsTotal = d->defsTotal;
+	if (d->defsTotal == 0) {
+		// No usable checksums.
+		return result;
+	}
+
+	// Initial search state.
+	GcnFatSolverPrivate::SearchState st;
+	st.chain.assign(d->length, -1);
+	st.used.assign(d->blocks.size(), 0);
+	st.good = 0;
+	st.checked = 0;
+	st.rank = 0;
+	st.incState.assign((size_t)d->incTotal * d->length, 0);
+	st.nodes = 0;
+	st.budget = MAX_SOLVE_NODES;
+	st.exhausted = false;
+	st.bestKey = -1;
+	st.bestGood = 0;
+
+	// Place the blocks up to the first covered position.
+	// These positions don't branch, so they're the same
+	// for all top-level candidates.
+	d->place(st, 0, 0);
+	int pos = 1;
+	for (; pos < d->length && !d->covered[pos]; pos++) {
+		const int idx = d->uncoveredIdx(st, pos);
+		if (idx < 0)
+			break;
+		d->place(st, pos, idx);
+	}
+	if (pos < d->length && !d->covered[pos]) {
+		// Ran out of blocks.
+		return result;
+	}
+
+	// Evaluate the default chain first.
+	// This is the first chain the search would visit, so it
+	// wins all ties, and it's usually correct.
+	{
+		GcnFatSolverPrivate::SearchState defSt = st;
+		int defPos = pos;
+		for (; defPos < d->length; defPos++) {
+			const int idx = d->uncoveredIdx(defSt, defPos);
+			if (idx < 0)
+				break;
+			d->place(defSt, defPos, idx);
+		}
+		if (defPos >= d->length) {
+			st.bestKey = GcnFatSolverPrivate::makeKey(defSt.good, 0);
+			st.bestGood = defSt.good;
+			st.bestChain = defSt.chain;
+		}
+	}
+
+	if (st.bestGood < d->defsTotal && pos < d->length) {
+		// Search each top-level candidate in parallel.
+		// Each task gets an equal share of the node budget
+		// and only prunes against its own best chain, so
+		// the result is the same regardless of scheduling.
+		const vector<int> cand = d->candidates(st, pos);
+		const int count = std::min((int)cand.size(), GcnFatSolverPrivate::MAX_RANK + 1);
+		const unsigned int budget = std::max(MAX_SOLVE_NODES / std::max(count, 1), 1U);
+
+		QSemaphore done;
+		vector<unique_ptr<GcnFatSolverPrivate::SearchTask> > tasks;
+		tasks.reserve(count);
+		for (int rank = 0; rank < count; rank++) {
+			GcnFatSolverPrivate::SearchState taskSt = st;
+			taskSt.rank = rank;
+			taskSt.budget = budget;
+			d->place(taskSt, pos, cand[rank]);
+			tasks.emplace_back(new GcnFatSolverPrivate::SearchTask(d, taskSt, pos + 1, &done));
+		}
+
+		// Run the first task on this thread.
+		QThreadPool *const pool = QThreadPool::globalInstance();
+		for (int rank = 1; rank < count; rank++) {
+			pool->start(tasks[rank].get());
+		}
+		if (count > 0) {
+			tasks[0]->run();
+			done.acquire(count);
+		}
+
+		// Merge the results.
+		// Keys include the rank, so there are no ties here.
+		for (const auto &task : tasks) {
+			const GcnFatSolverPrivate::SearchState &taskSt = task->st;
+			if (taskSt.exhausted) {
+				result.complete = false;
+			}
+			if (taskSt.bestKey > st.bestKey) {
+				st.bestKey = taskSt.bestKey;
+				st.bestGood = taskSt.bestGood;
+				st.bestChain = taskSt.bestChain;
+			}
+		}
+	}
+
+	if (st.bestChain.empty()) {
+		// No complete chain was found.
+		return result;
+	}
+
+	result.fatEntries.resize(d->length);
+	for (int i = 0; i < d->length; i++) {
+		result.fatEntries[i] = d->blocks[st.bestChain[i]];
+	}
+	result.checksumsGood = st.bestGood;
+	result.confidence = (st.bestGood * 100) / d->defsTotal;
+	return result;
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * GcnFatSolver.hpp: Checksum-guided FAT chain reconstruction.             *
+ *                                                                         *
+ * Copyright (c) 2013-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+// Checksum algorithm class
+#include "Checksum.hpp"
+
+// C includes
+#include <stdint.h>
+
+// C++ includes
+#include <vector>
+
+// Qt includes
+#include <QtCore/QtGlobal>
+
+/**
+ * Reconstruct a "lost" file's FAT chain using its checksums.
+ *
+ * The default chain (usually the next free blocks after the
+ * file's first block) is tried first. If the checksums don't
+ * match, other orderings of the candidate blocks are searched
+ * using branch-and-bound. Blocks are placed in file order, and
+ * each checksum's running state is carried from one position
+ * to the next, so a checksum is checked as soon as the last
+ * block it covers has been placed and orderings that fail it
+ * are pruned early.
+ *
+ * The search is limited by a node budget instead of a timer,
+ * so the same input always produces the same result.
+ *
+ * Blocks that aren't covered by any checksum can't be verified,
+ * so they're always taken from the default chain.
+ */
+class GcnFatSolverPrivate;
+class GcnFatSolver
+{
+	public:
+		/**
+		 * Create a FAT chain solver.
+		 * @param blockSize Block size
+		 * @param checksumDefs Checksum definitions for the file
+		 */
+		GcnFatSolver(int blockSize, const std::vector<Checksum::ChecksumDef> &checksumDefs);
+		~GcnFatSolver();
+
+	protected:
+		GcnFatSolverPrivate *const d_ptr;
+		Q_DECLARE_PRIVATE(GcnFatSolver)
+	private:
+		Q_DISABLE_COPY(GcnFatSolver)
+
+	public:
+		/**
+		 * Solver result.
+		 */
+		struct Result {
+			std::vector<uint16_t> fatEntries;	// FAT chain
+			int checksumsGood;	// Number of checksums that match
+			int checksumsTotal;	// Number of checksums that were checked
+			int confidence;		// Confidence, in percent. (0-100)
+			bool complete;		// True if the search finished within the node budget.
+		};
+
+		/**
+		 * Add a block that may be part of the file.
+		 * The first block added is the file's first block.
+		 * Other blocks are tried in the order they're added.
+		 * @param blockIdx Block index
+		 * @param data Block data (must be blockSize bytes; copied)
+		 */
+		void addBlock(uint16_t blockIdx, const uint8_t *data);
+
+		/**
+		 * Find the FAT chain with the most matching checksums.
+		 * @param defaultChain Default FAT chain, including the first block.
+		 *                     All blocks must have been added with addBlock().
+		 * @return Best FAT chain found
+		 */
+		Result solve(const std::vector<uint16_t> &defaultChain);
+
+		/**
+		 * Maximum number of search nodes to visit in solve().
+		 * The budget is split evenly between the top-level candidates.
+		 * If it runs out, the best chain found so far is returned.
+		 */
+		static const unsigned int MAX_SOLVE_NODES = (1U << 20);
+};
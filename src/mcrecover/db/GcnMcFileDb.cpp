@@ -16,6 +16,7 @@
 #include "config/ConfigStore.hpp"
 
 #include "GcnMcFileDef.hpp"
+#include "GcnMcFileMatchContext.hpp"
 #include "VarReplace.hpp"
 #include "libmemcard/TimeFuncs.hpp"
 
@@ -33,19 +34,13 @@
 
 // Qt includes
 #include <QtCore/QCoreApplication>
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QMap>
 #include <QtCore/QVector>
 #include <QtCore/QXmlStreamReader>
 
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-#  include <QtCore/QStringDecoder>
-#  include <QtCore/QStringEncoder>
-#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
-#  include <QtCore/QTextCodec>
-#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
-
 class GcnMcFileDbPrivate
 {
 public:
@@ -61,12 +56,71 @@ private:
 	static constexpr uint32_t BLOCK_SIZE_MASK = (BLOCK_SIZE - 1);
 
 public:
+	/**
+	 * GCN memory card file definitions for a single search address.
+	 */
+	struct AddrFileDefs {
+		QVector<GcnMcFileDef*> defs;
+
+		/**
+		 * Combined Game Description matcher.
+		 * Each definition's gameDesc regex is wrapped in an
+		 * optional lookahead with its own capture group, so
+		 * a single match finds all definitions that match.
+		 *
+		 * Definitions with a byte-level prefilter aren't included,
+		 * since the prefilter rejects most comments without
+		 * decoding them. Only valid if more than one definition
+		 * doesn't have a prefilter.
+		 */
+		QRegularExpression gameDesc_combined;
+
+		/**
+		 * Capture group in gameDesc_combined for each definition.
+		 * - 0 if the definition isn't in gameDesc_combined.
+		 * - -1 if the definition's regex is invalid.
+		 * Empty if gameDesc_combined isn't valid.
+		 */
+		QVector<int> gameDesc_groups;
+	};
+
 	/**
 	 * GCN memory card file definitions
-	 * - Key: Search address. (limited to BLOCK_SIZE-1)
-	 * - Value: QVector<>* of GcnMcFileDef*.
+	 * - Key: Search address, relative to the file's first block.
+	 * - Value: AddrFileDefs*
+	 *
+	 * QMap is sorted by address, so definitions are grouped by
+	 * block offset (address >> 13). checkBlock() stops at the
+	 * first address that isn't in the blocks it was given.
+	 */
+	QMap<uint32_t, AddrFileDefs*> addr_file_defs;
+
+	/**
+	 * Number of blocks needed to check all search addresses,
+	 * starting with the file's first block.
+	 */
+	int searchBlockCount;
+
+	/**
+	 * SHA-1 hash of the database file.
+	 */
+	QByteArray hash;
+
+	/**
+	 * GCN memory card file definitions, indexed by game ID.
+	 * Used by addChecksumDefs().
+	 * - Key: ID6 (or ID4 if the definition doesn't have a company code)
+	 * - Value: GcnMcFileDef*, in search address order.
+	 * NOTE: The GcnMcFileDefs are owned by addr_file_defs.
+	 */
+	QHash<QString, QVector<GcnMcFileDef*> > id6_file_defs;
+	QHash<QString, QVector<GcnMcFileDef*> > id4_file_defs;
+
+	/**
+	 * Build the game ID indexes.
+	 * This must be called after addr_file_defs is populated.
 	 */
-	QMap<uint32_t, QVector<GcnMcFileDef*>*> addr_file_defs;
+	void buildGameIdIndex(void);
 
 	/**
 	 * Convert a region character to a GcnMcFileDef::regions_t bitfield value.
@@ -77,7 +131,7 @@ public:
 
 	/**
 	 * Clear the GCN Memory Card File database.
-	 * This clears addr_file_defs.
+	 * This clears addr_file_defs and the game ID indexes.
 	 */
 	void clear(void);
 
@@ -97,95 +151,85 @@ public:
 	void parseXml_file_variables(QXmlStreamReader &xml, GcnMcFileDef *gcnMcFileDef);
 	void parseXml_file_variable(QXmlStreamReader &xml, GcnMcFileDef *gcnMcFileDef);
 
+	/**
+	 * Build the combined Game Description matcher for a search address.
+	 * @param addrDefs File definitions for the search address
+	 */
+	static void buildCombinedMatcher(AddrFileDefs *addrDefs);
+
 	/**
 	 * Error string.
 	 * Set if an error occurs in load().
 	 */
 	QString errorString;
 
-	// TODO: Allocate QStringDecoder/QStringEncoder/QTextCodec on demand?
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-	// String decoders
-	mutable QStringDecoder stringDecoderJP;
-	mutable QStringDecoder stringDecoderUS;
-
-	// String encoders
-	mutable QStringEncoder stringEncoderJP;
-	mutable QStringEncoder stringEncoderUS;
-
 	/**
-	 * Get a comment from the GCN comment block, converted to UTF-16.
-	 * @param buf Comment block
-	 * @param size Size of comment block (usually 32)
-	 * @param stringDecoder QStringDecoder (If invalid, use latin1.)
-	 * @return GCN comment block, converted to UTF-16.
+	 * Build a byte-level prefilter for a comment regex.
+	 * @param pattern Regex pattern
+	 * @return Byte-level prefilter (prefix is empty if the regex can't be prefiltered)
 	 */
-	static QString GetGcnCommentUtf16(const char *buf, size_t size, QStringDecoder &stringDecoder);
+	static GcnMcFileDef::ByteMatch ParseByteMatch(const QString &pattern);
 
 	/**
-	 * Get a comment from the GCN comment block, converted to UTF-8.
-	 * @param buf Comment block
-	 * @param siz Size of comment block (usually 32)
-	 * @param stringDecoder QStringDecoder (If invalid, use latin1.)
-	 * @return GCN comment block, converted to UTF-8.
+	 * Count the literal characters in a regex.
+	 * Character classes, metacharacters, and optional
+	 * characters aren't counted.
+	 * @param pattern Regex pattern
+	 * @return Number of literal characters
 	 */
-	static inline QByteArray GetGcnCommentUtf8(const char *buf, size_t size, QStringDecoder &stringDecoder)
-	{
-		// This is now a wrapper around GetGcnCommentUtf16().
-		return GetGcnCommentUtf16(buf, size, stringDecoder).toUtf8();
-	}
-#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
-	// Text codecs
-	QTextCodec *const textCodecJP;
-	QTextCodec *const textCodecUS;
+	static int RegexLiteralLength(const QString &pattern);
 
 	/**
-	 * Get a comment from the GCN comment block, converted to UTF-16.
-	 * @param buf Comment block
-	 * @param size Size of comment block (usually 32)
-	 * @param textCodec QTextCodec (If nullptr, use latin1.)
-	 * @return GCN comment block, converted to UTF-16.
+	 * Can a raw comment byte be removed by QString::trimmed()?
+	 * This includes bytes that start a whitespace character
+	 * in cp1252, Latin-1, or Shift-JIS.
+	 * @param chr Raw comment byte
+	 * @return True if this byte might be trimmed.
 	 */
-	static QString GetGcnCommentUtf16(const char *buf, size_t size, QTextCodec *textCodec);
+	static inline bool IsTrimmableByte(uint8_t chr)
+	{
+		return (chr == ' ' || (chr >= 0x09 && chr <= 0x0D) ||
+			chr == 0x81 ||	// Shift-JIS: U+3000 (0x8140)
+			chr == 0x85 ||	// Latin-1: U+0085
+			chr == 0xA0);	// cp1252: U+00A0
+	}
 
 	/**
-	 * Get a comment from the GCN comment block, converted to UTF-8.
-	 * @param buf Comment block
-	 * @param siz Size of comment block (usually 32)
-	 * @param textCodec QTextCodec (If nullptr, use latin1.)
-	 * @return GCN comment block, converted to UTF-8.
+	 * Match a comment against a file definition's regex.
+	 * The comment is checked against the byte-level prefilter first,
+	 * and is only decoded if the prefilter can't reject it.
+	 * @param ctx		[in] Match context
+	 * @param address	[in] Comment address
+	 * @param field		[in] Comment field
+	 * @param byteMatch	[in] Byte-level prefilter
+	 * @param regex		[in] Regex
+	 * @param capturedTexts	[out] Captured texts, if matched
+	 * @return True if the comment matches; false if not.
 	 */
-	static inline QByteArray GetGcnCommentUtf8(const char *buf, size_t size, QTextCodec *textCodec)
-	{
-		// This is now a wrapper around GetGcnCommentUtf16().
-		return GetGcnCommentUtf16(buf, size, textCodec).toUtf8();
-	}
-#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
+	static bool MatchComment(GcnMcFileMatchContext *ctx,
+		uint32_t address, GcnMcFileMatchContext::Field field,
+		const GcnMcFileDef::ByteMatch &byteMatch,
+		const QRegularExpression &regex,
+		QStringList *capturedTexts);
 
 	/**
 	 * Construct a GcnSearchData entry.
+	 * @param ctx		[in] Match context
 	 * @param matchFileDef	[in] File definition
 	 * @param vars		[in] Variables
 	 * @param qDateTime	[in] Timestamp
 	 * @return GcnSearchData entry
 	 */
-	GcnSearchData constructSearchData(
+	static GcnSearchData constructSearchData(
+		GcnMcFileMatchContext *ctx,
 		const GcnMcFileDef *matchFileDef,
 		const QHash<QString, QString> &vars,
-		const QDateTime &qDateTime) const;
+		const QDateTime &qDateTime);
 };
 
 GcnMcFileDbPrivate::GcnMcFileDbPrivate(GcnMcFileDb *q)
 	: q_ptr(q)
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-	, stringDecoderJP("Shift_JIS")
-	, stringDecoderUS("cp1252")
-	, stringEncoderJP("Shift_JIS")
-	, stringEncoderUS("cp1252")
-#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
-	, textCodecJP(QTextCodec::codecForName("Shift-JIS"))
-	, textCodecUS(QTextCodec::codecForName("cp1252"))
-#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
+	, searchBlockCount(1)
 {}
 
 GcnMcFileDbPrivate::~GcnMcFileDbPrivate()
@@ -218,20 +262,50 @@ uint8_t GcnMcFileDbPrivate::RegionCharToBitfield(QChar regionChr)
 
 /**
  * Clear the GCN Memory Card File database.
- * This clears addr_file_defs.
+ * This clears addr_file_defs and the game ID indexes.
  */
 void GcnMcFileDbPrivate::clear(void)
 {
 	// Delete all GcnMcFileDefs.
-	for (QMap<uint32_t, QVector<GcnMcFileDef*>*>::iterator iter = addr_file_defs.begin();
+	for (QMap<uint32_t, AddrFileDefs*>::iterator iter = addr_file_defs.begin();
 	     iter != addr_file_defs.end(); ++iter)
 	{
-		QVector<GcnMcFileDef*> *vec = *iter;
-		qDeleteAll(*vec);
-		delete vec;
+		AddrFileDefs *addrDefs = *iter;
+		qDeleteAll(addrDefs->defs);
+		delete addrDefs;
 	}
 
 	addr_file_defs.clear();
+	id6_file_defs.clear();
+	id4_file_defs.clear();
+	searchBlockCount = 1;
+	hash.clear();
+}
+
+/**
+ * Build the game ID indexes.
+ * This must be called after addr_file_defs is populated.
+ */
+void GcnMcFileDbPrivate::buildGameIdIndex(void)
+{
+	id6_file_defs.clear();
+	id4_file_defs.clear();
+
+	foreach (const AddrFileDefs *addrDefs, addr_file_defs) {
+		foreach (GcnMcFileDef *gcnMcFileDef, addrDefs->defs) {
+			if (gcnMcFileDef->company[0] == 0) {
+				// No company code. Index by ID4.
+				const QString id4 = QString::fromLatin1(
+					gcnMcFileDef->gamecode, sizeof(gcnMcFileDef->gamecode));
+				id4_file_defs[id4].append(gcnMcFileDef);
+			} else {
+				// Index by ID6.
+				const QString id6 = QString::fromLatin1(
+					gcnMcFileDef->id6, sizeof(gcnMcFileDef->id6));
+				id6_file_defs[id6].append(gcnMcFileDef);
+			}
+		}
+	}
 }
 
 
@@ -253,7 +327,11 @@ int GcnMcFileDbPrivate::load(const QString &filename)
 		return -1;
 	}
 
-	QXmlStreamReader xml(&file);
+	// Read the entire file so it can be hashed.
+	const QByteArray data = file.readAll();
+	file.close();
+
+	QXmlStreamReader xml(data);
 	while (!xml.atEnd() && !xml.hasError()) {
 		// Read the next element.
 		QXmlStreamReader::TokenType token = xml.readNext();
@@ -283,7 +361,23 @@ int GcnMcFileDbPrivate::load(const QString &filename)
 		return -2;
 	}
 
+	// Build the combined matchers.
+	foreach (AddrFileDefs *addrDefs, addr_file_defs) {
+		buildCombinedMatcher(addrDefs);
+	}
+
+	// Build the game ID indexes.
+	buildGameIdIndex();
+
+	// Determine how many blocks are needed for the search.
+	// Game Description + File Description == 64 bytes. (0x40)
+	if (!addr_file_defs.isEmpty()) {
+		const uint32_t maxAddress = addr_file_defs.lastKey() + 0x40 - 1;
+		searchBlockCount = (int)(maxAddress / BLOCK_SIZE) + 1;
+	}
+
 	// Database parsed successfully.
+	hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
 	errorString = QString();
 	return 0;
 }
@@ -309,20 +403,24 @@ void GcnMcFileDbPrivate::parseXml_GcnMcFileDb(QXmlStreamReader &xml)
 		    xml.name() == QLatin1String("file")) {
 			// Found a <file> element.
 			GcnMcFileDef *gcnMcFileDef = parseXml_file(xml);
-			if (gcnMcFileDef && gcnMcFileDef->search.address > BLOCK_SIZE_MASK) {
-				// FIXME: Support for files with search address above 0x1FFF.
+			if (gcnMcFileDef && gcnMcFileDef->search.address > BLOCK_SIZE_MASK &&
+			    ((uint64_t)gcnMcFileDef->search.address + 0x40 >
+			     (uint64_t)gcnMcFileDef->dirEntry.length * BLOCK_SIZE))
+			{
+				// Search address is past the end of the file.
+				// NOTE: This also rejects addresses above 0x1FFF
+				// if the file length isn't set.
 				delete gcnMcFileDef;
 			} else if (gcnMcFileDef) {
 				// Add the file to the database.
-				uint32_t address = gcnMcFileDef->search.address;
-				address &= BLOCK_SIZE_MASK;	// search the specific block only
-				QVector<GcnMcFileDef*>* vec = addr_file_defs.value(address);
-				if (!vec) {
-					// Create a new QVector.
-					vec = new QVector<GcnMcFileDef*>();
-					addr_file_defs.insert(address, vec);
+				const uint32_t address = gcnMcFileDef->search.address;
+				AddrFileDefs *addrDefs = addr_file_defs.value(address);
+				if (!addrDefs) {
+					// Create a new AddrFileDefs.
+					addrDefs = new AddrFileDefs();
+					addr_file_defs.insert(address, addrDefs);
 				}
-				vec->append(gcnMcFileDef);
+				addrDefs->defs.append(gcnMcFileDef);
 			}
 		} else {
 			// Skip unreocgnized tokens.
@@ -502,6 +600,15 @@ void GcnMcFileDbPrivate::parseXml_file_search(QXmlStreamReader &xml, GcnMcFileDe
 	gcnMcFileDef->search.gameDesc_regex.optimize();
 	gcnMcFileDef->search.fileDesc_regex.optimize();
 #endif /* QT_VERSION >= QT_VERSION_CHECK(5,4,0) */
+
+	// Set the byte-level prefilters.
+	gcnMcFileDef->search.gameDesc_bytes = ParseByteMatch(gcnMcFileDef->search.gameDesc);
+	gcnMcFileDef->search.fileDesc_bytes = ParseByteMatch(gcnMcFileDef->search.fileDesc);
+
+	// Specificity, for ranking multiple matches.
+	gcnMcFileDef->search.literalLength =
+		RegexLiteralLength(gcnMcFileDef->search.gameDesc) +
+		RegexLiteralLength(gcnMcFileDef->search.fileDesc);
 }
 
 
@@ -832,71 +939,304 @@ void GcnMcFileDbPrivate::parseXml_file_variable(QXmlStreamReader& xml, GcnMcFile
 	}
 }
 
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 /**
- * Get a comment from the GCN comment block, converted to UTF-16.
- * @param buf Comment block
- * @param size Size of comment block (usually 32)
- * @param stringDecoder QStringDecoder (If invalid, use latin1.)
- * @return GCN comment block, converted to UTF-16.
+ * Build the combined Game Description matcher for a search address.
+ * @param addrDefs File definitions for the search address
  */
-QString GcnMcFileDbPrivate::GetGcnCommentUtf16(const char *buf, size_t size, QStringDecoder &stringDecoder)
-#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
+void GcnMcFileDbPrivate::buildCombinedMatcher(AddrFileDefs *addrDefs)
+{
+	addrDefs->gameDesc_combined = QRegularExpression();
+	addrDefs->gameDesc_groups.clear();
+
+	// Only definitions without a byte-level prefilter are combined.
+	int unfilteredCount = 0;
+	foreach (const GcnMcFileDef *gcnMcFileDef, addrDefs->defs) {
+		if (gcnMcFileDef->search.gameDesc_bytes.prefix.isEmpty()) {
+			unfilteredCount++;
+		}
+	}
+	if (unfilteredCount < 2) {
+		// Not worth combining.
+		return;
+	}
+
+	// Backreferences and branch resets depend on group numbering,
+	// which changes when the regexes are combined.
+	static const QRegularExpression noCombineRegex(
+		QLatin1String("\\\\[1-9gk]|\\(\\?\\|"));
+
+	QString combined;
+	QVector<int> groups;
+	groups.reserve(addrDefs->defs.size());
+	int group = 1;
+	foreach (const GcnMcFileDef *gcnMcFileDef, addrDefs->defs) {
+		if (!gcnMcFileDef->search.gameDesc_bytes.prefix.isEmpty()) {
+			// Prefiltered definitions are checked individually.
+			groups.append(0);
+			continue;
+		}
+
+		const QRegularExpression &regex = gcnMcFileDef->search.gameDesc_regex;
+		if (!regex.isValid()) {
+			// Invalid regex. This definition never matches.
+			groups.append(-1);
+			continue;
+		}
+
+		const QString &pattern = gcnMcFileDef->search.gameDesc;
+		if (pattern.contains(noCombineRegex)) {
+			// Can't combine this regex.
+			return;
+		}
+
+		// Optional lookahead: (?:(?=(pattern)))?
+		// Unanchored regexes can match anywhere in the string.
+		combined += QLatin1String("(?:(?=");
+		if (!pattern.startsWith(QChar(L'^'))) {
+			combined += QLatin1String("[\\s\\S]*?");
+		}
+		combined += QChar(L'(') + pattern + QLatin1String(")))?");
+
+		groups.append(group);
+		group += 1 + regex.captureCount();
+	}
+
+	QRegularExpression combinedRegex(combined);
+	if (!combinedRegex.isValid()) {
+		// Combined regex is invalid.
+		return;
+	}
+#if QT_VERSION >= QT_VERSION_CHECK(5,4,0)
+	combinedRegex.optimize();
+#endif /* QT_VERSION >= QT_VERSION_CHECK(5,4,0) */
+
+	addrDefs->gameDesc_combined = combinedRegex;
+	addrDefs->gameDesc_groups = groups;
+}
+
 /**
- * Get a comment from the GCN comment block, converted to UTF-16.
- * @param buf Comment block
- * @param size Size of comment block (usually 32)
- * @param textCodec QTextCodec (If nullptr, use latin1.)
- * @return GCN comment block, converted to UTF-16.
+ * Build a byte-level prefilter for a comment regex.
+ * @param pattern Regex pattern
+ * @return Byte-level prefilter (prefix is empty if the regex can't be prefiltered)
  */
-QString GcnMcFileDbPrivate::GetGcnCommentUtf16(const char *buf, size_t size, QTextCodec *textCodec)
-#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
+GcnMcFileDef::ByteMatch GcnMcFileDbPrivate::ParseByteMatch(const QString &pattern)
 {
-	// Remove trailing NULL characters before converting to UTF-8.
-	const char *p_nullChr = (const char*)memchr(buf, 0x00, size);
-	if (p_nullChr) {
-		// Found a NULL character.
-		if (p_nullChr == buf) {
-			return QString();
+	GcnMcFileDef::ByteMatch byteMatch;
+	if (!pattern.startsWith(QChar(L'^')) || pattern.contains(QChar(L'|'))) {
+		// Not anchored, or has alternations.
+		return byteMatch;
+	}
+
+	// Get the plain ASCII text at the start of the regex.
+	// NOTE: Backslash and tilde are excluded, since some
+	// Shift-JIS variants map them to other characters.
+	QByteArray prefix;
+	bool stop = false;
+	const int len = pattern.size();
+	int i;
+	for (i = 1; i < len && !stop; i++) {
+		ushort chr = pattern.at(i).unicode();
+		if (chr == '\\') {
+			// Escape sequence.
+			// Only escaped punctuation is a literal character.
+			if (i + 1 >= len)
+				break;
+			chr = pattern.at(i + 1).unicode();
+			if (chr < 0x20 || chr >= 0x7F || isalnum(chr) ||
+			    chr == '\\' || chr == '~')
+			{
+				break;
+			}
+			i++;
+		} else if (chr < 0x20 || chr >= 0x7F || chr == '~' ||
+			   strchr(".[](){}*+?^$", (char)chr) != nullptr)
+		{
+			// Not a literal character.
+			break;
 		}
-		size = (p_nullChr - buf);
+
+		// Check for a quantifier.
+		if (i + 1 < len) {
+			const ushort next = pattern.at(i + 1).unicode();
+			if (next == '*' || next == '?' || next == '{') {
+				// This character is optional.
+				break;
+			} else if (next == '+') {
+				// This character is required, but
+				// nothing after it is part of the prefix.
+				stop = true;
+			}
+		}
+
+		prefix.append((char)chr);
 	}
 
-	// Convert the comment to Unicode.
-	// Trim the comment while we're at it.
-	QString comment;
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-	if (stringDecoder.isValid()) {
-		// Use the text codec.
-		comment = QString(stringDecoder.decode(QByteArrayView(buf, size))).trimmed();
-	} else
-#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
-	if (textCodec) {
-		// Use the text codec.
-		comment = textCodec->toUnicode(buf, size).trimmed();
-	} else
-#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
+	if (prefix.isEmpty() || IsTrimmableByte((uint8_t)prefix.at(0))) {
+		// No prefix, or the prefix starts with whitespace.
+		return byteMatch;
+	}
+
+	byteMatch.prefix = prefix;
+	if (!stop && i == len - 1 && pattern.at(i) == QChar(L'$') &&
+	    !IsTrimmableByte((uint8_t)prefix.at(prefix.size() - 1)))
 	{
-		// No text codec was specified.
-		// Default to Latin-1.
-		comment = QString::fromLatin1(buf, size).trimmed();
+		// The entire regex is plain text.
+		byteMatch.exact = true;
+		byteMatch.literal = QString::fromLatin1(prefix);
+	}
+	return byteMatch;
+}
+
+/**
+ * Count the literal characters in a regex.
+ * Character classes, metacharacters, and optional
+ * characters aren't counted.
+ * @param pattern Regex pattern
+ * @return Number of literal characters
+ */
+int GcnMcFileDbPrivate::RegexLiteralLength(const QString &pattern)
+{
+	int count = 0;
+	const int len = pattern.size();
+	for (int i = 0; i < len; i++) {
+		ushort chr = pattern.at(i).unicode();
+		bool isLiteral = false;
+		if (chr == '\\') {
+			// Escape sequence.
+			// Escaped letters and digits are classes or backreferences.
+			if (i + 1 >= len)
+				break;
+			chr = pattern.at(++i).unicode();
+			isLiteral = !(chr < 0x80 && isalnum(chr));
+		} else if (chr == '[') {
+			// Character class. Skip it.
+			// NOTE: ']' is literal if it's the first character.
+			i++;
+			if (i < len && pattern.at(i) == QChar(L'^'))
+				i++;
+			if (i < len && pattern.at(i) == QChar(L']'))
+				i++;
+			for (; i < len && pattern.at(i) != QChar(L']'); i++) {
+				if (pattern.at(i) == QChar(L'\\'))
+					i++;
+			}
+		} else if (chr == '{') {
+			// Quantifier. Skip it.
+			while (i < len && pattern.at(i) != QChar(L'}'))
+				i++;
+		} else if (chr == '(') {
+			// Group. Skip the group options.
+			if (i + 1 < len && pattern.at(i + 1) == QChar(L'?')) {
+				i += 2;
+				if (i < len && (pattern.at(i) == QChar(L'<') || pattern.at(i) == QChar(L'P'))) {
+					// Named group, or lookbehind.
+					while (i < len && pattern.at(i) != QChar(L'>') &&
+					       pattern.at(i) != QChar(L'=') && pattern.at(i) != QChar(L'!'))
+					{
+						i++;
+					}
+				}
+			}
+		} else if (chr >= 0x80 || (chr >= 0x20 && strchr(".|)^$*+?", (char)chr) == nullptr)) {
+			// Literal character.
+			isLiteral = true;
+		}
+
+		if (!isLiteral)
+			continue;
+
+		// Optional characters aren't counted.
+		if (i + 1 < len) {
+			const ushort next = pattern.at(i + 1).unicode();
+			if (next == '*' || next == '?')
+				continue;
+		}
+		count++;
 	}
 
-	// Comment converted to UTF-16.
-	return comment;
+	return count;
+}
+
+/**
+ * Match a comment against a file definition's regex.
+ * The comment is checked against the byte-level prefilter first,
+ * and is only decoded if the prefilter can't reject it.
+ * @param ctx		[in] Match context
+ * @param address	[in] Comment address
+ * @param field		[in] Comment field
+ * @param byteMatch	[in] Byte-level prefilter
+ * @param regex		[in] Regex
+ * @param capturedTexts	[out] Captured texts, if matched
+ * @return True if the comment matches; false if not.
+ */
+bool GcnMcFileDbPrivate::MatchComment(GcnMcFileMatchContext *ctx,
+	uint32_t address, GcnMcFileMatchContext::Field field,
+	const GcnMcFileDef::ByteMatch &byteMatch,
+	const QRegularExpression &regex,
+	QStringList *capturedTexts)
+{
+	if (!byteMatch.prefix.isEmpty()) {
+		size_t len;
+		const char *const raw = ctx->rawComment(address, field, &len);
+		if (len == 0) {
+			// Empty comment.
+			return false;
+		}
+
+		// If the comment starts with whitespace, the decoded comment
+		// will be trimmed, so the raw bytes can't be checked.
+		if (!IsTrimmableByte((uint8_t)raw[0])) {
+			// Plain ASCII is the same in both cp1252 and Shift-JIS,
+			// so if the prefix doesn't match, neither decoding will.
+			const size_t prefixLen = (size_t)byteMatch.prefix.size();
+			if (len < prefixLen || memcmp(raw, byteMatch.prefix.constData(), prefixLen) != 0) {
+				// Prefix doesn't match.
+				return false;
+			}
+
+			if (byteMatch.exact && len == prefixLen) {
+				// Exact match. No need to decode the comment.
+				*capturedTexts = QStringList(byteMatch.literal);
+				return true;
+			}
+		}
+	}
+
+	// Check if the comment (US) matches.
+	QRegularExpressionMatch match = regex.match(
+		ctx->comment(address, field, GcnMcFileMatchContext::ENC_US));
+	if (!match.hasMatch()) {
+		// No match for US.
+		if (ctx->isAsciiComment(address, field)) {
+			// Plain ASCII. JP is the same as US.
+			return false;
+		}
+
+		// Check if the comment (JP) matches.
+		match = regex.match(ctx->comment(address, field, GcnMcFileMatchContext::ENC_JP));
+		if (!match.hasMatch()) {
+			// No match for JP.
+			return false;
+		}
+	}
+
+	*capturedTexts = match.capturedTexts();
+	return true;
 }
 
 /**
  * Construct a GcnSearchData entry.
+ * @param ctx		[in] Match context
  * @param matchFileDef	[in] File definition
  * @param vars		[in] Variables
  * @param qDateTime	[in] Timestamp
  * @return GcnSearchData entry
  */
 GcnSearchData GcnMcFileDbPrivate::constructSearchData(
+	GcnMcFileMatchContext *ctx,
 	const GcnMcFileDef *matchFileDef,
 	const QHash<QString, QString> &vars,
-	const QDateTime &qDateTime) const
+	const QDateTime &qDateTime)
 {
 	// TODO: Implicitly share GcnSearchData?
 	GcnSearchData searchData;
@@ -907,33 +1247,13 @@ GcnSearchData GcnMcFileDbPrivate::constructSearchData(
 	memcpy(dirEntry->gamecode, matchFileDef->gamecode, sizeof(dirEntry->gamecode));
 	memcpy(dirEntry->company,  matchFileDef->company,  sizeof(dirEntry->company));
 
-	// Convert the filename to the correct encoding.
-	QByteArray ba;
-
 	// Substitute variables in the filename.
 	QString filename = VarReplace::Exec(matchFileDef->dirEntry.filename, vars);
 
 	// Filename
+	// JP files use Shift-JIS; US/EU files use cp1252.
 	// FIXME: Also for 'S' (used by SADX preview)?
-	// FIXME: What if the US encoder isn't working?
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-	if (dirEntry->gamecode[3] == 'J' && stringEncoderJP.isValid()) {
-		// JP file. Convert to Shift-JIS.
-		ba = stringEncoderJP.encode(filename);
-	} else if (stringEncoderUS.isValid()) {
-		// US/EU file. Convert to cp1252.
-		ba = stringEncoderUS.encode(filename);
-	}
-#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
-	if (dirEntry->gamecode[3] == 'J' && textCodecJP) {
-		// JP file. Convert to Shift-JIS.
-		ba = textCodecJP->fromUnicode(filename);
-	} else if (textCodecUS) {
-		// US/EU file. Convert to cp1252.
-		ba = textCodecUS->fromUnicode(filename);
-	}
-#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
-
+	QByteArray ba = ctx->encodeFilename(filename, (dirEntry->gamecode[3] == 'J'));
 	if (ba.isEmpty()) {
 		// QByteArray is empty. Conversion failed.
 		// Convert to Latin1 instead.
@@ -949,7 +1269,6 @@ GcnSearchData GcnMcFileDbPrivate::constructSearchData(
 	/**
 	 * TODO:
 	 * - Use the actual starting block?
-	 * - Block offsets for files with commentaddr >= 0x2000
 	 * - Support for variable-length files?
 	 */
 	dirEntry->pad_00	= 0xFF;
@@ -968,6 +1287,9 @@ GcnSearchData GcnMcFileDbPrivate::constructSearchData(
 	// Checksum data.
 	searchData.checksumDefs = matchFileDef->checksumDefs;
 
+	// Specificity.
+	searchData.specificity = matchFileDef->search.literalLength;
+
 	// Return the SearchData entry.
 	return searchData;
 }
@@ -1012,76 +1334,100 @@ QString GcnMcFileDb::errorString(void) const
 
 /**
  * Check a GCN memory card block to see if it matches any search patterns.
- * @param buf	[in] GCN memory card block to check
- * @param size	[in] Size of buf (Should be BLOCK_SIZE == 0x2000.)
+ * This function is thread-safe, as long as each thread uses its own context.
+ * @param ctx	[in] Match context, with the block to check set
  * @return QVector of matches, or empty QVector if no matches were found.
  */
-QVector<GcnSearchData> GcnMcFileDb::checkBlock(const void *buf, size_t size) const
+QVector<GcnSearchData> GcnMcFileDb::checkBlock(GcnMcFileMatchContext *ctx) const
 {
 	// File entry matches.
 	QVector<GcnSearchData> fileMatches;
 
 	Q_D(const GcnMcFileDb);
-	foreach (uint32_t address, d->addr_file_defs.keys()) {
+	const size_t size = ctx->blockSize();
+	for (auto iter = d->addr_file_defs.constBegin();
+	     iter != d->addr_file_defs.constEnd(); ++iter)
+	{
 		// Make sure this address is within the bounds of the buffer.
 		// Game Description + File Description == 64 bytes. (0x40)
-		const int maxAddress = (int)(address + 0x40);
-		if (maxAddress < 0 || maxAddress > size) {
-			continue;
+		// NOTE: Addresses are sorted, so none of the remaining
+		// addresses are within the buffer, either.
+		const uint32_t address = iter.key();
+		const size_t maxAddress = ((size_t)address + 0x40);
+		if (maxAddress > size) {
+			break;
 		}
 
-		// Get the game description and file description.
-		const char *const commentData = ((const char*)buf + address);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-		const QString gameDescUS = d->GetGcnCommentUtf16(commentData, 32, d->stringDecoderUS);
-		const QString gameDescJP = d->GetGcnCommentUtf16(commentData, 32, d->stringDecoderJP);
-		const QString fileDescUS = d->GetGcnCommentUtf16(commentData+32, 32, d->stringDecoderUS);
-		const QString fileDescJP = d->GetGcnCommentUtf16(commentData+32, 32, d->stringDecoderJP);
-#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
-		const QString gameDescUS = d->GetGcnCommentUtf16(commentData, 32, d->textCodecUS);
-		const QString gameDescJP = d->GetGcnCommentUtf16(commentData, 32, d->textCodecJP);
-		const QString fileDescUS = d->GetGcnCommentUtf16(commentData+32, 32, d->textCodecUS);
-		const QString fileDescJP = d->GetGcnCommentUtf16(commentData+32, 32, d->textCodecJP);
-#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
-
-		QVector<GcnMcFileDef*> *vec = d->addr_file_defs.value(address);
-		foreach (const GcnMcFileDef *gcnMcFileDef, *vec) {
-			// Check if the Game Description (US) matches.
-			QRegularExpressionMatch gameDescMatch =
-				gcnMcFileDef->search.gameDesc_regex.match(gameDescUS);
-			if (!gameDescMatch.hasMatch()) {
-				// No match for US.
-				// Check if the Game Description (JP) matches.
-				gameDescMatch = gcnMcFileDef->search.gameDesc_regex.match(gameDescJP);
-				if (!gameDescMatch.hasMatch()) {
-					// No match for JP.
-					continue;
+		const GcnMcFileDbPrivate::AddrFileDefs *const addrDefs = iter.value();
+		const bool isCombined = !addrDefs->gameDesc_groups.isEmpty();
+		QRegularExpressionMatch combinedMatchUS, combinedMatchJP;
+		bool combinedChecked = false;
+		bool checkJP = false;
+
+		const int defCount = addrDefs->defs.size();
+		for (int i = 0; i < defCount; i++) {
+			const GcnMcFileDef *const gcnMcFileDef = addrDefs->defs.at(i);
+			const int group = (isCombined ? addrDefs->gameDesc_groups.at(i) : 0);
+			if (group < 0) {
+				// Invalid regex.
+				continue;
+			} else if (group > 0) {
+				if (!combinedChecked) {
+					// Find all matching unfiltered Game Descriptions in a single pass.
+					// NOTE: The combined regex always matches, since all of
+					// the lookaheads are optional. Check the capture groups.
+					combinedMatchUS = addrDefs->gameDesc_combined.match(
+						ctx->comment(address, GcnMcFileMatchContext::FIELD_GAMEDESC,
+							GcnMcFileMatchContext::ENC_US));
+					checkJP = !ctx->isAsciiComment(address, GcnMcFileMatchContext::FIELD_GAMEDESC);
+					if (checkJP) {
+						combinedMatchJP = addrDefs->gameDesc_combined.match(
+							ctx->comment(address, GcnMcFileMatchContext::FIELD_GAMEDESC,
+								GcnMcFileMatchContext::ENC_JP));
+					}
+					combinedChecked = true;
 				}
-			}
 
-			// Check if the File Description (US) matches.
-			QRegularExpressionMatch fileDescMatch =
-				gcnMcFileDef->search.fileDesc_regex.match(fileDescUS);
-			if (!fileDescMatch.hasMatch()) {
-				// No match for US.
-				// Check if the Game Description (JP) matches.
-				fileDescMatch = gcnMcFileDef->search.fileDesc_regex.match(fileDescJP);
-				if (!fileDescMatch.hasMatch()) {
-					// No match for JP.
+				// Check the combined match.
+				if (combinedMatchUS.capturedStart(group) < 0 &&
+				    (!checkJP || combinedMatchJP.capturedStart(group) < 0))
+				{
+					// No match.
 					continue;
 				}
 			}
 
+			// Check if the Game Description matches.
+			// Prefiltered definitions are rejected here without
+			// decoding the comment, unless the prefilter passes.
+			// If the combined match succeeded, this gets the captured texts.
+			QStringList gameDescCaptures;
+			if (!d->MatchComment(ctx, address, GcnMcFileMatchContext::FIELD_GAMEDESC,
+			    gcnMcFileDef->search.gameDesc_bytes, gcnMcFileDef->search.gameDesc_regex,
+			    &gameDescCaptures))
+			{
+				continue;
+			}
+
+			// Check if the File Description matches.
+			QStringList fileDescCaptures;
+			if (!d->MatchComment(ctx, address, GcnMcFileMatchContext::FIELD_FILEDESC,
+			    gcnMcFileDef->search.fileDesc_bytes, gcnMcFileDef->search.fileDesc_regex,
+			    &fileDescCaptures))
+			{
+				continue;
+			}
+
 			// Found a match.
 			// Attempt to apply variable modifiers.
 			QDateTime qDateTime;
 			QHash<QString, QString> vars = VarReplace::StringListsToHash(
-				gameDescMatch.capturedTexts(), fileDescMatch.capturedTexts());
+				gameDescCaptures, fileDescCaptures);
 			int ret = VarReplace::ApplyModifiers(gcnMcFileDef->varModifiers, vars, &qDateTime);
 			if (ret == 0) {
 				// Variable modifiers applied successfully.
 				// Construct a GcnSearchData struct for this file entry.
-				fileMatches.append(d->constructSearchData(gcnMcFileDef, vars, qDateTime));
+				fileMatches.append(d->constructSearchData(ctx, gcnMcFileDef, vars, qDateTime));
 			}
 		}
 	}
@@ -1091,6 +1437,32 @@ QVector<GcnSearchData> GcnMcFileDb::checkBlock(const void *buf, size_t size) con
 }
 
 
+/**
+ * Get the number of blocks needed by checkBlock().
+ * Search addresses above 0x1FFF are in the file's
+ * subsequent blocks, so checkBlock() needs the
+ * candidate first block and the blocks after it.
+ * @return Number of blocks, starting with the file's first block.
+ */
+int GcnMcFileDb::searchBlockCount(void) const
+{
+	Q_D(const GcnMcFileDb);
+	return d->searchBlockCount;
+}
+
+
+/**
+ * Get the SHA-1 hash of the database file.
+ * Used to check if search results were made with this database.
+ * @return SHA-1 hash, or empty QByteArray if no database is loaded.
+ */
+QByteArray GcnMcFileDb::hash(void) const
+{
+	Q_D(const GcnMcFileDb);
+	return d->hash;
+}
+
+
 /**
  * Get a list of database files.
  * This function checks various paths for *.xml.
@@ -1205,17 +1577,23 @@ bool GcnMcFileDb::addChecksumDefs(GcnFile *file) const
 	const QString &gameDesc = desc[0];
 	const QString &fileDesc = desc[1];
 
-	// TODO: QHash<> with the game ID?
+	// Check definitions with a matching ID6 first,
+	// then definitions that only have an ID4.
 	const QString gameID = file->gameID();
 	Q_D(const GcnMcFileDb);
-	foreach (QVector<GcnMcFileDef*>* vec, d->addr_file_defs) {
-		foreach (GcnMcFileDef* gcnMcFileDef, *vec) {
-			// Check if this file matches.
-			if (gameID != QLatin1String(gcnMcFileDef->id6, sizeof(gcnMcFileDef->id6))) {
-				// No match.
-				continue;
-			}
+	const QHash<QString, QVector<GcnMcFileDef*> > *const indexes[2] = {
+		&d->id6_file_defs, &d->id4_file_defs
+	};
+	const QString ids[2] = {gameID, gameID.left(4)};
+
+	for (int i = 0; i < 2; i++) {
+		auto iter = indexes[i]->constFind(ids[i]);
+		if (iter == indexes[i]->constEnd()) {
+			// No definitions for this game ID.
+			continue;
+		}
 
+		foreach (const GcnMcFileDef *gcnMcFileDef, *iter) {
 			// Make sure the GameDesc matches.
 			QRegularExpressionMatch gameDescMatch =
 				gcnMcFileDef->search.gameDesc_regex.match(gameDesc);
@@ -18,12 +18,21 @@
 #include "GcnSearchData.hpp"
 
 // Qt includes.
+#include <QtCore/QByteArray>
 #include <QtCore/QObject>
 #include <QtCore/QString>
 #include <QtCore/QVector>
 
 class GcnFile;
+class GcnMcFileMatchContext;
 
+/**
+ * GCN Memory Card File database.
+ *
+ * The database is immutable once loaded, so all const functions
+ * are thread-safe. Multiple threads can share one database; each
+ * thread needs its own GcnMcFileMatchContext for checkBlock().
+ */
 class GcnMcFileDbPrivate;
 class GcnMcFileDb : public QObject
 {
@@ -57,11 +66,32 @@ public:
 
 	/**
 	 * Check a GCN memory card block to see if it matches any search patterns.
-	 * @param buf	[in] GCN memory card block to check
-	 * @param size	[in] Size of buf (Should be BLOCK_SIZE == 0x2000.)
+	 * This function is thread-safe, as long as each thread uses its own context.
+	 *
+	 * The context's block data should start with the candidate first block,
+	 * followed by up to searchBlockCount()-1 subsequent blocks. Search addresses
+	 * past the end of the block data are skipped.
+	 *
+	 * @param ctx	[in] Match context, with the block to check set
 	 * @return QVector of matches, or empty QVector if no matches were found.
 	 */
-	QVector<GcnSearchData> checkBlock(const void *buf, size_t size) const;
+	QVector<GcnSearchData> checkBlock(GcnMcFileMatchContext *ctx) const;
+
+	/**
+	 * Get the number of blocks needed by checkBlock().
+	 * Search addresses above 0x1FFF are in the file's
+	 * subsequent blocks, so checkBlock() needs the
+	 * candidate first block and the blocks after it.
+	 * @return Number of blocks, starting with the file's first block.
+	 */
+	int searchBlockCount(void) const;
+
+	/**
+	 * Get the SHA-1 hash of the database file.
+	 * Used to check if search results were made with this database.
+	 * @return SHA-1 hash, or empty QByteArray if no database is loaded.
+	 */
+	QByteArray hash(void) const;
 
 	/**
 	 * Get a list of database files.
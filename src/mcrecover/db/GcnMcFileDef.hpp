@@ -16,6 +16,7 @@
 #include <vector>
 
 // Qt includes
+#include <QtCore/QByteArray>
 #include <QtCore/QString>
 #include <QtCore/QHash>
 #include <QtCore/QRegularExpression>
@@ -53,6 +54,23 @@ public:
 		};
 	};
 
+	/**
+	 * Byte-level prefilter for a comment regex.
+	 * Set when the database is loaded.
+	 *
+	 * If the regex is anchored and starts with plain ASCII text,
+	 * that text must appear at the start of the raw comment bytes,
+	 * regardless of encoding. Comments that don't start with it
+	 * can be rejected without decoding the comment.
+	 */
+	struct ByteMatch {
+		ByteMatch() : exact(false) { }
+
+		QByteArray prefix;	// Required prefix (plain ASCII; empty if none)
+		QString literal;	// prefix, as a QString (only if exact)
+		bool exact;		// If true, the regex matches exactly prefix.
+	};
+
 	// Regions this file definition applies to
 	uint8_t regions;
 
@@ -69,6 +87,14 @@ public:
 		// Regular expressions
 		QRegularExpression gameDesc_regex;
 		QRegularExpression fileDesc_regex;
+
+		// Byte-level prefilters
+		ByteMatch gameDesc_bytes;
+		ByteMatch fileDesc_bytes;
+
+		// Number of literal characters in gameDesc and fileDesc.
+		// Set when the database is loaded.
+		int literalLength;
 	} search;
 
 	/**
@@ -104,6 +130,7 @@ public:
 		memset(id6, 0, sizeof(id6));
 
 		search.address = 0;
+		search.literalLength = 0;
 
 		dirEntry.bannerFormat = 0;
 		dirEntry.iconAddress = 0;
@@ -0,0 +1,335 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * GcnMcFileMatchContext.cpp: GCN Memory Card File Database match context. *
+ *                                                                         *
+ * Copyright (c) 2013-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "GcnMcFileMatchContext.hpp"
+
+// C includes (C++ namespace)
+#include <cstring>
+
+// Qt includes
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#  include <QtCore/QStringDecoder>
+#  include <QtCore/QStringEncoder>
+#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
+#  include <QtCore/QTextCodec>
+#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
+
+/** GcnMcFileMatchContextPrivate **/
+
+class GcnMcFileMatchContextPrivate
+{
+public:
+	GcnMcFileMatchContextPrivate();
+
+private:
+	Q_DISABLE_COPY(GcnMcFileMatchContextPrivate)
+
+public:
+	// Current block
+	const uint8_t *buf;
+	size_t size;
+
+	/**
+	 * Decoded comments for a single address.
+	 * Each comment is decoded on first use.
+	 */
+	struct Comments {
+		Comments() : decoded(0), asciiChecked(0), ascii(0) { }
+
+		QString str[GcnMcFileMatchContext::FIELD_MAX][GcnMcFileMatchContext::ENC_MAX];
+		uint8_t decoded;	// Bitfield: (1 << (field * ENC_MAX + encoding))
+		uint8_t asciiChecked;	// Bitfield: (1 << field)
+		uint8_t ascii;		// Bitfield: (1 << field)
+	};
+
+	// Decoded comments for the current block.
+	// Key: Comment address
+	QHash<uint32_t, Comments> comments;
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+	// String decoders
+	QStringDecoder stringDecoderJP;
+	QStringDecoder stringDecoderUS;
+
+	// String encoders
+	QStringEncoder stringEncoderJP;
+	QStringEncoder stringEncoderUS;
+
+	/**
+	 * Get a comment from the GCN comment block, converted to UTF-16.
+	 * @param buf Comment block
+	 * @param size Size of comment block (usually 32)
+	 * @param stringDecoder QStringDecoder (If invalid, use latin1.)
+	 * @return GCN comment block, converted to UTF-16.
+	 */
+	static QString GetGcnCommentUtf16(const char *buf, size_t size, QStringDecoder &stringDecoder);
+#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
+	// Text codecs
+	QTextCodec *const textCodecJP;
+	QTextCodec *const textCodecUS;
+
+	/**
+	 * Get a comment from the GCN comment block, converted to UTF-16.
+	 * @param buf Comment block
+	 * @param size Size of comment block (usually 32)
+	 * @param textCodec QTextCodec (If nullptr, use latin1.)
+	 * @return GCN comment block, converted to UTF-16.
+	 */
+	static QString GetGcnCommentUtf16(const char *buf, size_t size, QTextCodec *textCodec);
+#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
+};
+
+GcnMcFileMatchContextPrivate::GcnMcFileMatchContextPrivate()
+	: buf(nullptr)
+	, size(0)
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+	, stringDecoderJP("Shift_JIS")
+	, stringDecoderUS("cp1252")
+	, stringEncoderJP("Shift_JIS")
+	, stringEncoderUS("cp1252")
+#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
+	, textCodecJP(QTextCodec::codecForName("Shift-JIS"))
+	, textCodecUS(QTextCodec::codecForName("cp1252"))
+#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
+{ }
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+/**
+ * Get a comment from the GCN comment block, converted to UTF-16.
+ * @param buf Comment block
+ * @param size Size of comment block (usually 32)
+ * @param stringDecoder QStringDecoder (If invalid, use latin1.)
+ * @return GCN comment block, converted to UTF-16.
+ */
+QString GcnMcFileMatchContextPrivate::GetGcnCommentUtf16(const char *buf, size_t size, QStringDecoder &stringDecoder)
+#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
+/**
+ * Get a comment from the GCN comment block, converted to UTF-16.
+ * @param buf Comment block
+ * @param size Size of comment block (usually 32)
+ * @param textCodec QTextCodec (If nullptr, use latin1.)
+ * @return GCN comment block, converted to UTF-16.
+ */
+QString GcnMcFileMatchContextPrivate::GetGcnCommentUtf16(const char *buf, size_t size, QTextCodec *textCodec)
+#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
+{
+	// Remove trailing NULL characters before converting to UTF-8.
+	const char *p_nullChr = (const char*)memchr(buf, 0x00, size);
+	if (p_nullChr) {
+		// Found a NULL character.
+		if (p_nullChr == buf) {
+			return QString();
+		}
+		size = (p_nullChr - buf);
+	}
+
+	// Convert the comment to Unicode.
+	// Trim the comment while we're at it.
+	QString comment;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+	if (stringDecoder.isValid()) {
+		// Use the text codec.
+		comment = QString(stringDecoder.decode(QByteArrayView(buf, size))).trimmed();
+	} else
+#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
+	if (textCodec) {
+		// Use the text codec.
+		comment = textCodec->toUnicode(buf, size).trimmed();
+	} else
+#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
+	{
+		// No text codec was specified.
+		// Default to Latin-1.
+		comment = QString::fromLatin1(buf, size).trimmed();
+	}
+
+	// Comment converted to UTF-16.
+	return comment;
+}
+
+/** GcnMcFileMatchContext **/
+
+GcnMcFileMatchContext::GcnMcFileMatchContext()
+	: d_ptr(new GcnMcFileMatchContextPrivate())
+{ }
+
+GcnMcFileMatchContext::~GcnMcFileMatchContext()
+{
+	delete d_ptr;
+}
+
+/**
+ * Set the block to check.
+ * This clears the decoded comment cache.
+ * @param buf GCN memory card block, followed by any subsequent blocks
+ *            needed for search addresses above 0x1FFF.
+ *            (must remain valid until the next setBlock())
+ * @param size Size of buf (Should be a multiple of BLOCK_SIZE == 0x2000.)
+ */
+void GcnMcFileMatchContext::setBlock(const void *buf, size_t size)
+{
+	Q_D(GcnMcFileMatchContext);
+	d->buf = static_cast<const uint8_t*>(buf);
+	d->size = size;
+	d->comments.clear();
+}
+
+/**
+ * Get the current block.
+ * @return Current block
+ */
+const uint8_t *GcnMcFileMatchContext::block(void) const
+{
+	Q_D(const GcnMcFileMatchContext);
+	return d->buf;
+}
+
+/**
+ * Get the size of the current block.
+ * @return Size of the current block
+ */
+size_t GcnMcFileMatchContext::blockSize(void) const
+{
+	Q_D(const GcnMcFileMatchContext);
+	return d->size;
+}
+
+/**
+ * Get a raw comment from the current block.
+ * The comment is truncated at the first NULL character.
+ * It is *not* trimmed.
+ * The caller must make sure the comments are within the block.
+ * @param address	[in] Comment address
+ * @param field		[in] Comment field
+ * @param pLen		[out] Length of the comment, in bytes
+ * @return Raw comment (not NULL-terminated)
+ */
+const char *GcnMcFileMatchContext::rawComment(uint32_t address, Field field, size_t *pLen) const
+{
+	Q_D(const GcnMcFileMatchContext);
+	const char *const commentData =
+		(reinterpret_cast<const char*>(d->buf) + address + (field * 32));
+	const char *p_nullChr = (const char*)memchr(commentData, 0x00, 32);
+	*pLen = (p_nullChr ? (size_t)(p_nullChr - commentData) : 32);
+	return commentData;
+}
+
+/**
+ * Is a comment plain ASCII?
+ * Plain ASCII comments decode the same way in cp1252
+ * and Shift-JIS, so there's no need to check both.
+ * The caller must make sure the comments are within the block.
+ * @param address Comment address
+ * @param field Comment field
+ * @return True if the comment is plain ASCII.
+ */
+bool GcnMcFileMatchContext::isAsciiComment(uint32_t address, Field field)
+{
+	Q_D(GcnMcFileMatchContext);
+	GcnMcFileMatchContextPrivate::Comments &c = d->comments[address];
+	const uint8_t bit = (1U << field);
+	if (!(c.asciiChecked & bit)) {
+		size_t len;
+		const uint8_t *p = reinterpret_cast<const uint8_t*>(rawComment(address, field, &len));
+		bool ascii = true;
+		for (; len > 0; len--, p++) {
+			// NOTE: Some Shift-JIS variants map the backslash and tilde
+			// to the yen sign and overline.
+			if (*p >= 0x80 || *p == '\\' || *p == '~') {
+				ascii = false;
+				break;
+			}
+		}
+
+		c.asciiChecked |= bit;
+		if (ascii) {
+			c.ascii |= bit;
+		}
+	}
+
+	return !!(c.ascii & bit);
+}
+
+/**
+ * Get a decoded comment from the current block.
+ * Comments are decoded on first use and cached until
+ * the next setBlock().
+ * The caller must make sure the comments are within the block.
+ * @param address Comment address
+ * @param field Comment field
+ * @param encoding Encoding
+ * @return Decoded, trimmed comment
+ */
+QString GcnMcFileMatchContext::comment(uint32_t address, Field field, Encoding encoding)
+{
+	Q_D(GcnMcFileMatchContext);
+	const uint8_t bit = (1U << (field * ENC_MAX + encoding));
+	{
+		const GcnMcFileMatchContextPrivate::Comments &c = d->comments[address];
+		if (c.decoded & bit) {
+			// Comment was already decoded.
+			return c.str[field][encoding];
+		}
+	}
+
+	QString str;
+	if (encoding == ENC_JP && isAsciiComment(address, field)) {
+		// Plain ASCII. Shift-JIS is the same as cp1252.
+		str = comment(address, field, ENC_US);
+	} else {
+		const char *const commentData =
+			(reinterpret_cast<const char*>(d->buf) + address + (field * 32));
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+		str = d->GetGcnCommentUtf16(commentData, 32,
+			(encoding == ENC_JP ? d->stringDecoderJP : d->stringDecoderUS));
+#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
+		str = d->GetGcnCommentUtf16(commentData, 32,
+			(encoding == ENC_JP ? d->textCodecJP : d->textCodecUS));
+#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
+	}
+
+	// NOTE: Look up the cache entry again, since
+	// the recursive call above may have modified it.
+	GcnMcFileMatchContextPrivate::Comments &c = d->comments[address];
+	c.str[field][encoding] = str;
+	c.decoded |= bit;
+	return str;
+}
+
+/**
+ * Encode a filename for a directory entry.
+ * @param filename Filename
+ * @param isJP If true, use Shift-JIS; otherwise, use cp1252.
+ * @return Encoded filename, or empty QByteArray on error.
+ */
+QByteArray GcnMcFileMatchContext::encodeFilename(const QString &filename, bool isJP)
+{
+	Q_D(GcnMcFileMatchContext);
+	QByteArray ba;
+
+	// FIXME: What if the US encoder isn't working?
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+	if (isJP && d->stringEncoderJP.isValid()) {
+		// JP file. Convert to Shift-JIS.
+		ba = d->stringEncoderJP.encode(filename);
+	} else if (d->stringEncoderUS.isValid()) {
+		// US/EU file. Convert to cp1252.
+		ba = d->stringEncoderUS.encode(filename);
+	}
+#else /* QT_VERSION < QT_VERSION_CHECK(6, 0, 0) */
+	if (isJP && d->textCodecJP) {
+		// JP file. Convert to Shift-JIS.
+		ba = d->textCodecJP->fromUnicode(filename);
+	} else if (d->textCodecUS) {
+		// US/EU file. Convert to cp1252.
+		ba = d->textCodecUS->fromUnicode(filename);
+	}
+#endif /* QT_VERSION >= QT_VERSION_CHECK(6, 0, 0) */
+
+	return ba;
+}
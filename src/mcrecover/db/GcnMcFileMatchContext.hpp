@@ -0,0 +1,132 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * GcnMcFileMatchContext.hpp: GCN Memory Card File Database match context. *
+ *                                                                         *
+ * Copyright (c) 2013-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#pragma once
+
+// C includes
+#include <stddef.h>
+#include <stdint.h>
+
+// Qt includes
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+
+/**
+ * Per-thread state for matching blocks against GcnMcFileDb.
+ *
+ * GcnMcFileDb is immutable once loaded, so any number of threads
+ * can match against the same database. The text decoders and
+ * encoders have internal state, so each thread needs its own
+ * GcnMcFileMatchContext.
+ *
+ * The context also caches the decoded comments for the current
+ * block, so checking a block against multiple databases only
+ * decodes each comment once. Comments are only decoded when
+ * a definition actually needs them; most definitions can be
+ * rejected using the raw bytes. (See GcnMcFileDb::checkBlock().)
+ */
+class GcnMcFileMatchContextPrivate;
+class GcnMcFileMatchContext
+{
+	public:
+		GcnMcFileMatchContext();
+		~GcnMcFileMatchContext();
+
+	protected:
+		GcnMcFileMatchContextPrivate *const d_ptr;
+		Q_DECLARE_PRIVATE(GcnMcFileMatchContext)
+	private:
+		Q_DISABLE_COPY(GcnMcFileMatchContext)
+
+	public:
+		/**
+		 * Comment fields.
+		 */
+		enum Field {
+			FIELD_GAMEDESC = 0,	// Game description
+			FIELD_FILEDESC = 1,	// File description
+
+			FIELD_MAX
+		};
+
+		/**
+		 * Comment encodings.
+		 */
+		enum Encoding {
+			ENC_US = 0,	// cp1252
+			ENC_JP = 1,	// Shift-JIS
+
+			ENC_MAX
+		};
+
+		/**
+		 * Set the block to check.
+		 * This clears the decoded comment cache.
+		 * @param buf GCN memory card block, followed by any subsequent blocks
+		 *            needed for search addresses above 0x1FFF.
+		 *            (must remain valid until the next setBlock())
+		 * @param size Size of buf (Should be a multiple of BLOCK_SIZE == 0x2000.)
+		 */
+		void setBlock(const void *buf, size_t size);
+
+		/**
+		 * Get the current block.
+		 * @return Current block
+		 */
+		const uint8_t *block(void) const;
+
+		/**
+		 * Get the size of the current block.
+		 * @return Size of the current block
+		 */
+		size_t blockSize(void) const;
+
+		/**
+		 * Get a raw comment from the current block.
+		 * The comment is truncated at the first NULL character.
+		 * It is *not* trimmed.
+		 * The caller must make sure the comments are within the block.
+		 * @param address	[in] Comment address
+		 * @param field		[in] Comment field
+		 * @param pLen		[out] Length of the comment, in bytes
+		 * @return Raw comment (not NULL-terminated)
+		 */
+		const char *rawComment(uint32_t address, Field field, size_t *pLen) const;
+
+		/**
+		 * Is a comment plain ASCII?
+		 * Plain ASCII comments decode the same way in cp1252
+		 * and Shift-JIS, so there's no need to check both.
+		 * The caller must make sure the comments are within the block.
+		 * @param address Comment address
+		 * @param field Comment field
+		 * @return True if the comment is plain ASCII.
+		 */
+		bool isAsciiComment(uint32_t address, Field field);
+
+		/**
+		 * Get a decoded comment from the current block.
+		 * Comments are decoded on first use and cached until
+		 * the next setBlock().
+		 * The caller must make sure the comments are within the block.
+		 * @param address Comment address
+		 * @param field Comment field
+		 * @param encoding Encoding
+		 * @return Decoded, trimmed comment
+		 */
+		QString comment(uint32_t address, Field field, Encoding encoding);
+
+		/**
+		 * Encode a filename for a directory entry.
+		 * @param filename Filename
+		 * @param isJP If true, use Shift-JIS; otherwise, use cp1252.
+		 * @return Encoded filename, or empty QByteArray on error.
+		 */
+		QByteArray encodeFilename(const QString &filename, bool isJP);
+};
@@ -21,6 +21,7 @@
 using std::list;
 
 // Qt includes
+#include <QtCore/QSharedPointer>
 #include <QtCore/QStack>
 #include <QtCore/QThread>
 
@@ -38,7 +39,14 @@ private:
 
 public:
 	// GCN Memory Card File databases
-	QVector<GcnMcFileDb*> dbs;
+	// NOTE: The databases may be shared with other threads.
+	QVector<QSharedPointer<GcnMcFileDb> > dbs;
+
+	/**
+	 * Get raw pointers to the databases for the worker.
+	 * @return Databases
+	 */
+	QVector<GcnMcFileDb*> dbPointers(void) const;
 
 	// Worker object
 	// NOTE: This object cannot have a parent;
@@ -48,6 +56,9 @@ public:
 	// Worker thread
 	QThread *workerThread;
 
+	// Checkpoint filename (empty if disabled)
+	QString checkpointFilename;
+
 	/**
 	 * Stop the worker thread.
 	 */
@@ -59,11 +70,21 @@ GcnSearchThreadPrivate::GcnSearchThreadPrivate(GcnSearchThread* q)
 	, worker(new GcnSearchWorker())
 	, workerThread(nullptr)
 {
+	// GcnSearchData is sent across threads by fileFound()
+	// and provisionalFileFound().
+	qRegisterMetaType<GcnSearchData>();
+
 	// Signal passthrough.
 	QObject::connect(worker, &GcnSearchWorker::searchStarted,
 			 q, &GcnSearchThread::searchStarted);
 	QObject::connect(worker, &GcnSearchWorker::searchUpdate,
 			 q, &GcnSearchThread::searchUpdate);
+	QObject::connect(worker, &GcnSearchWorker::fileFound,
+			 q, &GcnSearchThread::fileFound);
+	QObject::connect(worker, &GcnSearchWorker::provisionalFileFound,
+			 q, &GcnSearchThread::provisionalFileFound);
+	QObject::connect(worker, &GcnSearchWorker::provisionalFilesDiscarded,
+			 q, &GcnSearchThread::provisionalFilesDiscarded);
 
 	// We have to handle these signals in order to move
 	// the worker object back to the main thread.
@@ -77,11 +98,28 @@ GcnSearchThreadPrivate::GcnSearchThreadPrivate(GcnSearchThread* q)
 
 GcnSearchThreadPrivate::~GcnSearchThreadPrivate()
 {
+	// Make sure the worker isn't still searching.
+	worker->cancel();
+	stopWorkerThread();
+
 	delete worker;
-	qDeleteAll(dbs);
 	dbs.clear();
 }
 
+/**
+ * Get raw pointers to the databases for the worker.
+ * @return Databases
+ */
+QVector<GcnMcFileDb*> GcnSearchThreadPrivate::dbPointers(void) const
+{
+	QVector<GcnMcFileDb*> ret;
+	ret.reserve(dbs.size());
+	foreach (const QSharedPointer<GcnMcFileDb> &db, dbs) {
+		ret.append(db.data());
+	}
+	return ret;
+}
+
 /**
  * Stop the worker thread.
  */
@@ -136,20 +174,18 @@ QString GcnSearchThread::errorString(void) const
 int GcnSearchThread::loadGcnMcFileDbs(const QVector<QString> &dbFilenames)
 {
 	Q_D(GcnSearchThread);
-	qDeleteAll(d->dbs);
 	d->dbs.clear();
 
 	if (dbFilenames.isEmpty())
 		return 0;
 
 	// Load the databases.
+	// NOTE: No parent, since the databases may be shared.
 	foreach (const QString &dbFilename, dbFilenames) {
-		GcnMcFileDb *db = new GcnMcFileDb(this);
+		QSharedPointer<GcnMcFileDb> db(new GcnMcFileDb());
 		int ret = db->load(dbFilename);
 		if (!ret) {
 			d->dbs.append(db);
-		} else {
-			delete db;
 		}
 	}
 
@@ -163,6 +199,35 @@ int GcnSearchThread::loadGcnMcFileDbs(const QVector<QString> &dbFilenames)
 	return 0;
 }
 
+/**
+ * Get the loaded GCN Memory Card File databases.
+ * These can be shared with other GcnSearchThreads.
+ * @return GCN Memory Card File databases
+ */
+QVector<QSharedPointer<GcnMcFileDb> > GcnSearchThread::gcnMcFileDbs(void) const
+{
+	Q_D(const GcnSearchThread);
+	return d->dbs;
+}
+
+/**
+ * Use GCN Memory Card File databases that were already loaded.
+ * This allows multiple GcnSearchThreads to share one set of databases.
+ * @param dbs GCN Memory Card File databases
+ * @return 0 on success; non-zero on error.
+ */
+int GcnSearchThread::setGcnMcFileDbs(const QVector<QSharedPointer<GcnMcFileDb> > &dbs)
+{
+	Q_D(GcnSearchThread);
+	if (d->workerThread) {
+		// Thread is running.
+		return -255;	// TODO: Error code constant?
+	}
+
+	d->dbs = dbs;
+	return 0;
+}
+
 /**
  * Get the list of files found in the last successful search.
  * @return List of files found
@@ -174,6 +239,19 @@ list<GcnSearchData> GcnSearchThread::filesFoundList(void)
 	return d->worker->filesFoundList();
 }
 
+/**
+ * Get the other candidates for the files found in the last successful search.
+ * Each candidate's dirEntry.block is the first block of the
+ * file it's an alternative for.
+ * @return List of other candidates
+ */
+list<GcnSearchData> GcnSearchThread::alternativesList(void)
+{
+	// TODO: Not while thread is running...
+	Q_D(GcnSearchThread);
+	return d->worker->alternativesList();
+}
+
 /**
  * Search a memory card for "lost" files.
  * Synchronous search; non-threaded.
@@ -204,9 +282,10 @@ int GcnSearchThread::searchMemCard(GcnCard *card, char preferredRegion, bool sea
 
 	// Set the GcnSearchWorker's properties.
 	d->worker->setCard(card);
-	d->worker->setDatabases(d->dbs);
+	d->worker->setDatabases(d->dbPointers());
 	d->worker->setPreferredRegion(preferredRegion);
 	d->worker->setSearchUsedBlocks(searchUsedBlocks);
+	d->worker->setCheckpointFilename(d->checkpointFilename);
 	d->worker->setOrigThread(nullptr);
 
 	// Search for files.
@@ -254,9 +333,10 @@ int GcnSearchThread::searchMemCard_async(GcnCard *card, char preferredRegion, bo
 
 	// Set the GcnSearchWorker's properties.
 	d->worker->setCard(card);
-	d->worker->setDatabases(d->dbs);
+	d->worker->setDatabases(d->dbPointers());
 	d->worker->setPreferredRegion(preferredRegion);
 	d->worker->setSearchUsedBlocks(searchUsedBlocks);
+	d->worker->setCheckpointFilename(d->checkpointFilename);
 	d->worker->setOrigThread(QThread::currentThread());
 
 	connect(d->workerThread, &QThread::started,
@@ -269,6 +349,40 @@ int GcnSearchThread::searchMemCard_async(GcnCard *card, char preferredRegion, bo
 	return 0;
 }
 
+/**
+ * Get the checkpoint filename.
+ * @return Checkpoint filename, or empty string if checkpoints are disabled.
+ */
+QString GcnSearchThread::checkpointFilename(void) const
+{
+	Q_D(const GcnSearchThread);
+	return d->checkpointFilename;
+}
+
+/**
+ * Set the checkpoint filename.
+ * This takes effect on the next search.
+ * (See GcnSearchWorker::setCheckpointFilename().)
+ * @param checkpointFilename Checkpoint filename, or empty string to disable checkpoints.
+ */
+void GcnSearchThread::setCheckpointFilename(const QString &checkpointFilename)
+{
+	Q_D(GcnSearchThread);
+	d->checkpointFilename = checkpointFilename;
+}
+
+/**
+ * Cancel the current search.
+ * If checkpoints are enabled, the search
+ * can be resumed by searching the same card.
+ * searchCancelled() is emitted once the search stops.
+ */
+void GcnSearchThread::cancel(void)
+{
+	Q_D(GcnSearchThread);
+	d->worker->cancel();
+}
+
 /** Slots **/
 
 /**
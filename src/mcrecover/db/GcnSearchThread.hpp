@@ -19,10 +19,12 @@
 
 // Qt includes
 #include <QtCore/QObject>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QString>
 #include <QtCore/QVector>
 
 class GcnCard;
+class GcnMcFileDb;
 
 class GcnSearchThreadPrivate;
 class GcnSearchThread : public QObject
@@ -68,6 +70,29 @@ signals:
 	 */
 	void searchUpdate(int currentPhysBlock, int currentSearchBlock, int lostFilesFound);
 
+	/**
+	 * A "lost" file has been found, and its blocks have been assigned.
+	 * This is emitted for each file before searchFinished(),
+	 * so files can be added to the card as they're found.
+	 * @param searchData Search data
+	 */
+	void fileFound(const GcnSearchData &searchData);
+
+	/**
+	 * A "lost" file has been found during the scan.
+	 * The file uses its default FAT chain, which may change
+	 * once all blocks have been scanned.
+	 * @param searchData Search data
+	 */
+	void provisionalFileFound(const GcnSearchData &searchData);
+
+	/**
+	 * The scan is complete, and blocks are about to be assigned.
+	 * Files from provisionalFileFound() should be removed, since
+	 * fileFound() is emitted for all files, including those files.
+	 */
+	void provisionalFilesDiscarded(void);
+
 	/**
 	 * An error has occurred during the search.
 	 * @param errorString Error string
@@ -102,12 +127,35 @@ public:
 	 */
 	int loadGcnMcFileDbs(const QVector<QString> &dbFilenames);
 
+	/**
+	 * Get the loaded GCN Memory Card File databases.
+	 * These can be shared with other GcnSearchThreads.
+	 * @return GCN Memory Card File databases
+	 */
+	QVector<QSharedPointer<GcnMcFileDb> > gcnMcFileDbs(void) const;
+
+	/**
+	 * Use GCN Memory Card File databases that were already loaded.
+	 * This allows multiple GcnSearchThreads to share one set of databases.
+	 * @param dbs GCN Memory Card File databases
+	 * @return 0 on success; non-zero on error.
+	 */
+	int setGcnMcFileDbs(const QVector<QSharedPointer<GcnMcFileDb> > &dbs);
+
 	/**
 	 * Get the list of files found in the last successful search.
 	 * @return List of files found
 	 */
 	std::list<GcnSearchData> filesFoundList(void);
 
+	/**
+	 * Get the other candidates for the files found in the last successful search.
+	 * Each candidate's dirEntry.block is the first block of the
+	 * file it's an alternative for.
+	 * @return List of other candidates
+	 */
+	std::list<GcnSearchData> alternativesList(void);
+
 	/**
 	 * Search a memory card for "lost" files.
 	 * Synchronous search; non-threaded.
@@ -146,6 +194,28 @@ public:
 	 */
 	int searchMemCard_async(GcnCard *card, char preferredRegion = 0, bool searchUsedBlocks = false);
 
+	/**
+	 * Get the checkpoint filename.
+	 * @return Checkpoint filename, or empty string if checkpoints are disabled.
+	 */
+	QString checkpointFilename(void) const;
+
+	/**
+	 * Set the checkpoint filename.
+	 * This takes effect on the next search.
+	 * (See GcnSearchWorker::setCheckpointFilename().)
+	 * @param checkpointFilename Checkpoint filename, or empty string to disable checkpoints.
+	 */
+	void setCheckpointFilename(const QString &checkpointFilename);
+
+	/**
+	 * Cancel the current search.
+	 * If checkpoints are enabled, the search
+	 * can be resumed by searching the same card.
+	 * searchCancelled() is emitted once the search stops.
+	 */
+	void cancel(void);
+
 private slots:
 	/**
 	 * Search has been cancelled.
@@ -13,20 +13,33 @@
 
 // GCN Memory Card File Database
 #include "db/GcnMcFileDb.hpp"
+#include "db/GcnMcFileMatchContext.hpp"
+#include "db/GcnFatSolver.hpp"
 
 // Checksum algorithm class
 #include "Checksum.hpp"
 
 // C includes (C++ namespace)
+#include <cerrno>
 #include <cstdio>
+#include <cstring>
 
 // C++ includes
+#include <algorithm>
 #include <limits>
 #include <memory>
+#include <vector>
 using std::list;
 using std::unique_ptr;
 
 // Qt includes.
+#include <QtCore/QAtomicInt>
+#include <QtCore/QBitArray>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
 #include <QtCore/QVector>
 
 /** GcnSearchWorkerPrivate **/
@@ -54,6 +67,13 @@ public:
 	 */
 	std::list<GcnSearchData> filesFoundList;
 
+	/**
+	 * Other candidates for the files found in the last successful search.
+	 * Each candidate's dirEntry.block is the first block of the
+	 * file in filesFoundList that it's an alternative for.
+	 */
+	std::list<GcnSearchData> alternativesList;
+
 	// Properties
 	GcnCard *card;
 	QVector<GcnMcFileDb*> databases;
@@ -62,6 +82,181 @@ public:
 
 	// Original thread
 	QThread *origThread;
+
+	// Checkpoint filename (empty if disabled)
+	QString checkpointFilename;
+
+	// Set when the search is cancelled.
+	QAtomicInt cancelled;
+
+	/**
+	 * Maximum number of blocks outside of the default FAT chain
+	 * to consider when reconstructing a FAT chain.
+	 */
+	static const int MAX_EXTRA_FAT_BLOCKS = 32;
+
+	/**
+	 * Minimum time between checkpoints, in milliseconds.
+	 */
+	static const int CHECKPOINT_INTERVAL_MS = 5000;
+
+	/**
+	 * Checkpoint file magic number and version.
+	 */
+	static const quint32 CHECKPOINT_MAGIC = 0x4D435253;	// 'MCRS'
+	static const quint32 CHECKPOINT_VERSION = 2;
+
+	/**
+	 * A block that matched one or more file definitions.
+	 * All candidates have the same first block.
+	 */
+	struct SearchHit {
+		// Candidates, best first.
+		std::vector<GcnSearchData> candidates;
+
+		// If true, the first block belongs to another file's
+		// verified FAT chain, so this isn't a lost file.
+		// Set by assignBlocks(); not saved in checkpoints.
+		bool rejected;
+
+		SearchHit() : rejected(false) { }
+	};
+
+	/**
+	 * Are two candidates identical?
+	 * This happens if multiple databases have the same file definition.
+	 * @param a First candidate
+	 * @param b Second candidate
+	 * @return True if the candidates are identical.
+	 */
+	static bool isSameCandidate(const GcnSearchData &a, const GcnSearchData &b);
+
+	/**
+	 * Remove duplicate candidates for a block and rank the rest.
+	 * Candidates are ranked by, in order:
+	 * - Preferred region
+	 * - Fit: the file's subsequent blocks are unused
+	 * - Specificity of the file definition
+	 * Candidates that rank the same stay in database order.
+	 * assignBlocks() re-ranks them by their checksums.
+	 * @param candidates	[in/out] Candidates (dirEntry.block and dirEntry.length must be set)
+	 * @param usedBlockMap	[in] Used block map
+	 */
+	void rankCandidates(QVector<GcnSearchData> &candidates, const QVector<uint8_t> &usedBlockMap) const;
+
+	/**
+	 * Construct the default FAT chain for a lost file.
+	 * The file's subsequent blocks are the next unused blocks
+	 * after its first block. If there aren't enough unused
+	 * blocks, the remaining blocks are allocated contiguously.
+	 * @param searchData	[in/out] Search data (dirEntry.block and dirEntry.length must be set)
+	 * @param usedBlockMap	[in] Used block map
+	 */
+	void defaultFatChain(GcnSearchData *searchData, const QVector<uint8_t> &usedBlockMap) const;
+
+	/**
+	 * Mark a lost file's blocks as used.
+	 * The first block is not marked, since assignBlocks() reserves it.
+	 * Blocks before the first block were wrapped around, and aren't
+	 * marked, since they might be used by actual files.
+	 * @param searchData	[in] Search data
+	 * @param usedBlockMap	[in/out] Used block map
+	 */
+	static void claimFatChain(const GcnSearchData &searchData, QVector<uint8_t> &usedBlockMap);
+
+	/**
+	 * Use a file's checksums to reconstruct its FAT chain.
+	 * searchData->fatEntries must contain the default FAT chain.
+	 * @param searchData	[in/out] Search data
+	 * @param usedBlockMap	[in] Used block map
+	 * @return Confidence, in percent (0-100), or -1 if the file has no usable checksums.
+	 */
+	int solveFatChain(GcnSearchData *searchData, const QVector<uint8_t> &usedBlockMap);
+
+	/**
+	 * Assign blocks to all lost files found in the search.
+	 *
+	 * All first blocks are reserved before any blocks are assigned,
+	 * so no file can take another file's first block. Files whose
+	 * FAT chains are verified by their checksums are assigned first.
+	 * Each file's candidates are re-ranked by the percentage of
+	 * checksums that match after solving, so a runner-up whose
+	 * checksums match is used instead of the best candidate.
+	 * Files whose checksums partially match keep the solver's
+	 * best FAT chain, if none of its blocks were claimed.
+	 * The remaining files get the next unused blocks after their
+	 * first block, in block order.
+	 *
+	 * Files whose first block is part of another file's verified
+	 * FAT chain are rejected, and don't get any blocks.
+	 *
+	 * fileFound() is emitted for each file once its blocks are assigned.
+	 * searchUpdate() is emitted before each checksummed file is solved.
+	 *
+	 * @param hits		[in/out] Files found in the search (sorted by first block on return)
+	 * @param usedBlockMap	[in/out] Used block map
+	 * @param currentSearchBlock [in] Number of blocks searched (for searchUpdate())
+	 * @return 0 on success; -ECANCELED if the search was cancelled.
+	 */
+	int assignBlocks(std::vector<SearchHit> &hits, QVector<uint8_t> &usedBlockMap, int currentSearchBlock);
+
+	/**
+	 * SHA-1 hash of each block read by the search. (Empty if not read.)
+	 * A checkpoint is only valid for the same card contents, but
+	 * hashing the entire card would read every block, even if the
+	 * scan only looks at a few of them. Instead, each block is hashed
+	 * when it's first read, and the checkpoint stores which blocks
+	 * were hashed along with a combined hash of those blocks.
+	 */
+	QVector<QByteArray> blockHashes;
+
+	/**
+	 * Hash a block, if it hasn't been hashed yet.
+	 * @param block Block number
+	 * @param data Block data
+	 */
+	void hashBlock(uint16_t block, const uint8_t *data);
+
+	/**
+	 * Read and hash blocks that haven't been hashed yet.
+	 * @param blocks Blocks to hash
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int hashBlocks(const QBitArray &blocks);
+
+	/**
+	 * Get the combined hash of all blocks that have been hashed.
+	 * @param hashedBlocks	[out] Blocks that have been hashed
+	 * @return SHA-1 hash of the block hashes, in block order.
+	 */
+	QByteArray blocksHash(QBitArray *hashedBlocks) const;
+
+	/**
+	 * Get the combined hash of the loaded databases.
+	 * Used to make sure a checkpoint is for the same databases.
+	 * @return SHA-1 hash of the database hashes, in database order.
+	 */
+	QByteArray databasesHash(void) const;
+
+	/**
+	 * Load a search checkpoint.
+	 * The checkpoint must be for the same card contents, databases,
+	 * and search settings. The blocks hashed by the checkpoint are
+	 * read again to verify them.
+	 * @param scannedBlocks	[out] Blocks that have been scanned
+	 * @param hits		[out] Files found in the scanned blocks
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int loadCheckpoint(QBitArray *scannedBlocks, std::vector<SearchHit> *hits);
+
+	/**
+	 * Save a search checkpoint.
+	 * @param scannedBlocks	[in] Blocks that have been scanned
+	 * @param hits		[in] Files found in the scanned blocks
+	 * @return 0 on success; negative POSIX error code on error.
+	 */
+	int saveCheckpoint(const QBitArray &scannedBlocks,
+		const std::vector<SearchHit> &hits) const;
 };
 
 GcnSearchWorkerPrivate::GcnSearchWorkerPrivate(GcnSearchWorker* q)
@@ -72,6 +267,699 @@ GcnSearchWorkerPrivate::GcnSearchWorkerPrivate(GcnSearchWorker* q)
 	, origThread(nullptr)
 { }
 
+/**
+ * Construct the default FAT chain for a lost file.
+ * The file's subsequent blocks are the next unused blocks
+ * after its first block. If there aren't enough unused
+ * blocks, the remaining blocks are allocated contiguously.
+ * @param searchData	[in/out] Search data (dirEntry.block and dirEntry.length must be set)
+ * @param usedBlockMap	[in] Used block map
+ */
+void GcnSearchWorkerPrivate::defaultFatChain(GcnSearchData *searchData, const QVector<uint8_t> &usedBlockMap) const
+{
+	const int totalPhysBlocks = card->totalPhysBlocks();
+	const int firstBlock = searchData->dirEntry.block;
+
+	std::vector<uint16_t> &fatEntries = searchData->fatEntries;
+	fatEntries.clear();
+	fatEntries.reserve(searchData->dirEntry.length);
+
+	// First block is always valid.
+	fatEntries.push_back(firstBlock);
+
+	int blocksRemaining = (searchData->dirEntry.length - 1);
+	int block = (firstBlock + 1);
+
+	// Skip used blocks and go after empty blocks only.
+	while (blocksRemaining > 0) {
+		if (block >= totalPhysBlocks) {
+			// Wraparound.
+			block = 5;
+			continue;
+		} else if (block == firstBlock) {
+			// ERROR: We wrapped around!
+			// Use the "naive" algorithm after the last valid block.
+			break;
+		}
+
+		// Check if this block is used.
+		if (usedBlockMap[block] == 0) {
+			// Block is not used.
+			fatEntries.push_back(block);
+			blocksRemaining--;
+		}
+
+		// Next block.
+		block++;
+	}
+
+	// Naive block algorithm for the remaining blocks.
+	block = (fatEntries[fatEntries.size() - 1] + 1);
+	while (blocksRemaining > 0) {
+		if (block >= totalPhysBlocks) {
+			// Wraparound.
+			block = 5;
+			continue;
+		}
+
+		// Add this block.
+		fatEntries.push_back(block);
+		block++;
+		blocksRemaining--;
+	}
+}
+
+/**
+ * Mark a lost file's blocks as used.
+ * The first block is not marked, since assignBlocks() reserves it.
+ * Blocks before the first block were wrapped around, and aren't
+ * marked, since they might be used by actual files.
+ * @param searchData	[in] Search data
+ * @param usedBlockMap	[in/out] Used block map
+ */
+void GcnSearchWorkerPrivate::claimFatChain(const GcnSearchData &searchData, QVector<uint8_t> &usedBlockMap)
+{
+	const uint16_t firstBlock = searchData.dirEntry.block;
+	for (size_t i = 1; i < searchData.fatEntries.size(); i++) {
+		const uint16_t block = searchData.fatEntries[i];
+		if (block > firstBlock && usedBlockMap[block] < std::numeric_limits<uint8_t>::max()) {
+			usedBlockMap[block]++;
+		}
+	}
+}
+
+/**
+ * Use a file's checksums to reconstruct its FAT chain.
+ * searchData->fatEntries must contain the default FAT chain.
+ * @param searchData	[in/out] Search data
+ * @param usedBlockMap	[in] Used block map
+ * @return Confidence, in percent (0-100), or -1 if the file has no usable checksums.
+ */
+int GcnSearchWorkerPrivate::solveFatChain(GcnSearchData *searchData, const QVector<uint8_t> &usedBlockMap)
+{
+	const int blockSize = card->blockSize();
+	const int totalPhysBlocks = card->totalPhysBlocks();
+	const uint16_t firstBlock = searchData->dirEntry.block;
+	const std::vector<uint16_t> &fatEntries = searchData->fatEntries;
+
+	// Read the default FAT chain.
+	const uint32_t fileSize = (uint32_t)(fatEntries.size() * blockSize);
+	std::vector<uint8_t> fileData(fileSize);
+	std::vector<uint8_t> blockRead(fatEntries.size(), 0);
+	bool allRead = true;
+	for (size_t i = 0; i < fatEntries.size(); i++) {
+		const int ret = card->readBlock(&fileData[i * blockSize], blockSize, fatEntries[i]);
+		blockRead[i] = (ret == blockSize);
+		allRead &= blockRead[i];
+	}
+	if (!blockRead[0]) {
+		// Error reading the first block.
+		return -1;
+	}
+
+	// Check the default FAT chain first.
+	// It's usually correct, and checking it only needs
+	// the blocks that were just read.
+	int checksumsGood = 0, checksumsTotal = 0;
+	for (const Checksum::ChecksumDef &checksumDef : searchData->checksumDefs) {
+		Checksum::ChecksumValue value;
+		if (Checksum::Calculate(checksumDef, fileData.data(), fileSize, &value)) {
+			checksumsTotal++;
+			if (value.expected == value.actual) {
+				checksumsGood++;
+			}
+		}
+	}
+	if (checksumsTotal == 0) {
+		// No usable checksums.
+		return -1;
+	} else if (allRead && checksumsGood == checksumsTotal) {
+		// Default FAT chain is verified.
+		return 100;
+	}
+
+	// Search other orderings of the default FAT chain
+	// and nearby unused blocks.
+	GcnFatSolver solver(blockSize, searchData->checksumDefs);
+	for (size_t i = 0; i < fatEntries.size(); i++) {
+		if (blockRead[i]) {
+			solver.addBlock(fatEntries[i], &fileData[i * blockSize]);
+		}
+	}
+
+	// Other unused blocks, starting after the first block.
+	unique_ptr<uint8_t[]> blockBuf(new uint8_t[blockSize]);
+	int extraBlocks = 0;
+	int block = firstBlock;
+	for (int i = 5; i < totalPhysBlocks && extraBlocks < MAX_EXTRA_FAT_BLOCKS; i++) {
+		block++;
+		if (block >= totalPhysBlocks) {
+			// Wraparound.
+			block = 5;
+		}
+		if (block == firstBlock || usedBlockMap[block] != 0 ||
+		    std::find(fatEntries.begin(), fatEntries.end(), (uint16_t)block) != fatEntries.end())
+		{
+			// Block is either used or already added.
+			continue;
+		}
+
+		const int ret = card->readBlock(blockBuf.get(), blockSize, (uint16_t)block);
+		if (ret == blockSize) {
+			solver.addBlock((uint16_t)block, blockBuf.get());
+			extraBlocks++;
+		}
+	}
+
+	const GcnFatSolver::Result result = solver.solve(fatEntries);
+	if (result.checksumsTotal == 0) {
+		// No usable checksums.
+		return -1;
+	}
+
+	searchData->fatEntries = result.fatEntries;
+	return result.confidence;
+}
+
+/**
+ * Are two candidates identical?
+ * This happens if multiple databases have the same file definition.
+ * @param a First candidate
+ * @param b Second candidate
+ * @return True if the candidates are identical.
+ */
+bool GcnSearchWorkerPrivate::isSameCandidate(const GcnSearchData &a, const GcnSearchData &b)
+{
+	if (memcmp(&a.dirEntry, &b.dirEntry, sizeof(a.dirEntry)) != 0 ||
+	    a.checksumDefs.size() != b.checksumDefs.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a.checksumDefs.size(); i++) {
+		const Checksum::ChecksumDef &chkA = a.checksumDefs[i];
+		const Checksum::ChecksumDef &chkB = b.checksumDefs[i];
+		if (chkA.algorithm != chkB.algorithm ||
+		    chkA.address != chkB.address ||
+		    chkA.param != chkB.param ||
+		    chkA.start != chkB.start ||
+		    chkA.length != chkB.length ||
+		    chkA.endian != chkB.endian)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Remove duplicate candidates for a block and rank the rest.
+ * Candidates are ranked by, in order:
+ * - Preferred region
+ * - Fit: the file's subsequent blocks are unused
+ * - Specificity of the file definition
+ * Candidates that rank the same stay in database order.
+ * assignBlocks() re-ranks them by their checksums.
+ * @param candidates	[in/out] Candidates (dirEntry.block and dirEntry.length must be set)
+ * @param usedBlockMap	[in] Used block map
+ */
+void GcnSearchWorkerPrivate::rankCandidates(QVector<GcnSearchData> &candidates, const QVector<uint8_t> &usedBlockMap) const
+{
+	// Remove duplicates.
+	for (int i = candidates.size() - 1; i > 0; i--) {
+		for (int j = 0; j < i; j++) {
+			if (isSameCandidate(candidates.at(i), candidates.at(j))) {
+				candidates.remove(i);
+				break;
+			}
+		}
+	}
+
+	if (candidates.size() <= 1) {
+		// Nothing to rank.
+		return;
+	}
+
+	// Rank keys, from most significant to least significant.
+	struct RankedCandidate {
+		bool region;
+		bool fit;
+		int specificity;
+		int index;
+	};
+
+	const int totalPhysBlocks = card->totalPhysBlocks();
+	std::vector<RankedCandidate> ranked;
+	ranked.reserve(candidates.size());
+	for (int i = 0; i < candidates.size(); i++) {
+		const GcnSearchData &searchData = candidates.at(i);
+		RankedCandidate rc;
+		rc.region = (preferredRegion != 0 && searchData.dirEntry.gamecode[3] == preferredRegion);
+		rc.specificity = searchData.specificity;
+		rc.index = i;
+
+		// Check if the file's subsequent blocks are unused.
+		const int firstBlock = searchData.dirEntry.block;
+		const int lastBlock = firstBlock + searchData.dirEntry.length - 1;
+		rc.fit = (lastBlock < totalPhysBlocks);
+		for (int block = firstBlock + 1; rc.fit && block <= lastBlock; block++) {
+			rc.fit = (usedBlockMap[block] == 0);
+		}
+
+		ranked.push_back(rc);
+	}
+
+	std::stable_sort(ranked.begin(), ranked.end(),
+		[](const RankedCandidate &a, const RankedCandidate &b) {
+			if (a.region != b.region)
+				return a.region;
+			if (a.fit != b.fit)
+				return a.fit;
+			return (a.specificity > b.specificity);
+		});
+
+	QVector<GcnSearchData> sorted;
+	sorted.reserve(candidates.size());
+	for (const RankedCandidate &rc : ranked) {
+		sorted.append(candidates.at(rc.index));
+	}
+	candidates = sorted;
+}
+
+/**
+ * Assign blocks to all lost files found in the search.
+ *
+ * All first blocks are reserved before any blocks are assigned,
+ * so no file can take another file's first block. Files whose
+ * FAT chains are verified by their checksums are assigned first.
+ * Each file's candidates are re-ranked by the percentage of
+ * checksums that match after solving, so a runner-up whose
+ * checksums match is used instead of the best candidate.
+ * Files whose checksums partially match keep the solver's
+ * best FAT chain, if none of its blocks were claimed.
+ * The remaining files get the next unused blocks after their
+ * first block, in block order.
+ *
+ * Files whose first block is part of another file's verified
+ * FAT chain are rejected, and don't get any blocks.
+ *
+ * fileFound() is emitted for each file once its blocks are assigned.
+ * searchUpdate() is emitted before each checksummed file is solved.
+ *
+ * @param hits		[in/out] Files found in the search (sorted by first block on return)
+ * @param usedBlockMap	[in/out] Used block map
+ * @param currentSearchBlock [in] Number of blocks searched (for searchUpdate())
+ * @return 0 on success; -ECANCELED if the search was cancelled.
+ */
+int GcnSearchWorkerPrivate::assignBlocks(std::vector<SearchHit> &hits, QVector<uint8_t> &usedBlockMap, int currentSearchBlock)
+{
+	Q_Q(GcnSearchWorker);
+	std::sort(hits.begin(), hits.end(),
+		[](const SearchHit &a, const SearchHit &b) {
+			return (a.candidates[0].dirEntry.block < b.candidates[0].dirEntry.block);
+		});
+
+	// Reserve the first blocks.
+	for (SearchHit &hit : hits) {
+		hit.rejected = false;
+		const uint16_t block = hit.candidates[0].dirEntry.block;
+		if (usedBlockMap[block] < std::numeric_limits<uint8_t>::max()) {
+			usedBlockMap[block]++;
+		}
+	}
+
+	// Files with checksums.
+	// If the checksums verify the FAT chain, the blocks
+	// definitely belong to this file, so assign them first.
+	std::vector<uint8_t> assigned(hits.size(), 0);
+	std::vector<uint8_t> solved(hits.size(), 0);
+	int filesAssigned = 0;
+	for (size_t i = 0; i < hits.size(); i++) {
+		std::vector<GcnSearchData> &candidates = hits[i].candidates;
+		const uint16_t firstBlock = candidates[0].dirEntry.block;
+		if (usedBlockMap[firstBlock] > 1) {
+			// First block was claimed by a verified file.
+			hits[i].rejected = true;
+			continue;
+		}
+
+		bool hasChecksums = false;
+		for (const GcnSearchData &searchData : candidates) {
+			if (!searchData.checksumDefs.empty() && searchData.dirEntry.length > 1) {
+				hasChecksums = true;
+				break;
+			}
+		}
+		if (!hasChecksums)
+			continue;
+		emit q->searchUpdate(firstBlock, currentSearchBlock, filesAssigned);
+
+		// Confidence for each candidate. (0 if no checksums)
+		std::vector<int> confidence(candidates.size(), 0);
+		bool verified = false;
+		for (size_t j = 0; j < candidates.size(); j++) {
+			GcnSearchData &searchData = candidates[j];
+			if (searchData.checksumDefs.empty() || searchData.dirEntry.length <= 1)
+				continue;
+			if (cancelled.loadAcquire()) {
+				// Search was cancelled.
+				return -ECANCELED;
+			}
+
+			defaultFatChain(&searchData, usedBlockMap);
+			confidence[j] = std::max(solveFatChain(&searchData, usedBlockMap), 0);
+			if (confidence[j] == 100) {
+				// FAT chain is verified.
+				// Nothing else can rank higher.
+				verified = true;
+				break;
+			}
+		}
+
+		// Rank the candidates by their checksums.
+		// Candidates that rank the same keep their order.
+		std::vector<size_t> order(candidates.size());
+		for (size_t j = 0; j < order.size(); j++) {
+			order[j] = j;
+		}
+		std::stable_sort(order.begin(), order.end(),
+			[&confidence](size_t a, size_t b) {
+				return (confidence[a] > confidence[b]);
+			});
+		if (order[0] != 0) {
+			std::vector<GcnSearchData> sorted;
+			sorted.reserve(candidates.size());
+			for (size_t j : order) {
+				sorted.push_back(candidates[j]);
+			}
+			candidates.swap(sorted);
+		}
+
+		if (verified) {
+			claimFatChain(candidates[0], usedBlockMap);
+			assigned[i] = 1;
+			filesAssigned++;
+			emit q->fileFound(candidates[0]);
+		} else if (confidence[order[0]] > 0) {
+			// Some checksums match. Keep the solver's best FAT chain.
+			solved[i] = 1;
+		}
+	}
+
+	// Files processed before a verified file claimed their first block.
+	// NOTE: Only verified files have claimed blocks so far.
+	for (size_t i = 0; i < hits.size(); i++) {
+		if (!assigned[i] && usedBlockMap[hits[i].candidates[0].dirEntry.block] > 1) {
+			hits[i].rejected = true;
+		}
+	}
+
+	// Files whose checksums partially match.
+	// The solver's best FAT chain is more likely to be correct
+	// than the default FAT chain, so these are assigned next,
+	// unless a verified file claimed some of the blocks.
+	for (size_t i = 0; i < hits.size(); i++) {
+		if (!solved[i] || hits[i].rejected)
+			continue;
+
+		GcnSearchData &searchData = hits[i].candidates[0];
+		bool unclaimed = true;
+		for (size_t j = 1; unclaimed && j < searchData.fatEntries.size(); j++) {
+			unclaimed = (usedBlockMap[searchData.fatEntries[j]] == 0);
+		}
+		if (!unclaimed)
+			continue;
+
+		claimFatChain(searchData, usedBlockMap);
+		assigned[i] = 1;
+		emit q->fileFound(searchData);
+	}
+
+	// Remaining files.
+	// These get the default FAT chain.
+	for (size_t i = 0; i < hits.size(); i++) {
+		if (assigned[i] || hits[i].rejected)
+			continue;
+
+		GcnSearchData &searchData = hits[i].candidates[0];
+		defaultFatChain(&searchData, usedBlockMap);
+		claimFatChain(searchData, usedBlockMap);
+		emit q->fileFound(searchData);
+	}
+
+	return 0;
+}
+
+/**
+ * Hash a block, if it hasn't been hashed yet.
+ * @param block Block number
+ * @param data Block data
+ */
+void GcnSearchWorkerPrivate::hashBlock(uint16_t block, const uint8_t *data)
+{
+	if (block >= blockHashes.size() || !blockHashes[block].isEmpty())
+		return;
+
+	blockHashes[block] = QCryptographicHash::hash(
+		QByteArray::fromRawData(reinterpret_cast<const char*>(data), card->blockSize()),
+		QCryptographicHash::Sha1);
+}
+
+/**
+ * Read and hash blocks that haven't been hashed yet.
+ * @param blocks Blocks to hash
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GcnSearchWorkerPrivate::hashBlocks(const QBitArray &blocks)
+{
+	const int blockSize = card->blockSize();
+	unique_ptr<uint8_t[]> buf(new uint8_t[blockSize]);
+	const int count = std::min(blocks.size(), blockHashes.size());
+	for (int block = 0; block < count; block++) {
+		if (!blocks.testBit(block) || !blockHashes[block].isEmpty())
+			continue;
+
+		const int ret = card->readBlock(buf.get(), blockSize, (uint16_t)block);
+		if (ret != blockSize) {
+			// Error reading the card.
+			return -EIO;
+		}
+		hashBlock((uint16_t)block, buf.get());
+	}
+	return 0;
+}
+
+/**
+ * Get the combined hash of all blocks that have been hashed.
+ * @param hashedBlocks	[out] Blocks that have been hashed
+ * @return SHA-1 hash of the block hashes, in block order.
+ */
+QByteArray GcnSearchWorkerPrivate::blocksHash(QBitArray *hashedBlocks) const
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	*hashedBlocks = QBitArray(blockHashes.size());
+	for (int block = 0; block < blockHashes.size(); block++) {
+		if (!blockHashes[block].isEmpty()) {
+			hashedBlocks->setBit(block);
+			hash.addData(blockHashes[block]);
+		}
+	}
+	return hash.result();
+}
+
+/**
+ * Get the combined hash of the loaded databases.
+ * Used to make sure a checkpoint is for the same databases.
+ * @return SHA-1 hash of the database hashes, in database order.
+ */
+QByteArray GcnSearchWorkerPrivate::databasesHash(void) const
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	foreach (const GcnMcFileDb *db, databases) {
+		hash.addData(db->hash());
+	}
+	return hash.result();
+}
+
+/**
+ * Load a search checkpoint.
+ * The checkpoint must be for the same card contents, databases,
+ * and search settings. The blocks hashed by the checkpoint are
+ * read again to verify them.
+ * @param scannedBlocks	[out] Blocks that have been scanned
+ * @param hits		[out] Files found in the scanned blocks
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GcnSearchWorkerPrivate::loadCheckpoint(QBitArray *scannedBlocks, std::vector<SearchHit> *hits)
+{
+	QFile file(checkpointFilename);
+	if (!file.open(QIODevice::ReadOnly)) {
+		// No checkpoint.
+		return -ENOENT;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_2);
+
+	// Header.
+	quint32 magic, version;
+	QByteArray fileDbHash;
+	qint32 fileTotalPhysBlocks;
+	bool fileSearchUsedBlocks;
+	stream >> magic >> version;
+	if (stream.status() != QDataStream::Ok ||
+	    magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION)
+	{
+		// Not a checkpoint file, or an older version.
+		return -EIO;
+	}
+	stream >> fileDbHash >> fileTotalPhysBlocks >> fileSearchUsedBlocks;
+
+	const int totalPhysBlocks = card->totalPhysBlocks();
+	if (stream.status() != QDataStream::Ok ||
+	    fileDbHash != databasesHash() ||
+	    fileTotalPhysBlocks != totalPhysBlocks ||
+	    fileSearchUsedBlocks != searchUsedBlocks)
+	{
+		// Checkpoint is for different databases or search settings.
+		return -ESTALE;
+	}
+
+	// Card contents.
+	QBitArray fileHashedBlocks;
+	QByteArray fileBlocksHash;
+	stream >> fileHashedBlocks >> fileBlocksHash;
+	if (stream.status() != QDataStream::Ok || fileHashedBlocks.size() != totalPhysBlocks) {
+		return -EIO;
+	}
+	int ret = hashBlocks(fileHashedBlocks);
+	if (ret != 0) {
+		return ret;
+	}
+	QBitArray hashedBlocks;
+	if (blocksHash(&hashedBlocks) != fileBlocksHash || hashedBlocks != fileHashedBlocks) {
+		// Checkpoint is for a different card image.
+		return -ESTALE;
+	}
+
+	// Scanned blocks.
+	QBitArray fileScannedBlocks;
+	stream >> fileScannedBlocks;
+	if (stream.status() != QDataStream::Ok || fileScannedBlocks.size() != totalPhysBlocks) {
+		return -EIO;
+	}
+
+	// Files found.
+	quint32 hitCount;
+	stream >> hitCount;
+	if (stream.status() != QDataStream::Ok || hitCount > (quint32)totalPhysBlocks) {
+		return -EIO;
+	}
+
+	std::vector<SearchHit> fileHits(hitCount);
+	for (SearchHit &hit : fileHits) {
+		quint32 candidateCount;
+		stream >> candidateCount;
+		if (stream.status() != QDataStream::Ok || candidateCount == 0 || candidateCount > 1024) {
+			return -EIO;
+		}
+
+		hit.candidates.resize(candidateCount);
+		for (GcnSearchData &searchData : hit.candidates) {
+			qint32 specificity;
+			quint32 checksumCount;
+			if (stream.readRawData(reinterpret_cast<char*>(&searchData.dirEntry),
+			    sizeof(searchData.dirEntry)) != (int)sizeof(searchData.dirEntry))
+			{
+				return -EIO;
+			}
+			stream >> specificity >> checksumCount;
+			if (stream.status() != QDataStream::Ok || checksumCount > 1024 ||
+			    searchData.dirEntry.block >= totalPhysBlocks)
+			{
+				return -EIO;
+			}
+			searchData.specificity = specificity;
+
+			searchData.checksumDefs.resize(checksumCount);
+			for (Checksum::ChecksumDef &checksumDef : searchData.checksumDefs) {
+				quint8 algorithm, endian;
+				stream >> algorithm >> checksumDef.address >> checksumDef.param
+				       >> checksumDef.start >> checksumDef.length >> endian;
+				if (stream.status() != QDataStream::Ok) {
+					return -EIO;
+				}
+				checksumDef.algorithm = static_cast<Checksum::ChkAlgorithm>(algorithm);
+				checksumDef.endian = static_cast<Checksum::ChkEndian>(endian);
+			}
+		}
+	}
+
+	*scannedBlocks = fileScannedBlocks;
+	hits->swap(fileHits);
+	return 0;
+}
+
+/**
+ * Save a search checkpoint.
+ * @param scannedBlocks	[in] Blocks that have been scanned
+ * @param hits		[in] Files found in the scanned blocks
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GcnSearchWorkerPrivate::saveCheckpoint(const QBitArray &scannedBlocks,
+	const std::vector<SearchHit> &hits) const
+{
+	// NOTE: QSaveFile only replaces the checkpoint if
+	// the entire file was written successfully.
+	QSaveFile file(checkpointFilename);
+	if (!file.open(QIODevice::WriteOnly)) {
+		// TODO: Convert QFileError to a POSIX error code.
+		return -EIO;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_2);
+
+	// Header.
+	// NOTE: The preferred region isn't saved, since it only
+	// affects ranking. Candidates are re-ranked on load.
+	stream << CHECKPOINT_MAGIC << CHECKPOINT_VERSION << databasesHash()
+	       << (qint32)card->totalPhysBlocks() << searchUsedBlocks;
+
+	// Card contents.
+	QBitArray hashedBlocks;
+	const QByteArray hash = blocksHash(&hashedBlocks);
+	stream << hashedBlocks << hash;
+
+	// Scanned blocks.
+	stream << scannedBlocks;
+
+	// Files found.
+	// NOTE: FAT entries aren't saved, since blocks
+	// are assigned after the scan is complete.
+	stream << (quint32)hits.size();
+	for (const SearchHit &hit : hits) {
+		stream << (quint32)hit.candidates.size();
+		for (const GcnSearchData &searchData : hit.candidates) {
+			stream.writeRawData(reinterpret_cast<const char*>(&searchData.dirEntry),
+				sizeof(searchData.dirEntry));
+			stream << (qint32)searchData.specificity
+			       << (quint32)searchData.checksumDefs.size();
+			for (const Checksum::ChecksumDef &checksumDef : searchData.checksumDefs) {
+				stream << (quint8)checksumDef.algorithm << checksumDef.address
+				       << checksumDef.param << checksumDef.start << checksumDef.length
+				       << (quint8)checksumDef.endian;
+			}
+		}
+	}
+
+	if (stream.status() != QDataStream::Ok || !file.commit()) {
+		return -EIO;
+	}
+	return 0;
+}
+
 /** GcnSearchWorker **/
 
 GcnSearchWorker::GcnSearchWorker(QObject *parent)
@@ -112,6 +1000,21 @@ std::list<GcnSearchData> GcnSearchWorker::filesFoundList(void) const
 	return d->filesFoundList;
 }
 
+/**
+ * Get the other candidates for the files found in the last successful search.
+ * If a block matched more than one file definition, the best match
+ * is in filesFoundList(), and the rest are here, best first.
+ * Each candidate's dirEntry.block is the first block of the
+ * file it's an alternative for.
+ * @return List of other candidates
+ */
+std::list<GcnSearchData> GcnSearchWorker::alternativesList(void) const
+{
+	// TODO: Not while thread is running...
+	Q_D(const GcnSearchWorker);
+	return d->alternativesList;
+}
+
 /** Properties **/
 
 /**
@@ -229,8 +1132,49 @@ void GcnSearchWorker::setOrigThread(QThread *origThread)
 	d->origThread = origThread;
 }
 
+/**
+ * Get the checkpoint filename.
+ * @return Checkpoint filename, or empty string if checkpoints are disabled.
+ */
+QString GcnSearchWorker::checkpointFilename(void) const
+{
+	Q_D(const GcnSearchWorker);
+	return d->checkpointFilename;
+}
+
+/**
+ * Set the checkpoint filename.
+ *
+ * If set, the search state is saved to this file periodically
+ * and when the search is cancelled. If the file has a checkpoint
+ * for the same card contents, databases, and search settings,
+ * searchMemCard() resumes from it. The file is removed when the
+ * search finishes. Old checkpoints are ignored.
+ *
+ * @param checkpointFilename Checkpoint filename, or empty string to disable checkpoints.
+ */
+void GcnSearchWorker::setCheckpointFilename(const QString &checkpointFilename)
+{
+	// TODO: Not if searching?
+	Q_D(GcnSearchWorker);
+	d->checkpointFilename = checkpointFilename;
+}
+
 /** Search functions **/
 
+/**
+ * Cancel the current search.
+ * This function is thread-safe.
+ *
+ * searchMemCard() saves a checkpoint, if enabled,
+ * emits searchCancelled(), and returns -ECANCELED.
+ */
+void GcnSearchWorker::cancel(void)
+{
+	Q_D(GcnSearchWorker);
+	d->cancelled.storeRelease(1);
+}
+
 /**
  * Search a memory card for "lost" files.
  * Properties must have been set previously.
@@ -243,6 +1187,8 @@ int GcnSearchWorker::searchMemCard(void)
 {
 	Q_D(GcnSearchWorker);
 	d->filesFoundList.clear();
+	d->alternativesList.clear();
+	d->cancelled.storeRelease(0);
 
 	if (!d->card) {
 		// No card specified.
@@ -300,65 +1246,155 @@ int GcnSearchWorker::searchMemCard(void)
 		return 0;
 	}
 
+	// Search addresses above 0x1FFF are in the file's subsequent blocks,
+	// so each candidate first block is checked along with the blocks
+	// after it. The blocks are kept in a sliding window, since the
+	// search list is in descending order: moving to the previous block
+	// only requires reading one new block.
+	int windowBlocks = 1;
+	foreach (const GcnMcFileDb *db, d->databases) {
+		windowBlocks = std::max(windowBlocks, db->searchBlockCount());
+	}
+
 	// Block buffer.
 	const int blockSize = d->card->blockSize();
-	unique_ptr<uint8_t[]> buf(new uint8_t[blockSize]);
+	unique_ptr<uint8_t[]> buf(new uint8_t[blockSize * windowBlocks]);
+	int windowStart = -1;	// First block in the window (-1 if invalid)
+	int windowCount = 0;	// Number of blocks in the window
+
+	// Match context.
+	// The databases may be shared with other threads,
+	// so the decoder state is kept here.
+	GcnMcFileMatchContext matchContext;
 
 	fprintf(stderr, "--------------------------------\n");
 	fprintf(stderr, "SCANNING MEMORY CARD...\n");
 
+	// Files found in the search.
+	// Blocks are assigned after the search is complete,
+	// since files found earlier might otherwise take
+	// blocks that belong to files found later.
+	std::vector<GcnSearchWorkerPrivate::SearchHit> hits;
+
+	// Blocks that have been scanned.
+	// If a checkpoint for this card image exists, the blocks
+	// it scanned are skipped, and its files are reused.
+	QBitArray scannedBlocks(totalPhysBlocks);
+	const bool useCheckpoint = !d->checkpointFilename.isEmpty();
+	d->blockHashes.clear();
+	if (useCheckpoint) {
+		// The system blocks determine which blocks are searched,
+		// so they're always part of the checkpoint's card hash.
+		d->blockHashes.resize(totalPhysBlocks);
+		QBitArray systemBlocks(totalPhysBlocks);
+		systemBlocks.fill(true, 0, std::min(5, totalPhysBlocks));
+		d->hashBlocks(systemBlocks);
+
+		// NOTE: If there's no checkpoint file, the card isn't
+		// read here; blocks are hashed as they're scanned.
+		if (QFile::exists(d->checkpointFilename) &&
+		    d->loadCheckpoint(&scannedBlocks, &hits) == 0)
+		{
+			// The preferred region may have changed,
+			// so rank the candidates again.
+			for (GcnSearchWorkerPrivate::SearchHit &hit : hits) {
+				QVector<GcnSearchData> candidates;
+				candidates.reserve((int)hit.candidates.size());
+				for (const GcnSearchData &searchData : hit.candidates) {
+					candidates.append(searchData);
+				}
+				d->rankCandidates(candidates, usedBlockMap);
+				hit.candidates.assign(candidates.constBegin(), candidates.constEnd());
+			}
+		}
+	}
+
+	// Files from the checkpoint are provisional, too.
+	for (const GcnSearchWorkerPrivate::SearchHit &hit : hits) {
+		GcnSearchData searchData = hit.candidates[0];
+		d->defaultFatChain(&searchData, usedBlockMap);
+		emit provisionalFileFound(searchData);
+	}
+	QElapsedTimer checkpointTimer;
+	checkpointTimer.start();
+
 	const int totalSearchBlocks = blockSearchList.size();
 	int currentPhysBlock = blockSearchList.value(0);
 	emit searchStarted(totalPhysBlocks, totalSearchBlocks, currentPhysBlock);
 
 	int currentSearchBlock = -1;	// compensate for currentSearchBlock++
+	bool isCancelled = false;
 	foreach (currentPhysBlock, blockSearchList) {
 		currentSearchBlock++;
-		fprintf(stderr, "Searching block: %d...\n", currentPhysBlock);
-		emit searchUpdate(currentPhysBlock, currentSearchBlock, d->filesFoundList.size());
+		if (d->cancelled.loadAcquire()) {
+			// Search was cancelled.
+			isCancelled = true;
+			break;
+		}
+		if (scannedBlocks.testBit(currentPhysBlock)) {
+			// Block was scanned before the checkpoint.
+			continue;
+		}
 
-		int ret = d->card->readBlock(buf.get(), blockSize, currentPhysBlock);
-		if (ret != blockSize) {
+		fprintf(stderr, "Searching block: %d...\n", currentPhysBlock);
+		emit searchUpdate(currentPhysBlock, currentSearchBlock, (int)hits.size());
+
+		const int count = std::min(windowBlocks, totalPhysBlocks - currentPhysBlock);
+		int ret;
+		if (windowStart == currentPhysBlock + 1) {
+			// Slide the window back by one block.
+			// Only the new first block needs to be read.
+			memmove(&buf[blockSize], &buf[0], (count - 1) * blockSize);
+			windowCount = std::min(windowCount + 1, count);
+			ret = d->card->readBlock(buf.get(), blockSize, currentPhysBlock);
+		} else {
+			// Read the entire window.
+			ret = d->card->readBlocks(buf.get(), blockSize * windowBlocks, currentPhysBlock, count);
+			windowCount = (ret > 0 ? (ret / blockSize) : 0);
+		}
+		if (ret < blockSize) {
 			// Error reading block.
 			fprintf(stderr, "ERROR reading block %d - readBlock() returned %d.\n", currentPhysBlock, ret);
+			windowStart = -1;
+			windowCount = 0;
 			continue;
 		}
+		if (useCheckpoint) {
+			// Hash the blocks that were just read.
+			// (Blocks that were already hashed are skipped.)
+			for (int i = 0; i < windowCount; i++) {
+				d->hashBlock((uint16_t)(currentPhysBlock + i), &buf[i * blockSize]);
+			}
+		}
+		windowStart = currentPhysBlock;
 
 		// Check the block in the databases.
 		QVector<GcnSearchData> searchDataEntries;
+		matchContext.setBlock(buf.get(), blockSize * windowCount);
 		foreach (GcnMcFileDb *db, d->databases) {
-			QVector<GcnSearchData> curEntries = db->checkBlock(buf.get(), blockSize);
+			QVector<GcnSearchData> curEntries = db->checkBlock(&matchContext);
 			searchDataEntries += curEntries;
 		}
 
-		// TODO: Search for preferred region. For now, just use the first hit.
 		if (!searchDataEntries.isEmpty()) {
 			// Matched!
-			GcnSearchData searchData;
-			if (searchDataEntries.size() == 1 || d->preferredRegion == 0) {
-				// Only one entry, or no preferred region.
-				searchData = searchDataEntries.at(0);
-			} else {
-				// Find an entry matching the preferred region.
-				bool isMatch = false;
-				for (int i = 0; i < searchDataEntries.size(); i++) {
-					const GcnSearchData &schk = searchDataEntries.at(i);
-					if (schk.dirEntry.gamecode[3] == d->preferredRegion) {
-						// Found a match!
-						searchData = schk;
-						isMatch = true;
-						break;
-					}
-				}
-
-				if (!isMatch) {
-					// No region match. Use the first entry.
-					searchData = searchDataEntries.at(0);
+			for (int i = 0; i < searchDataEntries.size(); i++) {
+				// NOTE: dirEntry's block start is not set by d->db->checkBlock().
+				// Set it here.
+				GcnSearchData &searchData = searchDataEntries[i];
+				searchData.dirEntry.block = currentPhysBlock;
+				if (searchData.dirEntry.length == 0) {
+					// This only happens if an entry is either
+					// missing a <dirEntry>, or has <length>0</length>.
+					// TODO: Check for this in GcnMcFileDb.
+					searchData.dirEntry.length = 1;
 				}
 			}
 
-			// NOTE: GcnMcFileDb doesn't initialize fatEntries.
-			// Hence, we have to make a copy and initialize the list.
+			// Rank the candidates.
+			d->rankCandidates(searchDataEntries, usedBlockMap);
+			const GcnSearchData &searchData = searchDataEntries.at(0);
+
 			fprintf(stderr, "FOUND A MATCH: %-.4s%-.2s %-.32s\n",
 				searchData.dirEntry.gamecode,
 				searchData.dirEntry.company,
@@ -369,84 +1405,76 @@ int GcnSearchWorker::searchMemCard(void)
 				searchData.dirEntry.iconfmt,
 				searchData.dirEntry.iconspeed);
 
-			// NOTE: dirEntry's block start is not set by d->db->checkBlock().
-			// Set it here.
-			searchData.dirEntry.block = currentPhysBlock;
-			if (searchData.dirEntry.length == 0) {
-				// This only happens if an entry is either
-				// missing a <dirEntry>, or has <length>0</length>.
-				// TODO: Check for this in GcnMcFileDb.
-				searchData.dirEntry.length = 1;
-			}
+			// NOTE: GcnMcFileDb doesn't initialize fatEntries.
+			// Blocks are assigned after all files have been found.
+			GcnSearchWorkerPrivate::SearchHit hit;
+			hit.candidates.assign(searchDataEntries.constBegin(), searchDataEntries.constEnd());
+			hits.push_back(hit);
+
+			// Show the file right away, using its default FAT chain.
+			// Its blocks may change once the scan is complete.
+			GcnSearchData provisional = searchData;
+			d->defaultFatChain(&provisional, usedBlockMap);
+			emit provisionalFileFound(provisional);
+		}
 
-			// Construct the FAT entries for this file.
-			searchData.fatEntries.clear();
-			searchData.fatEntries.reserve(searchData.dirEntry.length);
+		// Block has been scanned.
+		scannedBlocks.setBit(currentPhysBlock);
+		if (useCheckpoint &&
+		    checkpointTimer.elapsed() >= GcnSearchWorkerPrivate::CHECKPOINT_INTERVAL_MS)
+		{
+			d->saveCheckpoint(scannedBlocks, hits);
+			checkpointTimer.restart();
+		}
+	}
 
-			// First block is always valid.
-			searchData.fatEntries.push_back(searchData.dirEntry.block);
-			if (usedBlockMap[searchData.dirEntry.block] < std::numeric_limits<uint8_t>::max()) {
-				usedBlockMap[searchData.dirEntry.block]++;
-			}
+	if (isCancelled) {
+		// Save a checkpoint so the search can be resumed.
+		if (useCheckpoint) {
+			d->saveCheckpoint(scannedBlocks, hits);
+		}
 
-			uint16_t blocksRemaining = (searchData.dirEntry.length - 1);
-			uint16_t block = (searchData.dirEntry.block + 1);
-			bool wasWrapped = false;
-
-			// Skip used blocks and go after empty blocks only.
-			while (blocksRemaining > 0) {
-				if (block >= totalPhysBlocks) {
-					// Wraparound.
-					// Do NOT mark the wrapped blocks as used,
-					// since they might be used by actual files.
-					block = 5;
-					wasWrapped = true;
-					continue;
-				} else if (block == searchData.dirEntry.block) {
-					// ERROR: We wrapped around!
-					// Use the "naive" algorithm after the last valid block.
-					break;
-				}
+		fprintf(stderr, "Search cancelled.\n");
+		fprintf(stderr, "--------------------------------\n");
+		emit searchCancelled();
+		return -ECANCELED;
+	}
 
-				// Check if this block is used.
-				if (usedBlockMap[block] == 0) {
-					// Block is not used.
-					searchData.fatEntries.push_back(block);
-					if (!wasWrapped) {
-						usedBlockMap[block]++;
-					}
-					blocksRemaining--;
-				}
+	// Assign blocks to all of the files.
+	// The provisional files are replaced by fileFound().
+	// NOTE: This may take a while if checksums have to be
+	// searched, so it can be cancelled, too. The checkpoint
+	// has all blocks scanned, so resuming skips the scan.
+	emit provisionalFilesDiscarded();
+	if (d->assignBlocks(hits, usedBlockMap, currentSearchBlock) == -ECANCELED) {
+		if (useCheckpoint) {
+			d->saveCheckpoint(scannedBlocks, hits);
+		}
 
-				// Next block.
-				block++;
-			}
+		fprintf(stderr, "Search cancelled.\n");
+		fprintf(stderr, "--------------------------------\n");
+		emit searchCancelled();
+		return -ECANCELED;
+	}
 
-			// Naive block algorithm for the remaining blocks.
-			block = (searchData.fatEntries[searchData.fatEntries.size() - 1] + 1);
-			wasWrapped = false;
-			while (blocksRemaining > 0) {
-				if (block >= totalPhysBlocks) {
-					// Wraparound.
-					// Do NOT mark the wrapped blocks as used,
-					// since they might be used by actual files.
-					block = 5;
-					continue;
-				}
+	// The search is complete. The checkpoint is no longer needed.
+	if (useCheckpoint) {
+		QFile::remove(d->checkpointFilename);
+	}
 
-				// Add this block.
-				searchData.fatEntries.push_back(block);
-				if (usedBlockMap[block] < std::numeric_limits<uint8_t>::max()) {
-					if (!wasWrapped) {
-						usedBlockMap[block]++;
-					}
-				}
-				block++;
-				blocksRemaining--;
+	for (GcnSearchWorkerPrivate::SearchHit &hit : hits) {
+		if (hit.rejected)
+			continue;
+		d->filesFoundList.push_back(hit.candidates[0]);
+
+		// Runner-ups that weren't solved get their own
+		// default FAT chains, so they can be used as-is.
+		for (size_t i = 1; i < hit.candidates.size(); i++) {
+			GcnSearchData &alt = hit.candidates[i];
+			if (alt.fatEntries.empty()) {
+				d->defaultFatChain(&alt, usedBlockMap);
 			}
-
-			// Add the search data to the list. (front of list)
-			d->filesFoundList.push_front(searchData);
+			d->alternativesList.push_back(alt);
 		}
 	}
 
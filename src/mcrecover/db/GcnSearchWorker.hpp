@@ -27,6 +27,7 @@ class GcnCard;
 class GcnMcFileDb;
 Q_DECLARE_OPAQUE_POINTER(GcnCard*);
 Q_DECLARE_METATYPE(GcnCard*);
+Q_DECLARE_METATYPE(GcnSearchData);
 
 class GcnSearchWorkerPrivate;
 class GcnSearchWorker : public QObject
@@ -36,11 +37,13 @@ class GcnSearchWorker : public QObject
 
 	Q_PROPERTY(QString errorString READ errorString)
 	Q_PROPERTY(std::list<GcnSearchData> filesFoundList READ filesFoundList)
+	Q_PROPERTY(std::list<GcnSearchData> alternativesList READ alternativesList)
 
 	Q_PROPERTY(GcnCard* card READ card WRITE setCard)
 	Q_PROPERTY(QVector<GcnMcFileDb*> databases READ databases WRITE setDatabases)
 	Q_PROPERTY(char preferredRegion READ preferredRegion WRITE setPreferredRegion)
 	Q_PROPERTY(bool searchUsedBlocks READ searchUsedBlocks WRITE setSearchUsedBlocks)
+	Q_PROPERTY(QString checkpointFilename READ checkpointFilename WRITE setCheckpointFilename)
 	Q_PROPERTY(QThread* origThread READ origThread WRITE setOrigThread)
 
 public:
@@ -81,6 +84,29 @@ signals:
 	 */
 	void searchUpdate(int currentPhysBlock, int currentSearchBlock, int lostFilesFound);
 
+	/**
+	 * A "lost" file has been found, and its blocks have been assigned.
+	 * This is emitted for each file before searchFinished(),
+	 * so files can be added to the card as they're found.
+	 * @param searchData Search data
+	 */
+	void fileFound(const GcnSearchData &searchData);
+
+	/**
+	 * A "lost" file has been found during the scan.
+	 * The file uses its default FAT chain, which may change
+	 * once all blocks have been scanned.
+	 * @param searchData Search data
+	 */
+	void provisionalFileFound(const GcnSearchData &searchData);
+
+	/**
+	 * The scan is complete, and blocks are about to be assigned.
+	 * Files from provisionalFileFound() should be removed, since
+	 * fileFound() is emitted for all files, including those files.
+	 */
+	void provisionalFilesDiscarded(void);
+
 	/**
 	 * An error has occurred during the search.
 	 * @param errorString Error string
@@ -106,6 +132,16 @@ public:
 	 */
 	std::list<GcnSearchData> filesFoundList(void) const;
 
+	/**
+	 * Get the other candidates for the files found in the last successful search.
+	 * If a block matched more than one file definition, the best match
+	 * is in filesFoundList(), and the rest are here, best first.
+	 * Each candidate's dirEntry.block is the first block of the
+	 * file it's an alternative for.
+	 * @return List of other candidates
+	 */
+	std::list<GcnSearchData> alternativesList(void) const;
+
 public:
 	/** Properties **/
 
@@ -179,6 +215,25 @@ public:
 	 */
 	void setOrigThread(QThread *origThread);
 
+	/**
+	 * Get the checkpoint filename.
+	 * @return Checkpoint filename, or empty string if checkpoints are disabled.
+	 */
+	QString checkpointFilename(void) const;
+
+	/**
+	 * Set the checkpoint filename.
+	 *
+	 * If set, the search state is saved to this file periodically
+	 * and when the search is cancelled. If the file has a checkpoint
+	 * for the same card contents, databases, and search settings,
+	 * searchMemCard() resumes from it. The file is removed when the
+	 * search finishes. Old checkpoints are ignored.
+	 *
+	 * @param checkpointFilename Checkpoint filename, or empty string to disable checkpoints.
+	 */
+	void setCheckpointFilename(const QString &checkpointFilename);
+
 public:
 	/** Search functions **/
 
@@ -192,6 +247,15 @@ public:
 	 */
 	int searchMemCard(void);
 
+	/**
+	 * Cancel the current search.
+	 * This function is thread-safe.
+	 *
+	 * searchMemCard() saves a checkpoint, if enabled,
+	 * emits searchCancelled(), and returns -ECANCELED.
+	 */
+	void cancel(void);
+
 	/**
 	 * Set internal information for threading purposes.
 	 * This is basically the parameters to searchMemCard().
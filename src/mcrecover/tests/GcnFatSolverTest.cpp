@@ -0,0 +1,359 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program: Unit tests.                      *
+ * GcnFatSolverTest.cpp: Checksum-guided FAT chain reconstruction tests.   *
+ *                                                                         *
+ * Copyright (c) 2013-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "db/GcnFatSolver.hpp"
+using Checksum::ChecksumDef;
+using Checksum::ChecksumValue;
+using Checksum::ChkAlgorithm;
+
+// C includes (C++ namespace)
+#include <cstring>
+
+// C++ includes
+#include <algorithm>
+#include <vector>
+using std::vector;
+
+// Qt includes
+#include <QtCore/QObject>
+#include <QtTest/QtTest>
+
+Q_DECLARE_METATYPE(Checksum::ChkAlgorithm)
+
+class GcnFatSolverTest : public QObject
+{
+	Q_OBJECT
+
+	private:
+		/**
+		 * Pseudo-random number generator.
+		 * The sequence must be the same on all platforms,
+		 * so qrand() and rand() aren't used.
+		 * @return Pseudo-random number (15 bits)
+		 */
+		uint32_t nextRandom(void)
+		{
+			seed = (seed * 1103515245U) + 12345U;
+			return (seed >> 16) & 0x7FFF;
+		}
+
+		uint32_t seed;
+
+		/**
+		 * Test file.
+		 * Block i has block number (FIRST_BLOCK + i).
+		 * Block 0 is the file's first block.
+		 */
+		struct TestFile {
+			vector<vector<uint8_t> > blocks;	// Candidate blocks
+			vector<uint16_t> fatEntries;		// Correct FAT chain
+			vector<uint16_t> defaultChain;		// Default FAT chain (sequential)
+			vector<ChecksumDef> checksumDefs;
+		};
+
+		static const int BLOCK_SIZE = 0x2000;
+		static const uint16_t FIRST_BLOCK = 100;
+
+		/**
+		 * Create a test file with shuffled blocks.
+		 * A single checksum covers the entire file, except for
+		 * the checksum field itself at the start of the file.
+		 * @param file		[out] Test file
+		 * @param length	[in] File length, in blocks
+		 * @param extra		[in] Number of unrelated candidate blocks
+		 * @param algorithm	[in] Checksum algorithm
+		 */
+		void makeFile(TestFile &file, int length, int extra, ChkAlgorithm algorithm);
+
+		/**
+		 * Create a solver for a test file.
+		 * @param file Test file
+		 * @return Solver, with all of the candidate blocks added
+		 */
+		static GcnFatSolver *makeSolver(const TestFile &file);
+
+	private slots:
+		void init(void);
+
+		void recoverShuffled_data(void);
+		void recoverShuffled(void);
+
+		void deterministic(void);
+		void defaultChainCorrect(void);
+		void defaultWinsTies(void);
+		void uncoveredFromDefault(void);
+		void noChecksums(void);
+};
+
+void GcnFatSolverTest::init(void)
+{
+	seed = 1;
+}
+
+/**
+ * Create a test file with shuffled blocks.
+ * A single checksum covers the entire file, except for
+ * the checksum field itself at the start of the file.
+ * @param file		[out] Test file
+ * @param length	[in] File length, in blocks
+ * @param extra		[in] Number of unrelated candidate blocks
+ * @param algorithm	[in] Checksum algorithm
+ */
+void GcnFatSolverTest::makeFile(TestFile &file, int length, int extra, ChkAlgorithm algorithm)
+{
+	const int count = length + extra;
+	file.blocks.assign(count, vector<uint8_t>(BLOCK_SIZE));
+	for (vector<uint8_t> &block : file.blocks) {
+		for (uint8_t &chr : block) {
+			chr = (uint8_t)nextRandom();
+		}
+	}
+
+	// Shuffle everything except for the first block.
+	vector<int> order(count);
+	for (int i = 0; i < count; i++) {
+		order[i] = i;
+	}
+	for (int i = count - 1; i > 1; i--) {
+		std::swap(order[i], order[1 + (nextRandom() % i)]);
+	}
+
+	file.fatEntries.resize(length);
+	file.defaultChain.resize(length);
+	for (int i = 0; i < length; i++) {
+		file.fatEntries[i] = (uint16_t)(FIRST_BLOCK + order[i]);
+		file.defaultChain[i] = (uint16_t)(FIRST_BLOCK + i);
+	}
+
+	// Calculate the checksum over the file in its correct order.
+	ChecksumDef def;
+	def.algorithm = algorithm;
+	def.address = 0;
+	def.param = 0;
+	def.start = 4;
+	def.length = (length * BLOCK_SIZE) - 4;
+	def.endian = Checksum::ChkEndian::Big;
+
+	vector<uint8_t> data(length * BLOCK_SIZE);
+	for (int i = 0; i < length; i++) {
+		memcpy(&data[i * BLOCK_SIZE], file.blocks[order[i]].data(), BLOCK_SIZE);
+	}
+	ChecksumValue value;
+	QVERIFY(Checksum::Calculate(def, data.data(), (uint32_t)data.size(), &value));
+
+	// Store the checksum in the first block.
+	uint8_t *const field = file.blocks[0].data();
+	if (Checksum::FieldSize(algorithm) == 2) {
+		field[0] = (uint8_t)(value.actual >> 8);
+		field[1] = (uint8_t)(value.actual);
+	} else {
+		field[0] = (uint8_t)(value.actual >> 24);
+		field[1] = (uint8_t)(value.actual >> 16);
+		field[2] = (uint8_t)(value.actual >> 8);
+		field[3] = (uint8_t)(value.actual);
+	}
+
+	file.checksumDefs.assign(1, def);
+}
+
+/**
+ * Create a solver for a test file.
+ * @param file Test file
+ * @return Solver, with all of the candidate blocks added
+ */
+GcnFatSolver *GcnFatSolverTest::makeSolver(const TestFile &file)
+{
+	GcnFatSolver *const solver = new GcnFatSolver(BLOCK_SIZE, file.checksumDefs);
+	for (int i = 0; i < (int)file.blocks.size(); i++) {
+		solver->addBlock((uint16_t)(FIRST_BLOCK + i), file.blocks[i].data());
+	}
+	return solver;
+}
+
+void GcnFatSolverTest::recoverShuffled_data(void)
+{
+	QTest::addColumn<ChkAlgorithm>("algorithm");
+	QTest::addColumn<int>("length");
+	QTest::addColumn<int>("extra");
+
+	QTest::newRow("CRC16, 3 blocks") << ChkAlgorithm::CRC16 << 3 << 0;
+	QTest::newRow("CRC16, 4 blocks, 3 extra") << ChkAlgorithm::CRC16 << 4 << 3;
+	QTest::newRow("CRC16, 6 blocks, 2 extra") << ChkAlgorithm::CRC16 << 6 << 2;
+	QTest::newRow("DreamcastVMU, 5 blocks, 1 extra") << ChkAlgorithm::DreamcastVMU << 5 << 1;
+}
+
+/**
+ * The solver must recover the correct FAT chain
+ * if the default chain is wrong.
+ */
+void GcnFatSolverTest::recoverShuffled(void)
+{
+	QFETCH(ChkAlgorithm, algorithm);
+	QFETCH(int, length);
+	QFETCH(int, extra);
+
+	TestFile file;
+	for (int i = 0; i < 8; i++) {
+		makeFile(file, length, extra, algorithm);
+		if (file.fatEntries != file.defaultChain)
+			break;
+	}
+	QVERIFY(file.fatEntries != file.defaultChain);
+
+	QScopedPointer<GcnFatSolver> solver(makeSolver(file));
+	const GcnFatSolver::Result result = solver->solve(file.defaultChain);
+	QVERIFY(result.fatEntries == file.fatEntries);
+	QCOMPARE(result.checksumsGood, 1);
+	QCOMPARE(result.checksumsTotal, 1);
+	QCOMPARE(result.confidence, 100);
+	QVERIFY(result.complete);
+}
+
+/**
+ * The search is split between multiple threads,
+ * but the result must not depend on scheduling.
+ */
+void GcnFatSolverTest::deterministic(void)
+{
+	// Add a second checksum that doesn't match the file.
+	// The best chain can't match every checksum, so the
+	// search doesn't stop early.
+	TestFile file;
+	makeFile(file, 5, 3, ChkAlgorithm::CRC16);
+	ChecksumDef bad = file.checksumDefs[0];
+	bad.address = 2;
+	file.checksumDefs.push_back(bad);
+
+	QScopedPointer<GcnFatSolver> solver(makeSolver(file));
+	const GcnFatSolver::Result expected = solver->solve(file.defaultChain);
+	QVERIFY(expected.complete);
+	QCOMPARE(expected.checksumsTotal, 2);
+	QVERIFY(expected.checksumsGood >= 1);
+
+	for (int i = 0; i < 4; i++) {
+		// Same solver.
+		GcnFatSolver::Result result = solver->solve(file.defaultChain);
+		QVERIFY(result.fatEntries == expected.fatEntries);
+		QCOMPARE(result.checksumsGood, expected.checksumsGood);
+		QCOMPARE(result.complete, expected.complete);
+
+		// New solver.
+		QScopedPointer<GcnFatSolver> newSolver(makeSolver(file));
+		result = newSolver->solve(file.defaultChain);
+		QVERIFY(result.fatEntries == expected.fatEntries);
+		QCOMPARE(result.checksumsGood, expected.checksumsGood);
+		QCOMPARE(result.complete, expected.complete);
+	}
+}
+
+/**
+ * If the default chain is correct, it must be returned as-is.
+ */
+void GcnFatSolverTest::defaultChainCorrect(void)
+{
+	TestFile file;
+	makeFile(file, 4, 2, ChkAlgorithm::CRC16);
+
+	QScopedPointer<GcnFatSolver> solver(makeSolver(file));
+	const GcnFatSolver::Result result = solver->solve(file.fatEntries);
+	QVERIFY(result.fatEntries == file.fatEntries);
+	QCOMPARE(result.checksumsGood, 1);
+	QCOMPARE(result.confidence, 100);
+	QVERIFY(result.complete);
+}
+
+/**
+ * If other chains match as many checksums as the default chain,
+ * the default chain must be returned.
+ */
+void GcnFatSolverTest::defaultWinsTies(void)
+{
+	// AddBytes32 doesn't depend on the order of the data,
+	// so every ordering of the file's blocks matches.
+	TestFile file;
+	for (int i = 0; i < 8; i++) {
+		makeFile(file, 4, 0, ChkAlgorithm::AddBytes32);
+		if (file.fatEntries != file.defaultChain)
+			break;
+	}
+	QVERIFY(file.fatEntries != file.defaultChain);
+
+	QScopedPointer<GcnFatSolver> solver(makeSolver(file));
+	const GcnFatSolver::Result result = solver->solve(file.defaultChain);
+	QVERIFY(result.fatEntries == file.defaultChain);
+	QCOMPARE(result.checksumsGood, 1);
+	QCOMPARE(result.confidence, 100);
+}
+
+/**
+ * Positions that aren't covered by any checksum
+ * must be taken from the default chain.
+ */
+void GcnFatSolverTest::uncoveredFromDefault(void)
+{
+	// 3-block file. The checksum only covers the first two blocks.
+	// The second block is candidate 3, which is the default
+	// block for a position past the end of the file.
+	TestFile file;
+	file.blocks.assign(4, vector<uint8_t>(BLOCK_SIZE));
+	for (vector<uint8_t> &block : file.blocks) {
+		for (uint8_t &chr : block) {
+			chr = (uint8_t)nextRandom();
+		}
+	}
+	for (int i = 0; i < 3; i++) {
+		file.defaultChain.push_back((uint16_t)(FIRST_BLOCK + i));
+	}
+
+	ChecksumDef def;
+	def.algorithm = ChkAlgorithm::CRC16;
+	def.address = 0;
+	def.param = 0;
+	def.start = 4;
+	def.length = (2 * BLOCK_SIZE) - 4;
+	def.endian = Checksum::ChkEndian::Big;
+
+	vector<uint8_t> data(2 * BLOCK_SIZE);
+	memcpy(&data[0], file.blocks[0].data(), BLOCK_SIZE);
+	memcpy(&data[BLOCK_SIZE], file.blocks[3].data(), BLOCK_SIZE);
+	ChecksumValue value;
+	QVERIFY(Checksum::Calculate(def, data.data(), (uint32_t)data.size(), &value));
+	file.blocks[0][0] = (uint8_t)(value.actual >> 8);
+	file.blocks[0][1] = (uint8_t)(value.actual);
+	file.checksumDefs.assign(1, def);
+
+	QScopedPointer<GcnFatSolver> solver(makeSolver(file));
+	const GcnFatSolver::Result result = solver->solve(file.defaultChain);
+	QCOMPARE((int)result.fatEntries.size(), 3);
+	QCOMPARE((int)result.fatEntries[0], FIRST_BLOCK + 0);
+	QCOMPARE((int)result.fatEntries[1], FIRST_BLOCK + 3);
+	QCOMPARE((int)result.fatEntries[2], FIRST_BLOCK + 2);
+	QCOMPARE(result.confidence, 100);
+}
+
+/**
+ * Without usable checksums, the default chain is returned.
+ */
+void GcnFatSolverTest::noChecksums(void)
+{
+	TestFile file;
+	makeFile(file, 4, 2, ChkAlgorithm::CRC16);
+	file.checksumDefs.clear();
+
+	QScopedPointer<GcnFatSolver> solver(makeSolver(file));
+	const GcnFatSolver::Result result = solver->solve(file.defaultChain);
+	QVERIFY(result.fatEntries == file.defaultChain);
+	QCOMPARE(result.checksumsGood, 0);
+	QCOMPARE(result.checksumsTotal, 0);
+	QCOMPARE(result.confidence, 0);
+	QVERIFY(result.complete);
+}
+
+QTEST_APPLESS_MAIN(GcnFatSolverTest)
+
+#include "GcnFatSolverTest.moc"
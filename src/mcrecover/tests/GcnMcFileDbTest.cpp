@@ -0,0 +1,478 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program: Unit tests.                      *
+ * GcnMcFileDbTest.cpp: File database matching tests.                      *
+ *                                                                         *
+ * Copyright (c) 2013-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "db/GcnMcFileDb.hpp"
+#include "db/GcnMcFileMatchContext.hpp"
+
+// C includes (C++ namespace)
+#include <cstring>
+
+// C++ includes
+#include <vector>
+using std::vector;
+
+// Qt includes
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QObject>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QSet>
+#include <QtCore/QStringList>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QXmlStreamReader>
+#include <QtTest/QtTest>
+
+/**
+ * checkBlock() uses byte-level prefilters and combined regexes
+ * to speed up matching. The results must be the same as checking
+ * each file definition's regexes against the decoded comments.
+ */
+class GcnMcFileDbTest : public QObject
+{
+	Q_OBJECT
+
+	private:
+		static const int BLOCK_SIZE = 0x2000;
+
+		QTemporaryDir tmpDir;
+
+		/**
+		 * Reference file definition.
+		 */
+		struct RefDef {
+			QString gameID;
+			uint32_t address;
+			QRegularExpression gameDesc;
+			QRegularExpression fileDesc;
+			bool hasVariables;
+		};
+
+		/**
+		 * Comments to check.
+		 */
+		struct TestComment {
+			uint32_t address;
+			QByteArray gameDesc;
+			QByteArray fileDesc;
+		};
+
+		/**
+		 * Parse the file definitions from a database file.
+		 * Definitions that the database would reject, or that
+		 * can't be checked in a single block, are skipped.
+		 * @param filename Database filename
+		 * @param defs [out] File definitions
+		 * @return True on success; false on error.
+		 */
+		static bool parseDefs(const QString &filename, QVector<RefDef> &defs);
+
+		/**
+		 * Get a comment from a block, the same way the match context does.
+		 * Only ASCII comments are used, so Latin-1 is the same as cp1252.
+		 * @param block Block data
+		 * @param address Comment address
+		 * @return Comment, truncated at NULL and trimmed
+		 */
+		static QString comment(const uint8_t *block, uint32_t address)
+		{
+			const char *const buf = reinterpret_cast<const char*>(&block[address]);
+			const char *const p_nullChr = static_cast<const char*>(memchr(buf, 0x00, 32));
+			return QString::fromLatin1(buf, (p_nullChr ? (int)(p_nullChr - buf) : 32)).trimmed();
+		}
+
+		/**
+		 * Set a block's comments.
+		 * @param block Block data
+		 * @param address Comment address
+		 * @param gameDesc Game description (up to 32 characters)
+		 * @param fileDesc File description (up to 32 characters)
+		 */
+		static void setComment(uint8_t *block, uint32_t address,
+			const QByteArray &gameDesc, const QByteArray &fileDesc)
+		{
+			memset(&block[address], 0, 0x40);
+			memcpy(&block[address], gameDesc.constData(), qMin(gameDesc.size(), 32));
+			memcpy(&block[address + 0x20], fileDesc.constData(), qMin(fileDesc.size(), 32));
+		}
+
+		/**
+		 * Check a block using the reference file definitions.
+		 * @param defs File definitions
+		 * @param block Block data
+		 * @param ignore Game IDs to ignore
+		 * @return Sorted list of matching game IDs
+		 */
+		static QStringList refMatches(const QVector<RefDef> &defs,
+			const uint8_t *block, const QSet<QString> &ignore);
+
+		/**
+		 * Check a block using GcnMcFileDb.
+		 * @param db Database
+		 * @param ctx Match context
+		 * @param block Block data
+		 * @param ignore Game IDs to ignore
+		 * @return Sorted list of matching game IDs
+		 */
+		static QStringList dbMatches(const GcnMcFileDb &db, GcnMcFileMatchContext *ctx,
+			const uint8_t *block, const QSet<QString> &ignore);
+
+		/**
+		 * Get the literal string from a simple regex, e.g. "^Save Data$".
+		 * @param pattern Regex pattern
+		 * @param literal [out] Literal string
+		 * @return True if the regex is a printable ASCII literal; false if not.
+		 */
+		static bool simpleLiteral(const QString &pattern, QByteArray &literal);
+
+		/**
+		 * Check that GcnMcFileDb matches the same blocks as the reference.
+		 * Each comment is checked in an otherwise empty block.
+		 * @param filename Database filename
+		 * @param comments Comments to check
+		 */
+		void checkEquivalence(const QString &filename, const QVector<TestComment> &comments);
+
+	private slots:
+		void initTestCase(void);
+
+		void synthetic(void);
+
+		void realDatabases_data(void);
+		void realDatabases(void);
+};
+
+bool GcnMcFileDbTest::parseDefs(const QString &filename, QVector<RefDef> &defs)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QXmlStreamReader xml(&file);
+	RefDef def;
+	bool inFile = false, inSearch = false;
+	bool hasID6 = false, hasGameCodeOrCompany = false;
+	QString gamecode, company;
+	while (!xml.atEnd() && !xml.hasError()) {
+		xml.readNext();
+		if (xml.isStartElement()) {
+			if (xml.name() == QLatin1String("file")) {
+				def = RefDef();
+				def.address = 0;
+				def.hasVariables = false;
+				inFile = true;
+				hasID6 = false;
+				hasGameCodeOrCompany = false;
+				gamecode.clear();
+				company.clear();
+			} else if (!inFile) {
+				continue;
+			} else if (xml.name() == QLatin1String("search")) {
+				inSearch = true;
+			} else if (xml.name() == QLatin1String("id6")) {
+				hasID6 = true;
+				def.gameID = xml.readElementText();
+			} else if (xml.name() == QLatin1String("gamecode")) {
+				hasGameCodeOrCompany = true;
+				gamecode = xml.readElementText();
+			} else if (xml.name() == QLatin1String("company")) {
+				hasGameCodeOrCompany = true;
+				company = xml.readElementText();
+			} else if (xml.name() == QLatin1String("variables")) {
+				def.hasVariables = true;
+			} else if (!inSearch) {
+				continue;
+			} else if (xml.name() == QLatin1String("address")) {
+				def.address = xml.readElementText().toUInt(nullptr, 0);
+			} else if (xml.name() == QLatin1String("gameDesc")) {
+				def.gameDesc.setPattern(xml.readElementText());
+			} else if (xml.name() == QLatin1String("fileDesc")) {
+				def.fileDesc.setPattern(xml.readElementText());
+			}
+		} else if (xml.isEndElement()) {
+			if (xml.name() == QLatin1String("search")) {
+				inSearch = false;
+				continue;
+			} else if (xml.name() != QLatin1String("file")) {
+				continue;
+			}
+
+			inFile = false;
+			if (hasID6 == hasGameCodeOrCompany) {
+				// GcnMcFileDb rejects this definition.
+				continue;
+			}
+			if (hasGameCodeOrCompany) {
+				def.gameID = gamecode.left(4) + company.left(2);
+			}
+			if (def.address + 0x40 > (uint32_t)BLOCK_SIZE) {
+				// Not in the first block.
+				continue;
+			}
+			defs.append(def);
+		}
+	}
+
+	return !xml.hasError();
+}
+
+QStringList GcnMcFileDbTest::refMatches(const QVector<RefDef> &defs,
+	const uint8_t *block, const QSet<QString> &ignore)
+{
+	QStringList ret;
+	foreach (const RefDef &def, defs) {
+		if (ignore.contains(def.gameID))
+			continue;
+
+		if (def.gameDesc.match(comment(block, def.address)).hasMatch() &&
+		    def.fileDesc.match(comment(block, def.address + 0x20)).hasMatch())
+		{
+			ret.append(def.gameID);
+		}
+	}
+	ret.sort();
+	return ret;
+}
+
+QStringList GcnMcFileDbTest::dbMatches(const GcnMcFileDb &db, GcnMcFileMatchContext *ctx,
+	const uint8_t *block, const QSet<QString> &ignore)
+{
+	ctx->setBlock(block, BLOCK_SIZE);
+	const QVector<GcnSearchData> matches = db.checkBlock(ctx);
+
+	QStringList ret;
+	foreach (const GcnSearchData &searchData, matches) {
+		const QString gameID =
+			QString::fromLatin1(searchData.dirEntry.gamecode, sizeof(searchData.dirEntry.gamecode)) +
+			QString::fromLatin1(searchData.dirEntry.company, sizeof(searchData.dirEntry.company));
+		if (!ignore.contains(gameID)) {
+			ret.append(gameID);
+		}
+	}
+	ret.sort();
+	return ret;
+}
+
+bool GcnMcFileDbTest::simpleLiteral(const QString &pattern, QByteArray &literal)
+{
+	if (pattern.size() < 3 ||
+	    !pattern.startsWith(QLatin1Char('^')) ||
+	    !pattern.endsWith(QLatin1Char('$')))
+	{
+		return false;
+	}
+
+	static const char metachars[] = "\\^$.|?*+()[]{}";
+	literal.clear();
+	for (int i = 1; i < pattern.size() - 1; i++) {
+		const ushort chr = pattern.at(i).unicode();
+		if (chr < 0x20 || chr > 0x7E || strchr(metachars, chr) != nullptr)
+			return false;
+		literal.append((char)chr);
+	}
+	return (literal.size() <= 32);
+}
+
+void GcnMcFileDbTest::checkEquivalence(const QString &filename, const QVector<TestComment> &comments)
+{
+	GcnMcFileDb db;
+	QCOMPARE(db.load(filename), 0);
+
+	QVector<RefDef> defs;
+	QVERIFY(parseDefs(filename, defs));
+	QVERIFY(!defs.isEmpty());
+
+	// Variable modifiers may reject a match, which the reference doesn't handle.
+	QSet<QString> ignore;
+	foreach (const RefDef &def, defs) {
+		if (def.hasVariables) {
+			ignore.insert(def.gameID);
+		}
+	}
+
+	GcnMcFileMatchContext ctx;
+	vector<uint8_t> block(BLOCK_SIZE);
+	int matched = 0;
+	foreach (const TestComment &comment, comments) {
+		memset(block.data(), 0, block.size());
+		setComment(block.data(), comment.address, comment.gameDesc, comment.fileDesc);
+
+		const QStringList expected = refMatches(defs, block.data(), ignore);
+		const QStringList actual = dbMatches(db, &ctx, block.data(), ignore);
+		if (actual != expected) {
+			qWarning("Address 0x%04X: gameDesc '%s', fileDesc '%s'", comment.address,
+				comment.gameDesc.constData(), comment.fileDesc.constData());
+		}
+		QCOMPARE(actual, expected);
+		if (!expected.isEmpty()) {
+			matched++;
+		}
+	}
+
+	// Make sure the comments actually matched something.
+	QVERIFY(matched > 0);
+}
+
+void GcnMcFileDbTest::initTestCase(void)
+{
+	QVERIFY(tmpDir.isValid());
+}
+
+/**
+ * Synthetic database that covers each matching path:
+ * - Prefiltered exact literals and prefixes.
+ * - Unanchored regexes, alternation, and inline options. (combined)
+ * - An invalid regex.
+ * - A backreference, which disables combining for its address.
+ */
+void GcnMcFileDbTest::synthetic(void)
+{
+	static const char *const fileDefs[][4] = {
+		// id6, address, gameDesc, fileDesc
+		{"GS1E01", "0x0000", "^Alpha Game$",		"^Save Data$"},
+		{"GS2E01", "0x0000", "^Alpha",			".*"},
+		{"GS3E01", "0x0000", "Game$",			"^Save"},
+		{"GS4E01", "0x0000", "^(Alpha|Beta) Game$",	"^Save Data$"},
+		{"GS5E01", "0x0000", "^Beta.*Game$",		".*"},
+		{"GS6E01", "0x0000", "^(?i)gamma game$",	".*"},
+		{"GS7E01", "0x0000", "^\\s*Delta$",		".*"},
+		{"GS8E01", "0x0000", "^Epsilon (\\d+)$",	"^Slot (\\d)$"},
+		{"GS9E01", "0x0000", "(unclosed",		".*"},
+		{"GB1E01", "0x0100", "(\\w+) \\1",		".*"},
+		{"GB2E01", "0x0100", "Zeta",			".*"},
+		{"GB3E01", "0x0100", "^Zeta Zeta$",		"^$"},
+	};
+
+	QByteArray xml =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<GcnMcFileDb>\n"
+		"\t<dbInfo>\n"
+		"\t\t<dbFormatVersion>0.2</dbFormatVersion>\n"
+		"\t\t<dbName>Test</dbName>\n"
+		"\t</dbInfo>\n";
+	for (const auto &fileDef : fileDefs) {
+		xml += "\t<file>\n"
+			"\t\t<gameName>Test</gameName>\n"
+			"\t\t<id6>"; xml += fileDef[0]; xml += "</id6>\n"
+			"\t\t<search>\n"
+			"\t\t\t<address>"; xml += fileDef[1]; xml += "</address>\n"
+			"\t\t\t<gameDesc>"; xml += fileDef[2]; xml += "</gameDesc>\n"
+			"\t\t\t<fileDesc>"; xml += fileDef[3]; xml += "</fileDesc>\n"
+			"\t\t</search>\n"
+			"\t\t<dirEntry>\n"
+			"\t\t\t<filename>test</filename>\n"
+			"\t\t\t<length>1</length>\n"
+			"\t\t</dirEntry>\n"
+			"\t</file>\n";
+	}
+	xml += "</GcnMcFileDb>\n";
+
+	const QString filename = tmpDir.path() + QLatin1String("/synthetic.xml");
+	QFile file(filename);
+	QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+	QCOMPARE(file.write(xml), (qint64)xml.size());
+	file.close();
+
+	static const char *const comments[][2] = {
+		{"Alpha Game",		"Save Data"},
+		{"Alpha Game ",		"Save Data"},
+		{"  Alpha Game",	"Save Data "},
+		{"Alpha Games",		"Save Data"},
+		{"Alpha",		""},
+		{"Alph",		"Save"},
+		{"Beta Game",		"Save Data"},
+		{"Beta Big Game",	"Save File"},
+		{"GAMMA GAME",		"x"},
+		{"gamma game!",		"x"},
+		{"   Delta",		"y"},
+		{"Delta ",		"y"},
+		{"Epsilon 42",		"Slot 3"},
+		{"Epsilon x",		"Slot 3"},
+		{"Epsilon 7",		"Slot 10"},
+		{"My Game",		"Save File"},
+		{"Zeta Zeta",		""},
+		{"Zeta Eta",		""},
+		{"Zeta",		"Zeta"},
+		{"(unclosed",		""},
+		{"",			""},
+		{"\tAlpha Game\t",	"\tSave Data"},
+		{"Alpha Game Alpha Game Alpha Game!", "Save Data"},
+	};
+	QVector<TestComment> commentList;
+	for (const auto &comment : comments) {
+		TestComment testComment;
+		testComment.gameDesc = comment[0];
+		testComment.fileDesc = comment[1];
+		testComment.address = 0x0000;
+		commentList.append(testComment);
+		testComment.address = 0x0100;
+		commentList.append(testComment);
+	}
+
+	checkEquivalence(filename, commentList);
+}
+
+void GcnMcFileDbTest::realDatabases_data(void)
+{
+	QTest::addColumn<QString>("filename");
+
+	const QDir dataDir(QLatin1String(MCRECOVER_TEST_DATA_DIR));
+	const QStringList filenames = dataDir.entryList(
+		QStringList(QLatin1String("GcnMcFileDb.*.xml")), QDir::Files, QDir::Name);
+	foreach (const QString &filename, filenames) {
+		QTest::newRow(filename.toLatin1().constData()) << dataDir.filePath(filename);
+	}
+}
+
+/**
+ * The shipped databases. Comments are generated from each
+ * definition's literal regexes, plus variants that shouldn't
+ * match: a different last character, extra characters,
+ * and extra whitespace, which is trimmed.
+ */
+void GcnMcFileDbTest::realDatabases(void)
+{
+	QFETCH(QString, filename);
+
+	QVector<RefDef> defs;
+	QVERIFY(parseDefs(filename, defs));
+
+	QVector<TestComment> comments;
+	foreach (const RefDef &def, defs) {
+		QByteArray gameDesc, fileDesc;
+		if (!simpleLiteral(def.gameDesc.pattern(), gameDesc) || gameDesc.isEmpty())
+			continue;
+		if (!simpleLiteral(def.fileDesc.pattern(), fileDesc)) {
+			// Most file descriptions that aren't literals
+			// match anything, e.g. "^(.*)$".
+			fileDesc = "Save Data";
+		}
+
+		QByteArray changed = gameDesc;
+		changed[changed.size() - 1] = (changed.at(changed.size() - 1) == 'X' ? 'Y' : 'X');
+
+		const TestComment variants[] = {
+			{def.address, gameDesc, fileDesc},
+			{def.address, changed, fileDesc},
+			{def.address, gameDesc + '!', fileDesc},
+			{def.address, QByteArray("  ") + gameDesc, fileDesc},
+			{def.address, gameDesc, fileDesc + '!'},
+		};
+		for (const TestComment &variant : variants) {
+			comments.append(variant);
+		}
+	}
+	if (comments.isEmpty()) {
+		QSKIP("No literal game descriptions in this database.");
+	}
+
+	checkEquivalence(filename, comments);
+}
+
+QTEST_GUILESS_MAIN(GcnMcFileDbTest)
+
+#include "GcnMcFileDbTest.moc"
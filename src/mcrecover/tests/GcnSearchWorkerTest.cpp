@@ -0,0 +1,354 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program: Unit tests.                      *
+ * GcnSearchWorkerTest.cpp: Memory Card search and checkpoint tests.       *
+ *                                                                         *
+ * Copyright (c) 2013-2025 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "db/GcnSearchWorker.hpp"
+#include "db/GcnMcFileDb.hpp"
+#include "libmemcard/GcnCard.hpp"
+
+#include "GcnCardBuilder.hpp"
+
+// C includes (C++ namespace)
+#include <cerrno>
+#include <cstring>
+
+// C++ includes
+#include <vector>
+using std::vector;
+
+// Qt includes
+#include <QtCore/QFile>
+#include <QtCore/QObject>
+#include <QtCore/QScopedPointer>
+#include <QtCore/QStringList>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+
+class GcnSearchWorkerTest : public QObject
+{
+	Q_OBJECT
+
+	private:
+		QTemporaryDir tmpDir;
+		QString cardFilename;
+		QString checkpointFilename;
+		QScopedPointer<GcnCardBuilder> builder;
+
+		// Databases.
+		// otherDb has an extra file definition.
+		// altDb has a less specific file definition that
+		// matches the same blocks as the other definitions.
+		GcnMcFileDb db;
+		GcnMcFileDb otherDb;
+		GcnMcFileDb altDb;
+
+		/**
+		 * Write a test database.
+		 * @param filename Database filename
+		 * @param defs Indexes of the file definitions to write
+		 * @return True on success; false on error.
+		 */
+		static bool writeDb(const QString &filename, const QVector<int> &defs);
+
+		/**
+		 * Write a lost file's comment to a block.
+		 * @param blockIdx Block index
+		 * @param gameDesc Game description
+		 */
+		void setLostFile(uint16_t blockIdx, const char *gameDesc)
+		{
+			uint8_t *const data = builder->block(blockIdx);
+			memset(data, 0, 0x40);
+			strncpy(reinterpret_cast<char*>(data), gameDesc, 32);
+			strncpy(reinterpret_cast<char*>(&data[0x20]), "Save Data", 32);
+		}
+
+		/**
+		 * Search the Memory Card image using checkpoints.
+		 * @param searchDb Database
+		 * @param cancelAt Cancel the search after scanning this block, or -1 to not cancel.
+		 * @param updates [out] Blocks reported by searchUpdate()
+		 * @param files [out] Files found, as "ID6@block", sorted
+		 * @param alternatives [out, opt] Alternatives, as "ID6@block", sorted
+		 * @return searchMemCard() return value, or -EIO if the card couldn't be opened.
+		 */
+		int search(GcnMcFileDb *searchDb, int cancelAt, QVector<int> *updates, QStringList *files,
+			QStringList *alternatives = nullptr);
+
+		/**
+		 * Format a file as "ID6@block".
+		 * @param searchData Search data
+		 * @return "ID6@block"
+		 */
+		static QString formatFile(const GcnSearchData &searchData)
+		{
+			return QString::fromLatin1("%1%2@%3")
+				.arg(QString::fromLatin1(searchData.dirEntry.gamecode, sizeof(searchData.dirEntry.gamecode)))
+				.arg(QString::fromLatin1(searchData.dirEntry.company, sizeof(searchData.dirEntry.company)))
+				.arg(searchData.dirEntry.block);
+		}
+
+		/**
+		 * Files expected on the unmodified Memory Card image.
+		 * @return Files, as "ID6@block", sorted
+		 */
+		static QStringList expectedFiles(void)
+		{
+			return QStringList()
+				<< QLatin1String("GSAE01@250")
+				<< QLatin1String("GSBE01@20");
+		}
+
+	private slots:
+		void initTestCase(void);
+		void init(void);
+
+		void fullSearch(void);
+		void resume(void);
+		void staleCard(void);
+		void differentDatabases(void);
+		void truncatedCheckpoint(void);
+		void alternatives(void);
+};
+
+bool GcnSearchWorkerTest::writeDb(const QString &filename, const QVector<int> &defs)
+{
+	static const char *const gameDescs[] = {
+		// id6, gameDesc
+		"GSAE01", "^Search Test A$",
+		"GSBE01", "^Search Test B$",
+		"GSCE01", "^Search Test C$",
+		"GSDE01", "^Search Test .$",
+	};
+
+	QByteArray xml =
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<GcnMcFileDb>\n"
+		"\t<dbInfo>\n"
+		"\t\t<dbFormatVersion>0.2</dbFormatVersion>\n"
+		"\t\t<dbName>Test</dbName>\n"
+		"\t</dbInfo>\n";
+	for (int i : defs) {
+		xml += "\t<file>\n"
+			"\t\t<gameName>Test</gameName>\n"
+			"\t\t<id6>"; xml += gameDescs[i*2]; xml += "</id6>\n"
+			"\t\t<search>\n"
+			"\t\t\t<address>0x0000</address>\n"
+			"\t\t\t<gameDesc>"; xml += gameDescs[i*2+1]; xml += "</gameDesc>\n"
+			"\t\t\t<fileDesc>^Save Data$</fileDesc>\n"
+			"\t\t</search>\n"
+			"\t\t<dirEntry>\n"
+			"\t\t\t<filename>test</filename>\n"
+			"\t\t\t<length>1</length>\n"
+			"\t\t</dirEntry>\n"
+			"\t</file>\n";
+	}
+	xml += "</GcnMcFileDb>\n";
+
+	QFile file(filename);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	return (file.write(xml) == (qint64)xml.size());
+}
+
+int GcnSearchWorkerTest::search(GcnMcFileDb *searchDb, int cancelAt,
+	QVector<int> *updates, QStringList *files, QStringList *alternatives)
+{
+	updates->clear();
+	files->clear();
+	if (alternatives) {
+		alternatives->clear();
+	}
+
+	QScopedPointer<GcnCard> card(GcnCard::open(cardFilename, nullptr));
+	if (!card || !card->isOpen())
+		return -EIO;
+
+	GcnSearchWorker worker;
+	worker.setCard(card.data());
+	worker.setDatabases(QVector<GcnMcFileDb*>() << searchDb);
+	worker.setCheckpointFilename(checkpointFilename);
+
+	// cancel() is checked before the next block is scanned.
+	connect(&worker, &GcnSearchWorker::searchUpdate,
+		[&worker, updates, cancelAt](int currentPhysBlock, int, int) {
+			updates->append(currentPhysBlock);
+			if (currentPhysBlock == cancelAt) {
+				worker.cancel();
+			}
+		});
+
+	const int ret = worker.searchMemCard();
+	for (const GcnSearchData &searchData : worker.filesFoundList()) {
+		files->append(formatFile(searchData));
+	}
+	files->sort();
+	if (alternatives) {
+		for (const GcnSearchData &searchData : worker.alternativesList()) {
+			alternatives->append(formatFile(searchData));
+		}
+		alternatives->sort();
+	}
+	return ret;
+}
+
+void GcnSearchWorkerTest::initTestCase(void)
+{
+	QVERIFY(tmpDir.isValid());
+	cardFilename = tmpDir.path() + QLatin1String("/card.raw");
+	checkpointFilename = tmpDir.path() + QLatin1String("/card.checkpoint");
+
+	const QString dbFilename = tmpDir.path() + QLatin1String("/db.xml");
+	const QString otherDbFilename = tmpDir.path() + QLatin1String("/otherDb.xml");
+	const QString altDbFilename = tmpDir.path() + QLatin1String("/altDb.xml");
+	QVERIFY(writeDb(dbFilename, QVector<int>() << 0 << 1));
+	QVERIFY(writeDb(otherDbFilename, QVector<int>() << 0 << 1 << 2));
+	QVERIFY(writeDb(altDbFilename, QVector<int>() << 0 << 1 << 3));
+	QCOMPARE(db.load(dbFilename), 0);
+	QCOMPARE(otherDb.load(otherDbFilename), 0);
+	QCOMPARE(altDb.load(altDbFilename), 0);
+	QVERIFY(db.hash() != otherDb.hash());
+}
+
+/**
+ * Create the Memory Card image.
+ * Blocks 5-9 are used by a file. Lost files
+ * are in blocks 250 and 20, which are free.
+ */
+void GcnSearchWorkerTest::init(void)
+{
+	builder.reset(new GcnCardBuilder());
+	vector<uint16_t> fatEntries;
+	for (uint16_t i = 5; i < 10; i++) {
+		builder->fillBlock(i, (uint8_t)i);
+		fatEntries.push_back(i);
+	}
+	builder->addFile("GALE", "01", "used", fatEntries);
+
+	setLostFile(250, "Search Test A");
+	setLostFile(20, "Search Test B");
+	QVERIFY(builder->save(cardFilename));
+
+	QFile::remove(checkpointFilename);
+}
+
+/**
+ * A search without an existing checkpoint scans all free blocks,
+ * and the checkpoint is removed once the search is complete.
+ */
+void GcnSearchWorkerTest::fullSearch(void)
+{
+	QVector<int> updates;
+	QStringList files;
+	QCOMPARE(search(&db, -1, &updates, &files), 2);
+	QCOMPARE(files, expectedFiles());
+	QVERIFY(updates.contains(250));
+	QVERIFY(updates.contains(20));
+	QVERIFY(!updates.contains(9));
+	QVERIFY(!QFile::exists(checkpointFilename));
+}
+
+/**
+ * A cancelled search saves a checkpoint. Resuming skips the
+ * blocks that were already scanned, and keeps their files.
+ */
+void GcnSearchWorkerTest::resume(void)
+{
+	QVector<int> updates;
+	QStringList files;
+	QCOMPARE(search(&db, 240, &updates, &files), -ECANCELED);
+	QVERIFY(updates.contains(250));
+	QVERIFY(!updates.contains(239));
+	QVERIFY(QFile::exists(checkpointFilename));
+
+	QCOMPARE(search(&db, -1, &updates, &files), 2);
+	QCOMPARE(files, expectedFiles());
+	QVERIFY(!updates.contains(250));
+	QVERIFY(!updates.contains(240));
+	QVERIFY(updates.contains(239));
+	QVERIFY(updates.contains(20));
+	QVERIFY(!QFile::exists(checkpointFilename));
+}
+
+/**
+ * If a scanned block changed, the checkpoint is ignored.
+ */
+void GcnSearchWorkerTest::staleCard(void)
+{
+	QVector<int> updates;
+	QStringList files;
+	QCOMPARE(search(&db, 240, &updates, &files), -ECANCELED);
+	QVERIFY(QFile::exists(checkpointFilename));
+
+	// Remove the lost file in block 250.
+	memset(builder->block(250), 0, GcnCardBuilder::BLOCK_SIZE);
+	QVERIFY(builder->save(cardFilename));
+
+	QCOMPARE(search(&db, -1, &updates, &files), 1);
+	QCOMPARE(files, QStringList(QLatin1String("GSBE01@20")));
+	QVERIFY(updates.contains(250));
+	QVERIFY(!QFile::exists(checkpointFilename));
+}
+
+/**
+ * If the databases changed, the checkpoint is ignored.
+ */
+void GcnSearchWorkerTest::differentDatabases(void)
+{
+	QVector<int> updates;
+	QStringList files;
+	QCOMPARE(search(&db, 240, &updates, &files), -ECANCELED);
+	QVERIFY(QFile::exists(checkpointFilename));
+
+	QCOMPARE(search(&otherDb, -1, &updates, &files), 2);
+	QCOMPARE(files, expectedFiles());
+	QVERIFY(updates.contains(250));
+	QVERIFY(!QFile::exists(checkpointFilename));
+}
+
+/**
+ * If the checkpoint is truncated, it's ignored.
+ */
+void GcnSearchWorkerTest::truncatedCheckpoint(void)
+{
+	QVector<int> updates;
+	QStringList files;
+	QCOMPARE(search(&db, 240, &updates, &files), -ECANCELED);
+
+	QFile checkpoint(checkpointFilename);
+	QVERIFY(checkpoint.exists());
+	QVERIFY(checkpoint.resize(checkpoint.size() / 2));
+
+	QCOMPARE(search(&db, -1, &updates, &files), 2);
+	QCOMPARE(files, expectedFiles());
+	QVERIFY(updates.contains(250));
+	QVERIFY(!QFile::exists(checkpointFilename));
+}
+
+/**
+ * If a block matches more than one file definition, the most
+ * specific match is used, and the rest are alternatives.
+ */
+void GcnSearchWorkerTest::alternatives(void)
+{
+	QVector<int> updates;
+	QStringList files, alternatives;
+	QCOMPARE(search(&altDb, -1, &updates, &files, &alternatives), 2);
+	QCOMPARE(files, expectedFiles());
+	QCOMPARE(alternatives, QStringList()
+		<< QLatin1String("GSDE01@20")
+		<< QLatin1String("GSDE01@250"));
+
+	// Without other matches, there are no alternatives.
+	QCOMPARE(search(&db, -1, &updates, &files, &alternatives), 2);
+	QCOMPARE(files, expectedFiles());
+	QVERIFY(alternatives.isEmpty());
+}
+
+QTEST_MAIN(GcnSearchWorkerTest)
+
+#include "GcnSearchWorkerTest.moc"
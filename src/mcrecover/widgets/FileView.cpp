@@ -11,7 +11,8 @@
 #include "libmemcard/File.hpp"
 #include "libmemcard/GcnFile.hpp" /* FIXME: Remove later */
 #include "libmemcard/VmuFile.hpp" /* FIXME: Remove later */
-#include "IconAnimHelper.hpp"
+#include "libmemcard/IconAnimClock.hpp"
+#include "libmemcard/IconAnimSchedule.hpp"
 
 // XML template dialog.
 #include "../windows/XmlTemplateDialog.hpp"
@@ -21,9 +22,6 @@
 #include "libsaveedit/EditorWindow.hpp"
 #include "libsaveedit/EditorWidgetFactory.hpp"
 
-// Qt includes.
-#include <QtCore/QTimer>
-
 /** FileViewPrivate **/
 
 #include "ui_FileView.h"
@@ -45,11 +43,11 @@ public:
 
 	const File *file;
 
-	// Icon animation helper
-	IconAnimHelper helper;
+	// Icon animation schedule
+	IconAnimSchedule schedule;
+	// Current icon index
+	int iconIdx;
 
-	// Animation timer
-	QTimer *animTimer;
 	// Pause count. If >0, animation is paused.
 	int pauseCounter;
 
@@ -60,7 +58,7 @@ public:
 
 	/**
 	 * Update the animation timer state.
-	 * Starts the timer if animated icons are present; stops the timer if not.
+	 * Registers with IconAnimClock if the icon is animated; unregisters if not.
 	 */
 	void updateAnimTimerState(void);
 
@@ -73,17 +71,18 @@ public:
 FileViewPrivate::FileViewPrivate(FileView *q)
 	: q_ptr(q)
 	, file(nullptr)
-	, animTimer(new QTimer(q))
+	, iconIdx(0)
 	, pauseCounter(0)
 	, xmlTemplateDialogManager(new XmlTemplateDialogManager(q))
 {
-	// Connect animTimer's timeout() signal.
-	QObject::connect(animTimer, &QTimer::timeout,
+	// Connect the animation clock's ticked() signal.
+	QObject::connect(IconAnimClock::instance(), &IconAnimClock::ticked,
 		q, &FileView::animTimer_slot);
 }
 
 FileViewPrivate::~FileViewPrivate()
 {
+	IconAnimClock::instance()->removeClient(q_ptr);
 	delete xmlTemplateDialogManager;
 }
 
@@ -96,6 +95,8 @@ void FileViewPrivate::updateWidgetDisplay(void)
 
 	if (!file) {
 		// Clear the widget display.
+		schedule.clear();
+		updateAnimTimerState();
 		ui.lblFileIcon->clear();
 		ui.lblFileBanner->clear();
 		ui.btnXML->setVisible(false);
@@ -114,17 +115,18 @@ void FileViewPrivate::updateWidgetDisplay(void)
 
 	// Set the widget display.
 
+	// Icon animation.
+	schedule.setFile(file);
+	iconIdx = schedule.iconAt(IconAnimClock::instance()->tick());
+	updateAnimTimerState();
+
 	// File icon.
-	QPixmap icon = file->icon(0);
+	QPixmap icon = file->icon(iconIdx);
 	if (!icon.isNull())
 		ui.lblFileIcon->setPixmap(icon);
 	else
 		ui.lblFileIcon->clear();
 
-	// Icon animation.
-	helper.setFile(file);
-	updateAnimTimerState();
-
 	// File banner.
 	QPixmap banner = file->banner();
 	if (!banner.isNull()) {
@@ -214,20 +216,17 @@ void FileViewPrivate::updateWidgetDisplay(void)
 
 /**
  * Update the animation timer state.
- * Starts the timer if animated icons are present; stops the timer if not.
+ * Registers with IconAnimClock if the icon is animated; unregisters if not.
  */
 void FileViewPrivate::updateAnimTimerState(void)
 {
-	if (pauseCounter <= 0 && file != nullptr && helper.isAnimated()) {
+	Q_Q(FileView);
+	if (pauseCounter <= 0 && file != nullptr && schedule.isAnimated()) {
 		// Animation is not paused, and we have an animated icon.
-		// Start the timer.
-		// FIXME: Support PAL; handle extra beginning frame and reduced ending frame.
-		// FIXME: Dreamcast animation timing?
-		animTimer->start(67 /*4*1000/60*/);
+		IconAnimClock::instance()->addClient(q);
 	} else {
 		// Either animation is paused, or we don't have an animated icon.
-		// Stop the timer.
-		animTimer->stop();
+		IconAnimClock::instance()->removeClient(q);
 	}
 }
 
@@ -369,22 +368,22 @@ void FileView::file_destroyed_slot(QObject *obj)
 
 /**
  * Animation timer slot.
+ * @param tick Animation tick
  */
-void FileView::animTimer_slot(void)
+void FileView::animTimer_slot(quint32 tick)
 {
 	Q_D(FileView);
-	if (!d->file || !d->helper.isAnimated() || d->pauseCounter > 0) {
+	if (!d->file || !d->schedule.isAnimated() || d->pauseCounter > 0) {
 		// No file is loaded, or the file doesn't have an animated icon.
-		// Stop the animation timer.
-		d->animTimer->stop();
 		return;
 	}
 
 	// Check if the animated icon should be updated.
-	bool iconUpdated = d->helper.tick();
-	if (iconUpdated) {
+	const int iconIdx = d->schedule.iconAt(tick);
+	if (iconIdx != d->iconIdx) {
 		// Icon has been updated.
-		d->ui.lblFileIcon->setPixmap(d->helper.icon());
+		d->iconIdx = iconIdx;
+		d->ui.lblFileIcon->setPixmap(d->file->icon(iconIdx));
 	}
 }
 
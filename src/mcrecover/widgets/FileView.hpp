@@ -75,8 +75,9 @@ protected slots:
 
 	/**
 	 * Animation timer slot.
+	 * @param tick Animation tick
 	 */
-	void animTimer_slot(void);
+	void animTimer_slot(quint32 tick);
 
 	/**
 	 * XML button was pressed.
@@ -13,9 +13,13 @@
 #include <QHeaderView>
 #include <QMenu>
 #include <QAction>
+#include <QtCore/QTimer>
 
 QTreeViewOpt::QTreeViewOpt(QWidget *parent)
 	: super(parent)
+	, m_visFirst(-1)
+	, m_visLast(-1)
+	, m_visCheckPending(false)
 {
 	// Connect the signal for hiding/showing columns.
 	this->header()->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -55,6 +59,116 @@ void QTreeViewOpt::dataChanged(const QModelIndex &topLeft,
 	}
 }
 
+/**
+ * Lay out the items.
+ * Called after the model is reset, sorted, or filtered.
+ */
+void QTreeViewOpt::doItemsLayout(void)
+{
+	super::doItemsLayout();
+	invalidateVisibleRows();
+}
+
+/**
+ * The viewport has been scrolled.
+ * @param dx Horizontal distance
+ * @param dy Vertical distance
+ */
+void QTreeViewOpt::scrollContentsBy(int dx, int dy)
+{
+	super::scrollContentsBy(dx, dy);
+	if (dy != 0) {
+		scheduleVisibleRowsCheck();
+	}
+}
+
+/**
+ * The widget has been resized.
+ * @param event Resize event
+ */
+void QTreeViewOpt::resizeEvent(QResizeEvent *event)
+{
+	super::resizeEvent(event);
+	scheduleVisibleRowsCheck();
+}
+
+/**
+ * Rows have been inserted into the model.
+ * @param parent Parent index
+ * @param start First row
+ * @param end Last row
+ */
+void QTreeViewOpt::rowsInserted(const QModelIndex &parent, int start, int end)
+{
+	super::rowsInserted(parent, start, end);
+	invalidateVisibleRows();
+}
+
+/**
+ * Rows are about to be removed from the model.
+ * @param parent Parent index
+ * @param start First row
+ * @param end Last row
+ */
+void QTreeViewOpt::rowsAboutToBeRemoved(const QModelIndex &parent, int start, int end)
+{
+	super::rowsAboutToBeRemoved(parent, start, end);
+	// NOTE: The check is queued, so it runs after the rows are removed.
+	invalidateVisibleRows();
+}
+
+/**
+ * Invalidate the visible row range.
+ * The model's rows may have been moved, so
+ * visibleRowsChanged() will be emitted even if
+ * the range itself hasn't changed.
+ */
+void QTreeViewOpt::invalidateVisibleRows(void)
+{
+	m_visFirst = -2;
+	m_visLast = -2;
+	scheduleVisibleRowsCheck();
+}
+
+/**
+ * Schedule a visible row check.
+ * Multiple requests are coalesced into a single check.
+ */
+void QTreeViewOpt::scheduleVisibleRowsCheck(void)
+{
+	if (m_visCheckPending)
+		return;
+	m_visCheckPending = true;
+	QTimer::singleShot(0, this, &QTreeViewOpt::checkVisibleRows);
+}
+
+/**
+ * Check which rows are visible in the viewport.
+ * If the range has changed, visibleRowsChanged() is emitted.
+ */
+void QTreeViewOpt::checkVisibleRows(void)
+{
+	m_visCheckPending = false;
+
+	int first = -1, last = -1;
+	const QAbstractItemModel *const model = this->model();
+	if (model && model->rowCount() > 0) {
+		const QRect viewportRect(QPoint(0, 0), this->viewport()->size());
+		const QModelIndex topIdx = indexAt(viewportRect.topLeft());
+		if (topIdx.isValid()) {
+			first = topIdx.row();
+			const QModelIndex bottomIdx = indexAt(QPoint(0, viewportRect.bottom()));
+			last = (bottomIdx.isValid() ? bottomIdx.row() : (model->rowCount() - 1));
+		}
+	}
+
+	if (first != m_visFirst || last != m_visLast) {
+		m_visFirst = first;
+		m_visLast = last;
+		emit visibleRowsChanged(first, last);
+	}
+}
+
 /**
  * Show the column context menu.
  * Based on KSysGuard's KSysGuardProcessList::showColumnContextMenu().
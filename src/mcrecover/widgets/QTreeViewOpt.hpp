@@ -13,6 +13,7 @@
 #include <QTreeView>
 class QKeyEvent;
 class QFocusEvent;
+class QResizeEvent;
 
 class QTreeViewOpt : public QTreeView
 {
@@ -30,9 +31,54 @@ public:
 		const QModelIndex &bottomRight,
 		const QVector<int> &roles = QVector<int>()) final;
 
+	void doItemsLayout(void) final;
+
+protected:
+	void scrollContentsBy(int dx, int dy) final;
+	void resizeEvent(QResizeEvent *event) final;
+
 protected slots:
+	void rowsInserted(const QModelIndex &parent, int start, int end) final;
+	void rowsAboutToBeRemoved(const QModelIndex &parent, int start, int end) final;
+
 	void showColumnContextMenu(const QPoint &point);
 
+	/**
+	 * Check which rows are visible in the viewport.
+	 * If the range has changed, visibleRowsChanged() is emitted.
+	 */
+	void checkVisibleRows(void);
+
+signals:
+	/**
+	 * The range of rows visible in the viewport has changed.
+	 * Row numbers refer to top-level rows in this view's model.
+	 * @param first First visible row, or -1 if no rows are visible.
+	 * @param last Last visible row, or -1 if no rows are visible.
+	 */
+	void visibleRowsChanged(int first, int last);
+
+private:
+	/**
+	 * Invalidate the visible row range.
+	 * The model's rows may have been moved, so
+	 * visibleRowsChanged() will be emitted even if
+	 * the range itself hasn't changed.
+	 */
+	void invalidateVisibleRows(void);
+
+	/**
+	 * Schedule a visible row check.
+	 * Multiple requests are coalesced into a single check.
+	 */
+	void scheduleVisibleRowsCheck(void);
+
+	// Last visible row range.
+	int m_visFirst;
+	int m_visLast;
+	// Is a visible row check pending?
+	bool m_visCheckPending;
+
 	/** Shh... it's a secret to everybody. **/
 protected:
 	void keyPressEvent(QKeyEvent *event) final;
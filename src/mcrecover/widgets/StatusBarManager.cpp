@@ -18,6 +18,7 @@
 #include <QLabel>
 #include <QStatusBar>
 #include <QProgressBar>
+#include <QToolButton>
 
 // taskbarButtonManager.
 #include "TaskbarButtonManager/TaskbarButtonManager.hpp"
@@ -40,6 +41,7 @@ public:
 	QStatusBar *statusBar;		// Status bar
 	QLabel *lblMessage;		// Message label
 	QProgressBar *progressBar;	// Progress bar
+	QToolButton *btnCancel;		// Cancel button (exporting only)
 
 	// Search thread
 	// NOTE: We don't own this!
@@ -63,6 +65,13 @@ public:
 	int totalSearchBlocks;
 	int lostFilesFound;
 
+	// Are we currently saving files?
+	bool exporting;
+
+	// Export status from the last FileExporter update.
+	int filesExported;
+	int filesToExport;
+
 	// Number of seconds to wait before hiding the
 	// progress bar after the search has completed.
 	static constexpr int SECONDS_TO_HIDE_PROGRESS_BAR = 5;
@@ -79,6 +88,7 @@ StatusBarManagerPrivate::StatusBarManagerPrivate(StatusBarManager *q)
 	, statusBar(nullptr)
 	, lblMessage(nullptr)
 	, progressBar(nullptr)
+	, btnCancel(nullptr)
 	, searchThread(nullptr)
 	, scanning(false)
 	, currentPhysBlock(0)
@@ -86,6 +96,9 @@ StatusBarManagerPrivate::StatusBarManagerPrivate(StatusBarManager *q)
 	, currentSearchBlock(0)
 	, totalSearchBlocks(0)
 	, lostFilesFound(0)
+	, exporting(false)
+	, filesExported(0)
+	, filesToExport(0)
 	, taskbarButtonManager(nullptr)
 {
 	// Default message.
@@ -101,6 +114,7 @@ StatusBarManagerPrivate::StatusBarManagerPrivate(StatusBarManager *q)
 StatusBarManagerPrivate::~StatusBarManagerPrivate()
 {
 	delete lblMessage;
+	delete btnCancel;
 	delete progressBar;
 	delete statusBar;
 }
@@ -121,6 +135,11 @@ void StatusBarManagerPrivate::updateStatusBar(void)
 		QString filesFoundText = StatusBarManager::tr("%n lost file(s) found.", nullptr, lostFilesFound);
 		q->lblFilesFound->setText(filesFoundText);
 		*/
+	} else if (exporting) {
+		// We're saving files.
+		lastStatusMessage = StatusBarManager::tr("Saving files (%L1 of %L2)...")
+					.arg(filesExported)
+					.arg(filesToExport);
 	}
 
 	// Set the status bar message.
@@ -136,18 +155,24 @@ void StatusBarManagerPrivate::updateStatusBar(void)
 		lblMessage->resize(w, lblMessage->height());
 	}
 
-	// Make sure the progress bar is visible when scanning.
-	if (scanning && progressBar)
+	// Make sure the progress bar is visible when scanning or saving.
+	if ((scanning || exporting) && progressBar)
 		progressBar->setVisible(true);
 
+	// Saving can be cancelled.
+	if (btnCancel)
+		btnCancel->setVisible(exporting);
+
 	// Set the progress bar values.
 	if (progressBar && progressBar->isVisible()) {
-		progressBar->setMaximum(totalSearchBlocks);
-		progressBar->setValue(currentSearchBlock);
+		const int value = (exporting ? filesExported : currentSearchBlock);
+		const int max = (exporting ? filesToExport : totalSearchBlocks);
+		progressBar->setMaximum(max);
+		progressBar->setValue(value);
 		if (taskbarButtonManager) {
 			// TODO: Set max only in initialization?
-			taskbarButtonManager->setProgressBarValue(currentSearchBlock);
-			taskbarButtonManager->setProgressBarMax(totalSearchBlocks);
+			taskbarButtonManager->setProgressBarValue(value);
+			taskbarButtonManager->setProgressBarMax(max);
 		}
 	} else {
 		if (taskbarButtonManager) {
@@ -209,8 +234,12 @@ void StatusBarManager::setStatusBar(QStatusBar *statusBar)
 			   this, &StatusBarManager::object_destroyed_slot);
 		disconnect(d->progressBar, &QObject::destroyed,
 			   this, &StatusBarManager::object_destroyed_slot);
+		disconnect(d->btnCancel, &QObject::destroyed,
+			   this, &StatusBarManager::object_destroyed_slot);
 
-		// Delete the progress bar.
+		// Delete the progress bar and cancel button.
+		delete d->btnCancel;
+		d->btnCancel = nullptr;
 		delete d->progressBar;
 		d->progressBar = nullptr;
 	}
@@ -240,6 +269,16 @@ void StatusBarManager::setStatusBar(QStatusBar *statusBar)
 		d->progressBar->setMinimumWidth(320);
 		d->progressBar->setMaximumWidth(320);
 
+		// Create a new cancel button.
+		d->btnCancel = new QToolButton();
+		d->btnCancel->setText(tr("Cancel"));
+		d->btnCancel->setVisible(false);
+		connect(d->btnCancel, &QObject::destroyed,
+			this, &StatusBarManager::object_destroyed_slot);
+		connect(d->btnCancel, &QToolButton::clicked,
+			this, &StatusBarManager::cancelRequested);
+		d->statusBar->addPermanentWidget(d->btnCancel);
+
 		// Update the status bar.
 		d->updateStatusBar();
 	}
@@ -400,6 +439,7 @@ void StatusBarManager::filesSaved(int n, const QString &path)
 {
 	Q_D(StatusBarManager);
 	d->scanning = false;
+	d->exporting = false;
 	d->progressBar->setVisible(false);
 	d->lastStatusMessage = tr("%Ln file(s) saved to %1.", "", n)
 				.arg(QDir::toNativeSeparators(path));
@@ -409,6 +449,57 @@ void StatusBarManager::filesSaved(int n, const QString &path)
 	d->tmrHideProgressBar.stop();
 }
 
+/**
+ * Saving files has started.
+ * @param filesToExport Number of files to save
+ */
+void StatusBarManager::exportStarted(int filesToExport)
+{
+	Q_D(StatusBarManager);
+
+	// Initialize the export status.
+	// NOTE: When exporting, lastStatusMessage is set by updateStatusBar().
+	d->scanning = false;
+	d->exporting = true;
+	d->filesExported = 0;
+	d->filesToExport = filesToExport;
+	d->updateStatusBar();
+
+	// Stop the Hide Progress Bar timer.
+	d->tmrHideProgressBar.stop();
+}
+
+/**
+ * Update the status of saving files.
+ * @param filesExported Number of files processed so far
+ * @param filesToExport Number of files to save
+ */
+void StatusBarManager::exportUpdate(int filesExported, int filesToExport)
+{
+	Q_D(StatusBarManager);
+	if (!d->exporting)
+		return;
+
+	d->filesExported = filesExported;
+	d->filesToExport = filesToExport;
+	d->updateStatusBar();
+}
+
+/**
+ * Saving files was cancelled.
+ * @param n Number of files saved before cancelling
+ */
+void StatusBarManager::exportCancelled(int n)
+{
+	Q_D(StatusBarManager);
+	d->exporting = false;
+	d->lastStatusMessage = tr("Save cancelled. %Ln file(s) saved.", "", n);
+	d->updateStatusBar();
+
+	// Hide the progress bar after a few seconds.
+	d->tmrHideProgressBar.start();
+}
+
 /** Private Slots **/
 
 /**
@@ -425,6 +516,8 @@ void StatusBarManager::object_destroyed_slot(QObject *obj)
 		d->statusBar = nullptr;
 	} else if (obj == d->lblMessage) {
 		d->lblMessage = nullptr;
+	} else if (obj == d->btnCancel) {
+		d->btnCancel = nullptr;
 	} else if (obj == d->progressBar) {
 		// Stop the Hide Progress Bar timer.
 		d->tmrHideProgressBar.stop();
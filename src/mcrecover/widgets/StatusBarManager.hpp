@@ -98,6 +98,32 @@ public slots:
 	 */
 	void filesSaved(int n, const QString &path);
 
+	/**
+	 * Saving files has started.
+	 * @param filesToExport Number of files to save
+	 */
+	void exportStarted(int filesToExport);
+
+	/**
+	 * Update the status of saving files.
+	 * @param filesExported Number of files processed so far
+	 * @param filesToExport Number of files to save
+	 */
+	void exportUpdate(int filesExported, int filesToExport);
+
+	/**
+	 * Saving files was cancelled.
+	 * @param n Number of files saved before cancelling
+	 */
+	void exportCancelled(int n);
+
+signals:
+	/**
+	 * The user clicked the "Cancel" button.
+	 * (Only visible while saving files.)
+	 */
+	void cancelRequested(void);
+
 private slots:
 	/**
 	 * An object has been destroyed.
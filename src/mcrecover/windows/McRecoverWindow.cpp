@@ -9,7 +9,6 @@
 #include "config.mcrecover.h"
 #include "McRecoverWindow.hpp"
 #include "util/array_size.h"
-#include "util/bitstuff.h"
 
 #include "McRecoverQApplication.hpp"
 #include "AboutDialog.hpp"
@@ -18,14 +17,12 @@
 #include "libmemcard/GcnCard.hpp"
 #include "libmemcard/GcnFile.hpp"
 #include "libmemcard/MemCardModel.hpp"
+#include "libmemcard/FileCollectionModel.hpp"
 #include "libmemcard/MemCardItemDelegate.hpp"
 #include "libmemcard/MemCardSortFilterProxyModel.hpp"
 
-// GciCard
-#include "libmemcard/GciCard.hpp"
-
-// VmuCard
-#include "libmemcard/VmuCard.hpp"
+// Card factory
+#include "libmemcard/CardFactory.hpp"
 
 // File database
 #include "db/GcnMcFileDb.hpp"
@@ -35,6 +32,9 @@
 #include "db/GcnSearchThread.hpp"
 #include "widgets/StatusBarManager.hpp"
 
+// File exporter
+#include "FileExporter.hpp"
+
 // Taskbar Button Manager
 #include "TaskbarButtonManager/TaskbarButtonManager.hpp"
 #include "TaskbarButtonManager/TaskbarButtonManagerFactory.hpp"
@@ -48,7 +48,6 @@
 
 // C++ includes
 #include <vector>
-using std::list;
 using std::vector;
 
 // Qt includes
@@ -101,6 +100,25 @@ public:
 	MemCardModel *model;
 	MemCardSortFilterProxyModel *proxyModel;
 
+	// Model for cards with a large number of files,
+	// e.g. GCI directories. Icons aren't animated.
+	FileCollectionModel *collectionModel;
+	static const int LARGE_CARD_FILE_COUNT = 1024;
+
+	/**
+	 * Set the card to show in the file list.
+	 * Cards with a large number of files use FileCollectionModel.
+	 * @param card Card, or nullptr to clear the file list.
+	 */
+	void setModelCard(Card *card);
+
+	/**
+	 * Get the File for a source model row.
+	 * @param row Source model row
+	 * @return File, or nullptr on error.
+	 */
+	File *fileForSourceRow(int row) const;
+
 	/**
 	 * Format a file size
 	 * @param size File size
@@ -161,6 +179,10 @@ public:
 	 */
 	void saveFiles(const QVector<File*> &files, QString path = QString());
 
+	// File exporter
+	FileExporter *exporter;
+	QString exportPath;	// Absolute path, with trailing slash
+
 	// UI busy counter
 	int uiBusyCounter;
 
@@ -208,18 +230,6 @@ public:
 	// Shh... it's a secret to everybody.
 	HerpDerpEggListener *herpDerp;
 
-	/**
-	 * Read a memory card file and try to guess
-	 * what system it's for.
-	 *
-	 * NOTE: This function will actually just check for VMU.
-	 * If the VMU header is missing, it will assume GCN.
-	 *
-	 * @param filename Memory card filename
-	 * @return McRecoverWindow::FileType
-	 */
-	static McRecoverWindow::FileType checkCardType(const QString &filename);
-
 	// Taskbar Button Manager
 	TaskbarButtonManager *taskbarButtonManager;
 };
@@ -229,9 +239,11 @@ McRecoverWindowPrivate::McRecoverWindowPrivate(McRecoverWindow *q)
 	, card(nullptr)
 	, model(new MemCardModel(q))
 	, proxyModel(new MemCardSortFilterProxyModel(q))
+	, collectionModel(new FileCollectionModel(q))
 	, cols_init(false)
 	, searchThread(new GcnSearchThread(q))
 	, statusBarManager(nullptr)
+	, exporter(new FileExporter(q))
 	, uiBusyCounter(0)
 	, preferredRegion(0)
 	, lblPreferredRegion(nullptr)
@@ -247,16 +259,26 @@ McRecoverWindowPrivate::McRecoverWindowPrivate(McRecoverWindow *q)
 			 q, &McRecoverWindow::memCardModel_layoutChanged);
 	QObject::connect(model, &MemCardModel::rowsInserted,
 			 q, &McRecoverWindow::memCardModel_rowsInserted);
+	QObject::connect(collectionModel, &FileCollectionModel::layoutChanged,
+			 q, &McRecoverWindow::memCardModel_layoutChanged);
+	QObject::connect(collectionModel, &FileCollectionModel::rowsInserted,
+			 q, &McRecoverWindow::memCardModel_rowsInserted);
 
 	// Connect the SearchThread slots.
-	QObject::connect(searchThread, &GcnSearchThread::searchFinished,
-			 q, &McRecoverWindow::searchThread_searchFinished_slot);
+	QObject::connect(searchThread, &GcnSearchThread::fileFound,
+			 q, &McRecoverWindow::searchThread_fileFound_slot);
+	QObject::connect(searchThread, &GcnSearchThread::provisionalFileFound,
+			 q, &McRecoverWindow::searchThread_fileFound_slot);
+	QObject::connect(searchThread, &GcnSearchThread::provisionalFilesDiscarded,
+			 q, &McRecoverWindow::searchThread_provisionalFilesDiscarded_slot);
 
 	// Connect searchThread to the mark-as-busy slots.
 	QObject::connect(searchThread, &GcnSearchThread::searchStarted,
 			 q, &McRecoverWindow::markUiBusy);
 	QObject::connect(searchThread, &GcnSearchThread::searchFinished,
 			 q, &McRecoverWindow::markUiNotBusy);
+	QObject::connect(searchThread, &GcnSearchThread::searchCancelled,
+			 q, &McRecoverWindow::markUiNotBusy);
 	QObject::connect(searchThread, &GcnSearchThread::searchError,
 			 q, &McRecoverWindow::markUiNotBusy);
 	QObject::connect(searchThread, &QObject::destroyed,
@@ -278,12 +300,20 @@ McRecoverWindowPrivate::~McRecoverWindowPrivate()
 	// Save the configuration.
 	cfg->save();
 
-	// NOTE: Delete the MemCardModel first to prevent issues later.
+	// Stop the search before deleting the card.
+	// NOTE: If checkpoints are enabled, the search
+	// will resume the next time this card is searched.
+	delete searchThread;
+
+	// Cancel the current export before deleting the card.
+	// This waits for the worker threads to finish.
+	delete exporter;
+
+	// NOTE: Delete the models first to prevent issues later.
 	delete model;
+	delete collectionModel;
 	delete card;
 
-	// TODO: Wait for searchThread to finish?
-	delete searchThread;
 	delete taskbarButtonManager;
 }
 
@@ -331,12 +361,52 @@ void McRecoverWindowPrivate::updateLstFileList(void)
 	updateActionEnableStatus();
 
 	// Resize the columns to fit the contents.
-	int num_sections = model->columnCount();
+	int num_sections = proxyModel->columnCount();
 	for (int i = 0; i < num_sections; i++)
 		ui.lstFileList->resizeColumnToContents(i);
 	ui.lstFileList->resizeColumnToContents(num_sections);
 }
 
+/**
+ * Set the card to show in the file list.
+ * Cards with a large number of files use FileCollectionModel.
+ * @param card Card, or nullptr to clear the file list.
+ */
+void McRecoverWindowPrivate::setModelCard(Card *card)
+{
+	model->setCard(nullptr);
+	collectionModel->clear();
+
+	QAbstractItemModel *srcModel = model;
+	if (card) {
+		if (card->fileCount() >= LARGE_CARD_FILE_COUNT) {
+			// Large card. File metadata is paged in
+			// on demand, and most images aren't resident.
+			collectionModel->addCard(card);
+			srcModel = collectionModel;
+		} else {
+			model->setCard(card);
+		}
+	}
+
+	if (proxyModel->sourceModel() != srcModel) {
+		proxyModel->setSourceModel(srcModel);
+	}
+}
+
+/**
+ * Get the File for a source model row.
+ * @param row Source model row
+ * @return File, or nullptr on error.
+ */
+File *McRecoverWindowPrivate::fileForSourceRow(int row) const
+{
+	if (proxyModel->sourceModel() == collectionModel) {
+		return collectionModel->file(row);
+	}
+	return (card ? card->getFile(row) : nullptr);
+}
+
 /**
  * Initialize the toolbar.
  */
@@ -448,11 +518,13 @@ void McRecoverWindowPrivate::updateActionEnableStatus(void)
 	} else {
 		// Memory card image is loaded.
 		// TODO: Disable open, scan, and save (all) if we're scanning.
+		// Saving is disabled while files are being saved.
+		const bool exporting = exporter->isRunning();
 		ui.actionClose->setEnabled(true);
 		ui.actionScan->setEnabled(true);
-		ui.actionSave->setEnabled(
+		ui.actionSave->setEnabled(!exporting &&
 			ui.lstFileList->selectionModel()->hasSelection());
-		ui.actionSaveAll->setEnabled(card->fileCount() > 0);
+		ui.actionSaveAll->setEnabled(!exporting && card->fileCount() > 0);
 	}
 }
 
@@ -503,7 +575,7 @@ void McRecoverWindowPrivate::saveFiles(const QVector<File*> &files, QString path
 {
 	Q_Q(McRecoverWindow);
 
-	if (files.isEmpty())
+	if (files.isEmpty() || exporter->isRunning())
 		return;
 
 	const bool extractBanners = ui.actionExtractBanners->isChecked();
@@ -518,20 +590,9 @@ void McRecoverWindowPrivate::saveFiles(const QVector<File*> &files, QString path
 		extIcon = QLatin1String(".icon");
 	}
 
-	// Save files using default filenames to the specified path.
-	enum class OverwriteAllStatus {
-		Unknown		= 0,
-		YesToAll	= 1,
-		NoToAll		= 2,
-	};
-
-	int filesSaved = 0;
-	OverwriteAllStatus overwriteAll = OverwriteAllStatus::Unknown;
-
 	if (files.size() == 1 && path.isEmpty()) {
 		// Single file, path not specified.
 		singleFile = true;
-		overwriteAll = OverwriteAllStatus::YesToAll;
 		File *file = files.at(0);
 
 		const QString defFilename = lastPath() + QChar(L'/') +
@@ -564,91 +625,72 @@ void McRecoverWindowPrivate::saveFiles(const QVector<File*> &files, QString path
 		setLastPath(path);
 	}
 
-	// Animted image format for icons.
-	GcImageWriter::AnimImageFormat animImgf = animIconFormat();
-
+	// Determine the filenames.
+	QVector<FileExporter::Item> items;
+	items.reserve(files.size());
+	QStringList existingFiles;
 	foreach (File *file, files) {
-		if (!singleFile) {
+		FileExporter::Item item;
+		item.file = file;
+		if (singleFile) {
+			item.filename = filename;
+		} else {
 			const QString exportFilename = file->defaultExportFilename();
-			filename = path + QChar(L'/') + exportFilename;
+			item.filename = path + QChar(L'/') + exportFilename;
 
 			// Check if the file exists.
 			// NOTE: Not done in the case of a single file because
 			// the "Save" dialog already prompted the user.
-			if (QFile::exists(filename)) {
-				if (overwriteAll == OverwriteAllStatus::Unknown) {
-					bool overwrite = false;
-					int ret = QMessageBox::warning(q,
-						McRecoverWindow::tr("File Already Exists"),
-						McRecoverWindow::tr("A file named \"%1\" already exists in the specified directory.\n\n"
-								    "Do you want to overwrite it?")
-								.arg(exportFilename),
-						(QMessageBox::Yes | QMessageBox::No | QMessageBox::YesToAll | QMessageBox::NoToAll),
-						QMessageBox::No);
-					switch (ret) {
-						case QMessageBox::Yes:
-							// Overwrite this file.
-							overwrite = true;
-							break;
-
-						default:
-						case QMessageBox::No:
-						case QMessageBox::Escape:
-							// Don't overwrite this file.
-							overwrite = false;
-							break;
-
-						case QMessageBox::YesToAll:
-							// Overwrite this file and all other files.
-							overwriteAll = OverwriteAllStatus::YesToAll;
-							overwrite = true;
-							break;
-
-						case QMessageBox::NoToAll:
-							// Don't overwrite this file or any other files.
-							overwriteAll = OverwriteAllStatus::NoToAll;
-							overwrite = false;
-							break;
-					}
-
-					if (!overwrite)
-						continue;
-				} else if (overwriteAll == OverwriteAllStatus::NoToAll) {
-					// Don't overwrite any files.
-					continue;
-				}
+			if (QFile::exists(item.filename)) {
+				existingFiles.append(exportFilename);
 			}
 		}
 
-		// Save the file.
-		int ret = file->exportToFile(filename);
-		if (ret == 0) {
-			// File saved successfully.
-			filesSaved++;
-		} else {
-			// An error occurred while saving the file.
-			// TODO: Error details.
-		}
-
-		// Extract the banner.
 		if (extractBanners) {
-			// TODO: Error handling and details.
-			QString bannerFilename = changeFileExtension(filename, extBanner);
-			file->saveBanner(bannerFilename);
+			item.bannerFilename = changeFileExtension(item.filename, extBanner);
+		}
+		if (extractIcons && file->iconCount() >= 1) {
+			item.iconFilename = changeFileExtension(item.filename, extIcon);
 		}
+		items.append(item);
+	}
+
+	if (!existingFiles.isEmpty()) {
+		// Ask the user about all existing files at once.
+		QMessageBox msgBox(QMessageBox::Warning,
+			McRecoverWindow::tr("Files Already Exist"),
+			McRecoverWindow::tr("%Ln file(s) already exist in the specified directory.\n\n"
+					    "Do you want to overwrite them?", "", existingFiles.size()),
+			(QMessageBox::YesToAll | QMessageBox::NoToAll | QMessageBox::Cancel), q);
+		msgBox.setDefaultButton(QMessageBox::NoToAll);
+		msgBox.setDetailedText(existingFiles.join(QChar(L'\n')));
+		switch (msgBox.exec()) {
+			case QMessageBox::YesToAll:
+				// Overwrite all existing files.
+				break;
 
-		// Extract the icon.
-		if (extractIcons) {
-			// TODO: Error handling and details.
-			if (file->iconCount() >= 1) {
-				// File has an icon.
-				QString iconFilename = changeFileExtension(filename, extIcon);
-				file->saveIcon(iconFilename, animImgf);
+			case QMessageBox::NoToAll: {
+				// Skip all existing files.
+				QVector<FileExporter::Item> newItems;
+				newItems.reserve(items.size() - existingFiles.size());
+				foreach (const FileExporter::Item &item, items) {
+					if (!QFile::exists(item.filename)) {
+						newItems.append(item);
+					}
+				}
+				items.swap(newItems);
+				break;
 			}
+
+			default:
+			case QMessageBox::Cancel:
+			case QMessageBox::Escape:
+				// Don't save anything.
+				return;
 		}
 	}
 
-	// Update the status bar.
+	// Status bar path.
 	QDir dir;
 	if (singleFile) {
 		QFileInfo fileInfo(filename);
@@ -656,16 +698,19 @@ void McRecoverWindowPrivate::saveFiles(const QVector<File*> &files, QString path
 	} else {
 		dir = QDir(path);
 	}
-	QString absolutePath = dir.absolutePath();
+	exportPath = dir.absolutePath();
 
 	// Make sure tha path has a trailing slash.
-	if (!absolutePath.isEmpty() &&
-		absolutePath.at(absolutePath.size() - 1) != QChar(L'/'))
+	if (!exportPath.isEmpty() &&
+		exportPath.at(exportPath.size() - 1) != QChar(L'/'))
 	{
-		absolutePath += QChar(L'/');
+		exportPath += QChar(L'/');
 	}
 
-	statusBarManager->filesSaved(filesSaved, absolutePath);
+	// Save the files in the background.
+	// Animated image format for icons.
+	exporter->start(items, animIconFormat());
+	updateActionEnableStatus();
 }
 
 /**
@@ -753,79 +798,6 @@ GcImageWriter::AnimImageFormat McRecoverWindowPrivate::animIconFormat(void) cons
 	return animImgf;
 }
 
-/**
- * Read a memory card file and try to guess
- * what system it's for.
- *
- * NOTE: This function will actually just check for VMU.
- * If the VMU header is missing, it will assume GCN
- * if the filesize is a power of two, or GCI if it has
- * a 64-byte header.
- *
- * @param filename Memory card filename
- * @return McRecoverWindow::FileType
- */
-McRecoverWindow::FileType McRecoverWindowPrivate::checkCardType(const QString &filename)
-{
-	QFile file(filename);
-
-	const qint64 filesize = file.size();
-	if (filesize == 131072) {
-		// Possibly a Dreamcast VMU.
-		// TODO: Support for 4x cards, though
-		// 4x dumps are likely "four regular dumps".
-
-		// Check if 0x1FE00 - 0x1FE0F is all 0x55.
-		// If it is, then this is probably a VMU.
-		if (!file.open(QIODevice::ReadOnly))
-			goto not_vmu;
-		if (!file.seek(0x1FE00))
-			goto not_vmu;
-
-		// Read the data.
-		QByteArray ba = file.read(16);
-		if (ba.size() != 16)
-			goto not_vmu;
-
-		// Make sure all 16 bytes are 0x55.
-		const char *data = ba.data();
-		for (int i = ba.size(); i > 0; i--, data++) {
-			if (*data != 0x55) {
-				goto not_vmu;
-			}
-		}
-
-		// This is probably a VMU.
-		return McRecoverWindow::FileType::VMS;
-	}
-
-not_vmu:
-	// Check for a valid GCN memory card size:
-	// - Minimum: 512 KiB
-	// - Maximum: 16 MiB
-	// - Must be a power of two.
-	if (filesize >= 512*1024 && filesize <= 16*1024*1024 &&
-	    isPow2((unsigned int)filesize))
-	{
-		// Power of two. This is probably a GCN memory card.
-		return McRecoverWindow::FileType::GCN;
-	}
-
-	// Check for a valid GCN file size:
-	// - Minimum: 8 KiB + 64
-	// - Maximum: 16,344 KiB + 64
-	// - Must be a multiple of 8 KiB, plus 64 bytes.
-	if (filesize >= ((8*1024)+64) && filesize <= ((16344*1024)+64) &&
-	    ((filesize - 64) % 8192) == 0)
-	{
-		// This is probably a GCI file.
-		return McRecoverWindow::FileType::GCI;
-	}
-
-	// Unknown file type.
-	return McRecoverWindow::FileType::Unknown;
-}
-
 
 /** McRecoverWindow **/
 
@@ -884,6 +856,8 @@ McRecoverWindow::McRecoverWindow(QWidget *parent)
 	// Connect the lstFileList slots.
 	connect(d->ui.lstFileList->selectionModel(), &QItemSelectionModel::selectionChanged,
 		this, &McRecoverWindow::lstFileList_selectionModel_selectionChanged);
+	connect(d->ui.lstFileList, &QTreeViewOpt::visibleRowsChanged,
+		this, &McRecoverWindow::lstFileList_visibleRowsChanged);
 
 	// Initialize the UI.
 	d->updateLstFileList();
@@ -891,6 +865,18 @@ McRecoverWindow::McRecoverWindow(QWidget *parent)
 	d->statusBarManager = new StatusBarManager(d->ui.statusBar, this);
 	d->updateWindowTitle();
 
+	// Connect the FileExporter slots.
+	connect(d->exporter, &FileExporter::exportStarted,
+		d->statusBarManager, &StatusBarManager::exportStarted);
+	connect(d->exporter, &FileExporter::exportUpdate,
+		d->statusBarManager, &StatusBarManager::exportUpdate);
+	connect(d->exporter, &FileExporter::exportFinished,
+		this, &McRecoverWindow::exporter_exportFinished_slot);
+	connect(d->exporter, &FileExporter::exportCancelled,
+		this, &McRecoverWindow::exporter_exportCancelled_slot);
+	connect(d->statusBarManager, &StatusBarManager::cancelRequested,
+		d->exporter, &FileExporter::cancel);
+
 	// Shh... it's a secret to everybody.
 	connect(d->ui.lstFileList, &QTreeViewOpt::keyPress,
 		d->herpDerp, &HerpDerpEggListener::widget_keyPress);
@@ -922,7 +908,9 @@ void McRecoverWindow::openCard(const QString &filename, FileType type)
 	Q_D(McRecoverWindow);
 
 	if (d->card) {
-		d->model->setCard(nullptr);
+		// Stop the current export before deleting the card.
+		d->exporter->stop();
+		d->setModelCard(nullptr);
 		d->ui.mcCardView->setCard(nullptr);
 		d->ui.mcfFileView->setFile(nullptr);
 		d->chkAllowWrite->setEnabled(false);
@@ -930,37 +918,18 @@ void McRecoverWindow::openCard(const QString &filename, FileType type)
 		delete d->card;
 	}
 
-	/** TODO: CardFactory **/
-
-	// TODO: Use an enum for 'type'?
-	if (type == FileType::Unknown) {
-		// Check what type of card this is.
-		type = d->checkCardType(filename);
-		if (type == FileType::Unknown) {
-			// Still unknown.
-			// Assume GCN.
-			type = FileType::GCN;
-		}
-	}
-
 	// Open the specified memory card image.
+	// If the type is unknown, CardFactory will check the file contents.
 	// TODO: Set this as the last path?
-	const char *className;
-	switch (type) {
-		default:
-		case FileType::GCN:
-			className = "GcnCard";
-			d->card = GcnCard::open(filename, this);
-			break;
-		case FileType::GCI:
-			className = "GciCard";
-			d->card = GciCard::open(filename, this);
-			break;
-		case FileType::VMS:
-			className = "VmuCard";
-			d->card = VmuCard::open(filename, this);
-			break;
+	static_assert((int)FileType::GCN == (int)CardFactory::CardType::GCN, "FileType::GCN is incorrect");
+	static_assert((int)FileType::GCI == (int)CardFactory::CardType::GCI, "FileType::GCI is incorrect");
+	static_assert((int)FileType::VMS == (int)CardFactory::CardType::VMU, "FileType::VMS is incorrect");
+	CardFactory::CardType cardType = static_cast<CardFactory::CardType>(type);
+	if (cardType == CardFactory::CardType::Unknown) {
+		cardType = CardFactory::probe(filename);
 	}
+	const char *const className = CardFactory::className(cardType);
+	d->card = CardFactory::open(filename, this, cardType);
 
 	if (!d->card || !d->card->isOpen()) {
 		// Could not open the card.
@@ -995,7 +964,7 @@ void McRecoverWindow::openCard(const QString &filename, FileType type)
 
 	// If GCN, check file checksums.
 	// TODO: Run this in a separate thread after loading?
-	if (type == FileType::GCN) {
+	if (qobject_cast<GcnCard*>(d->card) != nullptr) {
 		// TODO: Singleton database management class.
 		// Get the database filenames.
 		QVector<QString> dbFilenames = GcnMcFileDb::GetDbFilenames();
@@ -1010,7 +979,12 @@ void McRecoverWindow::openCard(const QString &filename, FileType type)
 		}
 	}
 
-	d->model->setCard(d->card);
+	d->setModelCard(d->card);
+
+	// Files may be deleted when the file list is reloaded.
+	// Make sure the exporter isn't reading them.
+	connect(d->card, &Card::filesAboutToBeRemoved,
+		d->exporter, &FileExporter::stop);
 
 	// Extract the filename from the path.
 	d->displayFilename = filename;
@@ -1123,7 +1097,9 @@ void McRecoverWindow::closeCard(bool noMsg)
 		productName = d->card->productName();
 	}
 
-	d->model->setCard(nullptr);
+	// Stop the current export before deleting the card.
+	d->exporter->stop();
+	d->setModelCard(nullptr);
 	d->ui.mcCardView->setCard(nullptr);
 	d->ui.mcfFileView->setFile(nullptr);
 	delete d->card;
@@ -1433,7 +1409,7 @@ void McRecoverWindow::on_actionOpen_triggered(void)
 		if (selectedFilter == gcnFilter) {
 			type = FileType::GCN;
 		} else if (selectedFilter == gciFilter) {
-			type = FileType::VMS;
+			type = FileType::GCI;
 		} else if (selectedFilter == vmuFilter) {
 			type = FileType::VMS;
 		} else if (selectedFilter == allFilter) {
@@ -1518,6 +1494,10 @@ void McRecoverWindow::on_actionScan_triggered(void)
 		// that the search has been cancelled.
 	}
 
+	// Save checkpoints, so an interrupted search can be resumed.
+	d->searchThread->setCheckpointFilename(
+		QDir(ConfigStore::ConfigPath()).filePath(QLatin1String("search.checkpoint")));
+
 	// Search blocks for lost files.
 	// TODO: Handle errors.
 	ret = d->searchThread->searchMemCard_async(gcnCard, d->preferredRegion, searchUsedBlocks);
@@ -1525,7 +1505,7 @@ void McRecoverWindow::on_actionScan_triggered(void)
 		// Error starting the thread.
 		// Use the synchronous version.
 		// TODO: Handle errors.
-		// NOTE: Files will be added by searchThread_searchFinished_slot().
+		// NOTE: Files will be added by searchThread_fileFound_slot().
 		ret = d->searchThread->searchMemCard(gcnCard, d->preferredRegion, searchUsedBlocks);
 	}
 }
@@ -1565,7 +1545,7 @@ void McRecoverWindow::on_actionSave_triggered(void)
 
 	foreach(QModelIndex idx, selList) {
 		QModelIndex srcIdx = d->proxyModel->mapToSource(idx);
-		File *file = d->card->getFile(srcIdx.row());
+		File *file = d->fileForSourceRow(srcIdx.row());
 		if (file != nullptr)
 			files.append(file);
 	}
@@ -1685,12 +1665,13 @@ void McRecoverWindow::memCardModel_rowsInserted(void)
 }
 
 /**
- * Search has completed.
- * @param lostFilesFound Number of "lost" files found.
+ * A "lost" file has been found.
+ * This is used for both provisional and final files.
+ * NOTE: Lost files were removed from the card when the search started.
+ * @param searchData Search data
  */
-void McRecoverWindow::searchThread_searchFinished_slot(int lostFilesFound)
+void McRecoverWindow::searchThread_fileFound_slot(const GcnSearchData &searchData)
 {
-	Q_UNUSED(lostFilesFound)
 	Q_D(McRecoverWindow);
 
 	// FIXME: Move "lost files" code to Card?
@@ -1698,14 +1679,43 @@ void McRecoverWindow::searchThread_searchFinished_slot(int lostFilesFound)
 	if (!gcnCard)
 		return;
 
-	// Remove lost files from the card.
-	d->card->removeLostFiles();
+	// Add the directory entry.
+	gcnCard->addLostFile(searchData);
+}
+
+/**
+ * The scan is complete, and blocks are about to be assigned.
+ * Remove the provisional "lost" files. The final files
+ * will be added by searchThread_fileFound_slot().
+ */
+void McRecoverWindow::searchThread_provisionalFilesDiscarded_slot(void)
+{
+	Q_D(McRecoverWindow);
+	if (d->card) {
+		d->card->removeLostFiles();
+	}
+}
 
-	// Get the files found list.
-	list<GcnSearchData> filesFoundList = d->searchThread->filesFoundList();
+/**
+ * FileExporter has finished saving files.
+ * @param filesSaved Number of files saved
+ */
+void McRecoverWindow::exporter_exportFinished_slot(int filesSaved)
+{
+	Q_D(McRecoverWindow);
+	d->statusBarManager->filesSaved(filesSaved, d->exportPath);
+	d->updateActionEnableStatus();
+}
 
-	// Add the directory entries.
-	QList<GcnFile*> files = gcnCard->addLostFiles(filesFoundList);
+/**
+ * Saving files was cancelled.
+ * @param filesSaved Number of files saved before cancelling
+ */
+void McRecoverWindow::exporter_exportCancelled_slot(int filesSaved)
+{
+	Q_D(McRecoverWindow);
+	d->statusBarManager->exportCancelled(filesSaved);
+	d->updateActionEnableStatus();
 }
 
 /**
@@ -1736,7 +1746,7 @@ void McRecoverWindow::lstFileList_selectionModel_selectionChanged(
 		QModelIndex index = d->ui.lstFileList->selectionModel()->currentIndex();
 		if (index.isValid()) {
 			file_idx = d->proxyModel->mapToSource(index).row();
-			file = d->card->getFile(file_idx);
+			file = d->fileForSourceRow(file_idx);
 		}
 	}
 
@@ -1752,6 +1762,46 @@ void McRecoverWindow::lstFileList_selectionModel_selectionChanged(
 	d->herpDerp->setSelGameID(file ? file->gameID() : QString());
 }
 
+/**
+ * lstFileList: The range of visible rows has changed.
+ * @param first First visible row, or -1 if no rows are visible.
+ * @param last Last visible row, or -1 if no rows are visible.
+ */
+void McRecoverWindow::lstFileList_visibleRowsChanged(int first, int last)
+{
+	// Map the visible rows to MemCardModel rows.
+	// The rows may not be contiguous if the list is sorted.
+	Q_D(McRecoverWindow);
+	if (d->proxyModel->sourceModel() != d->model) {
+		// FileCollectionModel doesn't animate icons.
+		return;
+	}
+
+	QVector<int> rows;
+	if (first >= 0 && last >= first) {
+		rows.reserve(last - first + 1);
+		for (int i = first; i <= last; i++) {
+			const QModelIndex srcIdx = d->proxyModel->mapToSource(d->proxyModel->index(i, 0));
+			if (srcIdx.isValid()) {
+				rows.append(srcIdx.row());
+			}
+		}
+	}
+
+	// Only visible rows will be animated.
+	d->model->setVisibleRows(rows);
+}
+
+/**
+ * txtFilter: The filter query has been changed.
+ * @param text Filter query
+ */
+void McRecoverWindow::on_txtFilter_textChanged(const QString &text)
+{
+	Q_D(McRecoverWindow);
+	d->proxyModel->setFilterQuery(text);
+}
+
 /**
  * Animated icon format was changed by the user.
  * @param animIconFormat Animated icon format.
@@ -14,6 +14,9 @@
 #include <QtCore/QString>
 #include <QItemSelection>
 
+// GCN search data
+#include "GcnSearchData.hpp"
+
 // MemCard Recover classes.
 class MemCardFile;
 
@@ -113,12 +116,30 @@ protected slots:
 	void memCardModel_layoutChanged(void);
 	void memCardModel_rowsInserted(void);
 
-	// SearchThread has finished
-	void searchThread_searchFinished_slot(int lostFilesFound);
+	// SearchThread has found a file
+	void searchThread_fileFound_slot(const GcnSearchData &searchData);
+	void searchThread_provisionalFilesDiscarded_slot(void);
+
+	// FileExporter has finished
+	void exporter_exportFinished_slot(int filesSaved);
+	void exporter_exportCancelled_slot(int filesSaved);
 
 	// lstFileList slots
 	void lstFileList_selectionModel_selectionChanged(const QItemSelection& selected, const QItemSelection& deselected);
 
+	/**
+	 * lstFileList: The range of visible rows has changed.
+	 * @param first First visible row, or -1 if no rows are visible.
+	 * @param last Last visible row, or -1 if no rows are visible.
+	 */
+	void lstFileList_visibleRowsChanged(int first, int last);
+
+	/**
+	 * txtFilter: The filter query has been changed.
+	 * @param text Filter query
+	 */
+	void on_txtFilter_textChanged(const QString &text);
+
 	/**
 	 * Set the animated icon format.
 	 * This slot is triggered by a QSignalMapper that